@@ -3,26 +3,63 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
-layout (location = 3) in vec3 aTangent;
+layout (location = 3) in vec4 aTangent;
 layout (location = 4) in vec3 aBitangent;
 
+// The dequantization of the positions is a parameter of the mesh, which advances once per draw.
+layout (location = 5) in vec3 aPositionOffset;
+layout (location = 6) in vec3 aPositionScale;
+
 out vec3 WorldPos;
 out vec3 Normal;
 out vec2 TexCoords;
 out vec3 Tangent;
 out vec3 Bitangent;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 camPos;
+	float gamma;
+	float exposure;
+	int renderOutput;
+	int debugOutput;
+};
+
 uniform mat4 model;
 
+// Compact vertices store quantized positions, octahedral-encoded normals and tangents and the handedness of the bitangent.
+uniform bool compactVertices;
+
+// Vertices in the stream format keep the glTF tangent, whose w component holds the handedness of the bitangent.
+uniform bool tangentHandedness;
+
+vec3 DecodeOctahedral(const vec2 encoded);
+
 void main()
 {	
-	Normal = normalize(vec3(model * vec4(aNormal, 0.0f)));	
-	Tangent = normalize(vec3(model * vec4(aTangent, 0.0f)));	
-	Bitangent = normalize(vec3(model * vec4(aBitangent, 0.0f)));
+	vec3 position = aPositionOffset + aPositionScale * aPos;
+	vec3 normal = aNormal;
+	vec3 tangent = aTangent.xyz;
+	vec3 bitangent = aBitangent;
+
+	if(compactVertices)
+	{
+		normal = DecodeOctahedral(aNormal.xy);
+		tangent = DecodeOctahedral(aTangent.xy);
+		bitangent = cross(normal, tangent) * aBitangent.x;
+	}
+	else if(tangentHandedness)
+	{
+		bitangent = cross(normal, tangent) * aTangent.w;
+	}
+
+	Normal = normalize(vec3(model * vec4(normal, 0.0f)));	
+	Tangent = normalize(vec3(model * vec4(tangent, 0.0f)));	
+	Bitangent = normalize(vec3(model * vec4(bitangent, 0.0f)));
 
     TexCoords = aTexCoords;    
-	WorldPos = vec3(model * vec4(aPos, 1.0));
+	WorldPos = vec3(model * vec4(position, 1.0));
     gl_Position =  projection * view * vec4(WorldPos, 1.0);
 }
\ No newline at end of file
@@ -18,21 +18,30 @@ uniform sampler2D textureRoughness[1];
 uniform bool textureRoughnessAvailable;
 
 // ---------------------------------------------
-//                --- Camera ---
+//                --- Frame ---
 // ---------------------------------------------
-uniform vec3 camPos; 
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 camPos;
+	float gamma;
+	float exposure;
+	int renderOutput;
+	int debugOutput;
+};
 
 // ---------------------------------------------
 //                --- Lights ---
 // ---------------------------------------------
-uniform vec3 lightPositions[4];
-uniform bool isLightActive[4];
-uniform vec3 lightColors[4];
-
-// ---------------------------------------------
-//             --- User settings ---
-// ---------------------------------------------
-uniform int debugOutput;
+layout (std140) uniform LightData
+{
+	vec3 lightPositions[4];
+	vec3 lightColors[4];
+	bool isLightActive[4];
+	mat4 lightSpaceMatrices[4];
+	bool shadowsEnabled;
+};
 
 // ---------------------------------------------
 //              --- Constants ---
@@ -1,11 +1,22 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 5) in vec3 aPositionOffset;
+layout (location = 6) in vec3 aPositionScale;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 camPos;
+	float gamma;
+	float exposure;
+	int renderOutput;
+	int debugOutput;
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * vec4(aPositionOffset + aPositionScale * aPos, 1.0);
 }
\ No newline at end of file
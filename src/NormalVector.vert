@@ -2,17 +2,34 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 5) in vec3 aPositionOffset;
+layout (location = 6) in vec3 aPositionScale;
 
 out VS_OUT {
     vec3 normal;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 camPos;
+	float gamma;
+	float exposure;
+	int renderOutput;
+	int debugOutput;
+};
+
 uniform mat4 model;
 
+uniform bool compactVertices;
+
+vec3 DecodeOctahedral(const vec2 encoded);
+
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);    
-    vs_out.normal = mat3(projection) * mat3(model) * aNormal;
+    vec3 normal = compactVertices ? DecodeOctahedral(aNormal.xy) : aNormal;
+
+    gl_Position = projection * view * model * vec4(aPositionOffset + aPositionScale * aPos, 1.0);    
+    vs_out.normal = mat3(projection) * mat3(model) * normal;
 }
\ No newline at end of file
@@ -32,35 +32,71 @@ uniform bool texturePrefilteredEnvironmentAvailable;
 uniform sampler2D textureBRDFLookup[1];
 uniform bool textureBRDFLookupAvailable;
 
+// ---------------------------------------------
+//                --- Frame ---
+// ---------------------------------------------
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 camPos;
+	float gamma;
+	float exposure;
+	int renderOutput;
+	int debugOutput;
+};
+
 // ---------------------------------------------
 //                --- Lights ---
 // ---------------------------------------------
-uniform vec3 lightPositions[4];
-uniform bool isLightActive[4];
-uniform vec3 lightColors[4];
+layout (std140) uniform LightData
+{
+	vec3 lightPositions[4];
+	vec3 lightColors[4];
+	bool isLightActive[4];
+	mat4 lightSpaceMatrices[4];
+	bool shadowsEnabled;
+};
 
 // ---------------------------------------------
 //                --- Shadows ---
 // ---------------------------------------------
-uniform bool shadowsEnabled;
 uniform sampler2D textureShadows[4];
 uniform bool textureShadowsAvailable;
-uniform mat4 lightSpaceMatrices[4];
-
-// ---------------------------------------------
-//                --- Camera ---
-// ---------------------------------------------
-uniform vec3 camPos;
 
 // ---------------------------------------------
 //             --- User settings ---
 // ---------------------------------------------
-uniform int renderOutput;
-uniform float gamma;
-uniform float exposure;
-uniform bool customMaterialValuesEnabled;
-uniform float customMetalness;
-uniform float customRoughness;
+layout (std140) uniform BrdfData
+{
+	// Blinn-Phong
+	int blinnPhongExponent;
+
+	// Ashikhmin-Shirley: these variables control the shape of the highlight along the tangent and bitangent vectors.
+	int n_u;
+	int n_v;
+
+	// Cook-Torrance
+	int diffuseTerm;
+	int fresnelTerm;
+	int normalDistributionTerm;
+	int geometryTerm;
+	bool customMaterialValuesEnabled;
+	float customMetalness;
+	float customRoughness;
+
+	// Disney
+	float subsurface;
+	float metallic;
+	float specular;
+	float specularTint;
+	float roughness;
+	float anisotropic;
+	float sheen;
+	float sheenTint;
+	float clearcoat;
+	float clearcoatGloss;
+};
 
 // ---------------------------------------------
 //              --- Constants ---
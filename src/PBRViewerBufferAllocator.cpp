@@ -0,0 +1,169 @@
+#include "PBRViewerBufferAllocator.h"
+
+#include <algorithm>
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerBufferAllocator"/> class with an empty buffer.
+/// </summary>
+/// <param name="alignment">The alignment of the offsets and sizes of all ranges.</param>
+PBRViewerBufferAllocator::PBRViewerBufferAllocator( const size_t alignment )
+	: myAlignment(std::max(alignment, static_cast<size_t>(1u)))
+{
+}
+
+/// <summary>
+/// Allocates a range of the buffer.
+/// </summary>
+/// <param name="size">The size of the range, which is rounded up to the alignment.</param>
+/// <param name="offset">The offset of the range.</param>
+/// <returns>True if the buffer has a free range of the size, false if it has to grow first.</returns>
+GLboolean PBRViewerBufferAllocator::Allocate( const size_t size, size_t& offset )
+{
+	const size_t alignedSize = Align(size);
+	if (0u == alignedSize)
+	{
+		offset = 0u;
+		return GL_TRUE;
+	}
+
+	// First fit keeps the ranges at the start of the buffer in use, so the free range at the end stays large.
+	for (auto freeRange = myFreeRanges.begin(); freeRange != myFreeRanges.end(); ++freeRange)
+	{
+		if (freeRange->second < alignedSize)
+		{
+			continue;
+		}
+
+		offset = freeRange->first;
+		const size_t remainingSize = freeRange->second - alignedSize;
+		myFreeRanges.erase(freeRange);
+
+		if (remainingSize > 0u)
+		{
+			myFreeRanges.emplace(offset + alignedSize, remainingSize);
+		}
+
+		myAllocatedSize += alignedSize;
+		return GL_TRUE;
+	}
+
+	return GL_FALSE;
+}
+
+/// <summary>
+/// Frees a range of the buffer.
+/// </summary>
+/// <param name="offset">The offset of the range.</param>
+/// <param name="size">The size of the range as passed to <see cref="Allocate"/>.</param>
+GLvoid PBRViewerBufferAllocator::Free( size_t offset, const size_t size )
+{
+	size_t alignedSize = Align(size);
+	if (0u == alignedSize)
+	{
+		return;
+	}
+
+	myAllocatedSize -= alignedSize;
+
+	// Merge with the free range behind ...
+	auto next = myFreeRanges.lower_bound(offset);
+	if (next != myFreeRanges.end() && offset + alignedSize == next->first)
+	{
+		alignedSize += next->second;
+		next = myFreeRanges.erase(next);
+	}
+
+	// ... and in front of the freed range.
+	if (next != myFreeRanges.begin())
+	{
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			offset = previous->first;
+			alignedSize += previous->second;
+			myFreeRanges.erase(previous);
+		}
+	}
+
+	myFreeRanges.emplace(offset, alignedSize);
+}
+
+/// <summary>
+/// Gets the capacity the buffer needs to allocate a range of the given size, using the free range at the end of the buffer.
+/// </summary>
+/// <param name="size">The size of the range.</param>
+/// <returns>The required capacity or the current one if a free range is large enough.</returns>
+size_t PBRViewerBufferAllocator::GetRequiredCapacity( const size_t size ) const
+{
+	const size_t alignedSize = Align(size);
+	for (const auto& freeRange : myFreeRanges)
+	{
+		if (freeRange.second >= alignedSize)
+		{
+			return myCapacity;
+		}
+	}
+
+	const size_t freeSizeAtEnd = !myFreeRanges.empty() && myFreeRanges.rbegin()->first + myFreeRanges.rbegin()->second == myCapacity
+		                             ? myFreeRanges.rbegin()->second
+		                             : 0u;
+
+	return myCapacity + alignedSize - freeSizeAtEnd;
+}
+
+/// <summary>
+/// Enlarges the buffer. The new space is added to the free range at the end of the buffer.
+/// </summary>
+/// <param name="capacity">The new capacity, which must not be smaller than the current one.</param>
+GLvoid PBRViewerBufferAllocator::Grow( const size_t capacity )
+{
+	const size_t alignedCapacity = capacity / myAlignment * myAlignment;
+	if (alignedCapacity <= myCapacity)
+	{
+		return;
+	}
+
+	// Free the new space like an allocated range, which merges it with the free range at the end.
+	const size_t oldCapacity = myCapacity;
+	myCapacity = alignedCapacity;
+	myAllocatedSize += alignedCapacity - oldCapacity;
+	Free(oldCapacity, alignedCapacity - oldCapacity);
+}
+
+/// <summary>
+/// Frees all ranges and sets the capacity to zero.
+/// </summary>
+GLvoid PBRViewerBufferAllocator::Reset()
+{
+	myFreeRanges.clear();
+	myCapacity = 0u;
+	myAllocatedSize = 0u;
+}
+
+/// <summary>
+/// Gets the capacity of the buffer.
+/// </summary>
+/// <returns>The capacity.</returns>
+size_t PBRViewerBufferAllocator::GetCapacity() const
+{
+	return myCapacity;
+}
+
+/// <summary>
+/// Gets the total size of all allocated ranges.
+/// </summary>
+/// <returns>The allocated size.</returns>
+size_t PBRViewerBufferAllocator::GetAllocatedSize() const
+{
+	return myAllocatedSize;
+}
+
+/// <summary>
+/// Rounds a size up to the alignment.
+/// </summary>
+/// <param name="size">The size to round.</param>
+/// <returns>The aligned size.</returns>
+size_t PBRViewerBufferAllocator::Align( const size_t size ) const
+{
+	return (size + myAlignment - 1u) / myAlignment * myAlignment;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <map>
+
+/// <summary>
+/// This class manages the free ranges of a GPU buffer shared by many meshes (suballocation).
+/// Freed ranges are merged with their free neighbours and reused first-fit, so the memory of a model is recycled by the next one.
+/// The class only does the bookkeeping, it does not issue any OpenGL calls.
+/// </summary>
+class PBRViewerBufferAllocator
+{
+public:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerBufferAllocator"/> class with an empty buffer.
+	/// </summary>
+	/// <param name="alignment">The alignment of the offsets and sizes of all ranges.</param>
+	explicit PBRViewerBufferAllocator( size_t alignment = 1u );
+
+	/// <summary>
+	/// Allocates a range of the buffer.
+	/// </summary>
+	/// <param name="size">The size of the range, which is rounded up to the alignment.</param>
+	/// <param name="offset">The offset of the range.</param>
+	/// <returns>True if the buffer has a free range of the size, false if it has to grow first.</returns>
+	GLboolean Allocate( size_t size, size_t& offset );
+
+	/// <summary>
+	/// Frees a range of the buffer.
+	/// </summary>
+	/// <param name="offset">The offset of the range.</param>
+	/// <param name="size">The size of the range as passed to <see cref="Allocate"/>.</param>
+	GLvoid Free( size_t offset, size_t size );
+
+	/// <summary>
+	/// Gets the capacity the buffer needs to allocate a range of the given size, using the free range at the end of the buffer.
+	/// </summary>
+	/// <param name="size">The size of the range.</param>
+	/// <returns>The required capacity or the current one if a free range is large enough.</returns>
+	size_t GetRequiredCapacity( size_t size ) const;
+
+	/// <summary>
+	/// Enlarges the buffer. The new space is added to the free range at the end of the buffer.
+	/// </summary>
+	/// <param name="capacity">The new capacity, which must not be smaller than the current one.</param>
+	GLvoid Grow( size_t capacity );
+
+	/// <summary>
+	/// Frees all ranges and sets the capacity to zero.
+	/// </summary>
+	GLvoid Reset();
+
+	/// <summary>
+	/// Gets the capacity of the buffer.
+	/// </summary>
+	/// <returns>The capacity.</returns>
+	size_t GetCapacity() const;
+
+	/// <summary>
+	/// Gets the total size of all allocated ranges.
+	/// </summary>
+	/// <returns>The allocated size.</returns>
+	size_t GetAllocatedSize() const;
+
+private:
+	size_t myAlignment;
+	size_t myCapacity = 0u;
+	size_t myAllocatedSize = 0u;
+
+	// The free ranges ordered by their offset, mapped to their size.
+	std::map<size_t, size_t> myFreeRanges;
+
+	/// <summary>
+	/// Rounds a size up to the alignment.
+	/// </summary>
+	/// <param name="size">The size to round.</param>
+	/// <returns>The aligned size.</returns>
+	size_t Align( size_t size ) const;
+};
@@ -0,0 +1,998 @@
+#include "PBRViewerBvh.h"
+
+#include "PBRViewerThreadPool.h"
+
+#include <glm/geometric.hpp>
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <limits>
+#include <numeric>
+
+// Triangles gathered by one task.
+static const GLuint TrianglesPerGatherTask = 1u << 16;
+
+// The traversal stack holds the unvisited children of all nodes along the current path, which the median splits keep short.
+static const GLuint TraversalStackSize = 256u;
+
+// The cost of visiting a node relative to the cost of intersecting a triangle.
+static const GLfloat TraversalCost = 1.0f;
+
+/// <summary>
+/// Gets the number of indices of the full detail level of a mesh.
+/// </summary>
+/// <param name="mesh">The mesh data.</param>
+/// <returns>The number of indices without the appended levels of detail.</returns>
+static GLuint GetNumberOfFullDetailIndices( PBRViewerMeshData const& mesh )
+{
+	if (nullptr != mesh.MappedLods && mesh.NumberOfMappedLods > 0u)
+	{
+		return mesh.MappedLods[0].NumberOfIndices;
+	}
+
+	if (!mesh.Lods.empty())
+	{
+		return mesh.Lods[0].NumberOfIndices;
+	}
+
+	if (nullptr != mesh.MappedIndices || nullptr != mesh.MappedStreamIndices)
+	{
+		return mesh.NumberOfMappedIndices;
+	}
+
+	return static_cast<GLuint>(mesh.Indices.size());
+}
+
+/// <summary>
+/// Reads an index of a mesh from the mapped or the owned index buffer.
+/// </summary>
+/// <param name="mesh">The mesh data.</param>
+/// <param name="index">The position of the index within the index buffer.</param>
+/// <returns>The vertex the index refers to.</returns>
+static GLuint ReadIndex( PBRViewerMeshData const& mesh, const GLuint index )
+{
+	if (nullptr != mesh.MappedStreamIndices)
+	{
+		switch (mesh.MappedStreamIndexType)
+		{
+		case GL_UNSIGNED_BYTE:
+			return static_cast<const GLubyte*>(mesh.MappedStreamIndices)[index];
+		case GL_UNSIGNED_SHORT:
+			return static_cast<const GLushort*>(mesh.MappedStreamIndices)[index];
+		default:
+			return static_cast<const GLuint*>(mesh.MappedStreamIndices)[index];
+		}
+	}
+
+	return nullptr != mesh.MappedIndices ? mesh.MappedIndices[index] : mesh.Indices[index];
+}
+
+/// <summary>
+/// Reads the position of a vertex of a mesh in any of the vertex formats. Compact positions are dequantized like the vertex shaders do.
+/// </summary>
+/// <param name="mesh">The mesh data.</param>
+/// <param name="vertex">The index of the vertex.</param>
+/// <returns>The position in model space.</returns>
+static glm::vec3 ReadPosition( PBRViewerMeshData const& mesh, const GLuint vertex )
+{
+	switch (mesh.VertexFormat)
+	{
+	case PBRViewerEnumerations::Streams:
+	{
+		// The glTF loader only keeps streams with float positions, which are not necessarily aligned within their buffer.
+		const VertexStream& positions = mesh.Streams[PBRViewerEnumerations::PositionStream];
+		glm::vec3 position;
+		std::memcpy(&position[0], positions.Data + static_cast<size_t>(vertex) * static_cast<size_t>(positions.Stride), sizeof(GLfloat) * 3u);
+		return position;
+	}
+	case PBRViewerEnumerations::Quantized:
+	{
+		const CompactVertex& compactVertex = nullptr != mesh.MappedCompactVertices ? mesh.MappedCompactVertices[vertex] : mesh.CompactVertices[vertex];
+		const glm::vec3 quantizedPosition(compactVertex.Position[0], compactVertex.Position[1], compactVertex.Position[2]);
+		return mesh.PositionOffset + mesh.PositionScale * (quantizedPosition / 65535.0f);
+	}
+	default:
+		return nullptr != mesh.MappedVertices ? mesh.MappedVertices[vertex].Position : mesh.Vertices[vertex].Position;
+	}
+}
+
+/// <summary>
+/// Gets the bin of a centroid along an axis. Binning and partitioning use the same calculation, so they agree on every triangle.
+/// </summary>
+/// <param name="centroid">The coordinate of the centroid along the axis.</param>
+/// <param name="minimum">The minimum of the centroid bounds along the axis.</param>
+/// <param name="scale">The number of bins divided by the extent of the centroid bounds along the axis.</param>
+/// <param name="numberOfBins">The number of bins.</param>
+/// <returns>The index of the bin.</returns>
+static GLuint GetBin( const GLfloat centroid, const GLfloat minimum, const GLfloat scale, const GLuint numberOfBins )
+{
+	const GLuint bin = static_cast<GLuint>(std::max(0.0f, (centroid - minimum) * scale));
+	return bin < numberOfBins ? bin : numberOfBins - 1u;
+}
+
+/// <summary>
+/// Runs a function on consecutive chunks of a range. The chunks are processed in parallel on the thread pool if there is more than one.
+/// </summary>
+/// <param name="first">The first element of the range.</param>
+/// <param name="count">The number of elements.</param>
+/// <param name="numberOfChunks">The number of chunks to split the range into.</param>
+/// <param name="function">The function receiving the index, the first element and the number of elements of a chunk.</param>
+static GLvoid ForEachChunk( const GLuint first, const GLuint count, const GLuint numberOfChunks,
+                           std::function<GLvoid( GLuint, GLuint, GLuint )> const& function )
+{
+	if (numberOfChunks <= 1u)
+	{
+		function(0u, first, count);
+		return;
+	}
+
+	std::vector<std::future<GLvoid>> pendingChunks;
+	pendingChunks.reserve(numberOfChunks);
+
+	for (GLuint chunk = 0; chunk < numberOfChunks; chunk++)
+	{
+		const GLuint chunkBegin = first + static_cast<GLuint>(static_cast<uint64_t>(count) * chunk / numberOfChunks);
+		const GLuint chunkEnd = first + static_cast<GLuint>(static_cast<uint64_t>(count) * (chunk + 1u) / numberOfChunks);
+
+		pendingChunks.push_back(PBRViewerThreadPool::GetInstance().Enqueue([&function, chunk, chunkBegin, chunkEnd]()
+		{
+			function(chunk, chunkBegin, chunkEnd - chunkBegin);
+		}));
+	}
+
+	for (std::future<GLvoid>& pendingChunk : pendingChunks)
+	{
+		pendingChunk.get();
+	}
+}
+
+/// <summary>
+/// Initializes a new instance of the <see cref="Bounds"/> struct as empty box.
+/// </summary>
+PBRViewerBvh::Bounds::Bounds()
+	: Min(std::numeric_limits<GLfloat>::max()),
+	  Max(-std::numeric_limits<GLfloat>::max())
+{
+}
+
+/// <summary>
+/// Grows the box so it contains a point.
+/// </summary>
+/// <param name="point">The point to contain.</param>
+GLvoid PBRViewerBvh::Bounds::Grow( const glm::vec3 point )
+{
+	Min = glm::min(Min, point);
+	Max = glm::max(Max, point);
+}
+
+/// <summary>
+/// Grows the box so it contains another box.
+/// </summary>
+/// <param name="bounds">The box to contain.</param>
+GLvoid PBRViewerBvh::Bounds::Grow( Bounds const& bounds )
+{
+	Min = glm::min(Min, bounds.Min);
+	Max = glm::max(Max, bounds.Max);
+}
+
+/// <summary>
+/// Gets half of the surface area of the box, which is all the surface area heuristic needs.
+/// </summary>
+/// <returns>The half surface area or 0 if the box is empty.</returns>
+GLfloat PBRViewerBvh::Bounds::GetHalfArea() const
+{
+	const glm::vec3 extent = Max - Min;
+	if (extent.x < 0.0f || extent.y < 0.0f || extent.z < 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+/// <summary>
+/// Builds the hierarchy over the triangles of all meshes of a scene. A previously built hierarchy is replaced.
+/// The calling thread must not be a worker of the <see cref="PBRViewerThreadPool"/>, since it waits for the tasks of the build.
+/// </summary>
+/// <param name="sceneData">The scene data holding the meshes in any vertex format.</param>
+GLvoid PBRViewerBvh::Build( PBRViewerSceneData const& sceneData )
+{
+	myNodes.clear();
+	myPackets.clear();
+
+	GatherTriangles(sceneData);
+
+	if (!myTriangleOrder.empty())
+	{
+		Collapse(BuildBinaryTree());
+	}
+
+	std::vector<glm::vec3>().swap(myTriangleVertices);
+	std::vector<Bounds>().swap(myTriangleBounds);
+	std::vector<glm::vec3>().swap(myCentroids);
+	std::vector<GLuint>().swap(myTriangleOrder);
+}
+
+/// <summary>
+/// Finds the closest intersection of a ray with the triangles. Both sides of a triangle are hit.
+/// </summary>
+/// <param name="origin">The origin of the ray in model space.</param>
+/// <param name="direction">The direction of the ray in model space. It does not need to be normalized.</param>
+/// <param name="hit">The closest intersection, only valid if the ray hit a triangle.</param>
+/// <returns>True if the ray hit a triangle, false if not.</returns>
+GLboolean PBRViewerBvh::Intersect( const glm::vec3 origin, const glm::vec3 direction, PBRViewerRayHit& hit ) const
+{
+	if (myNodes.empty())
+	{
+		return GL_FALSE;
+	}
+
+	// Axis-parallel rays get a huge but finite inverse, so the slab test never multiplies zero by infinity.
+	glm::vec3 inverseDirection;
+	for (GLint axis = 0; axis < 3; axis++)
+	{
+		inverseDirection[axis] = std::abs(direction[axis]) > 1e-30f ? 1.0f / direction[axis] : std::copysign(1e30f, direction[axis]);
+	}
+
+	const __m128 originX = _mm_set1_ps(origin.x);
+	const __m128 originY = _mm_set1_ps(origin.y);
+	const __m128 originZ = _mm_set1_ps(origin.z);
+	const __m128 directionX = _mm_set1_ps(direction.x);
+	const __m128 directionY = _mm_set1_ps(direction.y);
+	const __m128 directionZ = _mm_set1_ps(direction.z);
+	const __m128 inverseX = _mm_set1_ps(inverseDirection.x);
+	const __m128 inverseY = _mm_set1_ps(inverseDirection.y);
+	const __m128 inverseZ = _mm_set1_ps(inverseDirection.z);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	GLfloat closestDistance = std::numeric_limits<GLfloat>::max();
+	GLuint closestPacket = 0u;
+	GLuint closestLane = 0u;
+	GLfloat closestU = 0.0f;
+	GLfloat closestV = 0.0f;
+	GLboolean isHit = GL_FALSE;
+
+	// The children are pushed with the distance at which the ray enters them, so children behind the closest hit are skipped.
+	GLuint stackChildren[TraversalStackSize];
+	GLubyte stackPackets[TraversalStackSize];
+	GLfloat stackDistances[TraversalStackSize];
+	GLuint stackSize = 1u;
+	stackChildren[0] = 0u;
+	stackPackets[0] = 0u;
+	stackDistances[0] = 0.0f;
+
+	while (stackSize > 0u)
+	{
+		stackSize--;
+		const GLuint child = stackChildren[stackSize];
+		if (stackDistances[stackSize] > closestDistance)
+		{
+			continue;
+		}
+
+		if (0u != (child & LeafFlag))
+		{
+			const GLuint firstPacket = child & ~LeafFlag;
+			for (GLuint packetIndex = firstPacket; packetIndex < firstPacket + stackPackets[stackSize]; packetIndex++)
+			{
+				const TrianglePacket& packet = myPackets[packetIndex];
+
+				// Möller-Trumbore for four triangles at once
+				const __m128 edge1X = _mm_loadu_ps(packet.Edge1X);
+				const __m128 edge1Y = _mm_loadu_ps(packet.Edge1Y);
+				const __m128 edge1Z = _mm_loadu_ps(packet.Edge1Z);
+				const __m128 edge2X = _mm_loadu_ps(packet.Edge2X);
+				const __m128 edge2Y = _mm_loadu_ps(packet.Edge2Y);
+				const __m128 edge2Z = _mm_loadu_ps(packet.Edge2Z);
+
+				const __m128 pX = _mm_sub_ps(_mm_mul_ps(directionY, edge2Z), _mm_mul_ps(directionZ, edge2Y));
+				const __m128 pY = _mm_sub_ps(_mm_mul_ps(directionZ, edge2X), _mm_mul_ps(directionX, edge2Z));
+				const __m128 pZ = _mm_sub_ps(_mm_mul_ps(directionX, edge2Y), _mm_mul_ps(directionY, edge2X));
+				const __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)), _mm_mul_ps(edge1Z, pZ));
+				const __m128 inverseDeterminant = _mm_div_ps(one, determinant);
+
+				const __m128 sX = _mm_sub_ps(originX, _mm_loadu_ps(packet.VertexX));
+				const __m128 sY = _mm_sub_ps(originY, _mm_loadu_ps(packet.VertexY));
+				const __m128 sZ = _mm_sub_ps(originZ, _mm_loadu_ps(packet.VertexZ));
+				const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, pX), _mm_mul_ps(sY, pY)), _mm_mul_ps(sZ, pZ)), inverseDeterminant);
+
+				const __m128 qX = _mm_sub_ps(_mm_mul_ps(sY, edge1Z), _mm_mul_ps(sZ, edge1Y));
+				const __m128 qY = _mm_sub_ps(_mm_mul_ps(sZ, edge1X), _mm_mul_ps(sX, edge1Z));
+				const __m128 qZ = _mm_sub_ps(_mm_mul_ps(sX, edge1Y), _mm_mul_ps(sY, edge1X));
+				const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qX), _mm_mul_ps(directionY, qY)), _mm_mul_ps(directionZ, qZ)),
+				                            inverseDeterminant);
+				const __m128 distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)), _mm_mul_ps(edge2Z, qZ)),
+				                                   inverseDeterminant);
+
+				// Degenerate lanes divide by zero, their NaNs fail all comparisons.
+				__m128 mask = _mm_cmpneq_ps(determinant, zero);
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+				mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), one));
+				mask = _mm_and_ps(mask, _mm_cmpgt_ps(distance, zero));
+				mask = _mm_and_ps(mask, _mm_cmplt_ps(distance, _mm_set1_ps(closestDistance)));
+
+				const GLint hitLanes = _mm_movemask_ps(mask);
+				if (0 == hitLanes)
+				{
+					continue;
+				}
+
+				GLfloat distances[4];
+				GLfloat us[4];
+				GLfloat vs[4];
+				_mm_storeu_ps(distances, distance);
+				_mm_storeu_ps(us, u);
+				_mm_storeu_ps(vs, v);
+
+				for (GLuint lane = 0; lane < 4u; lane++)
+				{
+					if (0 != (hitLanes & (1 << lane)) && distances[lane] < closestDistance)
+					{
+						closestDistance = distances[lane];
+						closestPacket = packetIndex;
+						closestLane = lane;
+						closestU = us[lane];
+						closestV = vs[lane];
+						isHit = GL_TRUE;
+					}
+				}
+			}
+
+			continue;
+		}
+
+		// Slab test against the four children at once
+		const Node& node = myNodes[child];
+		const __m128 minimumX = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinX), originX), inverseX);
+		const __m128 maximumX = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxX), originX), inverseX);
+		const __m128 minimumY = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinY), originY), inverseY);
+		const __m128 maximumY = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxY), originY), inverseY);
+		const __m128 minimumZ = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinZ), originZ), inverseZ);
+		const __m128 maximumZ = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxZ), originZ), inverseZ);
+
+		const __m128 entry = _mm_max_ps(_mm_max_ps(_mm_min_ps(minimumX, maximumX), _mm_min_ps(minimumY, maximumY)),
+		                                _mm_max_ps(_mm_min_ps(minimumZ, maximumZ), zero));
+		const __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(minimumX, maximumX), _mm_max_ps(minimumY, maximumY)),
+		                               _mm_min_ps(_mm_max_ps(minimumZ, maximumZ), _mm_set1_ps(closestDistance)));
+
+		const GLint hitChildren = _mm_movemask_ps(_mm_cmple_ps(entry, exit)) & ((1 << node.NumberOfChildren) - 1);
+		if (0 == hitChildren)
+		{
+			continue;
+		}
+
+		GLfloat entryDistances[4];
+		_mm_storeu_ps(entryDistances, entry);
+
+		// Push the hit children from far to near, so the nearest one is visited next.
+		GLuint order[4];
+		GLuint numberOfHitChildren = 0u;
+		for (GLuint lane = 0; lane < 4u; lane++)
+		{
+			if (0 == (hitChildren & (1 << lane)))
+			{
+				continue;
+			}
+
+			GLuint position = numberOfHitChildren++;
+			while (position > 0u && entryDistances[order[position - 1u]] < entryDistances[lane])
+			{
+				order[position] = order[position - 1u];
+				position--;
+			}
+
+			order[position] = lane;
+		}
+
+		for (GLuint i = 0; i < numberOfHitChildren; i++)
+		{
+			stackChildren[stackSize] = node.Children[order[i]];
+			stackPackets[stackSize] = node.NumberOfPackets[order[i]];
+			stackDistances[stackSize] = entryDistances[order[i]];
+			stackSize++;
+		}
+	}
+
+	if (GL_FALSE == isHit)
+	{
+		return GL_FALSE;
+	}
+
+	const TrianglePacket& packet = myPackets[closestPacket];
+	const GLuint triangle = packet.Triangles[closestLane];
+	const GLuint mesh = static_cast<GLuint>(std::upper_bound(myFirstTriangles.begin(), myFirstTriangles.end(), triangle) - myFirstTriangles.begin()) - 1u;
+
+	const glm::vec3 edge1(packet.Edge1X[closestLane], packet.Edge1Y[closestLane], packet.Edge1Z[closestLane]);
+	const glm::vec3 edge2(packet.Edge2X[closestLane], packet.Edge2Y[closestLane], packet.Edge2Z[closestLane]);
+
+	hit.Distance = closestDistance;
+	hit.Mesh = mesh;
+	hit.Triangle = triangle - myFirstTriangles[mesh];
+	hit.Barycentrics = glm::vec2(closestU, closestV);
+	hit.Position = origin + closestDistance * direction;
+	hit.Normal = glm::normalize(glm::cross(edge1, edge2));
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Gets the number of triangles within the hierarchy.
+/// </summary>
+/// <returns>The number of triangles.</returns>
+GLuint PBRViewerBvh::GetNumberOfTriangles() const
+{
+	return myFirstTriangles.empty() ? 0u : myFirstTriangles.back();
+}
+
+/// <summary>
+/// Gets the number of nodes with four children.
+/// </summary>
+/// <returns>The number of nodes.</returns>
+GLuint PBRViewerBvh::GetNumberOfNodes() const
+{
+	return static_cast<GLuint>(myNodes.size());
+}
+
+/// <summary>
+/// Gets the memory used by the nodes and the triangles.
+/// </summary>
+/// <returns>The size of the hierarchy in bytes.</returns>
+size_t PBRViewerBvh::GetSize() const
+{
+	return sizeof(Node) * myNodes.size() + sizeof(TrianglePacket) * myPackets.size() + sizeof(GLuint) * myFirstTriangles.size();
+}
+
+/// <summary>
+/// Gets a flag indicating if the hierarchy does not contain any triangles.
+/// </summary>
+/// <returns>True if the hierarchy is empty, false if not.</returns>
+GLboolean PBRViewerBvh::IsEmpty() const
+{
+	return myNodes.empty();
+}
+
+/// <summary>
+/// Reads the triangles of the full detail level of all meshes and calculates their bounds and centroids in parallel.
+/// </summary>
+/// <param name="sceneData">The scene data holding the meshes.</param>
+GLvoid PBRViewerBvh::GatherTriangles( PBRViewerSceneData const& sceneData )
+{
+	myFirstTriangles.assign(1u, 0u);
+	for (const PBRViewerMeshData& mesh : sceneData.Meshes)
+	{
+		myFirstTriangles.push_back(myFirstTriangles.back() + GetNumberOfFullDetailIndices(mesh) / 3u);
+	}
+
+	const GLuint numberOfTriangles = myFirstTriangles.back();
+	myTriangleVertices.resize(static_cast<size_t>(numberOfTriangles) * 3u);
+	myTriangleBounds.resize(numberOfTriangles);
+	myCentroids.resize(numberOfTriangles);
+	myTriangleOrder.resize(numberOfTriangles);
+	std::iota(myTriangleOrder.begin(), myTriangleOrder.end(), 0u);
+
+	// Large meshes are split into several tasks.
+	std::vector<std::future<Bounds>> pendingGathers;
+	for (size_t meshIndex = 0; meshIndex < sceneData.Meshes.size(); meshIndex++)
+	{
+		const GLuint firstTriangle = myFirstTriangles[meshIndex];
+		const GLuint meshTriangles = myFirstTriangles[meshIndex + 1u] - firstTriangle;
+
+		for (GLuint taskBegin = 0; taskBegin < meshTriangles; taskBegin += TrianglesPerGatherTask)
+		{
+			const GLuint taskEnd = std::min(meshTriangles, taskBegin + TrianglesPerGatherTask);
+			const PBRViewerMeshData& mesh = sceneData.Meshes[meshIndex];
+
+			pendingGathers.push_back(PBRViewerThreadPool::GetInstance().Enqueue([this, &mesh, firstTriangle, taskBegin, taskEnd]()
+			{
+				// Every task writes to its own triangles only, so the vectors need no locking.
+				Bounds taskBounds;
+				for (GLuint i = taskBegin; i < taskEnd; i++)
+				{
+					const GLuint triangle = firstTriangle + i;
+					Bounds bounds;
+
+					for (GLuint corner = 0; corner < 3u; corner++)
+					{
+						const glm::vec3 position = ReadPosition(mesh, ReadIndex(mesh, i * 3u + corner));
+						myTriangleVertices[static_cast<size_t>(triangle) * 3u + corner] = position;
+						bounds.Grow(position);
+					}
+
+					myTriangleBounds[triangle] = bounds;
+					myCentroids[triangle] = 0.5f * (bounds.Min + bounds.Max);
+					taskBounds.Grow(bounds);
+				}
+
+				return taskBounds;
+			}));
+		}
+	}
+
+	myBounds = Bounds();
+	for (std::future<Bounds>& pendingGather : pendingGathers)
+	{
+		myBounds.Grow(pendingGather.get());
+	}
+}
+
+/// <summary>
+/// Builds the binary tree. The top levels are split on the calling thread, the subtrees below are built by tasks and appended afterwards.
+/// </summary>
+/// <returns>The nodes of the binary tree, the root comes first.</returns>
+std::vector<PBRViewerBvh::BuildNode> PBRViewerBvh::BuildBinaryTree()
+{
+	const GLuint numberOfTriangles = static_cast<GLuint>(myTriangleOrder.size());
+
+	// Enough subtrees to keep all workers busy even if their sizes differ.
+	const GLuint numberOfThreads = std::max(1u, PBRViewerThreadPool::GetInstance().GetNumberOfThreads());
+	GLuint subtreeSize = numberOfTriangles / (numberOfThreads * 8u);
+	if (subtreeSize < MinimumSubtreeSize)
+	{
+		subtreeSize = MinimumSubtreeSize;
+	}
+
+	std::vector<BuildNode> nodes(1u);
+	nodes[0].Box = myBounds;
+	nodes[0].NumberOfTriangles = numberOfTriangles;
+
+	// The nodes still to split on this thread and the roots of the subtrees, each with its depth.
+	std::vector<std::pair<GLuint, GLuint>> pendingNodes(1u, std::make_pair(0u, 0u));
+	std::vector<std::pair<GLuint, GLuint>> subtreeRoots;
+
+	while (!pendingNodes.empty())
+	{
+		const std::pair<GLuint, GLuint> pendingNode = pendingNodes.back();
+		pendingNodes.pop_back();
+
+		if (nodes[pendingNode.first].NumberOfTriangles <= subtreeSize)
+		{
+			subtreeRoots.push_back(pendingNode);
+			continue;
+		}
+
+		BuildNode left;
+		BuildNode right;
+		if (GL_FALSE == SplitNode(nodes[pendingNode.first], pendingNode.second, GL_TRUE, left, right))
+		{
+			continue;
+		}
+
+		const GLuint leftIndex = static_cast<GLuint>(nodes.size());
+		nodes[pendingNode.first].Children[0] = leftIndex;
+		nodes[pendingNode.first].Children[1] = leftIndex + 1u;
+		nodes.push_back(left);
+		nodes.push_back(right);
+		pendingNodes.push_back(std::make_pair(leftIndex, pendingNode.second + 1u));
+		pendingNodes.push_back(std::make_pair(leftIndex + 1u, pendingNode.second + 1u));
+	}
+
+	// The subtrees cover disjoint ranges of the triangle order, so they are built independently.
+	std::vector<std::vector<BuildNode>> subtrees(subtreeRoots.size());
+	std::vector<std::future<GLvoid>> pendingSubtrees;
+	pendingSubtrees.reserve(subtreeRoots.size());
+
+	for (size_t i = 0; i < subtreeRoots.size(); i++)
+	{
+		subtrees[i].push_back(nodes[subtreeRoots[i].first]);
+
+		const GLuint depth = subtreeRoots[i].second;
+		std::vector<BuildNode>& subtree = subtrees[i];
+		pendingSubtrees.push_back(PBRViewerThreadPool::GetInstance().Enqueue([this, &subtree, depth]()
+		{
+			BuildSubtree(subtree, depth);
+		}));
+	}
+
+	for (std::future<GLvoid>& pendingSubtree : pendingSubtrees)
+	{
+		pendingSubtree.get();
+	}
+
+	// The root of a subtree replaces its node, the other nodes are appended.
+	for (size_t i = 0; i < subtrees.size(); i++)
+	{
+		const std::vector<BuildNode>& subtree = subtrees[i];
+		const GLuint offset = static_cast<GLuint>(nodes.size()) - 1u;
+
+		for (size_t j = 0; j < subtree.size(); j++)
+		{
+			BuildNode node = subtree[j];
+			if (0u != node.Children[0])
+			{
+				node.Children[0] += offset;
+				node.Children[1] += offset;
+			}
+
+			if (0u == j)
+			{
+				nodes[subtreeRoots[i].first] = node;
+			}
+			else
+			{
+				nodes.push_back(node);
+			}
+		}
+	}
+
+	return nodes;
+}
+
+/// <summary>
+/// Builds a subtree of the binary tree on the calling thread.
+/// </summary>
+/// <param name="nodes">The nodes to append the subtree to. The root of the subtree has to be the last node already.</param>
+/// <param name="depth">The depth of the root of the subtree.</param>
+GLvoid PBRViewerBvh::BuildSubtree( std::vector<BuildNode>& nodes, const GLuint depth )
+{
+	std::vector<std::pair<GLuint, GLuint>> pendingNodes(1u, std::make_pair(static_cast<GLuint>(nodes.size()) - 1u, depth));
+
+	while (!pendingNodes.empty())
+	{
+		const std::pair<GLuint, GLuint> pendingNode = pendingNodes.back();
+		pendingNodes.pop_back();
+
+		BuildNode left;
+		BuildNode right;
+		if (GL_FALSE == SplitNode(nodes[pendingNode.first], pendingNode.second, GL_FALSE, left, right))
+		{
+			continue;
+		}
+
+		const GLuint leftIndex = static_cast<GLuint>(nodes.size());
+		nodes[pendingNode.first].Children[0] = leftIndex;
+		nodes[pendingNode.first].Children[1] = leftIndex + 1u;
+		nodes.push_back(left);
+		nodes.push_back(right);
+		pendingNodes.push_back(std::make_pair(leftIndex, pendingNode.second + 1u));
+		pendingNodes.push_back(std::make_pair(leftIndex + 1u, pendingNode.second + 1u));
+	}
+}
+
+/// <summary>
+/// Splits the triangles of a node into two children. Small nodes and nodes whose split costs more than the leaf become leaves.
+/// </summary>
+/// <param name="node">The node to split.</param>
+/// <param name="depth">The depth of the node.</param>
+/// <param name="isParallel">True to bin the triangles of large nodes on the thread pool.</param>
+/// <param name="left">The triangles and bounds of the left child.</param>
+/// <param name="right">The triangles and bounds of the right child.</param>
+/// <returns>True if the node was split, false if it stays a leaf.</returns>
+GLboolean PBRViewerBvh::SplitNode( BuildNode const& node, const GLuint depth, const GLboolean isParallel, BuildNode& left, BuildNode& right )
+{
+	const GLuint firstTriangle = node.FirstTriangle;
+	const GLuint numberOfTriangles = node.NumberOfTriangles;
+
+	// A single packet is tested as fast as any split.
+	if (numberOfTriangles <= 4u)
+	{
+		return GL_FALSE;
+	}
+
+	const GLuint numberOfChunks = isParallel && numberOfTriangles >= ParallelBinningThreshold ? std::max(1u, PBRViewerThreadPool::GetInstance().GetNumberOfThreads()) : 1u;
+
+	std::vector<Bounds> chunkBounds(numberOfChunks);
+	std::vector<Bounds> chunkCentroidBounds(numberOfChunks);
+	ForEachChunk(firstTriangle, numberOfTriangles, numberOfChunks, [this, &chunkBounds, &chunkCentroidBounds]( const GLuint chunk, const GLuint first, const GLuint count )
+	{
+		CalculateBounds(first, count, chunkBounds[chunk], chunkCentroidBounds[chunk]);
+	});
+
+	Bounds centroidBounds;
+	for (const Bounds& bounds : chunkCentroidBounds)
+	{
+		centroidBounds.Grow(bounds);
+	}
+
+	const glm::vec3 centroidExtent = centroidBounds.Max - centroidBounds.Min;
+	const GLboolean hasExtent = centroidExtent.x > 0.0f || centroidExtent.y > 0.0f || centroidExtent.z > 0.0f;
+
+	GLint bestAxis = -1;
+	GLuint bestBin = 0u;
+	GLfloat bestCost = std::numeric_limits<GLfloat>::max();
+	Bin bins[3 * NumberOfBins];
+
+	if (hasExtent && depth < MaximumSahDepth)
+	{
+		std::vector<Bin> chunkBins(static_cast<size_t>(numberOfChunks) * 3u * NumberOfBins);
+		ForEachChunk(firstTriangle, numberOfTriangles, numberOfChunks, [this, &chunkBins, &centroidBounds]( const GLuint chunk, const GLuint first, const GLuint count )
+		{
+			FillBins(first, count, centroidBounds, &chunkBins[static_cast<size_t>(chunk) * 3u * NumberOfBins]);
+		});
+
+		for (GLuint chunk = 0; chunk < numberOfChunks; chunk++)
+		{
+			for (GLuint i = 0; i < 3u * NumberOfBins; i++)
+			{
+				const Bin& chunkBin = chunkBins[static_cast<size_t>(chunk) * 3u * NumberOfBins + i];
+				bins[i].Box.Grow(chunkBin.Box);
+				bins[i].NumberOfTriangles += chunkBin.NumberOfTriangles;
+			}
+		}
+
+		// Sweep the split planes between the bins from both sides.
+		for (GLint axis = 0; axis < 3; axis++)
+		{
+			if (centroidExtent[axis] <= 0.0f)
+			{
+				continue;
+			}
+
+			const Bin* axisBins = &bins[axis * NumberOfBins];
+			GLfloat leftCosts[NumberOfBins];
+			Bounds leftBounds;
+			GLuint leftTriangles = 0u;
+			for (GLuint bin = 0; bin < NumberOfBins - 1u; bin++)
+			{
+				leftBounds.Grow(axisBins[bin].Box);
+				leftTriangles += axisBins[bin].NumberOfTriangles;
+				leftCosts[bin] = 0u == leftTriangles ? std::numeric_limits<GLfloat>::max() : leftBounds.GetHalfArea() * static_cast<GLfloat>(leftTriangles);
+			}
+
+			Bounds rightBounds;
+			GLuint rightTriangles = 0u;
+			for (GLuint bin = NumberOfBins - 1u; bin > 0u; bin--)
+			{
+				rightBounds.Grow(axisBins[bin].Box);
+				rightTriangles += axisBins[bin].NumberOfTriangles;
+
+				if (0u == rightTriangles || std::numeric_limits<GLfloat>::max() == leftCosts[bin - 1u])
+				{
+					continue;
+				}
+
+				const GLfloat cost = leftCosts[bin - 1u] + rightBounds.GetHalfArea() * static_cast<GLfloat>(rightTriangles);
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = bin;
+				}
+			}
+		}
+	}
+
+	const GLfloat leafCost = node.Box.GetHalfArea() * static_cast<GLfloat>(numberOfTriangles);
+	const GLfloat splitCost = node.Box.GetHalfArea() * TraversalCost + bestCost;
+
+	if (numberOfTriangles <= MaximumTrianglesPerLeaf && (bestAxis < 0 || leafCost <= splitCost))
+	{
+		return GL_FALSE;
+	}
+
+	GLuint numberOfLeftTriangles;
+	auto firstIterator = myTriangleOrder.begin() + firstTriangle;
+	auto lastIterator = firstIterator + numberOfTriangles;
+
+	if (bestAxis >= 0)
+	{
+		const GLfloat minimum = centroidBounds.Min[bestAxis];
+		const GLfloat scale = static_cast<GLfloat>(NumberOfBins) / centroidExtent[bestAxis];
+		const GLint axis = bestAxis;
+		const GLuint splitBin = bestBin;
+
+		numberOfLeftTriangles = static_cast<GLuint>(std::partition(firstIterator, lastIterator, [this, axis, minimum, scale, splitBin]( const GLuint triangle )
+		{
+			return GetBin(myCentroids[triangle][axis], minimum, scale, NumberOfBins) < splitBin;
+		}) - firstIterator);
+
+		left.Box = Bounds();
+		right.Box = Bounds();
+		for (GLuint bin = 0; bin < NumberOfBins; bin++)
+		{
+			(bin < splitBin ? left.Box : right.Box).Grow(bins[axis * NumberOfBins + bin].Box);
+		}
+	}
+	else
+	{
+		// Split at the median along the largest extent of the centroids, or just in half if all centroids coincide.
+		numberOfLeftTriangles = numberOfTriangles / 2u;
+
+		if (hasExtent)
+		{
+			const GLint axis = centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z ? 0 : (centroidExtent.y >= centroidExtent.z ? 1 : 2);
+			std::nth_element(firstIterator, firstIterator + numberOfLeftTriangles, lastIterator, [this, axis]( const GLuint first, const GLuint second )
+			{
+				return myCentroids[first][axis] < myCentroids[second][axis];
+			});
+		}
+
+		Bounds centroids;
+		CalculateBounds(firstTriangle, numberOfLeftTriangles, left.Box, centroids);
+		CalculateBounds(firstTriangle + numberOfLeftTriangles, numberOfTriangles - numberOfLeftTriangles, right.Box, centroids);
+	}
+
+	left.FirstTriangle = firstTriangle;
+	left.NumberOfTriangles = numberOfLeftTriangles;
+	right.FirstTriangle = firstTriangle + numberOfLeftTriangles;
+	right.NumberOfTriangles = numberOfTriangles - numberOfLeftTriangles;
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Sorts a range of triangles into the bins of all three axes.
+/// </summary>
+/// <param name="firstTriangle">The first triangle within the triangle order.</param>
+/// <param name="numberOfTriangles">The number of triangles.</param>
+/// <param name="centroidBounds">The bounds of the centroids of the triangles.</param>
+/// <param name="bins">The bins to fill, <see cref="NumberOfBins"/> per axis.</param>
+GLvoid PBRViewerBvh::FillBins( const GLuint firstTriangle, const GLuint numberOfTriangles, Bounds const& centroidBounds, Bin* bins ) const
+{
+	const glm::vec3 extent = centroidBounds.Max - centroidBounds.Min;
+	glm::vec3 scale;
+	for (GLint axis = 0; axis < 3; axis++)
+	{
+		scale[axis] = extent[axis] > 0.0f ? static_cast<GLfloat>(NumberOfBins) / extent[axis] : 0.0f;
+	}
+
+	for (GLuint i = firstTriangle; i < firstTriangle + numberOfTriangles; i++)
+	{
+		const GLuint triangle = myTriangleOrder[i];
+		for (GLint axis = 0; axis < 3; axis++)
+		{
+			Bin& bin = bins[axis * NumberOfBins + GetBin(myCentroids[triangle][axis], centroidBounds.Min[axis], scale[axis], NumberOfBins)];
+			bin.Box.Grow(myTriangleBounds[triangle]);
+			bin.NumberOfTriangles++;
+		}
+	}
+}
+
+/// <summary>
+/// Calculates the bounds of a range of triangles.
+/// </summary>
+/// <param name="firstTriangle">The first triangle within the triangle order.</param>
+/// <param name="numberOfTriangles">The number of triangles.</param>
+/// <param name="bounds">The bounds of the triangles.</param>
+/// <param name="centroidBounds">The bounds of the centroids of the triangles.</param>
+GLvoid PBRViewerBvh::CalculateBounds( const GLuint firstTriangle, const GLuint numberOfTriangles, Bounds& bounds, Bounds& centroidBounds ) const
+{
+	bounds = Bounds();
+	centroidBounds = Bounds();
+
+	for (GLuint i = firstTriangle; i < firstTriangle + numberOfTriangles; i++)
+	{
+		const GLuint triangle = myTriangleOrder[i];
+		bounds.Grow(myTriangleBounds[triangle]);
+		centroidBounds.Grow(myCentroids[triangle]);
+	}
+}
+
+/// <summary>
+/// Collapses the binary tree into the tree with four children per node and packs the triangles of the leaves.
+/// </summary>
+/// <param name="binaryNodes">The nodes of the binary tree.</param>
+GLvoid PBRViewerBvh::Collapse( std::vector<BuildNode> const& binaryNodes )
+{
+	myNodes.reserve(binaryNodes.size() / 3u + 1u);
+	myPackets.reserve(myTriangleOrder.size() / 3u + 1u);
+
+	if (0u != binaryNodes[0].Children[0])
+	{
+		CollapseNode(binaryNodes, 0u);
+		return;
+	}
+
+	// A scene with only a few triangles is a single leaf below the root.
+	const BuildNode& leaf = binaryNodes[0];
+	Node root = {};
+	root.MinX[0] = leaf.Box.Min.x;
+	root.MinY[0] = leaf.Box.Min.y;
+	root.MinZ[0] = leaf.Box.Min.z;
+	root.MaxX[0] = leaf.Box.Max.x;
+	root.MaxY[0] = leaf.Box.Max.y;
+	root.MaxZ[0] = leaf.Box.Max.z;
+	root.Children[0] = LeafFlag | PackTriangles(leaf);
+	root.NumberOfPackets[0] = static_cast<GLubyte>((leaf.NumberOfTriangles + 3u) / 4u);
+	root.NumberOfChildren = 1u;
+	myNodes.push_back(root);
+}
+
+/// <summary>
+/// Collapses an inner node of the binary tree and its subtree. The children with the largest surface area are replaced by their own children
+/// until the node has four children or only leaves are left.
+/// </summary>
+/// <param name="binaryNodes">The nodes of the binary tree.</param>
+/// <param name="binaryNode">The index of the inner node to collapse.</param>
+/// <returns>The index of the collapsed node.</returns>
+GLuint PBRViewerBvh::CollapseNode( std::vector<BuildNode> const& binaryNodes, const GLuint binaryNode )
+{
+	GLuint children[4] = { binaryNodes[binaryNode].Children[0], binaryNodes[binaryNode].Children[1] };
+	GLuint numberOfChildren = 2u;
+
+	while (numberOfChildren < 4u)
+	{
+		GLint largestChild = -1;
+		GLfloat largestArea = -1.0f;
+		for (GLuint i = 0; i < numberOfChildren; i++)
+		{
+			const BuildNode& child = binaryNodes[children[i]];
+			if (0u != child.Children[0] && child.Box.GetHalfArea() > largestArea)
+			{
+				largestArea = child.Box.GetHalfArea();
+				largestChild = static_cast<GLint>(i);
+			}
+		}
+
+		if (largestChild < 0)
+		{
+			break;
+		}
+
+		const BuildNode& expandedChild = binaryNodes[children[largestChild]];
+		children[largestChild] = expandedChild.Children[0];
+		children[numberOfChildren++] = expandedChild.Children[1];
+	}
+
+	// The node is filled after its children were collapsed, since collapsing them reallocates the nodes.
+	const GLuint nodeIndex = static_cast<GLuint>(myNodes.size());
+	myNodes.push_back(Node());
+
+	Node node = {};
+	node.NumberOfChildren = numberOfChildren;
+	for (GLuint i = 0; i < numberOfChildren; i++)
+	{
+		const BuildNode& child = binaryNodes[children[i]];
+		node.MinX[i] = child.Box.Min.x;
+		node.MinY[i] = child.Box.Min.y;
+		node.MinZ[i] = child.Box.Min.z;
+		node.MaxX[i] = child.Box.Max.x;
+		node.MaxY[i] = child.Box.Max.y;
+		node.MaxZ[i] = child.Box.Max.z;
+
+		if (0u == child.Children[0])
+		{
+			node.Children[i] = LeafFlag | PackTriangles(child);
+			node.NumberOfPackets[i] = static_cast<GLubyte>((child.NumberOfTriangles + 3u) / 4u);
+		}
+		else
+		{
+			node.Children[i] = CollapseNode(binaryNodes, children[i]);
+		}
+	}
+
+	myNodes[nodeIndex] = node;
+	return nodeIndex;
+}
+
+/// <summary>
+/// Packs the triangles of a binary leaf into packets of four.
+/// </summary>
+/// <param name="leaf">The leaf to pack.</param>
+/// <returns>The index of the first packet.</returns>
+GLuint PBRViewerBvh::PackTriangles( BuildNode const& leaf )
+{
+	const GLuint firstPacket = static_cast<GLuint>(myPackets.size());
+
+	for (GLuint first = 0; first < leaf.NumberOfTriangles; first += 4u)
+	{
+		TrianglePacket packet = {};
+		for (GLuint lane = 0; lane < 4u && first + lane < leaf.NumberOfTriangles; lane++)
+		{
+			const GLuint triangle = myTriangleOrder[leaf.FirstTriangle + first + lane];
+			const glm::vec3* vertices = &myTriangleVertices[static_cast<size_t>(triangle) * 3u];
+			const glm::vec3 edge1 = vertices[1] - vertices[0];
+			const glm::vec3 edge2 = vertices[2] - vertices[0];
+
+			packet.VertexX[lane] = vertices[0].x;
+			packet.VertexY[lane] = vertices[0].y;
+			packet.VertexZ[lane] = vertices[0].z;
+			packet.Edge1X[lane] = edge1.x;
+			packet.Edge1Y[lane] = edge1.y;
+			packet.Edge1Z[lane] = edge1.z;
+			packet.Edge2X[lane] = edge2.x;
+			packet.Edge2Y[lane] = edge2.y;
+			packet.Edge2Z[lane] = edge2.z;
+			packet.Triangles[lane] = triangle;
+		}
+
+		myPackets.push_back(packet);
+	}
+
+	return firstPacket;
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerSceneData.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <vector>
+
+/// <summary>
+/// This struct represents the closest intersection of a ray with the triangles of a <see cref="PBRViewerBvh"/>.
+/// </summary>
+struct PBRViewerRayHit
+{
+	/// <summary>
+	/// The distance along the ray in multiples of the ray direction.
+	/// </summary>
+	GLfloat Distance = 0.0f;
+
+	/// <summary>
+	/// The index of the hit mesh within the scene.
+	/// </summary>
+	GLuint Mesh = 0u;
+
+	/// <summary>
+	/// The index of the hit triangle within the full detail level of the mesh.
+	/// </summary>
+	GLuint Triangle = 0u;
+
+	/// <summary>
+	/// The barycentric coordinates of the hit point relative to the second and third vertex of the triangle.
+	/// </summary>
+	glm::vec2 Barycentrics = glm::vec2(0.0f);
+
+	/// <summary>
+	/// The hit point.
+	/// </summary>
+	glm::vec3 Position = glm::vec3(0.0f);
+
+	/// <summary>
+	/// The normalized geometric normal of the hit triangle, following the winding order of its vertices.
+	/// </summary>
+	glm::vec3 Normal = glm::vec3(0.0f);
+};
+
+/// <summary>
+/// This class represents a bounding volume hierarchy over the triangles of a scene, which answers ray queries like the mouse picking.
+/// The hierarchy is built with the binned surface area heuristic: the top levels bin the triangles in parallel and the subtrees below
+/// are built as independent tasks on the <see cref="PBRViewerThreadPool"/>. The binary tree is then collapsed into a tree with four children per node,
+/// so the traversal tests a ray against four boxes or four triangles at once with SSE.
+/// Only the full detail level of each mesh is inserted, the coarser levels of detail appended to the index buffers are skipped.
+/// The BVH does not need an OpenGL context, so it is built on the import worker.
+/// </summary>
+class PBRViewerBvh
+{
+public:
+	/// <summary>
+	/// Builds the hierarchy over the triangles of all meshes of a scene. A previously built hierarchy is replaced.
+	/// The calling thread must not be a worker of the <see cref="PBRViewerThreadPool"/>, since it waits for the tasks of the build.
+	/// </summary>
+	/// <param name="sceneData">The scene data holding the meshes in any vertex format.</param>
+	GLvoid Build( PBRViewerSceneData const& sceneData );
+
+	/// <summary>
+	/// Finds the closest intersection of a ray with the triangles. Both sides of a triangle are hit.
+	/// </summary>
+	/// <param name="origin">The origin of the ray in model space.</param>
+	/// <param name="direction">The direction of the ray in model space. It does not need to be normalized.</param>
+	/// <param name="hit">The closest intersection, only valid if the ray hit a triangle.</param>
+	/// <returns>True if the ray hit a triangle, false if not.</returns>
+	GLboolean Intersect( glm::vec3 origin, glm::vec3 direction, PBRViewerRayHit& hit ) const;
+
+	/// <summary>
+	/// Gets the number of triangles within the hierarchy.
+	/// </summary>
+	/// <returns>The number of triangles.</returns>
+	GLuint GetNumberOfTriangles() const;
+
+	/// <summary>
+	/// Gets the number of nodes with four children.
+	/// </summary>
+	/// <returns>The number of nodes.</returns>
+	GLuint GetNumberOfNodes() const;
+
+	/// <summary>
+	/// Gets the memory used by the nodes and the triangles.
+	/// </summary>
+	/// <returns>The size of the hierarchy in bytes.</returns>
+	size_t GetSize() const;
+
+	/// <summary>
+	/// Gets a flag indicating if the hierarchy does not contain any triangles.
+	/// </summary>
+	/// <returns>True if the hierarchy is empty, false if not.</returns>
+	GLboolean IsEmpty() const;
+
+private:
+	/// <summary>
+	/// An axis-aligned bounding box.
+	/// </summary>
+	struct Bounds
+	{
+		glm::vec3 Min;
+		glm::vec3 Max;
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="Bounds"/> struct as empty box.
+		/// </summary>
+		Bounds();
+
+		/// <summary>
+		/// Grows the box so it contains a point.
+		/// </summary>
+		/// <param name="point">The point to contain.</param>
+		GLvoid Grow( glm::vec3 point );
+
+		/// <summary>
+		/// Grows the box so it contains another box.
+		/// </summary>
+		/// <param name="bounds">The box to contain.</param>
+		GLvoid Grow( Bounds const& bounds );
+
+		/// <summary>
+		/// Gets half of the surface area of the box, which is all the surface area heuristic needs.
+		/// </summary>
+		/// <returns>The half surface area or 0 if the box is empty.</returns>
+		GLfloat GetHalfArea() const;
+	};
+
+	/// <summary>
+	/// A bin of the surface area heuristic, collecting the triangles whose centroids fall into a slice of the centroid bounds.
+	/// </summary>
+	struct Bin
+	{
+		Bounds Box;
+		GLuint NumberOfTriangles = 0u;
+	};
+
+	/// <summary>
+	/// A node of the binary tree. The root is never a child, so leaves are marked by a first child of zero.
+	/// </summary>
+	struct BuildNode
+	{
+		Bounds Box;
+		GLuint Children[2] = { 0u, 0u };
+		GLuint FirstTriangle = 0u;
+		GLuint NumberOfTriangles = 0u;
+	};
+
+	/// <summary>
+	/// A node of the collapsed tree. The bounds of the four children are stored per axis, so they are tested at once.
+	/// Children flagged with <see cref="LeafFlag"/> refer to the first of their triangle packets, the others to a node.
+	/// </summary>
+	struct Node
+	{
+		GLfloat MinX[4];
+		GLfloat MinY[4];
+		GLfloat MinZ[4];
+		GLfloat MaxX[4];
+		GLfloat MaxY[4];
+		GLfloat MaxZ[4];
+		GLuint Children[4];
+		GLubyte NumberOfPackets[4];
+		GLuint NumberOfChildren;
+	};
+
+	/// <summary>
+	/// Four triangles of a leaf, stored per axis as first vertex and the two edges starting at it.
+	/// Unused lanes have degenerate edges, so they are never hit.
+	/// </summary>
+	struct TrianglePacket
+	{
+		GLfloat VertexX[4];
+		GLfloat VertexY[4];
+		GLfloat VertexZ[4];
+		GLfloat Edge1X[4];
+		GLfloat Edge1Y[4];
+		GLfloat Edge1Z[4];
+		GLfloat Edge2X[4];
+		GLfloat Edge2Y[4];
+		GLfloat Edge2Z[4];
+		GLuint Triangles[4];
+	};
+
+	// The number of slices the centroid bounds are split into along each axis.
+	static const GLuint NumberOfBins = 16u;
+
+	// Leaves hold at most this many triangles, i. e. four packets.
+	static const GLuint MaximumTrianglesPerLeaf = 16u;
+
+	// Below this depth the triangles are split at their median, so degenerate scenes cannot exhaust the traversal stack.
+	static const GLuint MaximumSahDepth = 48u;
+
+	// Nodes with more triangles are binned by several tasks.
+	static const GLuint ParallelBinningThreshold = 1u << 16;
+
+	// Subtrees with fewer triangles are built by a single task.
+	static const GLuint MinimumSubtreeSize = 1u << 12;
+
+	// Marks the children of a collapsed node which are leaves.
+	static const GLuint LeafFlag = 0x80000000u;
+
+	std::vector<Node> myNodes;
+	std::vector<TrianglePacket> myPackets;
+	Bounds myBounds;
+
+	// The first triangle of each mesh and the total number of triangles behind the last mesh.
+	std::vector<GLuint> myFirstTriangles;
+
+	// The per-triangle data used during the build only.
+	std::vector<glm::vec3> myTriangleVertices;
+	std::vector<Bounds> myTriangleBounds;
+	std::vector<glm::vec3> myCentroids;
+	std::vector<GLuint> myTriangleOrder;
+
+	/// <summary>
+	/// Reads the triangles of the full detail level of all meshes and calculates their bounds and centroids in parallel.
+	/// </summary>
+	/// <param name="sceneData">The scene data holding the meshes.</param>
+	GLvoid GatherTriangles( PBRViewerSceneData const& sceneData );
+
+	/// <summary>
+	/// Builds the binary tree. The top levels are split on the calling thread, the subtrees below are built by tasks and appended afterwards.
+	/// </summary>
+	/// <returns>The nodes of the binary tree, the root comes first.</returns>
+	std::vector<BuildNode> BuildBinaryTree();
+
+	/// <summary>
+	/// Builds a subtree of the binary tree on the calling thread.
+	/// </summary>
+	/// <param name="nodes">The nodes to append the subtree to. The root of the subtree has to be the last node already.</param>
+	/// <param name="depth">The depth of the root of the subtree.</param>
+	GLvoid BuildSubtree( std::vector<BuildNode>& nodes, GLuint depth );
+
+	/// <summary>
+	/// Splits the triangles of a node into two children. Small nodes and nodes whose split costs more than the leaf become leaves.
+	/// </summary>
+	/// <param name="node">The node to split.</param>
+	/// <param name="depth">The depth of the node.</param>
+	/// <param name="isParallel">True to bin the triangles of large nodes on the thread pool.</param>
+	/// <param name="left">The triangles and bounds of the left child.</param>
+	/// <param name="right">The triangles and bounds of the right child.</param>
+	/// <returns>True if the node was split, false if it stays a leaf.</returns>
+	GLboolean SplitNode( BuildNode const& node, GLuint depth, GLboolean isParallel, BuildNode& left, BuildNode& right );
+
+	/// <summary>
+	/// Sorts a range of triangles into the bins of all three axes.
+	/// </summary>
+	/// <param name="firstTriangle">The first triangle within the triangle order.</param>
+	/// <param name="numberOfTriangles">The number of triangles.</param>
+	/// <param name="centroidBounds">The bounds of the centroids of the triangles.</param>
+	/// <param name="bins">The bins to fill, <see cref="NumberOfBins"/> per axis.</param>
+	GLvoid FillBins( GLuint firstTriangle, GLuint numberOfTriangles, Bounds const& centroidBounds, Bin* bins ) const;
+
+	/// <summary>
+	/// Calculates the bounds of a range of triangles.
+	/// </summary>
+	/// <param name="firstTriangle">The first triangle within the triangle order.</param>
+	/// <param name="numberOfTriangles">The number of triangles.</param>
+	/// <param name="bounds">The bounds of the triangles.</param>
+	/// <param name="centroidBounds">The bounds of the centroids of the triangles.</param>
+	GLvoid CalculateBounds( GLuint firstTriangle, GLuint numberOfTriangles, Bounds& bounds, Bounds& centroidBounds ) const;
+
+	/// <summary>
+	/// Collapses the binary tree into the tree with four children per node and packs the triangles of the leaves.
+	/// </summary>
+	/// <param name="binaryNodes">The nodes of the binary tree.</param>
+	GLvoid Collapse( std::vector<BuildNode> const& binaryNodes );
+
+	/// <summary>
+	/// Collapses an inner node of the binary tree and its subtree. The children with the largest surface area are replaced by their own children
+	/// until the node has four children or only leaves are left.
+	/// </summary>
+	/// <param name="binaryNodes">The nodes of the binary tree.</param>
+	/// <param name="binaryNode">The index of the inner node to collapse.</param>
+	/// <returns>The index of the collapsed node.</returns>
+	GLuint CollapseNode( std::vector<BuildNode> const& binaryNodes, GLuint binaryNode );
+
+	/// <summary>
+	/// Packs the triangles of a binary leaf into packets of four.
+	/// </summary>
+	/// <param name="leaf">The leaf to pack.</param>
+	/// <returns>The index of the first packet.</returns>
+	GLuint PackTriangles( BuildNode const& leaf );
+};
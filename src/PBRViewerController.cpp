@@ -3,6 +3,7 @@
 #include <GLFW/glfw3.h>
 
 #include "PBRViewerOpenGLUtilities.h"
+#include "PBRViewerStateCache.h"
 #include <experimental/filesystem>
 #include "PBRViewerMouseCallbacks.h"
 #include "PBRViewerKeyboardCallbacks.h"
@@ -23,22 +24,32 @@ GLvoid PBRViewerController::StartRenderLoop()
 {
 	myLastTime = glfwGetTime();
 
+	// The textures created during the initialization have been bound without the state cache.
+	PBRViewerStateCache::Invalidate();
+
 	while (GL_FALSE == glfwWindowShouldClose(myModel->GetWindowContext()))
 	{
 		CalculateFps();
+		PBRViewerStateCache::ResetStatistics();
 
 		glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		myModel->DrawOpenGL();
+		UpdateModelLoadingProgress();
+		UpdateCullingStatistics();
+		UpdateParameterStatistics();
+		UpdateStateCacheStatistics();
 		myOverlayRoot->drawWidgets();
 
 		// NanoVG, the underlying library to draw the UI parts, changes the state of the OpenGL state machine.
 		// To ensure correct render calls, we reset the relevant states definded by the following link: 
 		// https://github.com/memononen/nanovg#opengl-state-touched-by-the-backend		
-		glDisable(GL_BLEND);
-		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_CULL_FACE);
+		// The state cache does not know these changes, so it forgets all tracked states before.
+		PBRViewerStateCache::Invalidate();
+		PBRViewerStateCache::SetCapability(GL_BLEND, GL_FALSE);
+		PBRViewerStateCache::SetCapability(GL_DEPTH_TEST, GL_TRUE);
+		PBRViewerStateCache::SetCapability(GL_CULL_FACE, GL_TRUE);
 
 		glfwSwapBuffers(myModel->GetWindowContext());
 	}
@@ -109,6 +120,43 @@ GLvoid PBRViewerController::CalculateFps()
 	}
 }
 
+/// <summary>
+/// Shows the progress of a running model import within the model loader window.
+/// </summary>
+GLvoid PBRViewerController::UpdateModelLoadingProgress() const
+{
+	myOverlayRoot->ModelLoader->SetModelLoadingProgress(myModel->GetModelLoadingProgress());
+}
+
+/// <summary>
+/// Shows the number of triangles culled and the number of meshes visible within the last frame within the model loader window.
+/// </summary>
+GLvoid PBRViewerController::UpdateCullingStatistics() const
+{
+	myOverlayRoot->ModelLoader->SetCulledTrianglesCounterContent(std::to_string(myModel->GetNumberOfCulledTriangles()));
+	myOverlayRoot->ModelLoader->SetVisibleMeshesCounterContent(std::to_string(myModel->GetNumberOfVisibleMeshes()) + " / " +
+	                                                           std::to_string(myModel->GetNumberOfMeshes()));
+	myOverlayRoot->ModelLoader->SetVisibleShadowMeshesCounterContent(std::to_string(myModel->GetNumberOfVisibleShadowMeshes()) + " / " +
+	                                                                 std::to_string(myModel->GetNumberOfShadowMeshes()));
+}
+
+/// <summary>
+/// Shows the number of parameter uploads within the last frame within the model loader window.
+/// </summary>
+GLvoid PBRViewerController::UpdateParameterStatistics() const
+{
+	myOverlayRoot->ModelLoader->SetParameterUploadsCounterContent(std::to_string(myModel->GetNumberOfParameterUploads()));
+}
+
+/// <summary>
+/// Shows the number of OpenGL calls filtered by the state cache within the last frame within the model loader window.
+/// </summary>
+GLvoid PBRViewerController::UpdateStateCacheStatistics() const
+{
+	myOverlayRoot->ModelLoader->SetFilteredCallsCounterContent(std::to_string(PBRViewerStateCache::GetNumberOfFilteredCalls()) + " / " +
+	                                                           std::to_string(PBRViewerStateCache::GetNumberOfRequestedCalls()));
+}
+
 /// <summary>
 /// Sets the callbacks for all overlay components, i. e. the visible windows.
 /// </summary>
@@ -152,6 +200,16 @@ GLvoid PBRViewerController::ConfigureModelLoader()
 		myOverlayRoot->ModelLoader->SetTextBoxOpenModelContent(resultFileDialog);
 	});
 
+	myOverlayRoot->ModelLoader->SetImportPresetComboBoxCallback([this]( const PBRViewerEnumerations::ImportPreset currentImportPreset )
+	{
+		myModel->SetImportPreset(currentImportPreset);
+	});
+
+	myOverlayRoot->ModelLoader->SetNativeLoadersCheckBoxCallback([this]( const GLboolean activated )
+	{
+		myModel->SetUseNativeLoaders(activated);
+	});
+
 	myOverlayRoot->ModelLoader->SetLoadSkyboxButtonCallback([&]
 	{
 		const std::vector<std::pair<std::string, std::string>> supportedFileTypes{		
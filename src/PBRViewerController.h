@@ -72,4 +72,24 @@ private:
 	/// Calculates frames per second.
 	/// </summary>
 	GLvoid CalculateFps();	
+
+	/// <summary>
+	/// Shows the progress of a running model import within the model loader window.
+	/// </summary>
+	GLvoid UpdateModelLoadingProgress() const;
+
+	/// <summary>
+	/// Shows the number of triangles culled and the number of meshes visible within the last frame within the model loader window.
+	/// </summary>
+	GLvoid UpdateCullingStatistics() const;
+
+	/// <summary>
+	/// Shows the number of parameter uploads within the last frame within the model loader window.
+	/// </summary>
+	GLvoid UpdateParameterStatistics() const;
+
+	/// <summary>
+	/// Shows the number of OpenGL calls filtered by the state cache within the last frame within the model loader window.
+	/// </summary>
+	GLvoid UpdateStateCacheStatistics() const;
 };
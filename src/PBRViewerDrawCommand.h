@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/// <summary>
+/// This struct represents a draw of an index range as read by glMultiDrawElementsIndirect from the indirect buffer.
+/// The layout is defined by OpenGL.
+/// </summary>
+struct DrawElementsIndirectCommand
+{
+	/// <summary>
+	/// The number of indices to draw.
+	/// </summary>
+	GLuint Count;
+
+	/// <summary>
+	/// The number of instances, always 1.
+	/// </summary>
+	GLuint InstanceCount;
+
+	/// <summary>
+	/// The position of the first index within the index buffer.
+	/// </summary>
+	GLuint FirstIndex;
+
+	/// <summary>
+	/// The value added to each index before the vertex is fetched.
+	/// </summary>
+	GLint BaseVertex;
+
+	/// <summary>
+	/// The element the per-mesh vertex attributes are read from, see <see cref="PBRViewerEnumerations::MeshParameterLocation"/>.
+	/// </summary>
+	GLuint BaseInstance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "The draw command must match the layout expected by OpenGL.");
@@ -116,4 +116,145 @@ namespace PBRViewerEnumerations
 		Increase = 0,
 		Decrease = 1
 	};
-};
+
+	/// <summary>
+	/// Entries for the import presets which can be selected by the user. They trade import time for optimized meshes and textures.
+	/// </summary>
+	enum ImportPreset
+	{
+		FastPreview = 0,
+		Balanced = 1,
+		FullOptimize = 2
+	};
+
+	/// <summary>
+	/// Entries for the vertex formats of a mesh.
+	/// </summary>
+	enum VertexFormat
+	{
+		FullPrecision = 0,
+		Quantized = 1,
+		Streams = 2
+	};
+
+	/// <summary>
+	/// Entries for the vertex attributes of a mesh in the stream format. Each entry is the attribute location in the vertex shaders.
+	/// </summary>
+	enum VertexStreamLocation
+	{
+		PositionStream = 0,
+		NormalStream = 1,
+		TexCoordsStream = 2,
+		TangentStream = 3,
+		NumberOfVertexStreams = 4
+	};
+
+	/// <summary>
+	/// Entries for the vertex attributes holding the parameters of a mesh. Each entry is the attribute location in the vertex shaders.
+	/// The attributes advance once per instance, so the base instance of a draw selects the parameters of its mesh.
+	/// </summary>
+	enum MeshParameterLocation
+	{
+		PositionOffsetParameter = 5,
+		PositionScaleParameter = 6
+	};
+
+	/// <summary>
+	/// Entries for the filter kernel used to generate mip levels.
+	/// </summary>
+	enum MipFilter
+	{
+		BoxFilter = 0,
+		KaiserFilter = 1
+	};
+
+	/// <summary>
+	/// Entries for the content of a texture, which decides in which space its mip levels are filtered.
+	/// </summary>
+	enum TextureContent
+	{
+		SRGBColor = 0,
+		LinearData = 1,
+		TangentSpaceNormals = 2
+	};
+
+	/// <summary>
+	/// Entries for the slots a texture is bound to. Each entry is the texture unit of the slot within the lighting shaders.
+	/// The material slots come first, so they index the binding table of a mesh. The shadow maps occupy one unit per light source from their entry on.
+	/// </summary>
+	enum TextureSlot
+	{
+		TextureDiffuse = 0,
+		TextureNormal = 1,
+		TextureRoughness = 2,
+		TextureEmissive = 3,
+		TextureIrradiance = 4,
+		TexturePreFilterEnvironment = 5,
+		TextureBRDFLookup = 6,
+		TextureEnvironment = 7,
+		TextureEquirectangular = 8,
+		TextureShadows = 9,
+		NumberOfTextureSlots = 10
+	};
+
+	/// <summary>
+	/// Entries for the uniforms which are set per model or per mesh and thus stay outside of the uniform blocks.
+	/// Each entry is a handle, which a shader resolves to the location of its uniform once it is compiled.
+	/// </summary>
+	enum Uniform
+	{
+		UniformModel = 0,
+		UniformCompactVertices = 1,
+		UniformTangentHandedness = 2,
+		NumberOfUniforms = 3
+	};
+
+	/// <summary>
+	/// Entries for the std140 uniform blocks shared by the shaders. Each entry is the binding point of the block.
+	/// Binding point 0 is left to NanoVG, which binds its own uniform buffer there while drawing the user interface.
+	/// </summary>
+	enum UniformBlock
+	{
+		UniformBlockFrame = 1,
+		UniformBlockLights = 2,
+		UniformBlockBrdf = 3
+	};
+
+	/// <summary>
+	/// Entries for the fields of the parameter store. The fields of each uniform block are contiguous, so a block checks them as one range.
+	/// </summary>
+	enum Parameter
+	{
+		ParameterView = 0,
+		ParameterProjection = 1,
+		ParameterCameraPosition = 2,
+		ParameterGamma = 3,
+		ParameterExposure = 4,
+		ParameterRenderOutput = 5,
+		ParameterDebugOutput = 6,
+		ParameterLights = 7,
+		ParameterShadowsEnabled = 8,
+		ParameterBlinnPhongExponent = 9,
+		ParameterNu = 10,
+		ParameterNv = 11,
+		ParameterDiffuseTerm = 12,
+		ParameterFresnelTerm = 13,
+		ParameterNormalDistributionTerm = 14,
+		ParameterGeometryTerm = 15,
+		ParameterCustomMaterialValuesEnabled = 16,
+		ParameterCustomMetalness = 17,
+		ParameterCustomRoughness = 18,
+		ParameterSubsurface = 19,
+		ParameterMetallic = 20,
+		ParameterSpecular = 21,
+		ParameterSpecularTint = 22,
+		ParameterRoughness = 23,
+		ParameterAnisotropic = 24,
+		ParameterSheen = 25,
+		ParameterSheenTint = 26,
+		ParameterClearcoat = 27,
+		ParameterClearcoatGloss = 28,
+		ParameterModelMatrix = 29,
+		NumberOfParameters = 30
+	};
+};
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "PBRViewerFramebufferCallbacks.h"
+#include "PBRViewerStateCache.h"
 
 // Needs to be static so we can set the GLFW callback accordingly.
 static std::shared_ptr<PBRViewerOverlay> myOverlay;
@@ -19,7 +20,7 @@ GLvoid PBRViewerFramebufferCallbacks::RegisterCallbacks( GLFWwindow* currentWind
 
 	glfwSetFramebufferSizeCallback(currentWindow, []( GLFWwindow*, const GLint width, const GLint height )
 	{
-		glViewport(0, 0, width, height);
+		PBRViewerStateCache::SetViewport(0, 0, width, height);
 
 		myOverlay->resizeCallbackEvent(width, height);
 
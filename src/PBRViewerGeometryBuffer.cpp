@@ -0,0 +1,314 @@
+#include "PBRViewerGeometryBuffer.h"
+
+#include "PBRViewerVertex.h"
+#include "PBRViewerStateCache.h"
+
+#include <algorithm>
+
+/// <summary>
+/// Reallocates a buffer with a larger size and copies the content of the old one, which is deleted.
+/// </summary>
+/// <param name="buffer">The buffer, which is replaced by the new one. 0 if there is no old buffer.</param>
+/// <param name="oldSize">The size of the old buffer in bytes.</param>
+/// <param name="newSize">The size of the new buffer in bytes.</param>
+static GLvoid ReallocateBuffer( GLuint& buffer, const size_t oldSize, const size_t newSize )
+{
+	GLuint newBuffer;
+	glGenBuffers(1, &newBuffer);
+
+	// The copy targets do not touch the element array binding of the currently bound vertex array.
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newSize), nullptr, GL_STATIC_DRAW);
+
+	if (0u != buffer)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldSize));
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glDeleteBuffers(1, &buffer);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	buffer = newBuffer;
+}
+
+/// <summary>
+/// Gets the geometry buffer of a vertex format shared by the whole application.
+/// Meshes in the stream format have their own buffers, so only full precision and quantized vertices are supported.
+/// </summary>
+/// <param name="vertexFormat">The vertex format.</param>
+/// <returns>The shared geometry buffer.</returns>
+PBRViewerGeometryBuffer& PBRViewerGeometryBuffer::GetInstance( const PBRViewerEnumerations::VertexFormat vertexFormat )
+{
+	static PBRViewerGeometryBuffer fullPrecisionInstance(PBRViewerEnumerations::FullPrecision);
+	static PBRViewerGeometryBuffer quantizedInstance(PBRViewerEnumerations::Quantized);
+
+	return PBRViewerEnumerations::Quantized == vertexFormat ? quantizedInstance : fullPrecisionInstance;
+}
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerGeometryBuffer"/> class.
+/// </summary>
+/// <param name="vertexFormat">The vertex format of the buffer.</param>
+PBRViewerGeometryBuffer::PBRViewerGeometryBuffer( const PBRViewerEnumerations::VertexFormat vertexFormat )
+	: myVertexFormat(vertexFormat),
+	  myStride(static_cast<GLsizei>(PBRViewerEnumerations::Quantized == vertexFormat ? sizeof(CompactVertex) : sizeof(Vertex))),
+	  myVertexAllocator(1u),
+	  myIndexAllocator(sizeof(GLuint)),
+	  myParameterAllocator(1u)
+{
+}
+
+/// <summary>
+/// Grows the buffers in advance, so the given number of vertices, index bytes and meshes can be allocated without further reallocations.
+/// </summary>
+/// <param name="numberOfVertices">The number of vertices to make room for.</param>
+/// <param name="indexSize">The number of index bytes to make room for.</param>
+/// <param name="numberOfMeshes">The number of meshes to make room for.</param>
+GLvoid PBRViewerGeometryBuffer::Reserve( const size_t numberOfVertices, const size_t indexSize, const size_t numberOfMeshes )
+{
+	Grow(myVertexAllocator.GetRequiredCapacity(numberOfVertices), myIndexAllocator.GetRequiredCapacity(indexSize),
+	     myParameterAllocator.GetRequiredCapacity(numberOfMeshes));
+}
+
+/// <summary>
+/// Allocates the ranges of a mesh and uploads its vertices, indices and parameters. The buffers grow if necessary.
+/// </summary>
+/// <param name="vertices">The vertices in the format of the buffer.</param>
+/// <param name="numberOfVertices">The number of vertices.</param>
+/// <param name="indices">The indices, relative to the first vertex of the mesh.</param>
+/// <param name="indexSize">The size of the indices in bytes.</param>
+/// <param name="positionOffset">The offset of the quantized positions.</param>
+/// <param name="positionScale">The scale of the quantized positions.</param>
+/// <param name="baseVertex">The first vertex of the allocated vertex range.</param>
+/// <param name="indexOffset">The byte offset of the allocated index range.</param>
+/// <param name="baseInstance">The element holding the parameters of the mesh, which its draws use as base instance.</param>
+GLvoid PBRViewerGeometryBuffer::Allocate( const GLvoid* vertices, const GLuint numberOfVertices, const GLvoid* indices, const size_t indexSize,
+                                          const glm::vec3 positionOffset, const glm::vec3 positionScale,
+                                          GLint& baseVertex, size_t& indexOffset, GLuint& baseInstance )
+{
+	// Growing by at least half of the current size keeps the number of reallocations logarithmic while a model is uploaded.
+	size_t vertexCapacity = myVertexAllocator.GetCapacity();
+	if (myVertexAllocator.GetRequiredCapacity(numberOfVertices) > vertexCapacity)
+	{
+		vertexCapacity = std::max(myVertexAllocator.GetRequiredCapacity(numberOfVertices), vertexCapacity + vertexCapacity / 2u);
+	}
+
+	size_t indexCapacity = myIndexAllocator.GetCapacity();
+	if (myIndexAllocator.GetRequiredCapacity(indexSize) > indexCapacity)
+	{
+		indexCapacity = std::max(myIndexAllocator.GetRequiredCapacity(indexSize), indexCapacity + indexCapacity / 2u);
+	}
+
+	size_t parameterCapacity = myParameterAllocator.GetCapacity();
+	if (myParameterAllocator.GetRequiredCapacity(1u) > parameterCapacity)
+	{
+		parameterCapacity *= 2u;
+	}
+
+	Grow(vertexCapacity, indexCapacity, parameterCapacity);
+
+	size_t vertexOffset = 0u;
+	size_t parameterOffset = 0u;
+	myVertexAllocator.Allocate(numberOfVertices, vertexOffset);
+	myIndexAllocator.Allocate(indexSize, indexOffset);
+	myParameterAllocator.Allocate(1u, parameterOffset);
+	baseVertex = static_cast<GLint>(vertexOffset);
+	baseInstance = static_cast<GLuint>(parameterOffset);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, myVBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(vertexOffset * static_cast<size_t>(myStride)), static_cast<GLsizeiptr>(numberOfVertices) * myStride, vertices);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, myEBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(indexOffset), static_cast<GLsizeiptr>(indexSize), indices);
+
+	MeshParameters parameters;
+	parameters.PositionOffset = positionOffset;
+	parameters.PositionScale = positionScale;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, myParameterBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(parameterOffset * sizeof(MeshParameters)), sizeof(MeshParameters), &parameters);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+/// <summary>
+/// Frees the ranges of a mesh, so later meshes can reuse them.
+/// </summary>
+/// <param name="baseVertex">The first vertex of the vertex range.</param>
+/// <param name="numberOfVertices">The number of vertices.</param>
+/// <param name="indexOffset">The byte offset of the index range.</param>
+/// <param name="indexSize">The size of the indices in bytes.</param>
+/// <param name="baseInstance">The element holding the parameters of the mesh.</param>
+GLvoid PBRViewerGeometryBuffer::Free( const GLint baseVertex, const GLuint numberOfVertices, const size_t indexOffset, const size_t indexSize,
+                                      const GLuint baseInstance )
+{
+	// The ranges are gone already if the buffers have been cleared.
+	if (0u == myVAO)
+	{
+		return;
+	}
+
+	myVertexAllocator.Free(static_cast<size_t>(baseVertex), numberOfVertices);
+	myIndexAllocator.Free(indexOffset, indexSize);
+	myParameterAllocator.Free(baseInstance, 1u);
+}
+
+/// <summary>
+/// Gets the vertex array referencing the shared buffers. Its identifier does not change when the buffers grow.
+/// </summary>
+/// <returns>The identifier of the vertex array or 0 if nothing has been allocated yet.</returns>
+GLuint PBRViewerGeometryBuffer::GetVertexArray() const
+{
+	return myVAO;
+}
+
+/// <summary>
+/// Gets the size of the vertex, index and parameter buffers.
+/// </summary>
+/// <returns>The size in bytes.</returns>
+size_t PBRViewerGeometryBuffer::GetCapacity() const
+{
+	return myVertexAllocator.GetCapacity() * static_cast<size_t>(myStride) + myIndexAllocator.GetCapacity() +
+		myParameterAllocator.GetCapacity() * sizeof(MeshParameters);
+}
+
+/// <summary>
+/// Deletes the buffers and the vertex array. Call this method before the OpenGL context is destroyed.
+/// </summary>
+GLvoid PBRViewerGeometryBuffer::Clear()
+{
+	glDeleteVertexArrays(1, &myVAO);
+	glDeleteBuffers(1, &myVBO);
+	glDeleteBuffers(1, &myEBO);
+	glDeleteBuffers(1, &myParameterBuffer);
+
+	myVAO = 0u;
+	myVBO = 0u;
+	myEBO = 0u;
+	myParameterBuffer = 0u;
+
+	myVertexAllocator.Reset();
+	myIndexAllocator.Reset();
+	myParameterAllocator.Reset();
+}
+
+/// <summary>
+/// Reallocates the buffers which have to become larger, copies their content and points the vertex array to the new buffers.
+/// </summary>
+/// <param name="numberOfVertices">The new number of vertices.</param>
+/// <param name="indexSize">The new size of the index buffer in bytes.</param>
+/// <param name="numberOfMeshes">The new number of meshes.</param>
+GLvoid PBRViewerGeometryBuffer::Grow( size_t numberOfVertices, size_t indexSize, size_t numberOfMeshes )
+{
+	const size_t initialNumberOfVertices = InitialNumberOfVertices;
+	const size_t initialIndexSize = InitialIndexSize;
+	const size_t initialNumberOfMeshes = InitialNumberOfMeshes;
+	numberOfVertices = std::max(numberOfVertices, initialNumberOfVertices);
+	indexSize = std::max(indexSize, initialIndexSize);
+	numberOfMeshes = std::max(numberOfMeshes, initialNumberOfMeshes);
+
+	const size_t oldNumberOfVertices = myVertexAllocator.GetCapacity();
+	const size_t oldIndexSize = myIndexAllocator.GetCapacity();
+	const size_t oldNumberOfMeshes = myParameterAllocator.GetCapacity();
+	if (numberOfVertices <= oldNumberOfVertices && indexSize <= oldIndexSize && numberOfMeshes <= oldNumberOfMeshes)
+	{
+		return;
+	}
+
+	if (0u == myVAO)
+	{
+		glGenVertexArrays(1, &myVAO);
+	}
+
+	if (numberOfVertices > oldNumberOfVertices)
+	{
+		const size_t stride = static_cast<size_t>(myStride);
+		ReallocateBuffer(myVBO, oldNumberOfVertices * stride, numberOfVertices * stride);
+		myVertexAllocator.Grow(numberOfVertices);
+	}
+
+	if (indexSize > oldIndexSize)
+	{
+		ReallocateBuffer(myEBO, oldIndexSize, indexSize);
+		myIndexAllocator.Grow(indexSize);
+	}
+
+	if (numberOfMeshes > oldNumberOfMeshes)
+	{
+		ReallocateBuffer(myParameterBuffer, oldNumberOfMeshes * sizeof(MeshParameters), numberOfMeshes * sizeof(MeshParameters));
+		myParameterAllocator.Grow(numberOfMeshes);
+	}
+
+	// The vertex array keeps its identifier, only the buffers it references are replaced.
+	PBRViewerStateCache::BindVertexArray(myVAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO);
+	SetupVertexAttributes();
+	PBRViewerStateCache::BindVertexArray(0);
+}
+
+/// <summary>
+/// Specifies the vertex attributes of the vertex format and the mesh parameters for the current buffers.
+/// </summary>
+GLvoid PBRViewerGeometryBuffer::SetupVertexAttributes() const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, myVBO);
+
+	if (PBRViewerEnumerations::Quantized == myVertexFormat)
+	{
+		// Positions are normalized to [0, 1] and dequantized by the vertex shader.
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, myStride, reinterpret_cast<GLvoid*>(offsetof(CompactVertex, Position)));
+
+		// Octahedral-encoded normals
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, myStride, reinterpret_cast<GLvoid*>(offsetof(CompactVertex, Normal)));
+
+		// Half float texture coords
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, myStride, reinterpret_cast<GLvoid*>(offsetof(CompactVertex, TexCoords)));
+
+		// Octahedral-encoded tangents
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 2, GL_SHORT, GL_TRUE, myStride, reinterpret_cast<GLvoid*>(offsetof(CompactVertex, Tangent)));
+
+		// The handedness replaces the bitangent
+		glEnableVertexAttribArray(4);
+		glVertexAttribPointer(4, 1, GL_SHORT, GL_TRUE, myStride, reinterpret_cast<GLvoid*>(offsetof(CompactVertex, Handedness)));
+	}
+	else
+	{
+		// Vertex Positions
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, myStride, static_cast<GLvoid*>(nullptr));
+
+		// Vertex normals
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, myStride, reinterpret_cast<GLvoid*>(offsetof(Vertex, Normal)));
+
+		// Vertex texture coords
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, myStride, reinterpret_cast<GLvoid*>(offsetof(Vertex, TexCoords)));
+
+		// Tangent
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, myStride, reinterpret_cast<GLvoid*>(offsetof(Vertex, Tangent)));
+
+		// Bitangent
+		glEnableVertexAttribArray(4);
+		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, myStride, reinterpret_cast<GLvoid*>(offsetof(Vertex, Bitangent)));
+	}
+
+	// The parameters advance once per instance. Each draw has a single instance, so its base instance selects the mesh.
+	glBindBuffer(GL_ARRAY_BUFFER, myParameterBuffer);
+	const GLsizei parameterStride = static_cast<GLsizei>(sizeof(MeshParameters));
+
+	glEnableVertexAttribArray(PBRViewerEnumerations::PositionOffsetParameter);
+	glVertexAttribPointer(PBRViewerEnumerations::PositionOffsetParameter, 3, GL_FLOAT, GL_FALSE, parameterStride,
+	                      reinterpret_cast<GLvoid*>(offsetof(MeshParameters, PositionOffset)));
+	glVertexAttribDivisor(PBRViewerEnumerations::PositionOffsetParameter, 1);
+
+	glEnableVertexAttribArray(PBRViewerEnumerations::PositionScaleParameter);
+	glVertexAttribPointer(PBRViewerEnumerations::PositionScaleParameter, 3, GL_FLOAT, GL_FALSE, parameterStride,
+	                      reinterpret_cast<GLvoid*>(offsetof(MeshParameters, PositionScale)));
+	glVertexAttribDivisor(PBRViewerEnumerations::PositionScaleParameter, 1);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerBufferAllocator.h"
+#include "PBRViewerEnumerations.h"
+
+#include <glm/vec3.hpp>
+
+/// <summary>
+/// This class represents the vertex and index buffers shared by all meshes of a vertex format.
+/// Each mesh occupies a range of vertices and a range of indices, which it draws with a base vertex and an index offset.
+/// All meshes of the format are drawn with the same vertex array, so a scene binds it once instead of once per mesh.
+/// The parameters of each mesh, e. g. the dequantization of its positions, are per-instance vertex attributes selected by the base instance of a draw.
+/// The ranges of cleaned up meshes are reused by later models, the buffers only grow if no free range is large enough.
+/// </summary>
+class PBRViewerGeometryBuffer
+{
+public:
+	/// <summary>
+	/// Gets the geometry buffer of a vertex format shared by the whole application.
+	/// Meshes in the stream format have their own buffers, so only full precision and quantized vertices are supported.
+	/// </summary>
+	/// <param name="vertexFormat">The vertex format.</param>
+	/// <returns>The shared geometry buffer.</returns>
+	static PBRViewerGeometryBuffer& GetInstance( PBRViewerEnumerations::VertexFormat vertexFormat );
+
+	PBRViewerGeometryBuffer( PBRViewerGeometryBuffer const& ) = delete;
+	PBRViewerGeometryBuffer& operator=( PBRViewerGeometryBuffer const& ) = delete;
+
+	/// <summary>
+	/// Grows the buffers in advance, so the given number of vertices, index bytes and meshes can be allocated without further reallocations.
+	/// </summary>
+	/// <param name="numberOfVertices">The number of vertices to make room for.</param>
+	/// <param name="indexSize">The number of index bytes to make room for.</param>
+	/// <param name="numberOfMeshes">The number of meshes to make room for.</param>
+	GLvoid Reserve( size_t numberOfVertices, size_t indexSize, size_t numberOfMeshes );
+
+	/// <summary>
+	/// Allocates the ranges of a mesh and uploads its vertices, indices and parameters. The buffers grow if necessary.
+	/// </summary>
+	/// <param name="vertices">The vertices in the format of the buffer.</param>
+	/// <param name="numberOfVertices">The number of vertices.</param>
+	/// <param name="indices">The indices, relative to the first vertex of the mesh.</param>
+	/// <param name="indexSize">The size of the indices in bytes.</param>
+	/// <param name="positionOffset">The offset of the quantized positions.</param>
+	/// <param name="positionScale">The scale of the quantized positions.</param>
+	/// <param name="baseVertex">The first vertex of the allocated vertex range.</param>
+	/// <param name="indexOffset">The byte offset of the allocated index range.</param>
+	/// <param name="baseInstance">The element holding the parameters of the mesh, which its draws use as base instance.</param>
+	GLvoid Allocate( const GLvoid* vertices, GLuint numberOfVertices, const GLvoid* indices, size_t indexSize,
+	                 glm::vec3 positionOffset, glm::vec3 positionScale,
+	                 GLint& baseVertex, size_t& indexOffset, GLuint& baseInstance );
+
+	/// <summary>
+	/// Frees the ranges of a mesh, so later meshes can reuse them.
+	/// </summary>
+	/// <param name="baseVertex">The first vertex of the vertex range.</param>
+	/// <param name="numberOfVertices">The number of vertices.</param>
+	/// <param name="indexOffset">The byte offset of the index range.</param>
+	/// <param name="indexSize">The size of the indices in bytes.</param>
+	/// <param name="baseInstance">The element holding the parameters of the mesh.</param>
+	GLvoid Free( GLint baseVertex, GLuint numberOfVertices, size_t indexOffset, size_t indexSize, GLuint baseInstance );
+
+	/// <summary>
+	/// Gets the vertex array referencing the shared buffers. Its identifier does not change when the buffers grow.
+	/// </summary>
+	/// <returns>The identifier of the vertex array or 0 if nothing has been allocated yet.</returns>
+	GLuint GetVertexArray() const;
+
+	/// <summary>
+	/// Gets the size of the vertex, index and parameter buffers.
+	/// </summary>
+	/// <returns>The size in bytes.</returns>
+	size_t GetCapacity() const;
+
+	/// <summary>
+	/// Deletes the buffers and the vertex array. Call this method before the OpenGL context is destroyed.
+	/// </summary>
+	GLvoid Clear();
+
+private:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerGeometryBuffer"/> class.
+	/// </summary>
+	/// <param name="vertexFormat">The vertex format of the buffer.</param>
+	explicit PBRViewerGeometryBuffer( PBRViewerEnumerations::VertexFormat vertexFormat );
+
+	/// <summary>
+	/// The parameters of a mesh, read as per-instance vertex attributes.
+	/// </summary>
+	struct MeshParameters
+	{
+		glm::vec3 PositionOffset;
+		glm::vec3 PositionScale;
+	};
+
+	// The buffers start with room for this many vertices, index bytes and meshes, so small models do not reallocate at all.
+	static const size_t InitialNumberOfVertices = 1u << 16;
+	static const size_t InitialIndexSize = 1u << 20;
+	static const size_t InitialNumberOfMeshes = 1u << 10;
+
+	PBRViewerEnumerations::VertexFormat myVertexFormat;
+	GLsizei myStride;
+
+	GLuint myVAO = 0u;
+	GLuint myVBO = 0u;
+	GLuint myEBO = 0u;
+	GLuint myParameterBuffer = 0u;
+
+	// The vertex ranges are counted in vertices, the index ranges in bytes and the parameter ranges in meshes.
+	// Four byte aligned index ranges suit both index types.
+	PBRViewerBufferAllocator myVertexAllocator;
+	PBRViewerBufferAllocator myIndexAllocator;
+	PBRViewerBufferAllocator myParameterAllocator;
+
+	/// <summary>
+	/// Reallocates the buffers which have to become larger, copies their content and points the vertex array to the new buffers.
+	/// </summary>
+	/// <param name="numberOfVertices">The new number of vertices.</param>
+	/// <param name="indexSize">The new size of the index buffer in bytes.</param>
+	/// <param name="numberOfMeshes">The new number of meshes.</param>
+	GLvoid Grow( size_t numberOfVertices, size_t indexSize, size_t numberOfMeshes );
+
+	/// <summary>
+	/// Specifies the vertex attributes of the vertex format and the mesh parameters for the current buffers.
+	/// </summary>
+	GLvoid SetupVertexAttributes() const;
+};
@@ -0,0 +1,1058 @@
+#include "PBRViewerGltfLoader.h"
+
+#include "PBRViewerLogger.h"
+#include "PBRViewerMappedFile.h"
+#include "PBRViewerTangentSpace.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+// Larger numbers cannot be told apart from their neighbours as double, so they are no valid indices or sizes.
+static const GLdouble MaximumExactInteger = 9007199254740992.0;
+
+/// <summary>
+/// Reads a little-endian 32 bit value of the binary glTF container.
+/// </summary>
+/// <param name="data">The first byte of the value.</param>
+/// <returns>The value.</returns>
+static GLuint ReadUInt( const GLubyte* data )
+{
+	return static_cast<GLuint>(data[0]) | static_cast<GLuint>(data[1]) << 8 | static_cast<GLuint>(data[2]) << 16 | static_cast<GLuint>(data[3]) << 24;
+}
+
+/// <summary>
+/// Gets a JSON number as non-negative integer, e. g. an index or a byte offset.
+/// </summary>
+/// <param name="value">The JSON value.</param>
+/// <param name="defaultValue">The value used if the member is missing. A negative value makes the member required.</param>
+/// <param name="result">The integer.</param>
+/// <returns>True if the value is a non-negative integer, false if not.</returns>
+static GLboolean GetUnsigned( const PBRViewerJsonValue& value, const GLdouble defaultValue, size_t& result )
+{
+	const GLdouble number = value.GetNumber(defaultValue);
+	if (number < 0.0 || number > MaximumExactInteger || std::floor(number) != number)
+	{
+		return GL_FALSE;
+	}
+
+	result = static_cast<size_t>(number);
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Gets a JSON number as index into an array of the document.
+/// </summary>
+/// <param name="value">The JSON value.</param>
+/// <param name="count">The number of elements of the array.</param>
+/// <param name="index">The index.</param>
+/// <returns>True if the value is a valid index, false if not.</returns>
+static GLboolean GetIndex( const PBRViewerJsonValue& value, const size_t count, size_t& index )
+{
+	return GetUnsigned(value, -1.0, index) && index < count;
+}
+
+/// <summary>
+/// Gets the size of a component type in bytes.
+/// </summary>
+/// <param name="componentType">The component type.</param>
+/// <returns>The size in bytes or zero if glTF does not define the type.</returns>
+static GLsizei GetComponentSize( const GLenum componentType )
+{
+	switch (componentType)
+	{
+	case GL_BYTE:
+	case GL_UNSIGNED_BYTE:
+		return 1;
+	case GL_SHORT:
+	case GL_UNSIGNED_SHORT:
+		return 2;
+	case GL_UNSIGNED_INT:
+	case GL_FLOAT:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+/// <summary>
+/// Checks by the file extension if a file is a glTF asset.
+/// </summary>
+/// <param name="filepath">The filepath of the model.</param>
+/// <returns>True if the file is a .gltf or .glb file, false if not.</returns>
+GLboolean PBRViewerGltfLoader::IsGltfFile( std::string const& filepath )
+{
+	const size_t extensionStart = filepath.find_last_of('.');
+	if (std::string::npos == extensionStart)
+	{
+		return GL_FALSE;
+	}
+
+	std::string extension = filepath.substr(extensionStart + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), []( const char character )
+	{
+		return static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+	});
+
+	return "gltf" == extension || "glb" == extension;
+}
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerGltfLoader"/> class.
+/// </summary>
+/// <param name="filepath">The filepath of the glTF asset.</param>
+PBRViewerGltfLoader::PBRViewerGltfLoader( std::string const& filepath )
+	: myFilepath(filepath)
+{
+}
+
+/// <summary>
+/// Loads the meshes and material textures of the default scene. The textures are registered, but not decoded.
+/// The mapped files and decoded buffers are added to the scene data, which keeps them alive until the upload.
+/// </summary>
+/// <param name="keepStreams">True to keep the vertex attributes in the buffers (stream format), false to interleave them into vertices.</param>
+/// <param name="sceneData">The scene data to fill. The directory has to be set.</param>
+/// <returns>True if the asset could be loaded, false if it is malformed or uses unsupported features.</returns>
+GLboolean PBRViewerGltfLoader::Load( const GLboolean keepStreams, PBRViewerSceneData& sceneData )
+{
+	PBRViewerImportReport& report = sceneData.Report;
+
+	auto startTime = std::chrono::steady_clock::now();
+	const GLboolean isRead = ReadDocument(sceneData);
+	report.AddPhase("glTF parse", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	if (GL_FALSE == isRead)
+	{
+		return GL_FALSE;
+	}
+
+	startTime = std::chrono::steady_clock::now();
+	const GLboolean areBuffersRead = ReadBuffers(sceneData);
+	report.AddPhase("glTF buffer mapping", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	if (GL_FALSE == areBuffersRead)
+	{
+		return GL_FALSE;
+	}
+
+	startTime = std::chrono::steady_clock::now();
+	myNumberOfVertices = 0u;
+	myNumberOfConvertedAttributes = 0u;
+
+	// Without any scene the asset is a library of meshes, which are all loaded.
+	const PBRViewerJsonValue& scenes = myDocument["scenes"];
+	if (0u == scenes.GetSize())
+	{
+		for (size_t i = 0; i < myDocument["meshes"].GetSize(); i++)
+		{
+			if (GL_FALSE == ProcessMesh(i, keepStreams, sceneData))
+			{
+				return GL_FALSE;
+			}
+		}
+	}
+	else
+	{
+		size_t sceneIndex;
+		if (GL_FALSE == GetUnsigned(myDocument["scene"], 0.0, sceneIndex) || sceneIndex >= scenes.GetSize())
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Invalid default scene of the glTF asset:", myFilepath);
+			return GL_FALSE;
+		}
+
+		const PBRViewerJsonValue& nodes = scenes[sceneIndex]["nodes"];
+		for (size_t i = 0; i < nodes.GetSize(); i++)
+		{
+			if (GL_FALSE == ProcessNode(nodes[i], 0u, keepStreams, sceneData))
+			{
+				return GL_FALSE;
+			}
+		}
+	}
+
+	report.AddPhase("glTF mesh conversion (" + std::to_string(myNumberOfVertices) + " vertices)",
+	                std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+	report.AddStatistic("glTF converted attributes", myNumberOfConvertedAttributes);
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Maps the asset, splits a binary file into its chunks and parses the JSON document.
+/// </summary>
+/// <param name="sceneData">The scene data keeping the mapped file alive.</param>
+/// <returns>True if the document could be read, false if not.</returns>
+GLboolean PBRViewerGltfLoader::ReadDocument( PBRViewerSceneData& sceneData )
+{
+	auto file = std::make_shared<PBRViewerMappedFile>();
+	if (GL_FALSE == file->Open(myFilepath))
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not open the glTF asset:", myFilepath);
+		return GL_FALSE;
+	}
+
+	const GLubyte* data = file->GetData();
+	const size_t size = file->GetSize();
+	const char* json = reinterpret_cast<const char*>(data);
+	size_t jsonLength = size;
+
+	// A binary file consists of a 12 byte header, the JSON chunk and an optional binary chunk.
+	if (size >= 12u && GlbMagic == ReadUInt(data))
+	{
+		const size_t length = ReadUInt(data + 8);
+		if (2u != ReadUInt(data + 4) || length > size || length < 20u || GlbJsonChunk != ReadUInt(data + 16))
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Invalid binary glTF header:", myFilepath);
+			return GL_FALSE;
+		}
+
+		jsonLength = ReadUInt(data + 12);
+		json = reinterpret_cast<const char*>(data + 20);
+		if (jsonLength > length - 20u)
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Invalid binary glTF header:", myFilepath);
+			return GL_FALSE;
+		}
+
+		// The chunks are padded to four bytes, so the binary chunk follows the JSON one directly.
+		const size_t binaryChunkStart = 20u + jsonLength;
+		if (binaryChunkStart + 8u <= length && GlbBinaryChunk == ReadUInt(data + binaryChunkStart + 4))
+		{
+			const size_t binaryChunkLength = ReadUInt(data + binaryChunkStart);
+			if (binaryChunkLength <= length - binaryChunkStart - 8u)
+			{
+				myBinaryChunk.Data = data + binaryChunkStart + 8u;
+				myBinaryChunk.Size = binaryChunkLength;
+			}
+		}
+
+		// The binary chunk and the images embedded into it are read in place, so the file stays mapped.
+		sceneData.MappedBuffers.push_back(file);
+	}
+
+	if (GL_FALSE == PBRViewerJsonValue::Parse(json, jsonLength, myDocument))
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "The JSON document of the glTF asset is malformed:", myFilepath);
+		return GL_FALSE;
+	}
+
+	const std::string& version = myDocument["asset"]["version"].GetString();
+	if (0u != version.compare(0, 2, "2."))
+	{
+		PBRViewerLogger::PrintInfoMessage("Unsupported glTF version '" + version + "': " + myFilepath);
+		return GL_FALSE;
+	}
+
+	const PBRViewerJsonValue& requiredExtensions = myDocument["extensionsRequired"];
+	if (requiredExtensions.GetSize() > 0u)
+	{
+		PBRViewerLogger::PrintInfoMessage("The glTF asset requires the extension '" + requiredExtensions[0].GetString() + "': " + myFilepath);
+		return GL_FALSE;
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Maps the external buffers, decodes the buffers given as data URI and takes the binary chunk of a .glb file.
+/// </summary>
+/// <param name="sceneData">The scene data keeping the buffers alive.</param>
+/// <returns>True if all buffers are available, false if not.</returns>
+GLboolean PBRViewerGltfLoader::ReadBuffers( PBRViewerSceneData& sceneData )
+{
+	const PBRViewerJsonValue& buffers = myDocument["buffers"];
+	myBuffers.resize(buffers.GetSize());
+
+	for (size_t i = 0; i < myBuffers.size(); i++)
+	{
+		const PBRViewerJsonValue& buffer = buffers[i];
+		Buffer& target = myBuffers[i];
+
+		size_t byteLength;
+		if (GL_FALSE == GetUnsigned(buffer["byteLength"], -1.0, byteLength))
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Invalid length of glTF buffer " + std::to_string(i) + ":", myFilepath);
+			return GL_FALSE;
+		}
+
+		const std::string& uri = buffer["uri"].GetString();
+		if (uri.empty())
+		{
+			// Only the first buffer may refer to the binary chunk.
+			target = 0u == i ? myBinaryChunk : Buffer();
+		}
+		else if (0u == uri.compare(0, 5, "data:"))
+		{
+			std::vector<GLubyte> data;
+			if (DecodeDataUri(uri, data))
+			{
+				target.Size = data.size();
+				target.Data = StoreBuffer(std::move(data), sceneData);
+			}
+		}
+		else
+		{
+			auto file = std::make_shared<PBRViewerMappedFile>();
+			if (file->Open(sceneData.Directory + '\\' + DecodeUri(uri)))
+			{
+				target.Data = file->GetData();
+				target.Size = file->GetSize();
+				sceneData.MappedBuffers.push_back(file);
+			}
+		}
+
+		if (nullptr == target.Data || target.Size < byteLength)
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not read glTF buffer " + std::to_string(i) + ":", myFilepath);
+			return GL_FALSE;
+		}
+
+		target.Size = byteLength;
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Gets the range and the stride of a buffer view.
+/// </summary>
+/// <param name="index">The index of the buffer view.</param>
+/// <param name="data">The first byte of the view.</param>
+/// <param name="size">The size of the view in bytes.</param>
+/// <param name="stride">The stride of the view or zero if the elements are tightly packed.</param>
+/// <returns>True if the view lies within its buffer, false if not.</returns>
+GLboolean PBRViewerGltfLoader::GetBufferView( const PBRViewerJsonValue& index, const GLubyte*& data, size_t& size, GLsizei& stride ) const
+{
+	const PBRViewerJsonValue& bufferViews = myDocument["bufferViews"];
+
+	size_t viewIndex;
+	size_t bufferIndex;
+	if (GL_FALSE == GetIndex(index, bufferViews.GetSize(), viewIndex) ||
+		GL_FALSE == GetIndex(bufferViews[viewIndex]["buffer"], myBuffers.size(), bufferIndex))
+	{
+		return GL_FALSE;
+	}
+
+	const PBRViewerJsonValue& bufferView = bufferViews[viewIndex];
+	const Buffer& buffer = myBuffers[bufferIndex];
+
+	size_t offset;
+	size_t byteStride;
+	if (GL_FALSE == GetUnsigned(bufferView["byteOffset"], 0.0, offset) ||
+		GL_FALSE == GetUnsigned(bufferView["byteLength"], -1.0, size) ||
+		GL_FALSE == GetUnsigned(bufferView["byteStride"], 0.0, byteStride) ||
+		offset > buffer.Size || size > buffer.Size - offset || byteStride > 252u)
+	{
+		return GL_FALSE;
+	}
+
+	data = buffer.Data + offset;
+	stride = static_cast<GLsizei>(byteStride);
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Gets an accessor and checks that all of its elements lie within its buffer view.
+/// </summary>
+/// <param name="index">The index of the accessor.</param>
+/// <param name="accessor">The accessor.</param>
+/// <returns>True if the accessor is valid and supported, false if not.</returns>
+GLboolean PBRViewerGltfLoader::GetAccessor( const PBRViewerJsonValue& index, Accessor& accessor ) const
+{
+	const PBRViewerJsonValue& accessors = myDocument["accessors"];
+
+	size_t accessorIndex;
+	if (GL_FALSE == GetIndex(index, accessors.GetSize(), accessorIndex))
+	{
+		return GL_FALSE;
+	}
+
+	const PBRViewerJsonValue& description = accessors[accessorIndex];
+
+	// Sparse accessors and accessors without buffer view are initialized with zeros, which cannot be read in place.
+	if (GL_FALSE == description["sparse"].IsNull() || description["bufferView"].IsNull())
+	{
+		PBRViewerLogger::PrintInfoMessage("Sparse glTF accessors are not supported: " + myFilepath);
+		return GL_FALSE;
+	}
+
+	const std::string& type = description["type"].GetString();
+	accessor.Components = "SCALAR" == type ? 1 : "VEC2" == type ? 2 : "VEC3" == type ? 3 : "VEC4" == type ? 4 : 0;
+	accessor.ComponentType = static_cast<GLenum>(description["componentType"].GetNumber());
+	accessor.IsNormalized = description["normalized"].GetBoolean();
+
+	const GLsizei componentSize = GetComponentSize(accessor.ComponentType);
+
+	size_t count;
+	size_t offset;
+	if (0 == accessor.Components || 0 == componentSize ||
+		GL_FALSE == GetUnsigned(description["count"], -1.0, count) || 0u == count || count > std::numeric_limits<GLuint>::max() ||
+		GL_FALSE == GetUnsigned(description["byteOffset"], 0.0, offset))
+	{
+		return GL_FALSE;
+	}
+
+	const GLubyte* data;
+	size_t size;
+	GLsizei stride;
+	if (GL_FALSE == GetBufferView(description["bufferView"], data, size, stride))
+	{
+		return GL_FALSE;
+	}
+
+	const size_t elementSize = static_cast<size_t>(componentSize) * static_cast<size_t>(accessor.Components);
+	accessor.Stride = 0 != stride ? stride : static_cast<GLsizei>(elementSize);
+
+	// The last element has to end within the view. The stride is at most 252, so the product cannot overflow.
+	if (static_cast<size_t>(accessor.Stride) < elementSize || offset > size ||
+		static_cast<size_t>(accessor.Stride) * (count - 1u) + elementSize > size - offset)
+	{
+		return GL_FALSE;
+	}
+
+	accessor.Data = data + offset;
+	accessor.Count = static_cast<GLuint>(count);
+
+	const PBRViewerJsonValue& minimum = description["min"];
+	const PBRViewerJsonValue& maximum = description["max"];
+	accessor.HasBounds = minimum.GetSize() >= 3u && maximum.GetSize() >= 3u;
+	if (accessor.HasBounds)
+	{
+		for (glm::length_t i = 0; i < 3; i++)
+		{
+			accessor.Min[i] = static_cast<GLfloat>(minimum[i].GetNumber());
+			accessor.Max[i] = static_cast<GLfloat>(maximum[i].GetNumber());
+		}
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Processes the meshes of a node and its children.
+/// </summary>
+/// <param name="index">The index of the node.</param>
+/// <param name="depth">The depth of the node, which guards against cyclic node trees.</param>
+/// <param name="keepStreams">True to keep the vertex attributes in the buffers.</param>
+/// <param name="sceneData">The scene data to fill.</param>
+/// <returns>True if all meshes could be processed, false if not.</returns>
+GLboolean PBRViewerGltfLoader::ProcessNode( const PBRViewerJsonValue& index, const size_t depth, const GLboolean keepStreams, PBRViewerSceneData& sceneData )
+{
+	// A node tree without cycles is at most as deep as the number of nodes.
+	const PBRViewerJsonValue& nodes = myDocument["nodes"];
+
+	size_t nodeIndex;
+	if (GL_FALSE == GetIndex(index, nodes.GetSize(), nodeIndex) || depth >= nodes.GetSize())
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Invalid node tree of the glTF asset:", myFilepath);
+		return GL_FALSE;
+	}
+
+	// Like the ASSIMP path, the meshes are loaded in model space and the node transformations are not applied.
+	const PBRViewerJsonValue& node = nodes[nodeIndex];
+	if (GL_FALSE == node["mesh"].IsNull())
+	{
+		size_t meshIndex;
+		if (GL_FALSE == GetIndex(node["mesh"], myDocument["meshes"].GetSize(), meshIndex))
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Invalid mesh reference in the glTF asset:", myFilepath);
+			return GL_FALSE;
+		}
+
+		if (GL_FALSE == ProcessMesh(meshIndex, keepStreams, sceneData))
+		{
+			return GL_FALSE;
+		}
+	}
+
+	const PBRViewerJsonValue& children = node["children"];
+	for (size_t i = 0; i < children.GetSize(); i++)
+	{
+		if (GL_FALSE == ProcessNode(children[i], depth + 1u, keepStreams, sceneData))
+		{
+			return GL_FALSE;
+		}
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Processes all primitives of a mesh. Each primitive becomes a mesh of the scene, just like ASSIMP splits them.
+/// </summary>
+/// <param name="index">The index of the mesh.</param>
+/// <param name="keepStreams">True to keep the vertex attributes in the buffers.</param>
+/// <param name="sceneData">The scene data to fill.</param>
+/// <returns>True if all primitives could be processed, false if not.</returns>
+GLboolean PBRViewerGltfLoader::ProcessMesh( const size_t index, const GLboolean keepStreams, PBRViewerSceneData& sceneData )
+{
+	const PBRViewerJsonValue& primitives = myDocument["meshes"][index]["primitives"];
+	for (size_t i = 0; i < primitives.GetSize(); i++)
+	{
+		if (GL_FALSE == ProcessPrimitive(primitives[i], keepStreams, sceneData))
+		{
+			return GL_FALSE;
+		}
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Converts a triangle list primitive into a mesh.
+/// </summary>
+/// <param name="primitive">The primitive to convert.</param>
+/// <param name="keepStreams">True to keep the vertex attributes in the buffers.</param>
+/// <param name="sceneData">The scene data to fill.</param>
+/// <returns>True if the primitive could be converted, false if not.</returns>
+GLboolean PBRViewerGltfLoader::ProcessPrimitive( const PBRViewerJsonValue& primitive, const GLboolean keepStreams, PBRViewerSceneData& sceneData )
+{
+	if (GL_TRIANGLES != static_cast<GLenum>(primitive["mode"].GetNumber(GL_TRIANGLES)))
+	{
+		PBRViewerLogger::PrintInfoMessage("Only glTF primitives of triangle lists are supported: " + myFilepath);
+		return GL_FALSE;
+	}
+
+	// OpenGL reads every component type of glTF, but the bounding box and the generated attributes need float positions.
+	const PBRViewerJsonValue& attributes = primitive["attributes"];
+	Accessor positions;
+	if (GL_FALSE == GetAccessor(attributes["POSITION"], positions) || GL_FLOAT != positions.ComponentType || 3 != positions.Components)
+	{
+		PBRViewerLogger::PrintInfoMessage("Only glTF primitives with float positions are supported: " + myFilepath);
+		return GL_FALSE;
+	}
+
+	const GLuint numberOfVertices = positions.Count;
+
+	Accessor normals;
+	Accessor textureCoordinates;
+	Accessor tangents;
+	const GLboolean hasNormals = GL_FALSE == attributes["NORMAL"].IsNull();
+	const GLboolean hasTextureCoordinates = GL_FALSE == attributes["TEXCOORD_0"].IsNull();
+	const GLboolean hasTangents = GL_FALSE == attributes["TANGENT"].IsNull();
+
+	if ((hasNormals && (GL_FALSE == GetAccessor(attributes["NORMAL"], normals) || GL_FLOAT != normals.ComponentType ||
+	                    3 != normals.Components || numberOfVertices != normals.Count)) ||
+		(hasTextureCoordinates && (GL_FALSE == GetAccessor(attributes["TEXCOORD_0"], textureCoordinates) || 2 != textureCoordinates.Components ||
+		                           numberOfVertices != textureCoordinates.Count)) ||
+		(hasTangents && (GL_FALSE == GetAccessor(attributes["TANGENT"], tangents) || GL_FLOAT != tangents.ComponentType ||
+		                 4 != tangents.Components || numberOfVertices != tangents.Count)))
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Invalid vertex attributes in the glTF asset:", myFilepath);
+		return GL_FALSE;
+	}
+
+	PBRViewerMeshData meshData;
+	std::vector<GLuint>& indices = meshData.Indices;
+
+	// 16 and 32 bit indices are read in place by the stream format, 8 bit indices are not supported by every driver and widened.
+	Accessor indexAccessor;
+	const GLboolean hasIndices = GL_FALSE == primitive["indices"].IsNull();
+	if (hasIndices && (GL_FALSE == GetAccessor(primitive["indices"], indexAccessor) || 1 != indexAccessor.Components ||
+	                   GL_FLOAT == indexAccessor.ComponentType || GetComponentSize(indexAccessor.ComponentType) != indexAccessor.Stride ||
+	                   GL_BYTE == indexAccessor.ComponentType || GL_SHORT == indexAccessor.ComponentType))
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Invalid indices in the glTF asset:", myFilepath);
+		return GL_FALSE;
+	}
+
+	const GLuint numberOfIndices = hasIndices ? indexAccessor.Count : numberOfVertices;
+	if (0u != numberOfIndices % 3u)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Incomplete triangle list in the glTF asset:", myFilepath);
+		return GL_FALSE;
+	}
+
+	// process the material
+	const PBRViewerJsonValue& materials = myDocument["materials"];
+	size_t materialIndex;
+	if (GetIndex(primitive["material"], materials.GetSize(), materialIndex))
+	{
+		meshData.Textures = LoadMaterialTextures(materials[materialIndex], sceneData);
+	}
+
+	const GLboolean hasNormalTexture = std::any_of(meshData.Textures.begin(), meshData.Textures.end(), []( PBRViewerTextureReference const& texture )
+	{
+		return PBRViewerEnumerations::TextureNormal == texture.Slot;
+	});
+
+	// The full precision vertices always hold a tangent frame, the streams only if a normal map needs it.
+	const GLboolean generateTangents = GL_FALSE == hasTangents && hasTextureCoordinates && (GL_FALSE == keepStreams || hasNormalTexture);
+	const GLboolean readPositions = GL_FALSE == keepStreams || GL_FALSE == hasNormals || generateTangents || GL_FALSE == positions.HasBounds;
+
+	// Mapped indices are only copied if the triangles are needed to generate normals or tangents.
+	const GLboolean mapIndices = keepStreams && hasIndices && GL_UNSIGNED_BYTE != indexAccessor.ComponentType;
+	const GLboolean copyIndices = GL_FALSE == mapIndices || GL_FALSE == hasNormals || generateTangents;
+
+	std::vector<GLuint> triangleList;
+	if (copyIndices)
+	{
+		triangleList.resize(numberOfIndices);
+	}
+
+	if (hasIndices)
+	{
+		GLuint maximumIndex = 0u;
+		for (GLuint i = 0; i < numberOfIndices; i++)
+		{
+			const GLuint index = ReadIndex(indexAccessor, i);
+			maximumIndex = std::max(maximumIndex, index);
+
+			if (copyIndices)
+			{
+				triangleList[i] = index;
+			}
+		}
+
+		// An out of range index would read behind the vertex buffer on the GPU.
+		if (maximumIndex >= numberOfVertices)
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Index out of range in the glTF asset:", myFilepath);
+			return GL_FALSE;
+		}
+	}
+	else
+	{
+		std::iota(triangleList.begin(), triangleList.end(), 0u);
+	}
+
+	if (mapIndices)
+	{
+		meshData.MappedStreamIndices = indexAccessor.Data;
+		meshData.MappedStreamIndexType = indexAccessor.ComponentType;
+		meshData.NumberOfMappedIndices = numberOfIndices;
+	}
+	else if (keepStreams)
+	{
+		myNumberOfConvertedAttributes++;
+	}
+
+	std::vector<glm::vec3> positionValues;
+	std::vector<glm::vec3> normalValues;
+	std::vector<glm::vec2> textureCoordinateValues;
+	std::vector<glm::vec4> tangentValues;
+
+	if (readPositions)
+	{
+		positionValues.resize(numberOfVertices);
+		for (GLuint i = 0; i < numberOfVertices; i++)
+		{
+			ReadElement(positions, i, &positionValues[i].x);
+		}
+	}
+
+	if (GL_FALSE == hasNormals)
+	{
+		normalValues = PBRViewerTangentSpace::GenerateNormals(positionValues, triangleList);
+		myNumberOfConvertedAttributes++;
+	}
+	else if (GL_FALSE == keepStreams || generateTangents)
+	{
+		normalValues.resize(numberOfVertices);
+		for (GLuint i = 0; i < numberOfVertices; i++)
+		{
+			ReadElement(normals, i, &normalValues[i].x);
+		}
+	}
+
+	if (hasTextureCoordinates && (GL_FALSE == keepStreams || generateTangents))
+	{
+		textureCoordinateValues.resize(numberOfVertices);
+		for (GLuint i = 0; i < numberOfVertices; i++)
+		{
+			ReadElement(textureCoordinates, i, &textureCoordinateValues[i].x);
+		}
+	}
+
+	if (generateTangents)
+	{
+		tangentValues = PBRViewerTangentSpace::GenerateTangents(positionValues, normalValues, textureCoordinateValues, triangleList);
+		myNumberOfConvertedAttributes++;
+	}
+	else if (hasTangents && GL_FALSE == keepStreams)
+	{
+		tangentValues.resize(numberOfVertices);
+		for (GLuint i = 0; i < numberOfVertices; i++)
+		{
+			ReadElement(tangents, i, &tangentValues[i].x);
+		}
+	}
+
+	if (keepStreams)
+	{
+		meshData.VertexFormat = PBRViewerEnumerations::Streams;
+		meshData.NumberOfMappedVertices = numberOfVertices;
+
+		VertexStream& positionStream = meshData.Streams[PBRViewerEnumerations::PositionStream];
+		positionStream.Data = positions.Data;
+		positionStream.Stride = positions.Stride;
+		positionStream.Size = 3;
+
+		VertexStream& normalStream = meshData.Streams[PBRViewerEnumerations::NormalStream];
+		normalStream.Size = 3;
+		if (hasNormals)
+		{
+			normalStream.Data = normals.Data;
+			normalStream.Stride = normals.Stride;
+		}
+		else
+		{
+			std::vector<GLubyte> data(sizeof(glm::vec3) * normalValues.size());
+			std::memcpy(data.data(), normalValues.data(), data.size());
+			normalStream.Data = StoreBuffer(std::move(data), sceneData);
+			normalStream.Stride = sizeof(glm::vec3);
+		}
+
+		// Normalized 8 and 16 bit texture coordinates are read by OpenGL as they are.
+		if (hasTextureCoordinates)
+		{
+			VertexStream& textureCoordinateStream = meshData.Streams[PBRViewerEnumerations::TexCoordsStream];
+			textureCoordinateStream.Data = textureCoordinates.Data;
+			textureCoordinateStream.Stride = textureCoordinates.Stride;
+			textureCoordinateStream.Size = 2;
+			textureCoordinateStream.Type = textureCoordinates.ComponentType;
+			textureCoordinateStream.IsNormalized = textureCoordinates.IsNormalized;
+		}
+
+		VertexStream& tangentStream = meshData.Streams[PBRViewerEnumerations::TangentStream];
+		tangentStream.Size = 4;
+		if (hasTangents)
+		{
+			tangentStream.Data = tangents.Data;
+			tangentStream.Stride = tangents.Stride;
+		}
+		else if (generateTangents)
+		{
+			std::vector<GLubyte> data(sizeof(glm::vec4) * tangentValues.size());
+			std::memcpy(data.data(), tangentValues.data(), data.size());
+			tangentStream.Data = StoreBuffer(std::move(data), sceneData);
+			tangentStream.Stride = sizeof(glm::vec4);
+		}
+
+		if (positions.HasBounds)
+		{
+			meshData.BoundingBoxMin = positions.Min;
+			meshData.BoundingBoxMax = positions.Max;
+		}
+		else
+		{
+			meshData.BoundingBoxMin = meshData.BoundingBoxMax = positionValues[0];
+			for (const glm::vec3& position : positionValues)
+			{
+				meshData.BoundingBoxMin = glm::min(meshData.BoundingBoxMin, position);
+				meshData.BoundingBoxMax = glm::max(meshData.BoundingBoxMax, position);
+			}
+		}
+
+		if (GL_FALSE == mapIndices)
+		{
+			indices = std::move(triangleList);
+		}
+	}
+	else
+	{
+		// The glTF tangent holds the handedness in w, the vertex layout keeps the bitangent itself.
+		meshData.Vertices.resize(numberOfVertices);
+		for (GLuint i = 0; i < numberOfVertices; i++)
+		{
+			Vertex& vertex = meshData.Vertices[i];
+			vertex.Position = positionValues[i];
+			vertex.Normal = normalValues[i];
+			vertex.TexCoords = textureCoordinateValues.empty() ? glm::vec2(0.0f) : textureCoordinateValues[i];
+			vertex.Tangent = tangentValues.empty() ? glm::vec3(0.0f) : glm::vec3(tangentValues[i]);
+			vertex.Bitangent = tangentValues.empty() ? glm::vec3(0.0f) : glm::cross(vertex.Normal, vertex.Tangent) * tangentValues[i].w;
+		}
+
+		indices = std::move(triangleList);
+	}
+
+	myNumberOfVertices += numberOfVertices;
+	sceneData.Meshes.push_back(std::move(meshData));
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Registers the textures of a material, mapping the glTF texture slots onto the texture types of the shaders.
+/// </summary>
+/// <param name="material">The material to process.</param>
+/// <param name="sceneData">The scene data the textures are registered with.</param>
+/// <returns>The references to the textures of the material.</returns>
+std::vector<PBRViewerTextureReference> PBRViewerGltfLoader::LoadMaterialTextures( const PBRViewerJsonValue& material, PBRViewerSceneData& sceneData )
+{
+	std::vector<PBRViewerTextureReference> textures;
+	const PBRViewerJsonValue& metallicRoughness = material["pbrMetallicRoughness"];
+
+	// 1. diffuse (albedo) maps
+	RegisterTexture(metallicRoughness["baseColorTexture"], PBRViewerEnumerations::TextureDiffuse, sceneData, textures);
+
+	// 2. normal maps
+	RegisterTexture(material["normalTexture"], PBRViewerEnumerations::TextureNormal, sceneData, textures);
+
+	// 3. Roughness maps (metallic and roughness on different color channels, like ASSIMP's unknown texture type)
+	RegisterTexture(metallicRoughness["metallicRoughnessTexture"], PBRViewerEnumerations::TextureRoughness, sceneData, textures);
+
+	// 4. Emissive maps
+	RegisterTexture(material["emissiveTexture"], PBRViewerEnumerations::TextureEmissive, sceneData, textures);
+
+	return textures;
+}
+
+/// <summary>
+/// Registers the image of a texture once for the whole scene.
+/// </summary>
+/// <param name="textureInfo">The texture info of the material referencing the texture.</param>
+/// <param name="slot">The slot the texture is bound to.</param>
+/// <param name="sceneData">The scene data the texture is registered with.</param>
+/// <param name="textures">The references of the material, which the texture is added to.</param>
+GLvoid PBRViewerGltfLoader::RegisterTexture( const PBRViewerJsonValue& textureInfo, const PBRViewerEnumerations::TextureSlot slot, PBRViewerSceneData& sceneData,
+                                             std::vector<PBRViewerTextureReference>& textures )
+{
+	const PBRViewerJsonValue& gltfTextures = myDocument["textures"];
+	const PBRViewerJsonValue& images = myDocument["images"];
+
+	// Textures whose image is only given by an extension, e. g. KHR_texture_basisu, have no source and are skipped.
+	size_t textureIndex;
+	size_t imageIndex;
+	if (GL_FALSE == GetIndex(textureInfo["index"], gltfTextures.GetSize(), textureIndex) ||
+		GL_FALSE == GetIndex(gltfTextures[textureIndex]["source"], images.GetSize(), imageIndex))
+	{
+		return;
+	}
+
+	// check if the image was registered before and if so, reuse it: skip decoding the same image twice
+	const GLuint key = static_cast<GLuint>(imageIndex);
+	auto registeredTexture = myTextureIndices.find(key);
+	if (registeredTexture == myTextureIndices.end())
+	{
+		const PBRViewerJsonValue& image = images[imageIndex];
+		const std::string& uri = image["uri"].GetString();
+
+		PBRViewerTextureData texture;
+		texture.Slot = slot;
+
+		if (!uri.empty() && 0u != uri.compare(0, 5, "data:"))
+		{
+			texture.Filepath = DecodeUri(uri);
+		}
+		else
+		{
+			// Embedded images are named after the model, so the report and the log can tell them apart.
+			texture.Filepath = myFilepath.substr(myFilepath.find_last_of("\\/") + 1u) + "#image" + std::to_string(imageIndex);
+
+			std::vector<GLubyte> data;
+			const GLubyte* bufferViewData;
+			size_t bufferViewSize;
+			GLsizei stride;
+			if (!uri.empty() && DecodeDataUri(uri, data))
+			{
+				texture.EncodedSize = data.size();
+				texture.EncodedData = StoreBuffer(std::move(data), sceneData);
+			}
+			else if (uri.empty() && GetBufferView(image["bufferView"], bufferViewData, bufferViewSize, stride))
+			{
+				texture.EncodedData = bufferViewData;
+				texture.EncodedSize = bufferViewSize;
+			}
+		}
+
+		registeredTexture = myTextureIndices.emplace(key, static_cast<GLuint>(sceneData.Textures.size())).first;
+		sceneData.Textures.push_back(texture);
+	}
+
+	PBRViewerTextureReference reference;
+	reference.Slot = slot;
+	reference.TextureIndex = registeredTexture->second;
+	textures.push_back(reference);
+}
+
+/// <summary>
+/// Stores data created by the loader within the scene data, so vertex streams and textures can point into it.
+/// </summary>
+/// <param name="data">The data to store.</param>
+/// <param name="sceneData">The scene data keeping the data alive.</param>
+/// <returns>The first byte of the stored data.</returns>
+const GLubyte* PBRViewerGltfLoader::StoreBuffer( std::vector<GLubyte>&& data, PBRViewerSceneData& sceneData )
+{
+	sceneData.DecodedBuffers.push_back(std::make_shared<std::vector<GLubyte>>(std::move(data)));
+	return sceneData.DecodedBuffers.back()->data();
+}
+
+/// <summary>
+/// Reads an element of an accessor as floating point values, normalizing integer components if required.
+/// </summary>
+/// <param name="accessor">The accessor to read.</param>
+/// <param name="index">The index of the element.</param>
+/// <param name="values">The values, which have to hold the number of components of the accessor.</param>
+GLvoid PBRViewerGltfLoader::ReadElement( Accessor const& accessor, const GLuint index, GLfloat* values )
+{
+	// The buffers only guarantee the alignment of the component type, so the components are copied.
+	const GLubyte* element = accessor.Data + static_cast<size_t>(accessor.Stride) * index;
+	for (GLint i = 0; i < accessor.Components; i++)
+	{
+		switch (accessor.ComponentType)
+		{
+		case GL_BYTE:
+		{
+			GLbyte value;
+			std::memcpy(&value, element + i, sizeof value);
+			values[i] = accessor.IsNormalized ? std::max(value / 127.0f, -1.0f) : static_cast<GLfloat>(value);
+			break;
+		}
+		case GL_UNSIGNED_BYTE:
+		{
+			GLubyte value;
+			std::memcpy(&value, element + i, sizeof value);
+			values[i] = accessor.IsNormalized ? value / 255.0f : static_cast<GLfloat>(value);
+			break;
+		}
+		case GL_SHORT:
+		{
+			GLshort value;
+			std::memcpy(&value, element + sizeof value * i, sizeof value);
+			values[i] = accessor.IsNormalized ? std::max(value / 32767.0f, -1.0f) : static_cast<GLfloat>(value);
+			break;
+		}
+		case GL_UNSIGNED_SHORT:
+		{
+			GLushort value;
+			std::memcpy(&value, element + sizeof value * i, sizeof value);
+			values[i] = accessor.IsNormalized ? value / 65535.0f : static_cast<GLfloat>(value);
+			break;
+		}
+		case GL_UNSIGNED_INT:
+		{
+			GLuint value;
+			std::memcpy(&value, element + sizeof value * i, sizeof value);
+			values[i] = static_cast<GLfloat>(value);
+			break;
+		}
+		default:
+			std::memcpy(values + i, element + sizeof(GLfloat) * i, sizeof(GLfloat));
+			break;
+		}
+	}
+}
+
+/// <summary>
+/// Reads an index of an index accessor.
+/// </summary>
+/// <param name="accessor">The index accessor.</param>
+/// <param name="index">The position of the index.</param>
+/// <returns>The vertex index.</returns>
+GLuint PBRViewerGltfLoader::ReadIndex( Accessor const& accessor, const GLuint index )
+{
+	switch (accessor.ComponentType)
+	{
+	case GL_UNSIGNED_BYTE:
+		return accessor.Data[index];
+	case GL_UNSIGNED_SHORT:
+	{
+		GLushort value;
+		std::memcpy(&value, accessor.Data + sizeof value * index, sizeof value);
+		return value;
+	}
+	default:
+	{
+		GLuint value;
+		std::memcpy(&value, accessor.Data + sizeof value * index, sizeof value);
+		return value;
+	}
+	}
+}
+
+/// <summary>
+/// Decodes the base64 payload of a data URI.
+/// </summary>
+/// <param name="uri">The data URI.</param>
+/// <param name="data">The decoded bytes.</param>
+/// <returns>True if the URI is a valid base64 data URI, false if not.</returns>
+GLboolean PBRViewerGltfLoader::DecodeDataUri( std::string const& uri, std::vector<GLubyte>& data )
+{
+	const size_t separator = uri.find(',');
+	if (0u != uri.compare(0, 5, "data:") || std::string::npos == separator || separator < 7u || 0u != uri.compare(separator - 7u, 7u, ";base64"))
+	{
+		return GL_FALSE;
+	}
+
+	data.clear();
+	data.reserve((uri.size() - separator) / 4u * 3u);
+
+	GLuint bits = 0u;
+	GLint numberOfBits = 0;
+	for (size_t i = separator + 1u; i < uri.size(); i++)
+	{
+		const char character = uri[i];
+		GLuint value;
+		if (character >= 'A' && character <= 'Z')
+		{
+			value = static_cast<GLuint>(character - 'A');
+		}
+		else if (character >= 'a' && character <= 'z')
+		{
+			value = static_cast<GLuint>(character - 'a') + 26u;
+		}
+		else if (character >= '0' && character <= '9')
+		{
+			value = static_cast<GLuint>(character - '0') + 52u;
+		}
+		else if ('+' == character)
+		{
+			value = 62u;
+		}
+		else if ('/' == character)
+		{
+			value = 63u;
+		}
+		else if ('=' == character)
+		{
+			break;
+		}
+		else
+		{
+			return GL_FALSE;
+		}
+
+		bits = (bits << 6) | value;
+		numberOfBits += 6;
+		if (numberOfBits >= 8)
+		{
+			numberOfBits -= 8;
+			data.push_back(static_cast<GLubyte>(bits >> numberOfBits));
+		}
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Decodes the percent-encoded characters of a relative URI, e. g. '%20' for spaces in filenames.
+/// </summary>
+/// <param name="uri">The URI to decode.</param>
+/// <returns>The decoded filepath.</returns>
+std::string PBRViewerGltfLoader::DecodeUri( std::string const& uri )
+{
+	std::string filepath;
+	filepath.reserve(uri.size());
+
+	for (size_t i = 0; i < uri.size(); i++)
+	{
+		if ('%' == uri[i] && i + 2u < uri.size() &&
+			std::isxdigit(static_cast<unsigned char>(uri[i + 1u])) && std::isxdigit(static_cast<unsigned char>(uri[i + 2u])))
+		{
+			filepath.push_back(static_cast<char>(std::stoi(uri.substr(i + 1u, 2u), nullptr, 16)));
+			i += 2u;
+		}
+		else
+		{
+			filepath.push_back(uri[i]);
+		}
+	}
+
+	return filepath;
+}
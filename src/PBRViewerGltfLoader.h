@@ -0,0 +1,208 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerJsonValue.h"
+#include "PBRViewerSceneData.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// This class loads glTF 2.0 assets (.gltf with external or embedded buffers and binary .glb files) without ASSIMP.
+/// The buffers are memory-mapped and the accessors are read in place: in the stream format the vertex attributes are uploaded
+/// straight from the mapped buffers, otherwise they are interleaved into the vertex layout in a single pass.
+/// Attributes are only converted if OpenGL cannot read their component type or if they are missing, e. g. normals or tangents.
+/// Embedded images are handed to the texture decoding as encoded data in memory.
+/// Assets using features the loader does not support (sparse accessors, required extensions, primitives other than triangle lists)
+/// are rejected, so the importer can fall back to ASSIMP.
+/// </summary>
+class PBRViewerGltfLoader
+{
+public:
+	/// <summary>
+	/// Checks by the file extension if a file is a glTF asset.
+	/// </summary>
+	/// <param name="filepath">The filepath of the model.</param>
+	/// <returns>True if the file is a .gltf or .glb file, false if not.</returns>
+	static GLboolean IsGltfFile( std::string const& filepath );
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerGltfLoader"/> class.
+	/// </summary>
+	/// <param name="filepath">The filepath of the glTF asset.</param>
+	explicit PBRViewerGltfLoader( std::string const& filepath );
+
+	/// <summary>
+	/// Loads the meshes and material textures of the default scene. The textures are registered, but not decoded.
+	/// The mapped files and decoded buffers are added to the scene data, which keeps them alive until the upload.
+	/// </summary>
+	/// <param name="keepStreams">True to keep the vertex attributes in the buffers (stream format), false to interleave them into vertices.</param>
+	/// <param name="sceneData">The scene data to fill. The directory has to be set.</param>
+	/// <returns>True if the asset could be loaded, false if it is malformed or uses unsupported features.</returns>
+	GLboolean Load( GLboolean keepStreams, PBRViewerSceneData& sceneData );
+
+private:
+	/// <summary>
+	/// A buffer of the asset, either mapped or decoded.
+	/// </summary>
+	struct Buffer
+	{
+		const GLubyte* Data = nullptr;
+		size_t Size = 0u;
+	};
+
+	/// <summary>
+	/// A validated accessor pointing into a buffer.
+	/// </summary>
+	struct Accessor
+	{
+		const GLubyte* Data = nullptr;
+		GLuint Count = 0u;
+		GLenum ComponentType = GL_FLOAT;
+		GLint Components = 0;
+		GLsizei Stride = 0;
+		GLboolean IsNormalized = GL_FALSE;
+		GLboolean HasBounds = GL_FALSE;
+		glm::vec3 Min = glm::vec3(0.0f);
+		glm::vec3 Max = glm::vec3(0.0f);
+	};
+
+	// The component types of glTF are the OpenGL enums.
+	static const GLuint GlbMagic = 0x46546C67u;
+	static const GLuint GlbJsonChunk = 0x4E4F534Au;
+	static const GLuint GlbBinaryChunk = 0x004E4942u;
+
+	std::string myFilepath;
+	PBRViewerJsonValue myDocument;
+	Buffer myBinaryChunk;
+	std::vector<Buffer> myBuffers;
+
+	// Maps the index of a glTF image to the index of the texture within the scene data.
+	std::unordered_map<GLuint, GLuint> myTextureIndices;
+
+	GLuint myNumberOfConvertedAttributes = 0u;
+	GLuint myNumberOfVertices = 0u;
+
+	/// <summary>
+	/// Maps the asset, splits a binary file into its chunks and parses the JSON document.
+	/// </summary>
+	/// <param name="sceneData">The scene data keeping the mapped file alive.</param>
+	/// <returns>True if the document could be read, false if not.</returns>
+	GLboolean ReadDocument( PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Maps the external buffers, decodes the buffers given as data URI and takes the binary chunk of a .glb file.
+	/// </summary>
+	/// <param name="sceneData">The scene data keeping the buffers alive.</param>
+	/// <returns>True if all buffers are available, false if not.</returns>
+	GLboolean ReadBuffers( PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Gets the range and the stride of a buffer view.
+	/// </summary>
+	/// <param name="index">The index of the buffer view.</param>
+	/// <param name="data">The first byte of the view.</param>
+	/// <param name="size">The size of the view in bytes.</param>
+	/// <param name="stride">The stride of the view or zero if the elements are tightly packed.</param>
+	/// <returns>True if the view lies within its buffer, false if not.</returns>
+	GLboolean GetBufferView( const PBRViewerJsonValue& index, const GLubyte*& data, size_t& size, GLsizei& stride ) const;
+
+	/// <summary>
+	/// Gets an accessor and checks that all of its elements lie within its buffer view.
+	/// </summary>
+	/// <param name="index">The index of the accessor.</param>
+	/// <param name="accessor">The accessor.</param>
+	/// <returns>True if the accessor is valid and supported, false if not.</returns>
+	GLboolean GetAccessor( const PBRViewerJsonValue& index, Accessor& accessor ) const;
+
+	/// <summary>
+	/// Processes the meshes of a node and its children.
+	/// </summary>
+	/// <param name="index">The index of the node.</param>
+	/// <param name="depth">The depth of the node, which guards against cyclic node trees.</param>
+	/// <param name="keepStreams">True to keep the vertex attributes in the buffers.</param>
+	/// <param name="sceneData">The scene data to fill.</param>
+	/// <returns>True if all meshes could be processed, false if not.</returns>
+	GLboolean ProcessNode( const PBRViewerJsonValue& index, size_t depth, GLboolean keepStreams, PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Processes all primitives of a mesh. Each primitive becomes a mesh of the scene, just like ASSIMP splits them.
+	/// </summary>
+	/// <param name="index">The index of the mesh.</param>
+	/// <param name="keepStreams">True to keep the vertex attributes in the buffers.</param>
+	/// <param name="sceneData">The scene data to fill.</param>
+	/// <returns>True if all primitives could be processed, false if not.</returns>
+	GLboolean ProcessMesh( size_t index, GLboolean keepStreams, PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Converts a triangle list primitive into a mesh.
+	/// </summary>
+	/// <param name="primitive">The primitive to convert.</param>
+	/// <param name="keepStreams">True to keep the vertex attributes in the buffers.</param>
+	/// <param name="sceneData">The scene data to fill.</param>
+	/// <returns>True if the primitive could be converted, false if not.</returns>
+	GLboolean ProcessPrimitive( const PBRViewerJsonValue& primitive, GLboolean keepStreams, PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Registers the textures of a material, mapping the glTF texture slots onto the texture types of the shaders.
+	/// </summary>
+	/// <param name="material">The material to process.</param>
+	/// <param name="sceneData">The scene data the textures are registered with.</param>
+	/// <returns>The references to the textures of the material.</returns>
+	std::vector<PBRViewerTextureReference> LoadMaterialTextures( const PBRViewerJsonValue& material, PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Registers the image of a texture once for the whole scene.
+	/// </summary>
+	/// <param name="textureInfo">The texture info of the material referencing the texture.</param>
+	/// <param name="slot">The slot the texture is bound to.</param>
+	/// <param name="sceneData">The scene data the texture is registered with.</param>
+	/// <param name="textures">The references of the material, which the texture is added to.</param>
+	GLvoid RegisterTexture( const PBRViewerJsonValue& textureInfo, PBRViewerEnumerations::TextureSlot slot, PBRViewerSceneData& sceneData,
+	                        std::vector<PBRViewerTextureReference>& textures );
+
+	/// <summary>
+	/// Stores data created by the loader within the scene data, so vertex streams and textures can point into it.
+	/// </summary>
+	/// <param name="data">The data to store.</param>
+	/// <param name="sceneData">The scene data keeping the data alive.</param>
+	/// <returns>The first byte of the stored data.</returns>
+	static const GLubyte* StoreBuffer( std::vector<GLubyte>&& data, PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Reads an element of an accessor as floating point values, normalizing integer components if required.
+	/// </summary>
+	/// <param name="accessor">The accessor to read.</param>
+	/// <param name="index">The index of the element.</param>
+	/// <param name="values">The values, which have to hold the number of components of the accessor.</param>
+	static GLvoid ReadElement( Accessor const& accessor, GLuint index, GLfloat* values );
+
+	/// <summary>
+	/// Reads an index of an index accessor.
+	/// </summary>
+	/// <param name="accessor">The index accessor.</param>
+	/// <param name="index">The position of the index.</param>
+	/// <returns>The vertex index.</returns>
+	static GLuint ReadIndex( Accessor const& accessor, GLuint index );
+
+	/// <summary>
+	/// Decodes the base64 payload of a data URI.
+	/// </summary>
+	/// <param name="uri">The data URI.</param>
+	/// <param name="data">The decoded bytes.</param>
+	/// <returns>True if the URI is a valid base64 data URI, false if not.</returns>
+	static GLboolean DecodeDataUri( std::string const& uri, std::vector<GLubyte>& data );
+
+	/// <summary>
+	/// Decodes the percent-encoded characters of a relative URI, e. g. '%20' for spaces in filenames.
+	/// </summary>
+	/// <param name="uri">The URI to decode.</param>
+	/// <returns>The decoded filepath.</returns>
+	static std::string DecodeUri( std::string const& uri );
+};
@@ -0,0 +1,278 @@
+#include "PBRViewerImportReport.h"
+
+#include "PBRViewerLogger.h"
+
+#include <experimental/filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+static const std::string ImportReportDirectory = "ImportReports";
+
+/// <summary>
+/// Sets the model the report belongs to.
+/// </summary>
+/// <param name="modelPath">The filepath of the model.</param>
+/// <param name="presetName">The name of the import preset.</param>
+GLvoid PBRViewerImportReport::SetModel( std::string const& modelPath, std::string const& presetName )
+{
+	myModelPath = modelPath;
+	myPresetName = presetName;
+}
+
+/// <summary>
+/// Sets the loader which read the meshes, so the load times of the same asset can be compared across loaders.
+/// </summary>
+/// <param name="loaderName">The name of the loader, e. g. 'ASSIMP'.</param>
+GLvoid PBRViewerImportReport::SetLoader( std::string const& loaderName )
+{
+	myLoaderName = loaderName;
+}
+
+/// <summary>
+/// Adds a phase of the import. Phases are reported in the order they are added.
+/// </summary>
+/// <param name="name">The name of the phase.</param>
+/// <param name="duration">The duration of the phase in milliseconds.</param>
+GLvoid PBRViewerImportReport::AddPhase( std::string const& name, const GLdouble duration )
+{
+	Phase phase;
+	phase.Name = name;
+	phase.Duration = duration;
+	myPhases.push_back(phase);
+}
+
+/// <summary>
+/// Adds the timings of a single texture.
+/// </summary>
+/// <param name="filepath">The filepath of the texture as referenced by the material.</param>
+/// <param name="decodeTime">The time in milliseconds needed to decode (or read the cooked file of) the texture.</param>
+/// <param name="uploadTime">The time in milliseconds needed to upload the texture.</param>
+/// <param name="isReused">True if the texture was taken from the texture cache.</param>
+GLvoid PBRViewerImportReport::AddTexture( std::string const& filepath, const GLdouble decodeTime, const GLdouble uploadTime, const GLboolean isReused )
+{
+	Texture texture;
+	texture.Filepath = filepath;
+	texture.DecodeTime = decodeTime;
+	texture.UploadTime = uploadTime;
+	texture.IsReused = isReused;
+	myTextures.push_back(texture);
+}
+
+/// <summary>
+/// Adds the buffer layout of a single uploaded mesh.
+/// </summary>
+/// <param name="numberOfVertices">The number of vertices.</param>
+/// <param name="numberOfIndices">The number of indices.</param>
+/// <param name="vertexSize">The size of a vertex in bytes.</param>
+/// <param name="indexSize">The size of an index in bytes.</param>
+GLvoid PBRViewerImportReport::AddMesh( const GLuint numberOfVertices, const GLuint numberOfIndices, const GLuint vertexSize, const GLuint indexSize )
+{
+	Mesh mesh;
+	mesh.NumberOfVertices = numberOfVertices;
+	mesh.NumberOfIndices = numberOfIndices;
+	mesh.VertexSize = vertexSize;
+	mesh.IndexSize = indexSize;
+	myMeshes.push_back(mesh);
+}
+
+/// <summary>
+/// Adds a statistic of the imported data, e. g. a precision error.
+/// </summary>
+/// <param name="name">The name of the statistic.</param>
+/// <param name="value">The value of the statistic.</param>
+GLvoid PBRViewerImportReport::AddStatistic( std::string const& name, const GLdouble value )
+{
+	myStatistics.emplace_back(name, value);
+}
+
+/// <summary>
+/// Gets the sum of all phases.
+/// </summary>
+/// <returns>The total duration of the import in milliseconds.</returns>
+GLdouble PBRViewerImportReport::GetTotalDuration() const
+{
+	GLdouble totalDuration = 0.0;
+	for (const Phase& phase : myPhases)
+	{
+		totalDuration += phase.Duration;
+	}
+
+	return totalDuration;
+}
+
+/// <summary>
+/// Prints the report to the log.
+/// </summary>
+GLvoid PBRViewerImportReport::Print() const
+{
+	std::stringstream message;
+	message << std::fixed << std::setprecision(1);
+	message << "Import of " << myModelPath << " (" << myPresetName << ", " << myLoaderName << ") took " << GetTotalDuration() << " ms";
+
+	for (const Phase& phase : myPhases)
+	{
+		message << std::endl << "  " << std::left << std::setw(40) << phase.Name << std::right << std::setw(10) << phase.Duration << " ms";
+	}
+
+	for (const std::pair<std::string, GLdouble>& statistic : myStatistics)
+	{
+		message << std::endl << "  " << std::left << std::setw(40) << statistic.first << std::right << std::setw(10) << std::setprecision(6)
+		        << std::defaultfloat << statistic.second << std::fixed << std::setprecision(1);
+	}
+
+	// The meshes are summarized, the JSON file lists each of them.
+	if (!myMeshes.empty())
+	{
+		size_t numberOfShortIndexMeshes = 0u;
+		GLdouble indexMemory = 0.0;
+		for (const Mesh& mesh : myMeshes)
+		{
+			numberOfShortIndexMeshes += sizeof(GLushort) == mesh.IndexSize ? 1u : 0u;
+			indexMemory += static_cast<GLdouble>(mesh.NumberOfIndices) * mesh.IndexSize;
+		}
+
+		message << std::endl << "  Meshes: " << numberOfShortIndexMeshes << " with 16 bit indices, " << myMeshes.size() - numberOfShortIndexMeshes
+		        << " with 32 bit indices, " << indexMemory / (1024.0 * 1024.0) << " MB of indices";
+	}
+
+	for (const Texture& texture : myTextures)
+	{
+		message << std::endl << "  Texture " << texture.Filepath << ": ";
+		if (texture.IsReused)
+		{
+			message << "reused from the texture cache";
+		}
+		else
+		{
+			message << "decoded in " << texture.DecodeTime << " ms, uploaded in " << texture.UploadTime << " ms";
+		}
+	}
+
+	PBRViewerLogger::PrintInfoMessage(message.str());
+}
+
+/// <summary>
+/// Writes the report into the 'ImportReports' directory. The file is named after the model and the loader,
+/// so the reports of the same model read by different loaders can be compared side by side.
+/// </summary>
+/// <returns>True if the report could be written, false if not.</returns>
+GLboolean PBRViewerImportReport::Write() const
+{
+	std::error_code errorCode;
+	std::experimental::filesystem::create_directories(ImportReportDirectory, errorCode);
+
+	std::string reportName = std::experimental::filesystem::path(myModelPath).stem().string();
+	if (!myLoaderName.empty())
+	{
+		reportName += " (" + myLoaderName + ")";
+	}
+
+	const std::string reportFilepath = (std::experimental::filesystem::path(ImportReportDirectory) / (reportName + ".json")).string();
+
+	std::ofstream file(reportFilepath, std::ios::trunc);
+	if (!file)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not create the import report:", reportFilepath);
+		return GL_FALSE;
+	}
+
+	file << std::fixed << std::setprecision(3);
+	file << "{" << std::endl;
+	file << "  \"model\": " << EscapeJson(myModelPath) << "," << std::endl;
+	file << "  \"preset\": " << EscapeJson(myPresetName) << "," << std::endl;
+	file << "  \"loader\": " << EscapeJson(myLoaderName) << "," << std::endl;
+	file << "  \"totalMilliseconds\": " << GetTotalDuration() << "," << std::endl;
+
+	file << "  \"phases\": [";
+	for (size_t i = 0; i < myPhases.size(); i++)
+	{
+		file << (i > 0 ? "," : "") << std::endl;
+		file << "    { \"name\": " << EscapeJson(myPhases[i].Name) << ", \"milliseconds\": " << myPhases[i].Duration << " }";
+	}
+	file << std::endl << "  ]," << std::endl;
+
+	file << "  \"textures\": [";
+	for (size_t i = 0; i < myTextures.size(); i++)
+	{
+		const Texture& texture = myTextures[i];
+		file << (i > 0 ? "," : "") << std::endl;
+		file << "    { \"filepath\": " << EscapeJson(texture.Filepath)
+		     << ", \"decodeMilliseconds\": " << texture.DecodeTime
+		     << ", \"uploadMilliseconds\": " << texture.UploadTime
+		     << ", \"reused\": " << (texture.IsReused ? "true" : "false") << " }";
+	}
+	file << std::endl << "  ]," << std::endl;
+
+	file << "  \"meshes\": [";
+	for (size_t i = 0; i < myMeshes.size(); i++)
+	{
+		const Mesh& mesh = myMeshes[i];
+		file << (i > 0 ? "," : "") << std::endl;
+		file << "    { \"vertices\": " << mesh.NumberOfVertices
+		     << ", \"indices\": " << mesh.NumberOfIndices
+		     << ", \"vertexBytes\": " << mesh.VertexSize
+		     << ", \"indexBytes\": " << mesh.IndexSize << " }";
+	}
+	file << std::endl << "  ]," << std::endl;
+
+	// Statistics are written with full precision, since precision errors can be tiny.
+	file << std::defaultfloat << std::setprecision(9);
+	file << "  \"statistics\": [";
+	for (size_t i = 0; i < myStatistics.size(); i++)
+	{
+		file << (i > 0 ? "," : "") << std::endl;
+		file << "    { \"name\": " << EscapeJson(myStatistics[i].first) << ", \"value\": " << myStatistics[i].second << " }";
+	}
+	file << std::endl << "  ]" << std::endl;
+	file << "}" << std::endl;
+
+	if (!file)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not write the import report:", reportFilepath);
+		return GL_FALSE;
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Escapes a string so it can be written as JSON string.
+/// </summary>
+/// <param name="value">The string to escape.</param>
+/// <returns>The escaped string including the quotes.</returns>
+std::string PBRViewerImportReport::EscapeJson( std::string const& value )
+{
+	std::stringstream escaped;
+	escaped << '"';
+
+	for (const char character : value)
+	{
+		switch (character)
+		{
+			case '"': escaped << "\\\"";
+				break;
+			case '\\': escaped << "\\\\";
+				break;
+			case '\n': escaped << "\\n";
+				break;
+			case '\r': escaped << "\\r";
+				break;
+			case '\t': escaped << "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(character) < 0x20u)
+				{
+					escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<GLint>(character) << std::dec << std::setfill(' ');
+				}
+				else
+				{
+					escaped << character;
+				}
+				break;
+		}
+	}
+
+	escaped << '"';
+	return escaped.str();
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// This class collects the time spent in each phase of a model import, from reading the file to the upload to the GPU.
+/// The report is printed to the log and written as JSON file, so the load time of different assets and presets can be compared.
+/// </summary>
+class PBRViewerImportReport
+{
+public:
+	/// <summary>
+	/// Sets the model the report belongs to.
+	/// </summary>
+	/// <param name="modelPath">The filepath of the model.</param>
+	/// <param name="presetName">The name of the import preset.</param>
+	GLvoid SetModel( std::string const& modelPath, std::string const& presetName );
+
+	/// <summary>
+	/// Sets the loader which read the meshes, so the load times of the same asset can be compared across loaders.
+	/// </summary>
+	/// <param name="loaderName">The name of the loader, e. g. 'ASSIMP'.</param>
+	GLvoid SetLoader( std::string const& loaderName );
+
+	/// <summary>
+	/// Adds a phase of the import. Phases are reported in the order they are added.
+	/// </summary>
+	/// <param name="name">The name of the phase.</param>
+	/// <param name="duration">The duration of the phase in milliseconds.</param>
+	GLvoid AddPhase( std::string const& name, GLdouble duration );
+
+	/// <summary>
+	/// Adds the timings of a single texture.
+	/// </summary>
+	/// <param name="filepath">The filepath of the texture as referenced by the material.</param>
+	/// <param name="decodeTime">The time in milliseconds needed to decode (or read the cooked file of) the texture.</param>
+	/// <param name="uploadTime">The time in milliseconds needed to upload the texture.</param>
+	/// <param name="isReused">True if the texture was taken from the texture cache.</param>
+	GLvoid AddTexture( std::string const& filepath, GLdouble decodeTime, GLdouble uploadTime, GLboolean isReused );
+
+	/// <summary>
+	/// Adds the buffer layout of a single uploaded mesh.
+	/// </summary>
+	/// <param name="numberOfVertices">The number of vertices.</param>
+	/// <param name="numberOfIndices">The number of indices.</param>
+	/// <param name="vertexSize">The size of a vertex in bytes.</param>
+	/// <param name="indexSize">The size of an index in bytes.</param>
+	GLvoid AddMesh( GLuint numberOfVertices, GLuint numberOfIndices, GLuint vertexSize, GLuint indexSize );
+
+	/// <summary>
+	/// Adds a statistic of the imported data, e. g. a precision error.
+	/// </summary>
+	/// <param name="name">The name of the statistic.</param>
+	/// <param name="value">The value of the statistic.</param>
+	GLvoid AddStatistic( std::string const& name, GLdouble value );
+
+	/// <summary>
+	/// Gets the sum of all phases.
+	/// </summary>
+	/// <returns>The total duration of the import in milliseconds.</returns>
+	GLdouble GetTotalDuration() const;
+
+	/// <summary>
+	/// Prints the report to the log.
+	/// </summary>
+	GLvoid Print() const;
+
+	/// <summary>
+	/// Writes the report into the 'ImportReports' directory. The file is named after the model and the loader,
+	/// so the reports of the same model read by different loaders can be compared side by side.
+	/// </summary>
+	/// <returns>True if the report could be written, false if not.</returns>
+	GLboolean Write() const;
+
+private:
+	/// <summary>
+	/// The duration of a single phase.
+	/// </summary>
+	struct Phase
+	{
+		std::string Name;
+		GLdouble Duration = 0.0;
+	};
+
+	/// <summary>
+	/// The timings of a single texture.
+	/// </summary>
+	struct Texture
+	{
+		std::string Filepath;
+		GLdouble DecodeTime = 0.0;
+		GLdouble UploadTime = 0.0;
+		GLboolean IsReused = GL_FALSE;
+	};
+
+	/// <summary>
+	/// The buffer layout of a single mesh.
+	/// </summary>
+	struct Mesh
+	{
+		GLuint NumberOfVertices = 0u;
+		GLuint NumberOfIndices = 0u;
+		GLuint VertexSize = 0u;
+		GLuint IndexSize = 0u;
+	};
+
+	std::string myModelPath;
+	std::string myPresetName;
+	std::string myLoaderName;
+	std::vector<Phase> myPhases;
+	std::vector<Texture> myTextures;
+	std::vector<Mesh> myMeshes;
+	std::vector<std::pair<std::string, GLdouble>> myStatistics;
+
+	/// <summary>
+	/// Escapes a string so it can be written as JSON string.
+	/// </summary>
+	/// <param name="value">The string to escape.</param>
+	/// <returns>The escaped string including the quotes.</returns>
+	static std::string EscapeJson( std::string const& value );
+};
@@ -0,0 +1,527 @@
+#include "PBRViewerJsonValue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/// <summary>
+/// Parses a JSON document.
+/// </summary>
+/// <param name="text">The UTF-8 encoded document. It does not have to be null-terminated.</param>
+/// <param name="length">The length of the document in bytes.</param>
+/// <param name="value">The parsed root value.</param>
+/// <returns>True if the document could be parsed, false if it is malformed.</returns>
+GLboolean PBRViewerJsonValue::Parse( const char* text, const size_t length, PBRViewerJsonValue& value )
+{
+	Cursor cursor;
+	cursor.Position = text;
+	cursor.End = text + length;
+
+	value = PBRViewerJsonValue();
+	if (GL_FALSE == ParseValue(cursor, 0u, value))
+	{
+		value = PBRViewerJsonValue();
+		return GL_FALSE;
+	}
+
+	// Only whitespace may follow the root value.
+	SkipWhitespace(cursor);
+	if (cursor.Position != cursor.End)
+	{
+		value = PBRViewerJsonValue();
+		return GL_FALSE;
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Gets the type of the value.
+/// </summary>
+/// <returns>The type of the value.</returns>
+PBRViewerJsonValue::Type PBRViewerJsonValue::GetType() const
+{
+	return myType;
+}
+
+/// <summary>
+/// Gets a flag indicating if the value is null, i. e. it is missing or explicitly set to null.
+/// </summary>
+/// <returns>True if the value is null, false if not.</returns>
+GLboolean PBRViewerJsonValue::IsNull() const
+{
+	return Null == myType;
+}
+
+/// <summary>
+/// Gets the value as boolean.
+/// </summary>
+/// <param name="defaultValue">The value returned if the value is no boolean.</param>
+/// <returns>The boolean value.</returns>
+GLboolean PBRViewerJsonValue::GetBoolean( const GLboolean defaultValue ) const
+{
+	return Boolean == myType ? myBoolean : defaultValue;
+}
+
+/// <summary>
+/// Gets the value as number.
+/// </summary>
+/// <param name="defaultValue">The value returned if the value is no number.</param>
+/// <returns>The numeric value.</returns>
+GLdouble PBRViewerJsonValue::GetNumber( const GLdouble defaultValue ) const
+{
+	return Number == myType ? myNumber : defaultValue;
+}
+
+/// <summary>
+/// Gets the value as string.
+/// </summary>
+/// <returns>The string value or an empty string if the value is no string.</returns>
+std::string const& PBRViewerJsonValue::GetString() const
+{
+	// Non-string values keep their string empty.
+	return myString;
+}
+
+/// <summary>
+/// Gets the number of elements of an array or members of an object.
+/// </summary>
+/// <returns>The number of elements or zero if the value is neither an array nor an object.</returns>
+size_t PBRViewerJsonValue::GetSize() const
+{
+	return myElements.size();
+}
+
+/// <summary>
+/// Gets an element of an array.
+/// </summary>
+/// <param name="index">The index of the element.</param>
+/// <returns>The element or a null value if the value is no array or the index is out of range.</returns>
+PBRViewerJsonValue const& PBRViewerJsonValue::operator[]( const size_t index ) const
+{
+	static const PBRViewerJsonValue nullValue;
+
+	if (Array != myType || index >= myElements.size())
+	{
+		return nullValue;
+	}
+
+	return myElements[index];
+}
+
+/// <summary>
+/// Gets a member of an object.
+/// </summary>
+/// <param name="name">The name of the member.</param>
+/// <returns>The member or a null value if the value is no object or has no member with the name.</returns>
+PBRViewerJsonValue const& PBRViewerJsonValue::operator[]( std::string const& name ) const
+{
+	static const PBRViewerJsonValue nullValue;
+
+	// The objects of a glTF asset have a handful of members, so a linear search is faster than a map.
+	for (size_t i = 0; i < myNames.size(); i++)
+	{
+		if (myNames[i] == name)
+		{
+			return myElements[i];
+		}
+	}
+
+	return nullValue;
+}
+
+/// <summary>
+/// Parses the value at the cursor.
+/// </summary>
+/// <param name="cursor">The cursor, which is moved behind the value.</param>
+/// <param name="depth">The nesting depth of the value.</param>
+/// <param name="value">The parsed value.</param>
+/// <returns>True if the value could be parsed, false if not.</returns>
+GLboolean PBRViewerJsonValue::ParseValue( Cursor& cursor, const GLuint depth, PBRViewerJsonValue& value )
+{
+	SkipWhitespace(cursor);
+	if (cursor.Position == cursor.End || depth > MaxDepth)
+	{
+		return GL_FALSE;
+	}
+
+	const auto parseLiteral = [&cursor]( const char* literal ) -> GLboolean
+	{
+		const char* position = cursor.Position;
+		for (; '\0' != *literal; literal++, position++)
+		{
+			if (position == cursor.End || *position != *literal)
+			{
+				return GL_FALSE;
+			}
+		}
+
+		cursor.Position = position;
+		return GL_TRUE;
+	};
+
+	switch (*cursor.Position)
+	{
+		case 'n':
+			value.myType = Null;
+			return parseLiteral("null");
+		case 't':
+			value.myType = Boolean;
+			value.myBoolean = GL_TRUE;
+			return parseLiteral("true");
+		case 'f':
+			value.myType = Boolean;
+			value.myBoolean = GL_FALSE;
+			return parseLiteral("false");
+		case '"':
+			value.myType = String;
+			return ParseString(cursor, value.myString);
+		case '[':
+		{
+			value.myType = Array;
+			cursor.Position++;
+
+			SkipWhitespace(cursor);
+			if (cursor.Position != cursor.End && ']' == *cursor.Position)
+			{
+				cursor.Position++;
+				return GL_TRUE;
+			}
+
+			while (true)
+			{
+				value.myElements.emplace_back();
+				if (GL_FALSE == ParseValue(cursor, depth + 1u, value.myElements.back()))
+				{
+					return GL_FALSE;
+				}
+
+				SkipWhitespace(cursor);
+				if (cursor.Position == cursor.End)
+				{
+					return GL_FALSE;
+				}
+
+				const char separator = *cursor.Position++;
+				if (']' == separator)
+				{
+					return GL_TRUE;
+				}
+
+				if (',' != separator)
+				{
+					return GL_FALSE;
+				}
+			}
+		}
+		case '{':
+		{
+			value.myType = Object;
+			cursor.Position++;
+
+			SkipWhitespace(cursor);
+			if (cursor.Position != cursor.End && '}' == *cursor.Position)
+			{
+				cursor.Position++;
+				return GL_TRUE;
+			}
+
+			while (true)
+			{
+				SkipWhitespace(cursor);
+				value.myNames.emplace_back();
+				if (cursor.Position == cursor.End || '"' != *cursor.Position || GL_FALSE == ParseString(cursor, value.myNames.back()))
+				{
+					return GL_FALSE;
+				}
+
+				SkipWhitespace(cursor);
+				if (cursor.Position == cursor.End || ':' != *cursor.Position)
+				{
+					return GL_FALSE;
+				}
+				cursor.Position++;
+
+				value.myElements.emplace_back();
+				if (GL_FALSE == ParseValue(cursor, depth + 1u, value.myElements.back()))
+				{
+					return GL_FALSE;
+				}
+
+				SkipWhitespace(cursor);
+				if (cursor.Position == cursor.End)
+				{
+					return GL_FALSE;
+				}
+
+				const char separator = *cursor.Position++;
+				if ('}' == separator)
+				{
+					return GL_TRUE;
+				}
+
+				if (',' != separator)
+				{
+					return GL_FALSE;
+				}
+			}
+		}
+		default:
+			value.myType = Number;
+			return ParseNumber(cursor, value.myNumber);
+	}
+}
+
+/// <summary>
+/// Parses the string at the cursor and decodes its escape sequences.
+/// </summary>
+/// <param name="cursor">The cursor pointing to the opening quote, which is moved behind the closing quote.</param>
+/// <param name="value">The decoded string.</param>
+/// <returns>True if the string could be parsed, false if not.</returns>
+GLboolean PBRViewerJsonValue::ParseString( Cursor& cursor, std::string& value )
+{
+	const auto parseHexDigits = [&cursor]( std::uint32_t& codePoint ) -> GLboolean
+	{
+		codePoint = 0u;
+		for (GLuint i = 0; i < 4u; i++)
+		{
+			if (cursor.Position == cursor.End)
+			{
+				return GL_FALSE;
+			}
+
+			const char digit = *cursor.Position++;
+			codePoint <<= 4u;
+			if (digit >= '0' && digit <= '9')
+			{
+				codePoint |= static_cast<std::uint32_t>(digit - '0');
+			}
+			else if (digit >= 'a' && digit <= 'f')
+			{
+				codePoint |= static_cast<std::uint32_t>(digit - 'a' + 10);
+			}
+			else if (digit >= 'A' && digit <= 'F')
+			{
+				codePoint |= static_cast<std::uint32_t>(digit - 'A' + 10);
+			}
+			else
+			{
+				return GL_FALSE;
+			}
+		}
+
+		return GL_TRUE;
+	};
+
+	// Skip the opening quote.
+	cursor.Position++;
+
+	while (cursor.Position != cursor.End)
+	{
+		const char character = *cursor.Position++;
+		if ('"' == character)
+		{
+			return GL_TRUE;
+		}
+
+		if ('\\' != character)
+		{
+			value.push_back(character);
+			continue;
+		}
+
+		if (cursor.Position == cursor.End)
+		{
+			return GL_FALSE;
+		}
+
+		switch (*cursor.Position++)
+		{
+			case '"': value.push_back('"');
+				break;
+			case '\\': value.push_back('\\');
+				break;
+			case '/': value.push_back('/');
+				break;
+			case 'b': value.push_back('\b');
+				break;
+			case 'f': value.push_back('\f');
+				break;
+			case 'n': value.push_back('\n');
+				break;
+			case 'r': value.push_back('\r');
+				break;
+			case 't': value.push_back('\t');
+				break;
+			case 'u':
+			{
+				std::uint32_t codePoint;
+				if (GL_FALSE == parseHexDigits(codePoint))
+				{
+					return GL_FALSE;
+				}
+
+				// Characters outside of the basic multilingual plane are escaped as surrogate pair.
+				if (codePoint >= 0xD800u && codePoint <= 0xDBFFu)
+				{
+					std::uint32_t lowSurrogate;
+					if (cursor.End - cursor.Position < 2 || '\\' != cursor.Position[0] || 'u' != cursor.Position[1])
+					{
+						return GL_FALSE;
+					}
+
+					cursor.Position += 2;
+					if (GL_FALSE == parseHexDigits(lowSurrogate) || lowSurrogate < 0xDC00u || lowSurrogate > 0xDFFFu)
+					{
+						return GL_FALSE;
+					}
+
+					codePoint = 0x10000u + ((codePoint - 0xD800u) << 10u) + (lowSurrogate - 0xDC00u);
+				}
+
+				// Encode the code point as UTF-8.
+				if (codePoint < 0x80u)
+				{
+					value.push_back(static_cast<char>(codePoint));
+				}
+				else if (codePoint < 0x800u)
+				{
+					value.push_back(static_cast<char>(0xC0u | codePoint >> 6u));
+					value.push_back(static_cast<char>(0x80u | (codePoint & 0x3Fu)));
+				}
+				else if (codePoint < 0x10000u)
+				{
+					value.push_back(static_cast<char>(0xE0u | codePoint >> 12u));
+					value.push_back(static_cast<char>(0x80u | (codePoint >> 6u & 0x3Fu)));
+					value.push_back(static_cast<char>(0x80u | (codePoint & 0x3Fu)));
+				}
+				else
+				{
+					value.push_back(static_cast<char>(0xF0u | codePoint >> 18u));
+					value.push_back(static_cast<char>(0x80u | (codePoint >> 12u & 0x3Fu)));
+					value.push_back(static_cast<char>(0x80u | (codePoint >> 6u & 0x3Fu)));
+					value.push_back(static_cast<char>(0x80u | (codePoint & 0x3Fu)));
+				}
+				break;
+			}
+			default:
+				return GL_FALSE;
+		}
+	}
+
+	// The document ended within the string.
+	return GL_FALSE;
+}
+
+/// <summary>
+/// Parses the number at the cursor.
+/// </summary>
+/// <param name="cursor">The cursor, which is moved behind the number.</param>
+/// <param name="value">The parsed number.</param>
+/// <returns>True if the number could be parsed, false if not.</returns>
+GLboolean PBRViewerJsonValue::ParseNumber( Cursor& cursor, GLdouble& value )
+{
+	// The number is converted by hand, since strtod depends on the locale of the process.
+	const auto isDigit = [&cursor]() -> GLboolean
+	{
+		return cursor.Position != cursor.End && *cursor.Position >= '0' && *cursor.Position <= '9';
+	};
+
+	const GLboolean isNegative = cursor.Position != cursor.End && '-' == *cursor.Position;
+	if (isNegative)
+	{
+		cursor.Position++;
+	}
+
+	if (GL_FALSE == isDigit())
+	{
+		return GL_FALSE;
+	}
+
+	// The first 19 significant digits fit into the mantissa, further digits only shift the exponent.
+	std::uint64_t mantissa = 0u;
+	GLuint numberOfDigits = 0u;
+	GLint exponent = 0;
+
+	while (isDigit())
+	{
+		if (numberOfDigits < 19u)
+		{
+			mantissa = 10u * mantissa + static_cast<std::uint64_t>(*cursor.Position - '0');
+			numberOfDigits += 0u == mantissa ? 0u : 1u;
+		}
+		else
+		{
+			exponent++;
+		}
+		cursor.Position++;
+	}
+
+	if (cursor.Position != cursor.End && '.' == *cursor.Position)
+	{
+		cursor.Position++;
+		if (GL_FALSE == isDigit())
+		{
+			return GL_FALSE;
+		}
+
+		while (isDigit())
+		{
+			if (numberOfDigits < 19u)
+			{
+				mantissa = 10u * mantissa + static_cast<std::uint64_t>(*cursor.Position - '0');
+				numberOfDigits += 0u == mantissa ? 0u : 1u;
+				exponent--;
+			}
+			cursor.Position++;
+		}
+	}
+
+	if (cursor.Position != cursor.End && ('e' == *cursor.Position || 'E' == *cursor.Position))
+	{
+		cursor.Position++;
+
+		GLboolean isExponentNegative = GL_FALSE;
+		if (cursor.Position != cursor.End && ('+' == *cursor.Position || '-' == *cursor.Position))
+		{
+			isExponentNegative = '-' == *cursor.Position;
+			cursor.Position++;
+		}
+
+		if (GL_FALSE == isDigit())
+		{
+			return GL_FALSE;
+		}
+
+		GLint explicitExponent = 0;
+		while (isDigit())
+		{
+			// Larger exponents over- or underflow anyway.
+			explicitExponent = std::min(10 * explicitExponent + (*cursor.Position - '0'), 100000);
+			cursor.Position++;
+		}
+
+		exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+	}
+
+	value = static_cast<GLdouble>(mantissa) * std::pow(10.0, static_cast<GLdouble>(exponent));
+	if (isNegative)
+	{
+		value = -value;
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Moves the cursor behind any whitespace.
+/// </summary>
+/// <param name="cursor">The cursor to move.</param>
+GLvoid PBRViewerJsonValue::SkipWhitespace( Cursor& cursor )
+{
+	while (cursor.Position != cursor.End &&
+		(' ' == *cursor.Position || '\t' == *cursor.Position || '\n' == *cursor.Position || '\r' == *cursor.Position))
+	{
+		cursor.Position++;
+	}
+}
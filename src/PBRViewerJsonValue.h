@@ -0,0 +1,142 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// This class represents a parsed JSON value, e. g. the scene description of a glTF asset.
+/// Missing members and array elements are returned as null values, so nested lookups need no checks in between.
+/// </summary>
+class PBRViewerJsonValue
+{
+public:
+	/// <summary>
+	/// The types of a JSON value.
+	/// </summary>
+	enum Type
+	{
+		Null = 0,
+		Boolean = 1,
+		Number = 2,
+		String = 3,
+		Array = 4,
+		Object = 5
+	};
+
+	/// <summary>
+	/// Parses a JSON document.
+	/// </summary>
+	/// <param name="text">The UTF-8 encoded document. It does not have to be null-terminated.</param>
+	/// <param name="length">The length of the document in bytes.</param>
+	/// <param name="value">The parsed root value.</param>
+	/// <returns>True if the document could be parsed, false if it is malformed.</returns>
+	static GLboolean Parse( const char* text, size_t length, PBRViewerJsonValue& value );
+
+	/// <summary>
+	/// Gets the type of the value.
+	/// </summary>
+	/// <returns>The type of the value.</returns>
+	Type GetType() const;
+
+	/// <summary>
+	/// Gets a flag indicating if the value is null, i. e. it is missing or explicitly set to null.
+	/// </summary>
+	/// <returns>True if the value is null, false if not.</returns>
+	GLboolean IsNull() const;
+
+	/// <summary>
+	/// Gets the value as boolean.
+	/// </summary>
+	/// <param name="defaultValue">The value returned if the value is no boolean.</param>
+	/// <returns>The boolean value.</returns>
+	GLboolean GetBoolean( GLboolean defaultValue = GL_FALSE ) const;
+
+	/// <summary>
+	/// Gets the value as number.
+	/// </summary>
+	/// <param name="defaultValue">The value returned if the value is no number.</param>
+	/// <returns>The numeric value.</returns>
+	GLdouble GetNumber( GLdouble defaultValue = 0.0 ) const;
+
+	/// <summary>
+	/// Gets the value as string.
+	/// </summary>
+	/// <returns>The string value or an empty string if the value is no string.</returns>
+	std::string const& GetString() const;
+
+	/// <summary>
+	/// Gets the number of elements of an array or members of an object.
+	/// </summary>
+	/// <returns>The number of elements or zero if the value is neither an array nor an object.</returns>
+	size_t GetSize() const;
+
+	/// <summary>
+	/// Gets an element of an array.
+	/// </summary>
+	/// <param name="index">The index of the element.</param>
+	/// <returns>The element or a null value if the value is no array or the index is out of range.</returns>
+	PBRViewerJsonValue const& operator[]( size_t index ) const;
+
+	/// <summary>
+	/// Gets a member of an object.
+	/// </summary>
+	/// <param name="name">The name of the member.</param>
+	/// <returns>The member or a null value if the value is no object or has no member with the name.</returns>
+	PBRViewerJsonValue const& operator[]( std::string const& name ) const;
+
+private:
+	// Nested arrays and objects deeper than this are rejected instead of exhausting the stack.
+	static const GLuint MaxDepth = 256u;
+
+	Type myType = Null;
+	GLboolean myBoolean = GL_FALSE;
+	GLdouble myNumber = 0.0;
+	std::string myString;
+
+	// The elements of an array or the member values of an object. Objects keep the member names at the same positions.
+	std::vector<PBRViewerJsonValue> myElements;
+	std::vector<std::string> myNames;
+
+	/// <summary>
+	/// The position within the document while parsing.
+	/// </summary>
+	struct Cursor
+	{
+		const char* Position;
+		const char* End;
+	};
+
+	/// <summary>
+	/// Parses the value at the cursor.
+	/// </summary>
+	/// <param name="cursor">The cursor, which is moved behind the value.</param>
+	/// <param name="depth">The nesting depth of the value.</param>
+	/// <param name="value">The parsed value.</param>
+	/// <returns>True if the value could be parsed, false if not.</returns>
+	static GLboolean ParseValue( Cursor& cursor, GLuint depth, PBRViewerJsonValue& value );
+
+	/// <summary>
+	/// Parses the string at the cursor and decodes its escape sequences.
+	/// </summary>
+	/// <param name="cursor">The cursor pointing to the opening quote, which is moved behind the closing quote.</param>
+	/// <param name="value">The decoded string.</param>
+	/// <returns>True if the string could be parsed, false if not.</returns>
+	static GLboolean ParseString( Cursor& cursor, std::string& value );
+
+	/// <summary>
+	/// Parses the number at the cursor.
+	/// </summary>
+	/// <param name="cursor">The cursor, which is moved behind the number.</param>
+	/// <param name="value">The parsed number.</param>
+	/// <returns>True if the number could be parsed, false if not.</returns>
+	static GLboolean ParseNumber( Cursor& cursor, GLdouble& value );
+
+	/// <summary>
+	/// Moves the cursor behind any whitespace.
+	/// </summary>
+	/// <param name="cursor">The cursor to move.</param>
+	static GLvoid SkipWhitespace( Cursor& cursor );
+};
@@ -112,6 +112,15 @@ public:
 		std::cout << "---------------" << std::endl;
 	}
 
+	/// <summary>
+	/// Prints an informational message to the standard output device.
+	/// </summary>
+	/// <param name="message">The message to print.</param>
+	static GLvoid PrintInfoMessage( const std::string& message )
+	{
+		std::cout << message << std::endl;
+	}
+
 	/// <summary>
 	/// Prints a welcome message to the standard output device.
 	/// </summary>
@@ -0,0 +1,144 @@
+// Windows.h has to be included before glad, otherwise APIENTRY is redefined.
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+#include "PBRViewerMappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// Finalizes an instance of the <see cref="PBRViewerMappedFile"/> class.
+/// </summary>
+PBRViewerMappedFile::~PBRViewerMappedFile()
+{
+	Close();
+}
+
+/// <summary>
+/// Maps the specified file.
+/// </summary>
+/// <param name="filepath">The filepath of the file to map.</param>
+/// <returns>True if the file could be mapped, false if not.</returns>
+GLboolean PBRViewerMappedFile::Open( std::string const& filepath )
+{
+	Close();
+
+#ifdef _WIN32
+	myFileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (INVALID_HANDLE_VALUE == myFileHandle)
+	{
+		myFileHandle = nullptr;
+		return GL_FALSE;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (FALSE == GetFileSizeEx(myFileHandle, &fileSize) || 0 == fileSize.QuadPart)
+	{
+		Close();
+		return GL_FALSE;
+	}
+
+	myMappingHandle = CreateFileMappingA(myFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (nullptr == myMappingHandle)
+	{
+		Close();
+		return GL_FALSE;
+	}
+
+	myData = static_cast<const GLubyte*>(MapViewOfFile(myMappingHandle, FILE_MAP_READ, 0, 0, 0));
+	mySize = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	myFileDescriptor = open(filepath.c_str(), O_RDONLY);
+	if (myFileDescriptor < 0)
+	{
+		return GL_FALSE;
+	}
+
+	struct stat fileStatus;
+	if (fstat(myFileDescriptor, &fileStatus) != 0 || 0 == fileStatus.st_size)
+	{
+		Close();
+		return GL_FALSE;
+	}
+
+	GLvoid* mapping = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, myFileDescriptor, 0);
+	if (MAP_FAILED != mapping)
+	{
+		myData = static_cast<const GLubyte*>(mapping);
+		mySize = static_cast<std::size_t>(fileStatus.st_size);
+	}
+#endif
+
+	if (nullptr == myData)
+	{
+		Close();
+		return GL_FALSE;
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Unmaps the file (if any).
+/// </summary>
+GLvoid PBRViewerMappedFile::Close()
+{
+#ifdef _WIN32
+	if (myData)
+	{
+		UnmapViewOfFile(myData);
+	}
+
+	if (myMappingHandle)
+	{
+		CloseHandle(myMappingHandle);
+		myMappingHandle = nullptr;
+	}
+
+	if (myFileHandle)
+	{
+		CloseHandle(myFileHandle);
+		myFileHandle = nullptr;
+	}
+#else
+	if (myData)
+	{
+		munmap(const_cast<GLubyte*>(myData), mySize);
+	}
+
+	if (myFileDescriptor >= 0)
+	{
+		close(myFileDescriptor);
+		myFileDescriptor = -1;
+	}
+#endif
+
+	myData = nullptr;
+	mySize = 0u;
+}
+
+/// <summary>
+/// Gets the mapped content of the file.
+/// </summary>
+/// <returns>The pointer to the first byte of the file or nullptr if no file is mapped.</returns>
+const GLubyte* PBRViewerMappedFile::GetData() const
+{
+	return myData;
+}
+
+/// <summary>
+/// Gets the size of the mapped file in bytes.
+/// </summary>
+/// <returns>The size of the file.</returns>
+std::size_t PBRViewerMappedFile::GetSize() const
+{
+	return mySize;
+}
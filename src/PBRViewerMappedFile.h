@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+
+/// <summary>
+/// This class maps a file read-only into the address space of the process.
+/// The content can be accessed directly without copying it into an intermediate buffer.
+/// </summary>
+class PBRViewerMappedFile
+{
+public:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerMappedFile"/> class.
+	/// </summary>
+	PBRViewerMappedFile() = default;
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="PBRViewerMappedFile"/> class.
+	/// </summary>
+	~PBRViewerMappedFile();
+
+	PBRViewerMappedFile( PBRViewerMappedFile const& ) = delete;
+	PBRViewerMappedFile& operator=( PBRViewerMappedFile const& ) = delete;
+
+	/// <summary>
+	/// Maps the specified file.
+	/// </summary>
+	/// <param name="filepath">The filepath of the file to map.</param>
+	/// <returns>True if the file could be mapped, false if not.</returns>
+	GLboolean Open( std::string const& filepath );
+
+	/// <summary>
+	/// Unmaps the file (if any).
+	/// </summary>
+	GLvoid Close();
+
+	/// <summary>
+	/// Gets the mapped content of the file.
+	/// </summary>
+	/// <returns>The pointer to the first byte of the file or nullptr if no file is mapped.</returns>
+	const GLubyte* GetData() const;
+
+	/// <summary>
+	/// Gets the size of the mapped file in bytes.
+	/// </summary>
+	/// <returns>The size of the file.</returns>
+	std::size_t GetSize() const;
+
+private:
+	const GLubyte* myData = nullptr;
+	std::size_t mySize = 0u;
+
+#ifdef _WIN32
+	GLvoid* myFileHandle = nullptr;
+	GLvoid* myMappingHandle = nullptr;
+#else
+	GLint myFileDescriptor = -1;
+#endif
+};
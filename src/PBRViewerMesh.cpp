@@ -1,20 +1,414 @@
 #include "PBRViewerMesh.h"
 
+#include "PBRViewerGeometryBuffer.h"
+#include "PBRViewerStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Meshes up to this number of vertices can address all of them with 16 bit indices.
+static const GLuint MaxVerticesForShortIndices = 65536u;
+
+/// <summary>
+/// Gets the size of a component of a vertex attribute.
+/// </summary>
+/// <param name="type">The component type.</param>
+/// <returns>The size in bytes.</returns>
+static GLsizei GetComponentSize( const GLenum type )
+{
+	switch (type)
+	{
+	case GL_BYTE:
+	case GL_UNSIGNED_BYTE:
+		return 1;
+	case GL_SHORT:
+	case GL_UNSIGNED_SHORT:
+	case GL_HALF_FLOAT:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
 /// <summary>
 /// Initializes a new instance of the <see cref="PBRViewerMesh"/> class.
+/// The vertices and indices are moved into the mesh and kept until <see cref="ReleaseGeometry"/> is called.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="indices">The indices of the mesh.</param>
+/// <param name="textures">The textures of the mesh.</param>
+PBRViewerMesh::PBRViewerMesh( std::vector<Vertex>&& vertices,
+                              std::vector<GLuint>&& indices,
+                              std::vector<PBRViewerTexture>&& textures )
+	: myVertices(std::move(vertices)), myIndices(std::move(indices)), myTextures(std::move(textures))
+{
+	resolveTextureBindings();
+	setupMesh(myVertices.data(), static_cast<GLuint>(myVertices.size()), myIndices.data(), static_cast<GLuint>(myIndices.size()));
+}
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerMesh"/> class without keeping a CPU-side copy of the geometry.
+/// The vertices and indices are handed to OpenGL directly, e. g. from a memory-mapped mesh cache file.
 /// </summary>
 /// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="numberOfVertices">The number of vertices.</param>
 /// <param name="indices">The indices of the mesh.</param>
+/// <param name="numberOfIndices">The number of indices.</param>
 /// <param name="textures">The textures of the mesh.</param>
-PBRViewerMesh::PBRViewerMesh( const std::vector<Vertex>& vertices,
-                              const std::vector<GLuint>& indices,
-                              const std::vector<PBRViewerTexture>& textures )
+PBRViewerMesh::PBRViewerMesh( const Vertex* vertices,
+                              const GLuint numberOfVertices,
+                              const GLuint* indices,
+                              const GLuint numberOfIndices,
+                              std::vector<PBRViewerTexture>&& textures )
+	: myTextures(std::move(textures))
+{
+	resolveTextureBindings();
+	setupMesh(vertices, numberOfVertices, indices, numberOfIndices);
+}
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerMesh"/> class with compact vertices.
+/// The vertex shader dequantizes the positions with the offset and scale of the mesh.
+/// </summary>
+/// <param name="vertices">The compact vertices of the mesh.</param>
+/// <param name="numberOfVertices">The number of vertices.</param>
+/// <param name="positionOffset">The offset of the quantized positions.</param>
+/// <param name="positionScale">The scale of the quantized positions.</param>
+/// <param name="indices">The indices of the mesh.</param>
+/// <param name="numberOfIndices">The number of indices.</param>
+/// <param name="textures">The textures of the mesh.</param>
+PBRViewerMesh::PBRViewerMesh( const CompactVertex* vertices,
+                              const GLuint numberOfVertices,
+                              const glm::vec3 positionOffset,
+                              const glm::vec3 positionScale,
+                              const GLuint* indices,
+                              const GLuint numberOfIndices,
+                              std::vector<PBRViewerTexture>&& textures )
+	: myTextures(std::move(textures)),
+	  myVertexFormat(PBRViewerEnumerations::Quantized),
+	  myPositionOffset(positionOffset),
+	  myPositionScale(positionScale)
+{
+	resolveTextureBindings();
+	setupMesh(vertices, numberOfVertices, indices, numberOfIndices);
+}
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerMesh"/> class with vertex attributes in the stream format.
+/// Each attribute is uploaded as it is, keeping its component type and stride, e. g. straight from a mapped glTF buffer.
+/// </summary>
+/// <param name="streams">The vertex attributes indexed by <see cref="PBRViewerEnumerations::VertexStreamLocation"/>.</param>
+/// <param name="numberOfVertices">The number of vertices.</param>
+/// <param name="indices">The indices of the mesh.</param>
+/// <param name="indexType">The type of the indices, either GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.</param>
+/// <param name="numberOfIndices">The number of indices.</param>
+/// <param name="boundingBoxMin">The minimum corner of the axis-aligned bounding box.</param>
+/// <param name="boundingBoxMax">The maximum corner of the axis-aligned bounding box.</param>
+/// <param name="textures">The textures of the mesh.</param>
+PBRViewerMesh::PBRViewerMesh( const VertexStream* streams,
+                              const GLuint numberOfVertices,
+                              const GLvoid* indices,
+                              const GLenum indexType,
+                              const GLuint numberOfIndices,
+                              const glm::vec3 boundingBoxMin,
+                              const glm::vec3 boundingBoxMax,
+                              std::vector<PBRViewerTexture>&& textures )
+	: myTextures(std::move(textures)),
+	  myNumberOfVertices(numberOfVertices),
+	  myNumberOfIndices(numberOfIndices),
+	  myVertexFormat(PBRViewerEnumerations::Streams),
+	  myBoundingBoxMin(boundingBoxMin),
+	  myBoundingBoxMax(boundingBoxMax),
+	  myBoundingSphereCenter(0.5f * (boundingBoxMin + boundingBoxMax)),
+	  myBoundingSphereRadius(0.5f * glm::length(boundingBoxMax - boundingBoxMin))
+{
+	resolveTextureBindings();
+	setupStreams(streams, indices, indexType);
+}
+
+/// <summary>
+/// Frees the CPU-side copy of the vertices and indices. The mesh can still be drawn since the data lives in the GPU buffers.
+/// </summary>
+/// <returns>The number of released bytes.</returns>
+size_t PBRViewerMesh::ReleaseGeometry()
+{
+	const size_t releasedBytes = sizeof(Vertex) * myVertices.capacity() + sizeof(GLuint) * myIndices.capacity();
+
+	// Swapping with an empty vector is the only way to actually free the memory of a vector.
+	std::vector<Vertex>().swap(myVertices);
+	std::vector<GLuint>().swap(myIndices);
+
+	return releasedBytes;
+}
+
+/// <summary>
+/// Sets the meshlets the index buffer is split into. Without meshlets the mesh is always drawn as a whole.
+/// </summary>
+/// <param name="meshlets">The meshlets of the mesh.</param>
+/// <param name="numberOfMeshlets">The number of meshlets.</param>
+GLvoid PBRViewerMesh::SetMeshlets( const Meshlet* meshlets, const GLuint numberOfMeshlets )
+{
+	myMeshlets.assign(meshlets, meshlets + numberOfMeshlets);
+	myMeshletVisibility.assign(numberOfMeshlets, GL_TRUE);
+
+	myVisibleIndexCounts.reserve(numberOfMeshlets);
+	myVisibleIndexOffsets.reserve(numberOfMeshlets);
+
+	myVisibleFirstIndices.reserve(numberOfMeshlets);
+}
+
+/// <summary>
+/// Gets the number of meshlets of the mesh.
+/// </summary>
+/// <returns>The number of meshlets.</returns>
+GLuint PBRViewerMesh::GetNumberOfMeshlets() const
+{
+	return static_cast<GLuint>(myMeshlets.size());
+}
+
+/// <summary>
+/// Tests a range of meshlets against the view frustum and their normal cones against the camera position.
+/// The method does not issue any OpenGL calls, so disjoint ranges can be culled on several threads at once.
+/// </summary>
+/// <param name="frustumPlanes">The six normalized frustum planes in model space.</param>
+/// <param name="cameraPosition">The camera position in model space.</param>
+/// <param name="firstMeshlet">The first meshlet to test.</param>
+/// <param name="lastMeshlet">The meshlet behind the last one to test.</param>
+/// <returns>The number of culled triangles.</returns>
+GLuint PBRViewerMesh::CullMeshlets( const glm::vec4* frustumPlanes, const glm::vec3 cameraPosition, const GLuint firstMeshlet, const GLuint lastMeshlet )
+{
+	GLuint numberOfCulledTriangles = 0u;
+
+	for (GLuint i = firstMeshlet; i < lastMeshlet; i++)
+	{
+		const Meshlet& meshlet = myMeshlets[i];
+		GLboolean isVisible = GL_TRUE;
+
+		// Frustum: the bounding sphere lies completely behind one of the planes.
+		for (GLuint plane = 0; plane < 6u && isVisible; plane++)
+		{
+			isVisible = glm::dot(glm::vec3(frustumPlanes[plane]), meshlet.Center) + frustumPlanes[plane].w >= -meshlet.Radius;
+		}
+
+		// Back faces: every point of the bounding sphere sees all triangles of the cone from behind.
+		if (isVisible)
+		{
+			const glm::vec3 viewDirection = meshlet.Center - cameraPosition;
+			isVisible = glm::dot(viewDirection, meshlet.ConeAxis) < meshlet.ConeCutoff * glm::length(viewDirection) + meshlet.Radius;
+		}
+
+		myMeshletVisibility[i] = isVisible;
+		if (GL_FALSE == isVisible)
+		{
+			numberOfCulledTriangles += meshlet.NumberOfIndices / 3u;
+		}
+	}
+
+	return numberOfCulledTriangles;
+}
+
+/// <summary>
+/// Tests the bounding sphere and the bounding box of the mesh against the view frustum.
+/// Culled meshes are skipped by <see cref="Draw"/> and <see cref="AppendDrawCommands"/> until the next test.
+/// </summary>
+/// <param name="frustumPlanes">The six normalized frustum planes in model space.</param>
+/// <returns>True if the mesh may be visible, false if it lies completely outside of the frustum.</returns>
+GLboolean PBRViewerMesh::CullBounds( const glm::vec4* frustumPlanes )
+{
+	myIsVisible = GL_TRUE;
+
+	for (GLuint plane = 0; plane < 6u && myIsVisible; plane++)
+	{
+		const glm::vec3 normal = glm::vec3(frustumPlanes[plane]);
+
+		// The sphere is the cheaper test, the box is tighter for long and flat meshes.
+		// The corner of the box furthest along the plane normal decides if the whole box lies behind the plane.
+		const glm::vec3 furthestCorner = glm::mix(myBoundingBoxMin, myBoundingBoxMax, glm::greaterThan(normal, glm::vec3(0.0f)));
+		myIsVisible = glm::dot(normal, myBoundingSphereCenter) + frustumPlanes[plane].w >= -myBoundingSphereRadius &&
+			glm::dot(normal, furthestCorner) + frustumPlanes[plane].w >= 0.0f;
+	}
+
+	return myIsVisible;
+}
+
+/// <summary>
+/// Gets a flag indicating if the mesh passed the last <see cref="CullBounds"/> call.
+/// </summary>
+/// <returns>True if the mesh may be visible, false if it has been culled.</returns>
+GLboolean PBRViewerMesh::IsVisible() const
+{
+	return myIsVisible;
+}
+
+/// <summary>
+/// Sets the levels of detail of the mesh. Without levels of detail the whole index buffer is drawn.
+/// </summary>
+/// <param name="lods">The levels of detail starting with the full detail level.</param>
+/// <param name="numberOfLods">The number of levels of detail.</param>
+GLvoid PBRViewerMesh::SetLods( const MeshLod* lods, const GLuint numberOfLods )
+{
+	myLods.assign(lods, lods + numberOfLods);
+	myCurrentLod = 0u;
+}
+
+/// <summary>
+/// Selects the coarsest level of detail whose error projected onto the screen stays below the given number of pixels.
+/// The distance is measured to the bounding sphere of the mesh, so the full detail level is used if the camera is inside of it.
+/// </summary>
+/// <param name="cameraPosition">The camera position in model space.</param>
+/// <param name="pixelsPerUnit">The number of pixels a model unit covers at a distance of one unit.</param>
+/// <param name="maximumPixelError">The largest acceptable error in pixels.</param>
+/// <returns>The selected level of detail.</returns>
+GLuint PBRViewerMesh::SelectLod( const glm::vec3 cameraPosition, const GLfloat pixelsPerUnit, const GLfloat maximumPixelError )
+{
+	myCurrentLod = 0u;
+
+	const GLfloat distance = glm::length(cameraPosition - myBoundingSphereCenter) - myBoundingSphereRadius;
+	if (false == (distance > 0.0f))
+	{
+		return myCurrentLod;
+	}
+
+	// The levels are ordered by increasing error, so the first level above the threshold ends the search.
+	const GLfloat maximumError = maximumPixelError * distance / pixelsPerUnit;
+	for (GLuint i = 1u; i < myLods.size() && myLods[i].Error <= maximumError; i++)
+	{
+		myCurrentLod = i;
+	}
+
+	return myCurrentLod;
+}
+
+/// <summary>
+/// Gets the level of detail selected by the last <see cref="SelectLod"/> call.
+/// </summary>
+/// <returns>The selected level of detail, 0 is the full detail level.</returns>
+GLuint PBRViewerMesh::GetCurrentLod() const
+{
+	return myCurrentLod;
+}
+
+/// <summary>
+/// Gets the number of vertices of the mesh.
+/// </summary>
+/// <returns>The number of vertices.</returns>
+GLuint PBRViewerMesh::GetNumberOfVertices() const
+{
+	return myNumberOfVertices;
+}
+
+/// <summary>
+/// Gets the number of indices of the mesh.
+/// </summary>
+/// <returns>The number of indices.</returns>
+GLuint PBRViewerMesh::GetNumberOfIndices() const
+{
+	return myNumberOfIndices;
+}
+
+/// <summary>
+/// Gets the number of triangles of the selected level of detail.
+/// </summary>
+/// <returns>The number of triangles.</returns>
+GLuint PBRViewerMesh::GetNumberOfTriangles() const
+{
+	return (myLods.empty() ? myNumberOfIndices : myLods[myCurrentLod].NumberOfIndices) / 3u;
+}
+
+/// <summary>
+/// Gets the format of the vertices in the vertex buffer.
+/// </summary>
+/// <returns>The vertex format.</returns>
+PBRViewerEnumerations::VertexFormat PBRViewerMesh::GetVertexFormat() const
+{
+	return myVertexFormat;
+}
+
+/// <summary>
+/// Gets the size of a vertex in the vertex buffer. In the stream format it is the sum of the sizes of all attributes.
+/// </summary>
+/// <returns>The size of a vertex in bytes.</returns>
+GLuint PBRViewerMesh::GetVertexSize() const
+{
+	return myVertexSize;
+}
+
+/// <summary>
+/// Gets the type of the indices in the index buffer.
+/// </summary>
+/// <returns>GL_UNSIGNED_SHORT if the mesh has at most 65536 vertices, otherwise GL_UNSIGNED_INT.</returns>
+GLenum PBRViewerMesh::GetIndexType() const
 {
-	myVertices = vertices;
-	myIndices = indices;
-	myTextures = textures;	
-	
-	setupMesh();
+	return myIndexType;
+}
+
+/// <summary>
+/// Gets the vertex array the mesh is drawn with. Meshes with full precision or quantized vertices share the vertex array of their format.
+/// </summary>
+/// <returns>The identifier of the vertex array.</returns>
+GLuint PBRViewerMesh::GetVertexArray() const
+{
+	if (PBRViewerEnumerations::Streams == myVertexFormat)
+	{
+		return myVAO;
+	}
+
+	return PBRViewerGeometryBuffer::GetInstance(myVertexFormat).GetVertexArray();
+}
+
+/// <summary>
+/// Gets the type of the indices a mesh with the given number of vertices uploads.
+/// </summary>
+/// <param name="numberOfVertices">The number of vertices.</param>
+/// <returns>GL_UNSIGNED_SHORT if the mesh has at most 65536 vertices, otherwise GL_UNSIGNED_INT.</returns>
+GLenum PBRViewerMesh::GetIndexTypeForVertices( const GLuint numberOfVertices )
+{
+	return numberOfVertices <= MaxVerticesForShortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+/// <summary>
+/// Gets the minimum corner of the axis-aligned bounding box in model space.
+/// </summary>
+/// <returns>The minimum corner of the bounding box.</returns>
+glm::vec3 PBRViewerMesh::GetBoundingBoxMin() const
+{
+	return myBoundingBoxMin;
+}
+
+/// <summary>
+/// Gets the maximum corner of the axis-aligned bounding box in model space.
+/// </summary>
+/// <returns>The maximum corner of the bounding box.</returns>
+glm::vec3 PBRViewerMesh::GetBoundingBoxMax() const
+{
+	return myBoundingBoxMax;
+}
+
+/// <summary>
+/// Gets the center of the bounding sphere in model space.
+/// </summary>
+/// <returns>The center of the bounding sphere.</returns>
+glm::vec3 PBRViewerMesh::GetBoundingSphereCenter() const
+{
+	return myBoundingSphereCenter;
+}
+
+/// <summary>
+/// Gets the radius of the bounding sphere in model units.
+/// </summary>
+/// <returns>The radius of the bounding sphere.</returns>
+GLfloat PBRViewerMesh::GetBoundingSphereRadius() const
+{
+	return myBoundingSphereRadius;
+}
+
+/// <summary>
+/// Gets the material textures of the mesh.
+/// </summary>
+/// <returns>The textures of the mesh.</returns>
+std::vector<PBRViewerTexture> const& PBRViewerMesh::GetTextures() const
+{
+	return myTextures;
 }
 
 /// <summary>
@@ -22,174 +416,316 @@ PBRViewerMesh::PBRViewerMesh( const std::vector<Vertex>& vertices,
 /// </summary>
 GLvoid PBRViewerMesh::Cleanup() const
 {
+	if (PBRViewerEnumerations::Streams != myVertexFormat)
+	{
+		PBRViewerGeometryBuffer::GetInstance(myVertexFormat).Free(myBaseVertex, myNumberOfVertices, myIndexOffset, getIndexBufferSize(), myBaseInstance);
+		return;
+	}
+
 	glDeleteVertexArrays(1, &myVAO);
 	glDeleteBuffers(1, &myVBO);
 	glDeleteBuffers(1, &myEBO);
 }
 
 /// <summary>
-/// Adds a texture to the mesh.
+/// Checks if the mesh can be drawn by the same indirect draw call as another mesh.
+/// This requires the same shared vertex array, the same index type and the same textures bound to the material slots.
 /// </summary>
-/// <param name="textureToAdd">The texture to add.</param>	
-GLvoid PBRViewerMesh::AddTexture( PBRViewerTexture const& textureToAdd )
+/// <param name="other">The other mesh.</param>
+/// <returns>True if both meshes can be drawn together, false if not.</returns>
+GLboolean PBRViewerMesh::CanBatchWith( PBRViewerMesh const& other ) const
 {
-	// Do not add duplicate textures.
-	if (std::find(myTextures.begin(), myTextures.end(), textureToAdd) != myTextures.end())
+	if (PBRViewerEnumerations::Streams == myVertexFormat || myVertexFormat != other.myVertexFormat || myIndexType != other.myIndexType)
 	{
-		return;
+		return GL_FALSE;
 	}
 
-	myTextures.push_back(textureToAdd);
+	return std::equal(std::begin(myTextureBindings), std::end(myTextureBindings), std::begin(other.myTextureBindings));
 }
 
 /// <summary>
-/// Removes a texture from the mesh.
+/// Appends the draw commands of the index ranges to draw. Only meshes in the shared geometry buffers can be drawn indirectly.
 /// </summary>
-/// <param name="textureToRemove">The texture to remove.</param>	
-GLvoid PBRViewerMesh::RemoveTexture( PBRViewerTexture const& textureToRemove )
+/// <param name="commands">The commands to append to.</param>
+/// <param name="useCulling">True to draw only the meshlets which passed the last <see cref="CullMeshlets"/> call.
+/// The meshlets belong to the full detail level, so coarser levels are always drawn as a whole.</param>
+GLvoid PBRViewerMesh::AppendDrawCommands( std::vector<DrawElementsIndirectCommand>& commands, const GLboolean useCulling )
 {
-	const auto it = std::find(myTextures.begin(), myTextures.end(), textureToRemove);
-	if (it != myTextures.end())
+	collectDrawRanges(useCulling);
+
+	// The shared index buffer is aligned to four bytes, so the offset of the mesh is a whole number of indices of either type.
+	const GLuint firstIndexOfMesh = static_cast<GLuint>(myIndexOffset / getIndexSize());
+	for (size_t i = 0; i < myVisibleIndexCounts.size(); i++)
 	{
-		myTextures.erase(it);
+		DrawElementsIndirectCommand command;
+		command.Count = static_cast<GLuint>(myVisibleIndexCounts[i]);
+		command.InstanceCount = 1u;
+		command.FirstIndex = firstIndexOfMesh + myVisibleFirstIndices[i];
+		command.BaseVertex = myBaseVertex;
+		command.BaseInstance = myBaseInstance;
+		commands.push_back(command);
 	}
 }
 
 /// <summary>
-/// Draws the mesh with the specified shader.
+/// Binds the textures of the mesh to the material slots and sets the uniforms describing its textures and its vertex format.
+/// The textures shared by all meshes, like the shadow maps, are bound once per pass by the caller.
 /// </summary>
-/// <param name="shader">The shader to draw.</param>	
-GLvoid PBRViewerMesh::Draw( std::shared_ptr<PBRViewerShader> const& shader )
+/// <param name="shader">The shader to draw with.</param>
+GLvoid PBRViewerMesh::BindTextures( std::shared_ptr<PBRViewerShader> const& shader ) const
 {
-	// Materials
-	GLuint diffuseNr = 0u;
-	GLuint normalNr = 0u;
-	GLuint roughnessNr = 0u;
-	GLuint emissiveNr = 0u;
+	// The sampler of each material slot reads from the texture unit with the number of the slot.
+	for (GLuint slot = 0u; slot < NumberOfMaterialSlots; ++slot)
+	{
+		const GLuint texture = myTextureBindings[slot];
+		if (0u != texture)
+		{
+			PBRViewerStateCache::BindTexture(slot, GL_TEXTURE_2D, texture);
+		}
 
-	// Image Based Lighting
-	GLuint irradianceNr = 0u;
-	GLuint preFilteredEnvironmentNr = 0u;
-	GLuint brdfLookupNr = 0u;
+		shader->SetTextureAvailable(static_cast<PBRViewerEnumerations::TextureSlot>(slot), 0u != texture);
+	}
 
-	// Shadows
-	GLuint shadowNr = 0u;
+	shader->SetVertexFormat(myVertexFormat);
+}
 
-	for (GLuint i = 0u; i < myTextures.size(); ++i)
+/// <summary>
+/// Draws the mesh with the specified shader. The vertex array returned by <see cref="GetVertexArray"/> has to be bound.
+/// </summary>
+/// <param name="shader">The shader to draw.</param>	
+/// <param name="useCulling">True to draw only the meshlets which passed the last <see cref="CullMeshlets"/> call.
+/// The meshlets belong to the full detail level, so coarser levels are always drawn as a whole.</param>	
+GLvoid PBRViewerMesh::Draw( std::shared_ptr<PBRViewerShader> const& shader, const GLboolean useCulling )
+{
+	collectDrawRanges(useCulling);
+	if (myVisibleIndexCounts.empty())
 	{
-		glActiveTexture(GL_TEXTURE0 + i);
+		return;
+	}
 
-		std::string variableName;
-		std::string name = myTextures[i].Type;
+	BindTextures(shader);
 
-		if (name == "textureDiffuse")
-		{
-			glBindTexture(GL_TEXTURE_2D, myTextures[i].ID);
-			variableName = name.append("[").append(std::to_string(diffuseNr++)).append("]");
-			shader->setBool("textureDiffuseAvailable", GL_TRUE);
-		}
-		else if (name == "textureNormal")
+	// Draw mesh
+	if (PBRViewerEnumerations::Streams == myVertexFormat)
+	{
+		// The own vertex array has no parameter attributes, so their constant values apply to all vertices.
+		glVertexAttrib3fv(PBRViewerEnumerations::PositionOffsetParameter, &myPositionOffset[0]);
+		glVertexAttrib3fv(PBRViewerEnumerations::PositionScaleParameter, &myPositionScale[0]);
+
+		myVisibleIndexOffsets.clear();
+		for (const GLuint firstIndex : myVisibleFirstIndices)
 		{
-			glBindTexture(GL_TEXTURE_2D, myTextures[i].ID);
-			variableName = name.append("[").append(std::to_string(normalNr++)).append("]");
-			shader->setBool("textureNormalAvailable", GL_TRUE);
+			myVisibleIndexOffsets.push_back(reinterpret_cast<const GLvoid*>(static_cast<size_t>(firstIndex) * getIndexSize()));
 		}
-		else if (name == "textureRoughness")
+
+		glMultiDrawElements(GL_TRIANGLES, myVisibleIndexCounts.data(), myIndexType, myVisibleIndexOffsets.data(),
+		                    static_cast<GLsizei>(myVisibleIndexCounts.size()));
+	}
+	else
+	{
+		// The base instance selects the parameters of the mesh within the shared geometry buffer.
+		for (size_t i = 0; i < myVisibleIndexCounts.size(); i++)
 		{
-			glBindTexture(GL_TEXTURE_2D, myTextures[i].ID);
-			variableName = name.append("[").append(std::to_string(roughnessNr++)).append("]");
-			shader->setBool("textureRoughnessAvailable", GL_TRUE);
+			const size_t offset = myIndexOffset + static_cast<size_t>(myVisibleFirstIndices[i]) * getIndexSize();
+			glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, myVisibleIndexCounts[i], myIndexType, reinterpret_cast<const GLvoid*>(offset),
+			                                              1, myBaseVertex, myBaseInstance);
 		}
-		else if (name == "textureEmissive")
+	}
+}
+
+/// <summary>
+/// Resolves the texture bound to each material slot. If a material has several textures of the same slot, the first one is used.
+/// </summary>
+GLvoid PBRViewerMesh::resolveTextureBindings()
+{
+	std::fill(std::begin(myTextureBindings), std::end(myTextureBindings), 0u);
+	for (auto texture = myTextures.rbegin(); texture != myTextures.rend(); ++texture)
+	{
+		if (texture->Slot < NumberOfMaterialSlots)
 		{
-			glBindTexture(GL_TEXTURE_2D, myTextures[i].ID);
-			variableName = name.append("[").append(std::to_string(emissiveNr++)).append("]");
-			shader->setBool("textureEmissiveAvailable", GL_TRUE);
+			myTextureBindings[texture->Slot] = texture->ID;
 		}
-		else if (name == "textureIrradiance")
+	}
+}
+
+GLvoid PBRViewerMesh::setupMesh( const GLvoid* vertices, const GLuint numberOfVertices, const GLuint* indices, const GLuint numberOfIndices )
+{
+	myNumberOfVertices = numberOfVertices;
+	myNumberOfIndices = numberOfIndices;
+
+	// Keep the bounds, so they are still available after the CPU-side geometry has been released.
+	// The quantization range of compact vertices is the bounding box of the mesh.
+	const Vertex* fullPrecisionVertices = static_cast<const Vertex*>(vertices);
+	if (PBRViewerEnumerations::Quantized == myVertexFormat)
+	{
+		myBoundingBoxMin = myPositionOffset;
+		myBoundingBoxMax = myPositionOffset + myPositionScale;
+	}
+	else if (numberOfVertices > 0u)
+	{
+		myBoundingBoxMin = fullPrecisionVertices[0].Position;
+		myBoundingBoxMax = fullPrecisionVertices[0].Position;
+		for (GLuint i = 1; i < numberOfVertices; i++)
 		{
-			// The irradiance map is a cubemap texture and not a plain 2D one.
-			glBindTexture(GL_TEXTURE_CUBE_MAP, myTextures[i].ID);
-			variableName = name.append("[").append(std::to_string(irradianceNr++)).append("]");
-			shader->setBool("textureIrradianceAvailable", GL_TRUE);
+			myBoundingBoxMin = glm::min(myBoundingBoxMin, fullPrecisionVertices[i].Position);
+			myBoundingBoxMax = glm::max(myBoundingBoxMax, fullPrecisionVertices[i].Position);
 		}
-		else if (name == "texturePreFilterEnvironment")
+	}
+
+	// The sphere around the center of the box. With the vertices at hand its radius is usually tighter than half of the diagonal.
+	myBoundingSphereCenter = 0.5f * (myBoundingBoxMin + myBoundingBoxMax);
+	myBoundingSphereRadius = 0.5f * glm::length(myBoundingBoxMax - myBoundingBoxMin);
+	if (PBRViewerEnumerations::Quantized != myVertexFormat && numberOfVertices > 0u)
+	{
+		GLfloat squaredRadius = 0.0f;
+		for (GLuint i = 0; i < numberOfVertices; i++)
 		{
-			// The prefiltered environment map is a cubemap texture and not a plain 2D one.
-			glBindTexture(GL_TEXTURE_CUBE_MAP, myTextures[i].ID);
-			variableName = name.append("[").append(std::to_string(preFilteredEnvironmentNr++)).append("]");
-			shader->setBool("texturePrefilteredEnvironmentAvailable", GL_TRUE);
+			const glm::vec3 offset = fullPrecisionVertices[i].Position - myBoundingSphereCenter;
+			squaredRadius = std::max(squaredRadius, glm::dot(offset, offset));
 		}
-		else if (name == "textureBRDFLookup")
+
+		myBoundingSphereRadius = std::sqrt(squaredRadius);
+	}
+
+	myVertexSize = static_cast<GLuint>(PBRViewerEnumerations::Quantized == myVertexFormat ? sizeof(CompactVertex) : sizeof(Vertex));
+
+	// The ranges of the shared buffers are drawn with the vertex array of the format, so there is no vertex array per mesh.
+	std::vector<GLushort> shortIndices;
+	const GLvoid* uploadedIndices = narrowIndices(indices, GL_UNSIGNED_INT, shortIndices);
+	PBRViewerGeometryBuffer::GetInstance(myVertexFormat).Allocate(vertices, numberOfVertices, uploadedIndices, getIndexBufferSize(),
+	                                                              myPositionOffset, myPositionScale, myBaseVertex, myIndexOffset, myBaseInstance);
+}
+
+GLvoid PBRViewerMesh::setupStreams( const VertexStream* streams, const GLvoid* indices, const GLenum indexType )
+{
+	// Each attribute gets its own range of the vertex buffer. The ranges start at multiples of four bytes, as OpenGL requires for the offsets.
+	GLsizeiptr offsets[PBRViewerEnumerations::NumberOfVertexStreams] = {};
+	GLsizeiptr sizes[PBRViewerEnumerations::NumberOfVertexStreams] = {};
+	GLsizeiptr bufferSize = 0;
+	myVertexSize = 0u;
+
+	for (GLuint location = 0; location < PBRViewerEnumerations::NumberOfVertexStreams; location++)
+	{
+		const VertexStream& stream = streams[location];
+		if (nullptr == stream.Data || 0u == myNumberOfVertices)
 		{
-			glBindTexture(GL_TEXTURE_2D, myTextures[i].ID);
-			variableName = name.append("[").append(std::to_string(brdfLookupNr++)).append("]");
-			shader->setBool("textureBRDFLookupAvailable", GL_TRUE);
+			continue;
 		}
-		else if (name == "textureShadows")
+
+		// The last element ends behind its own components, the padding of an interleaved stride may lie outside of the buffer.
+		const GLsizei elementSize = stream.Size * GetComponentSize(stream.Type);
+		offsets[location] = bufferSize;
+		sizes[location] = static_cast<GLsizeiptr>(stream.Stride) * (myNumberOfVertices - 1u) + elementSize;
+		bufferSize += (sizes[location] + 3) / 4 * 4;
+		myVertexSize += static_cast<GLuint>(elementSize);
+	}
+
+	glGenVertexArrays(1, &myVAO);
+	glGenBuffers(1, &myVBO);
+	glGenBuffers(1, &myEBO);
+
+	PBRViewerStateCache::BindVertexArray(myVAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, myVBO);
+	glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STATIC_DRAW);
+
+	for (GLuint location = 0; location < PBRViewerEnumerations::NumberOfVertexStreams; location++)
+	{
+		const VertexStream& stream = streams[location];
+		if (0 == sizes[location])
 		{
-			glBindTexture(GL_TEXTURE_2D, myTextures[i].ID);
-			variableName = name.append("[").append(std::to_string(shadowNr++)).append("]");
-			shader->setBool("textureShadowsAvailable", GL_TRUE);
+			continue;
 		}
 
-		shader->setInt(variableName, i);
+		glBufferSubData(GL_ARRAY_BUFFER, offsets[location], sizes[location], stream.Data);
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, stream.Size, stream.Type, stream.IsNormalized, stream.Stride,
+		                      reinterpret_cast<GLvoid*>(static_cast<size_t>(offsets[location])));
 	}
 
-	// Draw mesh
-	glBindVertexArray(myVAO);
-	glDrawElements(GL_TRIANGLES, static_cast<GLint>(myIndices.size()), GL_UNSIGNED_INT, nullptr);
-	glBindVertexArray(0);
+	// The bitangent stays disabled, the vertex shader rebuilds it from the normal and the handedness in the w component of the tangent.
+	std::vector<GLushort> shortIndices;
+	const GLvoid* uploadedIndices = narrowIndices(indices, indexType, shortIndices);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(getIndexBufferSize()), uploadedIndices, GL_STATIC_DRAW);
 
 	// Reset states
-	glActiveTexture(GL_TEXTURE0);
-	shader->setBool("textureDiffuseAvailable", GL_FALSE);
-	shader->setBool("textureNormalAvailable", GL_FALSE);
-	shader->setBool("textureRoughnessAvailable", GL_FALSE);
-	shader->setBool("textureEmissiveAvailable", GL_FALSE);
+	PBRViewerStateCache::BindVertexArray(0);
+}
 
-	shader->setBool("textureIrradianceAvailable", GL_FALSE);
-	shader->setBool("textureBRDFLookupAvailable", GL_FALSE);
-	shader->setBool("texturePrefilteredEnvironmentAvailable", GL_FALSE);
+const GLvoid* PBRViewerMesh::narrowIndices( const GLvoid* indices, const GLenum indexType, std::vector<GLushort>& shortIndices )
+{
+	// Small meshes use 16 bit indices, which halves the index memory and the index fetch bandwidth.
+	// The CPU-side copy keeps the 32 bit indices, only the buffer is narrowed.
+	myIndexType = GL_UNSIGNED_SHORT == indexType ? GL_UNSIGNED_SHORT : GetIndexTypeForVertices(myNumberOfVertices);
+	if (indexType == myIndexType)
+	{
+		return indices;
+	}
 
-	shader->setBool("textureShadowsAvailable", GL_FALSE);
+	const GLuint* longIndices = static_cast<const GLuint*>(indices);
+	shortIndices.resize(myNumberOfIndices);
+	for (GLuint i = 0; i < myNumberOfIndices; i++)
+	{
+		shortIndices[i] = static_cast<GLushort>(longIndices[i]);
+	}
+
+	return shortIndices.data();
 }
 
-GLvoid PBRViewerMesh::setupMesh()
+size_t PBRViewerMesh::getIndexSize() const
 {
-	glGenVertexArrays(1, &myVAO);
-	glGenBuffers(1, &myVBO);
-	glGenBuffers(1, &myEBO);
-
-	glBindVertexArray(myVAO);
+	return GL_UNSIGNED_SHORT == myIndexType ? sizeof(GLushort) : sizeof(GLuint);
+}
 
-	// Load data into vertex buffers
-	glBindBuffer(GL_ARRAY_BUFFER, myVBO);	
-	glBufferData(GL_ARRAY_BUFFER, sizeof myVertices[0] * myVertices.size(), myVertices.data(), GL_STATIC_DRAW);
+size_t PBRViewerMesh::getIndexBufferSize() const
+{
+	return getIndexSize() * myNumberOfIndices;
+}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof myIndices[0] * myIndices.size(), myIndices.data(), GL_STATIC_DRAW);
+GLvoid PBRViewerMesh::collectDrawRanges( const GLboolean useCulling )
+{
+	myVisibleIndexCounts.clear();
+	myVisibleFirstIndices.clear();
 
-	// Vertex Positions
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), static_cast<GLvoid*>(nullptr));
+	if (GL_FALSE == myIsVisible)
+	{
+		return;
+	}
 
-	// Vertex normals
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<GLvoid*>(offsetof(Vertex, Normal)));
+	if (GL_FALSE == useCulling || myMeshlets.empty() || 0u != myCurrentLod)
+	{
+		// The index buffer holds all levels of detail one after another.
+		const GLuint numberOfIndices = myLods.empty() ? myNumberOfIndices : myLods[myCurrentLod].NumberOfIndices;
+		if (numberOfIndices > 0u)
+		{
+			myVisibleIndexCounts.push_back(static_cast<GLsizei>(numberOfIndices));
+			myVisibleFirstIndices.push_back(myLods.empty() ? 0u : myLods[myCurrentLod].FirstIndex);
+		}
 
-	// Vertex texture coords
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<GLvoid*>(offsetof(Vertex, TexCoords)));
+		return;
+	}
 
-	// Tangent
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<GLvoid*>(offsetof(Vertex, Tangent)));
+	// Neighbouring visible meshlets are consecutive in the index buffer and merged into a single range.
+	GLboolean isPreviousVisible = GL_FALSE;
+	for (size_t i = 0; i < myMeshlets.size(); i++)
+	{
+		if (GL_FALSE == myMeshletVisibility[i])
+		{
+			isPreviousVisible = GL_FALSE;
+			continue;
+		}
 
-	// Bitangent
-	glEnableVertexAttribArray(4);
-	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<GLvoid*>(offsetof(Vertex, Bitangent)));
+		if (isPreviousVisible)
+		{
+			myVisibleIndexCounts.back() += static_cast<GLsizei>(myMeshlets[i].NumberOfIndices);
+		}
+		else
+		{
+			myVisibleIndexCounts.push_back(static_cast<GLsizei>(myMeshlets[i].NumberOfIndices));
+			myVisibleFirstIndices.push_back(myMeshlets[i].FirstIndex);
+		}
 
-	// Reset states
-	glBindVertexArray(0);
+		isPreviousVisible = GL_TRUE;
+	}
 }
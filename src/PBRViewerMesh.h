@@ -2,6 +2,10 @@
 
 #include <glad/glad.h>
 
+#include "PBRViewerDrawCommand.h"
+#include "PBRViewerEnumerations.h"
+#include "PBRViewerMeshLod.h"
+#include "PBRViewerMeshlet.h"
 #include "PBRViewerShader.h"
 #include "PBRViewerTexture.h"
 #include "PBRViewerVertex.h"
@@ -18,13 +22,220 @@ class PBRViewerMesh
 public:
 	/// <summary>
 	/// Initializes a new instance of the <see cref="PBRViewerMesh"/> class.
+	/// The vertices and indices are moved into the mesh and kept until <see cref="ReleaseGeometry"/> is called.
 	/// </summary>
 	/// <param name="vertices">The vertices of the mesh.</param>
 	/// <param name="indices">The indices of the mesh.</param>
 	/// <param name="textures">The textures of the mesh.</param>
-	PBRViewerMesh(const std::vector<Vertex>& vertices,
-	               const std::vector<GLuint>& indices,
-	               const std::vector<PBRViewerTexture>& textures );
+	PBRViewerMesh( std::vector<Vertex>&& vertices,
+	               std::vector<GLuint>&& indices,
+	               std::vector<PBRViewerTexture>&& textures );
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerMesh"/> class without keeping a CPU-side copy of the geometry.
+	/// The vertices and indices are handed to OpenGL directly, e. g. from a memory-mapped mesh cache file.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="numberOfVertices">The number of vertices.</param>
+	/// <param name="indices">The indices of the mesh.</param>
+	/// <param name="numberOfIndices">The number of indices.</param>
+	/// <param name="textures">The textures of the mesh.</param>
+	PBRViewerMesh( const Vertex* vertices,
+	               GLuint numberOfVertices,
+	               const GLuint* indices,
+	               GLuint numberOfIndices,
+	               std::vector<PBRViewerTexture>&& textures );
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerMesh"/> class with compact vertices.
+	/// The vertex shader dequantizes the positions with the offset and scale of the mesh.
+	/// </summary>
+	/// <param name="vertices">The compact vertices of the mesh.</param>
+	/// <param name="numberOfVertices">The number of vertices.</param>
+	/// <param name="positionOffset">The offset of the quantized positions.</param>
+	/// <param name="positionScale">The scale of the quantized positions.</param>
+	/// <param name="indices">The indices of the mesh.</param>
+	/// <param name="numberOfIndices">The number of indices.</param>
+	/// <param name="textures">The textures of the mesh.</param>
+	PBRViewerMesh( const CompactVertex* vertices,
+	               GLuint numberOfVertices,
+	               glm::vec3 positionOffset,
+	               glm::vec3 positionScale,
+	               const GLuint* indices,
+	               GLuint numberOfIndices,
+	               std::vector<PBRViewerTexture>&& textures );
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerMesh"/> class with vertex attributes in the stream format.
+	/// Each attribute is uploaded as it is, keeping its component type and stride, e. g. straight from a mapped glTF buffer.
+	/// </summary>
+	/// <param name="streams">The vertex attributes indexed by <see cref="PBRViewerEnumerations::VertexStreamLocation"/>.</param>
+	/// <param name="numberOfVertices">The number of vertices.</param>
+	/// <param name="indices">The indices of the mesh.</param>
+	/// <param name="indexType">The type of the indices, either GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.</param>
+	/// <param name="numberOfIndices">The number of indices.</param>
+	/// <param name="boundingBoxMin">The minimum corner of the axis-aligned bounding box.</param>
+	/// <param name="boundingBoxMax">The maximum corner of the axis-aligned bounding box.</param>
+	/// <param name="textures">The textures of the mesh.</param>
+	PBRViewerMesh( const VertexStream* streams,
+	               GLuint numberOfVertices,
+	               const GLvoid* indices,
+	               GLenum indexType,
+	               GLuint numberOfIndices,
+	               glm::vec3 boundingBoxMin,
+	               glm::vec3 boundingBoxMax,
+	               std::vector<PBRViewerTexture>&& textures );
+
+	PBRViewerMesh( PBRViewerMesh const& ) = delete;
+	PBRViewerMesh& operator=( PBRViewerMesh const& ) = delete;
+	PBRViewerMesh( PBRViewerMesh&& ) = default;
+	PBRViewerMesh& operator=( PBRViewerMesh&& ) = default;
+
+	/// <summary>
+	/// Frees the CPU-side copy of the vertices and indices. The mesh can still be drawn since the data lives in the GPU buffers.
+	/// </summary>
+	/// <returns>The number of released bytes.</returns>
+	size_t ReleaseGeometry();
+
+	/// <summary>
+	/// Sets the meshlets the index buffer is split into. Without meshlets the mesh is always drawn as a whole.
+	/// </summary>
+	/// <param name="meshlets">The meshlets of the mesh.</param>
+	/// <param name="numberOfMeshlets">The number of meshlets.</param>
+	GLvoid SetMeshlets( const Meshlet* meshlets, GLuint numberOfMeshlets );
+
+	/// <summary>
+	/// Gets the number of meshlets of the mesh.
+	/// </summary>
+	/// <returns>The number of meshlets.</returns>
+	GLuint GetNumberOfMeshlets() const;
+
+	/// <summary>
+	/// Tests a range of meshlets against the view frustum and their normal cones against the camera position.
+	/// The method does not issue any OpenGL calls, so disjoint ranges can be culled on several threads at once.
+	/// </summary>
+	/// <param name="frustumPlanes">The six normalized frustum planes in model space.</param>
+	/// <param name="cameraPosition">The camera position in model space.</param>
+	/// <param name="firstMeshlet">The first meshlet to test.</param>
+	/// <param name="lastMeshlet">The meshlet behind the last one to test.</param>
+	/// <returns>The number of culled triangles.</returns>
+	GLuint CullMeshlets( const glm::vec4* frustumPlanes, glm::vec3 cameraPosition, GLuint firstMeshlet, GLuint lastMeshlet );
+
+	/// <summary>
+	/// Tests the bounding sphere and the bounding box of the mesh against the view frustum.
+	/// Culled meshes are skipped by <see cref="Draw"/> and <see cref="AppendDrawCommands"/> until the next test.
+	/// </summary>
+	/// <param name="frustumPlanes">The six normalized frustum planes in model space.</param>
+	/// <returns>True if the mesh may be visible, false if it lies completely outside of the frustum.</returns>
+	GLboolean CullBounds( const glm::vec4* frustumPlanes );
+
+	/// <summary>
+	/// Gets a flag indicating if the mesh passed the last <see cref="CullBounds"/> call.
+	/// </summary>
+	/// <returns>True if the mesh may be visible, false if it has been culled.</returns>
+	GLboolean IsVisible() const;
+
+	/// <summary>
+	/// Sets the levels of detail of the mesh. Without levels of detail the whole index buffer is drawn.
+	/// </summary>
+	/// <param name="lods">The levels of detail starting with the full detail level.</param>
+	/// <param name="numberOfLods">The number of levels of detail.</param>
+	GLvoid SetLods( const MeshLod* lods, GLuint numberOfLods );
+
+	/// <summary>
+	/// Selects the coarsest level of detail whose error projected onto the screen stays below the given number of pixels.
+	/// The distance is measured to the bounding sphere of the mesh, so the full detail level is used if the camera is inside of it.
+	/// </summary>
+	/// <param name="cameraPosition">The camera position in model space.</param>
+	/// <param name="pixelsPerUnit">The number of pixels a model unit covers at a distance of one unit.</param>
+	/// <param name="maximumPixelError">The largest acceptable error in pixels.</param>
+	/// <returns>The selected level of detail.</returns>
+	GLuint SelectLod( glm::vec3 cameraPosition, GLfloat pixelsPerUnit, GLfloat maximumPixelError );
+
+	/// <summary>
+	/// Gets the level of detail selected by the last <see cref="SelectLod"/> call.
+	/// </summary>
+	/// <returns>The selected level of detail, 0 is the full detail level.</returns>
+	GLuint GetCurrentLod() const;
+
+	/// <summary>
+	/// Gets the number of vertices of the mesh.
+	/// </summary>
+	/// <returns>The number of vertices.</returns>
+	GLuint GetNumberOfVertices() const;
+
+	/// <summary>
+	/// Gets the number of indices of the mesh.
+	/// </summary>
+	/// <returns>The number of indices.</returns>
+	GLuint GetNumberOfIndices() const;
+
+	/// <summary>
+	/// Gets the number of triangles of the selected level of detail.
+	/// </summary>
+	/// <returns>The number of triangles.</returns>
+	GLuint GetNumberOfTriangles() const;
+
+	/// <summary>
+	/// Gets the format of the vertices in the vertex buffer.
+	/// </summary>
+	/// <returns>The vertex format.</returns>
+	PBRViewerEnumerations::VertexFormat GetVertexFormat() const;
+
+	/// <summary>
+	/// Gets the size of a vertex in the vertex buffer. In the stream format it is the sum of the sizes of all attributes.
+	/// </summary>
+	/// <returns>The size of a vertex in bytes.</returns>
+	GLuint GetVertexSize() const;
+
+	/// <summary>
+	/// Gets the type of the indices in the index buffer.
+	/// </summary>
+	/// <returns>GL_UNSIGNED_SHORT if the mesh has at most 65536 vertices, otherwise GL_UNSIGNED_INT.</returns>
+	GLenum GetIndexType() const;
+
+	/// <summary>
+	/// Gets the vertex array the mesh is drawn with. Meshes with full precision or quantized vertices share the vertex array of their format.
+	/// </summary>
+	/// <returns>The identifier of the vertex array.</returns>
+	GLuint GetVertexArray() const;
+
+	/// <summary>
+	/// Gets the type of the indices a mesh with the given number of vertices uploads.
+	/// </summary>
+	/// <param name="numberOfVertices">The number of vertices.</param>
+	/// <returns>GL_UNSIGNED_SHORT if the mesh has at most 65536 vertices, otherwise GL_UNSIGNED_INT.</returns>
+	static GLenum GetIndexTypeForVertices( GLuint numberOfVertices );
+
+	/// <summary>
+	/// Gets the minimum corner of the axis-aligned bounding box in model space.
+	/// </summary>
+	/// <returns>The minimum corner of the bounding box.</returns>
+	glm::vec3 GetBoundingBoxMin() const;
+
+	/// <summary>
+	/// Gets the maximum corner of the axis-aligned bounding box in model space.
+	/// </summary>
+	/// <returns>The maximum corner of the bounding box.</returns>
+	glm::vec3 GetBoundingBoxMax() const;
+
+	/// <summary>
+	/// Gets the center of the bounding sphere in model space.
+	/// </summary>
+	/// <returns>The center of the bounding sphere.</returns>
+	glm::vec3 GetBoundingSphereCenter() const;
+
+	/// <summary>
+	/// Gets the radius of the bounding sphere in model units.
+	/// </summary>
+	/// <returns>The radius of the bounding sphere.</returns>
+	GLfloat GetBoundingSphereRadius() const;
+
+	/// <summary>
+	/// Gets the material textures of the mesh.
+	/// </summary>
+	/// <returns>The textures of the mesh.</returns>
+	std::vector<PBRViewerTexture> const& GetTextures() const;
 
 	/// <summary>
 	/// Disposes internal instances and frees memory.
@@ -32,31 +243,85 @@ public:
 	GLvoid Cleanup() const;
 
 	/// <summary>
-	/// Adds a texture to the mesh.
+	/// Checks if the mesh can be drawn by the same indirect draw call as another mesh.
+	/// This requires the same shared vertex array, the same index type and the same textures bound to the material slots.
+	/// </summary>
+	/// <param name="other">The other mesh.</param>
+	/// <returns>True if both meshes can be drawn together, false if not.</returns>
+	GLboolean CanBatchWith( PBRViewerMesh const& other ) const;
+
+	/// <summary>
+	/// Appends the draw commands of the index ranges to draw. Only meshes in the shared geometry buffers can be drawn indirectly.
 	/// </summary>
-	/// <param name="textureToAdd">The texture to add.</param>	
-	GLvoid AddTexture(PBRViewerTexture const& textureToAdd);
+	/// <param name="commands">The commands to append to.</param>
+	/// <param name="useCulling">True to draw only the meshlets which passed the last <see cref="CullMeshlets"/> call.
+	/// The meshlets belong to the full detail level, so coarser levels are always drawn as a whole.</param>
+	GLvoid AppendDrawCommands( std::vector<DrawElementsIndirectCommand>& commands, GLboolean useCulling );
 
 	/// <summary>
-	/// Removes a texture from the mesh.
+	/// Binds the textures of the mesh to the material slots and sets the uniforms describing its textures and its vertex format.
+	/// The textures shared by all meshes, like the shadow maps, are bound once per pass by the caller.
 	/// </summary>
-	/// <param name="textureToRemove">The texture to remove.</param>	
-	GLvoid RemoveTexture( PBRViewerTexture const& textureToRemove );
+	/// <param name="shader">The shader to draw with.</param>
+	GLvoid BindTextures( std::shared_ptr<PBRViewerShader> const& shader ) const;
 
 	/// <summary>
-	/// Draws the mesh with the specified shader.
+	/// Draws the mesh with the specified shader. The vertex array returned by <see cref="GetVertexArray"/> has to be bound.
 	/// </summary>
 	/// <param name="shader">The shader to draw.</param>	
-	GLvoid Draw(std::shared_ptr<PBRViewerShader> const& shader);
+	/// <param name="useCulling">True to draw only the meshlets which passed the last <see cref="CullMeshlets"/> call.
+	/// The meshlets belong to the full detail level, so coarser levels are always drawn as a whole.</param>	
+	GLvoid Draw( std::shared_ptr<PBRViewerShader> const& shader, GLboolean useCulling = GL_FALSE );
 
 private:
+	// The material slots come first among the texture slots.
+	static const GLuint NumberOfMaterialSlots = PBRViewerEnumerations::TextureEmissive + 1u;
+
 	std::vector<Vertex> myVertices;
 	std::vector<GLuint> myIndices;
 	std::vector<PBRViewerTexture> myTextures;
 
+	// The texture bound to each material slot, resolved once the textures are known. Zero if the slot is empty.
+	GLuint myTextureBindings[NumberOfMaterialSlots];
+
+	std::vector<Meshlet> myMeshlets;
+	std::vector<GLboolean> myMeshletVisibility;
+	std::vector<GLsizei> myVisibleIndexCounts;
+	std::vector<GLuint> myVisibleFirstIndices;
+	std::vector<const GLvoid*> myVisibleIndexOffsets;
+
+	std::vector<MeshLod> myLods;
+	GLuint myCurrentLod = 0u;
+
 	GLuint myVAO = 0u;
 	GLuint myVBO = 0u;
 	GLuint myEBO = 0u;
+	GLuint myNumberOfVertices = 0u;
+	GLuint myNumberOfIndices = 0u;
+	GLenum myIndexType = GL_UNSIGNED_INT;
+	GLuint myVertexSize = 0u;
+
+	// Meshes with full precision or quantized vertices occupy ranges of the shared geometry buffer of their format.
+	// Meshes in the stream format own their buffers, since the layout of their attributes differs from mesh to mesh.
+	GLint myBaseVertex = 0;
+	size_t myIndexOffset = 0u;
+	GLuint myBaseInstance = 0u;
+
+	PBRViewerEnumerations::VertexFormat myVertexFormat = PBRViewerEnumerations::FullPrecision;
+	glm::vec3 myPositionOffset = glm::vec3(0.0f);
+	glm::vec3 myPositionScale = glm::vec3(1.0f);
+
+	glm::vec3 myBoundingBoxMin = glm::vec3(0.0f);
+	glm::vec3 myBoundingBoxMax = glm::vec3(0.0f);
+	glm::vec3 myBoundingSphereCenter = glm::vec3(0.0f);
+	GLfloat myBoundingSphereRadius = 0.0f;
+	GLboolean myIsVisible = GL_TRUE;
 
-	GLvoid setupMesh();
+	GLvoid resolveTextureBindings();
+	GLvoid setupMesh( const GLvoid* vertices, GLuint numberOfVertices, const GLuint* indices, GLuint numberOfIndices );
+	GLvoid setupStreams( const VertexStream* streams, const GLvoid* indices, GLenum indexType );
+	const GLvoid* narrowIndices( const GLvoid* indices, GLenum indexType, std::vector<GLushort>& shortIndices );
+	size_t getIndexSize() const;
+	size_t getIndexBufferSize() const;
+	GLvoid collectDrawRanges( GLboolean useCulling );
 };
@@ -0,0 +1,456 @@
+#include "PBRViewerMeshCache.h"
+
+#include "PBRViewerLogger.h"
+#include "PBRViewerMappedFile.h"
+
+#include <cstring>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iomanip>
+
+/// <summary>
+/// The fixed-size header at the beginning of each cache file.
+/// The header is followed by one <see cref="PBRViewerMeshCacheMeshRecord"/> per mesh, the vertex, index and meshlet data of all meshes
+/// and finally the metadata section holding the source path, the textures and the texture references of the meshes.
+/// </summary>
+struct PBRViewerMeshCacheHeader
+{
+	char Magic[8];
+	std::uint32_t Version;
+	std::uint32_t PostProcessFlags;
+	std::int64_t SourceModificationTime;
+	std::uint64_t SourceFileSize;
+	std::uint32_t NumberOfMeshes;
+	std::uint32_t NumberOfTextures;
+	std::uint64_t MetadataOffset;
+	std::uint64_t MetadataSize;
+};
+
+/// <summary>
+/// The location and the format of the vertex, index, meshlet and level of detail data of a single mesh within the cache file.
+/// </summary>
+struct PBRViewerMeshCacheMeshRecord
+{
+	std::uint64_t VertexOffset;
+	std::uint64_t IndexOffset;
+	std::uint64_t MeshletOffset;
+	std::uint64_t LodOffset;
+	std::uint32_t NumberOfVertices;
+	std::uint32_t NumberOfIndices;
+	std::uint32_t NumberOfMeshlets;
+	std::uint32_t NumberOfLods;
+	std::uint32_t VertexFormat;
+	GLfloat PositionOffset[3];
+	GLfloat PositionScale[3];
+};
+
+/// <summary>
+/// Gets the size of a single vertex in the given format.
+/// </summary>
+static std::uint64_t GetVertexSize( const std::uint32_t vertexFormat )
+{
+	return static_cast<std::uint32_t>(PBRViewerEnumerations::Quantized) == vertexFormat ? sizeof(CompactVertex) : sizeof(Vertex);
+}
+
+static const char MeshCacheMagic[8] = { 'P', 'B', 'R', 'V', 'M', 'S', 'H', '\0' };
+static const std::uint64_t MeshCacheAlignment = 16u;
+static const std::string MeshCacheDirectory = "MeshCache";
+
+/// <summary>
+/// Rounds the offset up to the alignment of the vertex and index data.
+/// </summary>
+static std::uint64_t AlignOffset( const std::uint64_t offset )
+{
+	return (offset + MeshCacheAlignment - 1u) / MeshCacheAlignment * MeshCacheAlignment;
+}
+
+/// <summary>
+/// Appends a length-prefixed string to the metadata section.
+/// </summary>
+static GLvoid WriteString( std::string& metadata, std::string const& value )
+{
+	const std::uint32_t length = static_cast<std::uint32_t>(value.size());
+	metadata.append(reinterpret_cast<const char*>(&length), sizeof length);
+	metadata.append(value);
+}
+
+/// <summary>
+/// Appends an unsigned integer to the metadata section.
+/// </summary>
+static GLvoid WriteUInt( std::string& metadata, const std::uint32_t value )
+{
+	metadata.append(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+/// <summary>
+/// Reads values from the metadata section with bounds checking.
+/// </summary>
+class PBRViewerMeshCacheMetadataReader
+{
+public:
+	PBRViewerMeshCacheMetadataReader( const GLubyte* data, const std::uint64_t size ) : myData(data), mySize(size)
+	{
+	}
+
+	GLboolean ReadUInt( std::uint32_t& value )
+	{
+		if (sizeof value > mySize - myPosition)
+		{
+			return GL_FALSE;
+		}
+
+		std::memcpy(&value, myData + myPosition, sizeof value);
+		myPosition += sizeof value;
+		return GL_TRUE;
+	}
+
+	GLboolean ReadString( std::string& value )
+	{
+		std::uint32_t length;
+		if (GL_FALSE == ReadUInt(length) || length > mySize - myPosition)
+		{
+			return GL_FALSE;
+		}
+
+		value.assign(reinterpret_cast<const char*>(myData + myPosition), length);
+		myPosition += length;
+		return GL_TRUE;
+	}
+
+private:
+	const GLubyte* myData;
+	std::uint64_t mySize;
+	std::uint64_t myPosition = 0u;
+};
+
+/// <summary>
+/// Reads the cached meshes of a model (if a valid cache file exists).
+/// The vertex and index ranges of the meshes point into the mapped cache file which is kept alive by the scene data.
+/// </summary>
+/// <param name="modelPath">The filepath of the model.</param>
+/// <param name="postProcessFlags">The ASSIMP post processing flags used to import the model.</param>
+/// <param name="sceneData">The scene data to fill.</param>
+/// <returns>True on a cache hit, false if the model has to be imported.</returns>
+GLboolean PBRViewerMeshCache::Read( std::string const& modelPath, const GLuint postProcessFlags, PBRViewerSceneData& sceneData )
+{
+	std::int64_t modificationTime;
+	std::uint64_t fileSize;
+	if (GL_FALSE == GetSourceKey(modelPath, modificationTime, fileSize))
+	{
+		return GL_FALSE;
+	}
+
+	auto mappedFile = std::make_shared<PBRViewerMappedFile>();
+	if (GL_FALSE == mappedFile->Open(GetCacheFilepath(modelPath)))
+	{
+		return GL_FALSE;
+	}
+
+	const GLubyte* data = mappedFile->GetData();
+	const std::uint64_t size = mappedFile->GetSize();
+
+	// Validate the key of the cache file.
+	PBRViewerMeshCacheHeader header;
+	if (size < sizeof header)
+	{
+		return GL_FALSE;
+	}
+
+	std::memcpy(&header, data, sizeof header);
+	if (0 != std::memcmp(header.Magic, MeshCacheMagic, sizeof MeshCacheMagic) ||
+		Version != header.Version ||
+		postProcessFlags != header.PostProcessFlags ||
+		modificationTime != header.SourceModificationTime ||
+		fileSize != header.SourceFileSize ||
+		header.MetadataOffset > size ||
+		header.MetadataSize > size - header.MetadataOffset ||
+		header.NumberOfMeshes > (size - sizeof header) / sizeof(PBRViewerMeshCacheMeshRecord))
+	{
+		return GL_FALSE;
+	}
+
+	PBRViewerMeshCacheMetadataReader metadata(data + header.MetadataOffset, header.MetadataSize);
+
+	// Two models with the same hash must not share a cache file.
+	std::string sourcePath;
+	if (GL_FALSE == metadata.ReadString(sourcePath) || sourcePath != modelPath)
+	{
+		return GL_FALSE;
+	}
+
+	PBRViewerSceneData cachedSceneData;
+	cachedSceneData.Textures.resize(header.NumberOfTextures);
+	for (PBRViewerTextureData& texture : cachedSceneData.Textures)
+	{
+		std::uint32_t slot;
+		if (GL_FALSE == metadata.ReadUInt(slot) || slot >= PBRViewerEnumerations::NumberOfTextureSlots ||
+			GL_FALSE == metadata.ReadString(texture.Filepath))
+		{
+			return GL_FALSE;
+		}
+
+		texture.Slot = static_cast<PBRViewerEnumerations::TextureSlot>(slot);
+	}
+
+	const PBRViewerMeshCacheMeshRecord* records = reinterpret_cast<const PBRViewerMeshCacheMeshRecord*>(data + sizeof header);
+
+	cachedSceneData.Meshes.resize(header.NumberOfMeshes);
+	for (std::uint32_t i = 0; i < header.NumberOfMeshes; i++)
+	{
+		const PBRViewerMeshCacheMeshRecord& record = records[i];
+		PBRViewerMeshData& mesh = cachedSceneData.Meshes[i];
+
+		const std::uint64_t vertexSize = static_cast<std::uint64_t>(record.NumberOfVertices) * GetVertexSize(record.VertexFormat);
+		const std::uint64_t indexSize = static_cast<std::uint64_t>(record.NumberOfIndices) * sizeof(GLuint);
+		const std::uint64_t meshletSize = static_cast<std::uint64_t>(record.NumberOfMeshlets) * sizeof(Meshlet);
+		const std::uint64_t lodSize = static_cast<std::uint64_t>(record.NumberOfLods) * sizeof(MeshLod);
+		if (record.VertexFormat > static_cast<std::uint32_t>(PBRViewerEnumerations::Quantized) ||
+			record.VertexOffset > size || vertexSize > size - record.VertexOffset ||
+			record.IndexOffset > size || indexSize > size - record.IndexOffset ||
+			record.MeshletOffset > size || meshletSize > size - record.MeshletOffset ||
+			record.LodOffset > size || lodSize > size - record.LodOffset)
+		{
+			return GL_FALSE;
+		}
+
+		// The levels of detail are drawn as index ranges, so they have to stay within the indices.
+		const MeshLod* lods = reinterpret_cast<const MeshLod*>(data + record.LodOffset);
+		for (std::uint32_t j = 0; j < record.NumberOfLods; j++)
+		{
+			if (lods[j].FirstIndex > record.NumberOfIndices || lods[j].NumberOfIndices > record.NumberOfIndices - lods[j].FirstIndex)
+			{
+				return GL_FALSE;
+			}
+		}
+
+		if (static_cast<std::uint32_t>(PBRViewerEnumerations::Quantized) == record.VertexFormat)
+		{
+			mesh.VertexFormat = PBRViewerEnumerations::Quantized;
+			mesh.MappedCompactVertices = reinterpret_cast<const CompactVertex*>(data + record.VertexOffset);
+			mesh.PositionOffset = glm::vec3(record.PositionOffset[0], record.PositionOffset[1], record.PositionOffset[2]);
+			mesh.PositionScale = glm::vec3(record.PositionScale[0], record.PositionScale[1], record.PositionScale[2]);
+		}
+		else
+		{
+			mesh.MappedVertices = reinterpret_cast<const Vertex*>(data + record.VertexOffset);
+		}
+
+		mesh.NumberOfMappedVertices = record.NumberOfVertices;
+		mesh.MappedIndices = reinterpret_cast<const GLuint*>(data + record.IndexOffset);
+		mesh.NumberOfMappedIndices = record.NumberOfIndices;
+		mesh.MappedMeshlets = reinterpret_cast<const Meshlet*>(data + record.MeshletOffset);
+		mesh.NumberOfMappedMeshlets = record.NumberOfMeshlets;
+		mesh.MappedLods = lods;
+		mesh.NumberOfMappedLods = record.NumberOfLods;
+
+		std::uint32_t numberOfTextureReferences;
+		if (GL_FALSE == metadata.ReadUInt(numberOfTextureReferences))
+		{
+			return GL_FALSE;
+		}
+
+		for (std::uint32_t j = 0; j < numberOfTextureReferences; j++)
+		{
+			PBRViewerTextureReference reference;
+			std::uint32_t slot;
+			if (GL_FALSE == metadata.ReadUInt(slot) || slot >= PBRViewerEnumerations::NumberOfTextureSlots ||
+				GL_FALSE == metadata.ReadUInt(reference.TextureIndex) ||
+				reference.TextureIndex >= header.NumberOfTextures)
+			{
+				return GL_FALSE;
+			}
+
+			reference.Slot = static_cast<PBRViewerEnumerations::TextureSlot>(slot);
+			mesh.Textures.push_back(reference);
+		}
+	}
+
+	cachedSceneData.Directory = sceneData.Directory;
+	cachedSceneData.MappedFile = mappedFile;
+	sceneData = std::move(cachedSceneData);
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Writes the converted meshes of a model into the cache.
+/// </summary>
+/// <param name="modelPath">The filepath of the model.</param>
+/// <param name="postProcessFlags">The ASSIMP post processing flags used to import the model.</param>
+/// <param name="sceneData">The imported scene data.</param>
+/// <returns>True if the cache file could be written, false if not.</returns>
+GLboolean PBRViewerMeshCache::Write( std::string const& modelPath, const GLuint postProcessFlags, PBRViewerSceneData const& sceneData )
+{
+	PBRViewerMeshCacheHeader header{};
+	std::memcpy(header.Magic, MeshCacheMagic, sizeof MeshCacheMagic);
+	header.Version = Version;
+	header.PostProcessFlags = postProcessFlags;
+	header.NumberOfMeshes = static_cast<std::uint32_t>(sceneData.Meshes.size());
+	header.NumberOfTextures = static_cast<std::uint32_t>(sceneData.Textures.size());
+
+	if (GL_FALSE == GetSourceKey(modelPath, header.SourceModificationTime, header.SourceFileSize))
+	{
+		return GL_FALSE;
+	}
+
+	// Place the vertex, index, meshlet and level of detail data of all meshes behind the mesh records.
+	std::vector<PBRViewerMeshCacheMeshRecord> records(sceneData.Meshes.size());
+	std::uint64_t offset = sizeof header + sizeof(PBRViewerMeshCacheMeshRecord) * records.size();
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const PBRViewerMeshData& mesh = sceneData.Meshes[i];
+		PBRViewerMeshCacheMeshRecord& record = records[i];
+
+		const GLboolean isQuantized = PBRViewerEnumerations::Quantized == mesh.VertexFormat;
+		record.VertexFormat = static_cast<std::uint32_t>(mesh.VertexFormat);
+		record.NumberOfVertices = static_cast<std::uint32_t>(isQuantized ? mesh.CompactVertices.size() : mesh.Vertices.size());
+		record.NumberOfIndices = static_cast<std::uint32_t>(mesh.Indices.size());
+		record.NumberOfMeshlets = static_cast<std::uint32_t>(mesh.Meshlets.size());
+		record.NumberOfLods = static_cast<std::uint32_t>(mesh.Lods.size());
+		for (GLint axis = 0; axis < 3; axis++)
+		{
+			record.PositionOffset[axis] = mesh.PositionOffset[axis];
+			record.PositionScale[axis] = mesh.PositionScale[axis];
+		}
+
+		record.VertexOffset = AlignOffset(offset);
+		offset = record.VertexOffset + GetVertexSize(record.VertexFormat) * record.NumberOfVertices;
+
+		record.IndexOffset = AlignOffset(offset);
+		offset = record.IndexOffset + sizeof(GLuint) * mesh.Indices.size();
+
+		record.MeshletOffset = AlignOffset(offset);
+		offset = record.MeshletOffset + sizeof(Meshlet) * mesh.Meshlets.size();
+
+		record.LodOffset = AlignOffset(offset);
+		offset = record.LodOffset + sizeof(MeshLod) * mesh.Lods.size();
+	}
+
+	// The metadata section holds all variable-sized data.
+	std::string metadata;
+	WriteString(metadata, modelPath);
+	for (const PBRViewerTextureData& texture : sceneData.Textures)
+	{
+		WriteUInt(metadata, static_cast<std::uint32_t>(texture.Slot));
+		WriteString(metadata, texture.Filepath);
+	}
+
+	for (const PBRViewerMeshData& mesh : sceneData.Meshes)
+	{
+		WriteUInt(metadata, static_cast<std::uint32_t>(mesh.Textures.size()));
+		for (const PBRViewerTextureReference& reference : mesh.Textures)
+		{
+			WriteUInt(metadata, static_cast<std::uint32_t>(reference.Slot));
+			WriteUInt(metadata, reference.TextureIndex);
+		}
+	}
+
+	header.MetadataOffset = offset;
+	header.MetadataSize = metadata.size();
+
+	// Write into a temporary file first, so a concurrent reader never sees a partially written cache file.
+	std::error_code errorCode;
+	std::experimental::filesystem::create_directories(MeshCacheDirectory, errorCode);
+
+	const std::string cacheFilepath = GetCacheFilepath(modelPath);
+	const std::string temporaryFilepath = cacheFilepath + ".tmp";
+
+	{
+		std::ofstream file(temporaryFilepath, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not create the mesh cache file:", temporaryFilepath);
+			return GL_FALSE;
+		}
+
+		const auto writePadding = [&file]( const std::uint64_t targetOffset )
+		{
+			static const char padding[MeshCacheAlignment] = {};
+			const std::uint64_t currentOffset = static_cast<std::uint64_t>(file.tellp());
+			file.write(padding, static_cast<std::streamsize>(targetOffset - currentOffset));
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof header);
+		file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(sizeof(PBRViewerMeshCacheMeshRecord) * records.size()));
+
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			const PBRViewerMeshData& mesh = sceneData.Meshes[i];
+
+			writePadding(records[i].VertexOffset);
+			const GLvoid* vertices = PBRViewerEnumerations::Quantized == mesh.VertexFormat ? static_cast<const GLvoid*>(mesh.CompactVertices.data())
+			                                                                               : static_cast<const GLvoid*>(mesh.Vertices.data());
+			file.write(static_cast<const char*>(vertices), static_cast<std::streamsize>(GetVertexSize(records[i].VertexFormat) * records[i].NumberOfVertices));
+
+			writePadding(records[i].IndexOffset);
+			file.write(reinterpret_cast<const char*>(mesh.Indices.data()), static_cast<std::streamsize>(sizeof(GLuint) * mesh.Indices.size()));
+
+			writePadding(records[i].MeshletOffset);
+			file.write(reinterpret_cast<const char*>(mesh.Meshlets.data()), static_cast<std::streamsize>(sizeof(Meshlet) * mesh.Meshlets.size()));
+
+			writePadding(records[i].LodOffset);
+			file.write(reinterpret_cast<const char*>(mesh.Lods.data()), static_cast<std::streamsize>(sizeof(MeshLod) * mesh.Lods.size()));
+		}
+
+		file.write(metadata.data(), static_cast<std::streamsize>(metadata.size()));
+
+		if (!file)
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not write the mesh cache file:", temporaryFilepath);
+			file.close();
+			std::experimental::filesystem::remove(temporaryFilepath, errorCode);
+			return GL_FALSE;
+		}
+	}
+
+	std::experimental::filesystem::remove(cacheFilepath, errorCode);
+	std::experimental::filesystem::rename(temporaryFilepath, cacheFilepath, errorCode);
+	if (errorCode)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not store the mesh cache file:", cacheFilepath);
+		std::experimental::filesystem::remove(temporaryFilepath, errorCode);
+		return GL_FALSE;
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Gets the filepath of the cache file belonging to a model.
+/// </summary>
+/// <param name="modelPath">The filepath of the model.</param>
+/// <returns>The filepath of the cache file.</returns>
+std::string PBRViewerMeshCache::GetCacheFilepath( std::string const& modelPath )
+{
+	std::stringstream filename;
+	filename << std::hex << std::setw(16) << std::setfill('0')
+		<< static_cast<std::uint64_t>(std::hash<std::string>()(modelPath)) << ".pbrmesh";
+	return (std::experimental::filesystem::path(MeshCacheDirectory) / filename.str()).string();
+}
+
+/// <summary>
+/// Gets the modification time and the size of the model file.
+/// </summary>
+/// <param name="modelPath">The filepath of the model.</param>
+/// <param name="modificationTime">The modification time of the model.</param>
+/// <param name="fileSize">The size of the model in bytes.</param>
+/// <returns>True if the model file exists, false if not.</returns>
+GLboolean PBRViewerMeshCache::GetSourceKey( std::string const& modelPath, std::int64_t& modificationTime, std::uint64_t& fileSize )
+{
+	std::error_code errorCode;
+
+	const auto lastWriteTime = std::experimental::filesystem::last_write_time(modelPath, errorCode);
+	if (errorCode)
+	{
+		return GL_FALSE;
+	}
+
+	fileSize = static_cast<std::uint64_t>(std::experimental::filesystem::file_size(modelPath, errorCode));
+	if (errorCode)
+	{
+		return GL_FALSE;
+	}
+
+	modificationTime = static_cast<std::int64_t>(lastWriteTime.time_since_epoch().count());
+	return GL_TRUE;
+}
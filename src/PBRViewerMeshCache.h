@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerSceneData.h"
+
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// This class stores the converted meshes of a model in a binary cache file, so that ASSIMP can be bypassed when the model is loaded again.
+/// The cache is keyed by the filepath, the modification time and the size of the model as well as the ASSIMP post processing flags.
+/// A cache hit maps the file into memory and hands the vertex and index ranges to OpenGL without any parsing or per-vertex copies.
+/// </summary>
+class PBRViewerMeshCache
+{
+public:
+	/// <summary>
+	/// Reads the cached meshes of a model (if a valid cache file exists).
+	/// The vertex and index ranges of the meshes point into the mapped cache file which is kept alive by the scene data.
+	/// </summary>
+	/// <param name="modelPath">The filepath of the model.</param>
+	/// <param name="postProcessFlags">The ASSIMP post processing flags used to import the model.</param>
+	/// <param name="sceneData">The scene data to fill.</param>
+	/// <returns>True on a cache hit, false if the model has to be imported.</returns>
+	static GLboolean Read( std::string const& modelPath, GLuint postProcessFlags, PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Writes the converted meshes of a model into the cache.
+	/// </summary>
+	/// <param name="modelPath">The filepath of the model.</param>
+	/// <param name="postProcessFlags">The ASSIMP post processing flags used to import the model.</param>
+	/// <param name="sceneData">The imported scene data.</param>
+	/// <returns>True if the cache file could be written, false if not.</returns>
+	static GLboolean Write( std::string const& modelPath, GLuint postProcessFlags, PBRViewerSceneData const& sceneData );
+
+private:
+	// Increase the version whenever the layout of the cache file or of the vertex data changes.
+	static const std::uint32_t Version = 6u;
+
+	/// <summary>
+	/// Gets the filepath of the cache file belonging to a model.
+	/// </summary>
+	/// <param name="modelPath">The filepath of the model.</param>
+	/// <returns>The filepath of the cache file.</returns>
+	static std::string GetCacheFilepath( std::string const& modelPath );
+
+	/// <summary>
+	/// Gets the modification time and the size of the model file.
+	/// </summary>
+	/// <param name="modelPath">The filepath of the model.</param>
+	/// <param name="modificationTime">The modification time of the model.</param>
+	/// <param name="fileSize">The size of the model in bytes.</param>
+	/// <returns>True if the model file exists, false if not.</returns>
+	static GLboolean GetSourceKey( std::string const& modelPath, std::int64_t& modificationTime, std::uint64_t& fileSize );
+};
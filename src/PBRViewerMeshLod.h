@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/// <summary>
+/// This struct represents a level of detail of a mesh. All levels share the vertex buffer of the mesh,
+/// the index lists of the coarser levels are appended to the index buffer behind the full detail level.
+/// </summary>
+struct MeshLod
+{
+	/// <summary>
+	/// The position of the first index of the level within the index buffer.
+	/// </summary>
+	GLuint FirstIndex;
+
+	/// <summary>
+	/// The number of indices of the level.
+	/// </summary>
+	GLuint NumberOfIndices;
+
+	/// <summary>
+	/// The geometric error of the level in model units, i. e. the largest distance the simplified surface deviates from the original one.
+	/// </summary>
+	GLfloat Error;
+};
+
+static_assert(sizeof(MeshLod) == 12, "The mesh level of detail must not contain any padding.");
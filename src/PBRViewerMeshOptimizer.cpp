@@ -0,0 +1,535 @@
+#include "PBRViewerMeshOptimizer.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// A cluster is split as soon as a part reaches this factor of the cache miss ratio of the whole cluster.
+// Smaller clusters sort better for the overdraw but restart the vertex cache more often.
+static const GLdouble ClusterSplitThreshold = 1.05;
+
+/// <summary>
+/// Gets the average cache miss ratio, i. e. the transformed vertices per triangle (0.5 is optimal for large grids, 3.0 the worst case).
+/// </summary>
+GLdouble PBRViewerMeshOptimizer::CacheStatistics::GetACMR() const
+{
+	return Triangles > 0u ? static_cast<GLdouble>(TransformedVertices) / static_cast<GLdouble>(Triangles) : 0.0;
+}
+
+/// <summary>
+/// Gets the average transformed vertex ratio, i. e. the transformed vertices per referenced vertex (1.0 is optimal).
+/// </summary>
+GLdouble PBRViewerMeshOptimizer::CacheStatistics::GetATVR() const
+{
+	return Vertices > 0u ? static_cast<GLdouble>(TransformedVertices) / static_cast<GLdouble>(Vertices) : 0.0;
+}
+
+/// <summary>
+/// Reorders the triangles and vertices of a mesh. Vertices not referenced by any triangle are removed.
+/// Meshes which do not consist of triangles only are left unchanged.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="indices">The triangle list of the mesh.</param>
+/// <param name="before">The cache efficiency of the original index buffer.</param>
+/// <param name="after">The cache efficiency of the optimized index buffer.</param>
+/// <returns>True if the mesh was optimized, false if it was left unchanged.</returns>
+GLboolean PBRViewerMeshOptimizer::Optimize( std::vector<Vertex>& vertices, std::vector<GLuint>& indices, CacheStatistics& before, CacheStatistics& after )
+{
+	const GLuint numberOfVertices = static_cast<GLuint>(vertices.size());
+
+	// Lines and points are not optimized, the same holds for broken index buffers.
+	if (indices.empty() || 0u != indices.size() % 3u ||
+		std::any_of(indices.begin(), indices.end(), [numberOfVertices]( const GLuint index ) { return index >= numberOfVertices; }))
+	{
+		before = CacheStatistics();
+		after = CacheStatistics();
+		return GL_FALSE;
+	}
+
+	before = AnalyzeVertexCache(indices, numberOfVertices);
+
+	std::vector<GLuint> clusters;
+	OptimizeVertexCache(indices, numberOfVertices, clusters);
+	SplitClusters(indices, numberOfVertices, clusters);
+	OptimizeOverdraw(indices, vertices, clusters);
+	OptimizeVertexFetch(vertices, indices);
+
+	after = AnalyzeVertexCache(indices, static_cast<GLuint>(vertices.size()));
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Splits the triangle list into meshlets of at most 64 vertices and 124 triangles, keeping the order of the triangles.
+/// Each meshlet gets a bounding sphere and a normal cone for the frustum and back-face culling.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="indices">The triangle list of the mesh.</param>
+/// <returns>The meshlets, which are empty if the mesh does not consist of triangles only.</returns>
+std::vector<Meshlet> PBRViewerMeshOptimizer::BuildMeshlets( std::vector<Vertex> const& vertices, std::vector<GLuint> const& indices )
+{
+	std::vector<Meshlet> meshlets;
+
+	const GLuint numberOfVertices = static_cast<GLuint>(vertices.size());
+	if (indices.empty() || 0u != indices.size() % 3u ||
+		std::any_of(indices.begin(), indices.end(), [numberOfVertices]( const GLuint index ) { return index >= numberOfVertices; }))
+	{
+		return meshlets;
+	}
+
+	// The triangles are already ordered for the vertex cache, so consecutive triangles share most of their vertices.
+	const GLuint unassigned = static_cast<GLuint>(-1);
+	std::vector<GLuint> meshletOfVertex(vertices.size(), unassigned);
+	std::vector<GLuint> meshletVertices;
+	meshletVertices.reserve(MaxMeshletVertices);
+
+	Meshlet meshlet = {};
+	GLuint meshletIndex = 0u;
+
+	for (GLuint i = 0; i < indices.size(); i += 3u)
+	{
+		GLuint numberOfNewVertices = 0u;
+		for (GLuint corner = 0; corner < 3u; corner++)
+		{
+			const GLuint vertex = indices[i + corner];
+			const GLboolean isDuplicate = (corner > 0u && vertex == indices[i]) || (corner > 1u && vertex == indices[i + 1u]);
+			if (meshletIndex != meshletOfVertex[vertex] && GL_FALSE == isDuplicate)
+			{
+				numberOfNewVertices++;
+			}
+		}
+
+		if (meshletVertices.size() + numberOfNewVertices > MaxMeshletVertices || meshlet.NumberOfIndices == 3u * MaxMeshletTriangles)
+		{
+			CalculateMeshletBounds(vertices, indices, meshletVertices, meshlet);
+			meshlets.push_back(meshlet);
+
+			meshlet = {};
+			meshlet.FirstIndex = i;
+			meshletIndex++;
+			meshletVertices.clear();
+		}
+
+		for (GLuint corner = 0; corner < 3u; corner++)
+		{
+			const GLuint vertex = indices[i + corner];
+			if (meshletIndex != meshletOfVertex[vertex])
+			{
+				meshletOfVertex[vertex] = meshletIndex;
+				meshletVertices.push_back(vertex);
+			}
+		}
+
+		meshlet.NumberOfIndices += 3u;
+	}
+
+	CalculateMeshletBounds(vertices, indices, meshletVertices, meshlet);
+	meshlets.push_back(meshlet);
+
+	return meshlets;
+}
+
+/// <summary>
+/// Simulates the post-transform vertex cache for an index buffer.
+/// </summary>
+/// <param name="indices">The triangle list.</param>
+/// <param name="numberOfVertices">The number of vertices the indices refer to.</param>
+/// <returns>The cache efficiency of the index buffer.</returns>
+PBRViewerMeshOptimizer::CacheStatistics PBRViewerMeshOptimizer::AnalyzeVertexCache( std::vector<GLuint> const& indices, const GLuint numberOfVertices )
+{
+	CacheStatistics statistics;
+	statistics.Triangles = static_cast<GLuint>(indices.size() / 3u);
+
+	// A vertex is cached as long as less than 'CacheSize' other vertices were transformed after it.
+	std::vector<GLuint> timestamps(numberOfVertices, 0u);
+	std::vector<GLboolean> isReferenced(numberOfVertices, GL_FALSE);
+	GLuint timestamp = CacheSize + 1u;
+
+	for (const GLuint index : indices)
+	{
+		if (timestamp - timestamps[index] > CacheSize)
+		{
+			timestamps[index] = timestamp++;
+			statistics.TransformedVertices++;
+		}
+
+		if (GL_FALSE == isReferenced[index])
+		{
+			isReferenced[index] = GL_TRUE;
+			statistics.Vertices++;
+		}
+	}
+
+	return statistics;
+}
+
+/// <summary>
+/// Orders the triangles for the post-transform vertex cache by fanning around the vertex which keeps most of its neighbours in the cache.
+/// </summary>
+/// <param name="indices">The triangle list to reorder.</param>
+/// <param name="numberOfVertices">The number of vertices the indices refer to.</param>
+/// <param name="clusters">The first triangle of each cluster. A cluster ends where the fan had to restart after a cache flush.</param>
+GLvoid PBRViewerMeshOptimizer::OptimizeVertexCache( std::vector<GLuint>& indices, const GLuint numberOfVertices, std::vector<GLuint>& clusters )
+{
+	const GLuint numberOfTriangles = static_cast<GLuint>(indices.size() / 3u);
+
+	// The triangles adjacent to each vertex, stored consecutively per vertex.
+	std::vector<GLuint> liveTriangles(numberOfVertices, 0u);
+	for (const GLuint index : indices)
+	{
+		liveTriangles[index]++;
+	}
+
+	std::vector<GLuint> adjacencyOffsets(numberOfVertices + 1u, 0u);
+	std::partial_sum(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+
+	std::vector<GLuint> adjacency(indices.size());
+	std::vector<GLuint> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (GLuint i = 0; i < indices.size(); i++)
+	{
+		adjacency[adjacencyFill[indices[i]]++] = i / 3u;
+	}
+
+	std::vector<GLuint> timestamps(numberOfVertices, 0u);
+	std::vector<GLboolean> isEmitted(numberOfTriangles, GL_FALSE);
+	std::vector<GLuint> deadEnds;
+	std::vector<GLuint> candidates;
+	std::vector<GLuint> result;
+	result.reserve(indices.size());
+
+	GLuint timestamp = CacheSize + 1u;
+	GLuint cursor = 0u;
+
+	clusters.assign(1u, 0u);
+
+	// The first vertex with any triangle starts the first fan.
+	while (cursor < numberOfVertices && 0u == liveTriangles[cursor])
+	{
+		cursor++;
+	}
+
+	GLint fanningVertex = cursor < numberOfVertices ? static_cast<GLint>(cursor) : -1;
+	while (fanningVertex >= 0)
+	{
+		// Emit all remaining triangles around the fanning vertex.
+		candidates.clear();
+		for (GLuint i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++)
+		{
+			const GLuint triangle = adjacency[i];
+			if (isEmitted[triangle])
+			{
+				continue;
+			}
+
+			for (GLuint corner = 0; corner < 3u; corner++)
+			{
+				const GLuint vertex = indices[3u * triangle + corner];
+				result.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+
+				if (timestamp - timestamps[vertex] > CacheSize)
+				{
+					timestamps[vertex] = timestamp++;
+				}
+			}
+
+			isEmitted[triangle] = GL_TRUE;
+		}
+
+		// Continue with the oldest candidate which stays in the cache while its remaining triangles are emitted.
+		fanningVertex = -1;
+		GLint bestPriority = -1;
+		for (const GLuint candidate : candidates)
+		{
+			if (0u == liveTriangles[candidate])
+			{
+				continue;
+			}
+
+			GLint priority = 0;
+			if (timestamp - timestamps[candidate] + 2u * liveTriangles[candidate] <= CacheSize)
+			{
+				priority = static_cast<GLint>(timestamp - timestamps[candidate]);
+			}
+
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				fanningVertex = static_cast<GLint>(candidate);
+			}
+		}
+
+		if (fanningVertex >= 0)
+		{
+			continue;
+		}
+
+		// Dead end: fall back to a recently used vertex with remaining triangles, otherwise to the next one in the vertex buffer.
+		while (false == deadEnds.empty() && fanningVertex < 0)
+		{
+			const GLuint vertex = deadEnds.back();
+			deadEnds.pop_back();
+
+			if (liveTriangles[vertex] > 0u)
+			{
+				fanningVertex = static_cast<GLint>(vertex);
+			}
+		}
+
+		while (fanningVertex < 0 && cursor < numberOfVertices)
+		{
+			if (liveTriangles[cursor] > 0u)
+			{
+				fanningVertex = static_cast<GLint>(cursor);
+			}
+
+			cursor++;
+		}
+
+		if (fanningVertex >= 0)
+		{
+			clusters.push_back(static_cast<GLuint>(result.size() / 3u));
+		}
+	}
+
+	indices.swap(result);
+}
+
+/// <summary>
+/// Splits the clusters further as long as each part keeps the cache efficiency close to the one of the whole cluster.
+/// </summary>
+/// <param name="indices">The triangle list ordered for the vertex cache.</param>
+/// <param name="numberOfVertices">The number of vertices the indices refer to.</param>
+/// <param name="clusters">The first triangle of each cluster.</param>
+GLvoid PBRViewerMeshOptimizer::SplitClusters( std::vector<GLuint> const& indices, const GLuint numberOfVertices, std::vector<GLuint>& clusters )
+{
+	const GLuint numberOfTriangles = static_cast<GLuint>(indices.size() / 3u);
+
+	std::vector<GLuint> timestamps(numberOfVertices, 0u);
+	GLuint timestamp = CacheSize + 1u;
+
+	// Returns the number of cache misses of a triangle.
+	auto transformTriangle = [&indices, &timestamps, &timestamp]( const GLuint triangle )
+	{
+		GLuint misses = 0u;
+		for (GLuint corner = 0; corner < 3u; corner++)
+		{
+			const GLuint vertex = indices[3u * triangle + corner];
+			if (timestamp - timestamps[vertex] > CacheSize)
+			{
+				timestamps[vertex] = timestamp++;
+				misses++;
+			}
+		}
+
+		return misses;
+	};
+
+	std::vector<GLuint> splitClusters;
+	splitClusters.reserve(clusters.size());
+
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		const GLuint start = clusters[i];
+		const GLuint end = i + 1 < clusters.size() ? clusters[i + 1] : numberOfTriangles;
+
+		// Each cluster may be drawn after any other one, so the simulation starts with an empty cache.
+		timestamp += CacheSize + 1u;
+		GLuint clusterMisses = 0u;
+		for (GLuint triangle = start; triangle < end; triangle++)
+		{
+			clusterMisses += transformTriangle(triangle);
+		}
+
+		const GLdouble threshold = ClusterSplitThreshold * static_cast<GLdouble>(clusterMisses) / static_cast<GLdouble>(end - start);
+
+		timestamp += CacheSize + 1u;
+		splitClusters.push_back(start);
+
+		GLuint partStart = start;
+		GLuint partMisses = 0u;
+		for (GLuint triangle = start; triangle < end; triangle++)
+		{
+			partMisses += transformTriangle(triangle);
+
+			if (triangle + 1u < end && static_cast<GLdouble>(partMisses) <= threshold * static_cast<GLdouble>(triangle + 1u - partStart))
+			{
+				splitClusters.push_back(triangle + 1u);
+				timestamp += CacheSize + 1u;
+				partStart = triangle + 1u;
+				partMisses = 0u;
+			}
+		}
+	}
+
+	clusters.swap(splitClusters);
+}
+
+/// <summary>
+/// Sorts the clusters so clusters facing away from the center of the mesh are drawn first.
+/// These clusters are likely to occlude the others from any view, which reduces the overdraw independently of the camera.
+/// </summary>
+/// <param name="indices">The triangle list to reorder.</param>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="clusters">The first triangle of each cluster.</param>
+GLvoid PBRViewerMeshOptimizer::OptimizeOverdraw( std::vector<GLuint>& indices, std::vector<Vertex> const& vertices, std::vector<GLuint> const& clusters )
+{
+	const GLuint numberOfTriangles = static_cast<GLuint>(indices.size() / 3u);
+
+	glm::vec3 meshCentroid(0.0f);
+	for (const GLuint index : indices)
+	{
+		meshCentroid += vertices[index].Position;
+	}
+	meshCentroid /= static_cast<GLfloat>(indices.size());
+
+	// The distance of the area-weighted cluster centroid from the mesh centroid along the average cluster normal.
+	std::vector<GLfloat> sortKeys(clusters.size(), 0.0f);
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		const GLuint start = clusters[i];
+		const GLuint end = i + 1 < clusters.size() ? clusters[i + 1] : numberOfTriangles;
+
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		GLfloat area = 0.0f;
+		for (GLuint triangle = start; triangle < end; triangle++)
+		{
+			const glm::vec3& p0 = vertices[indices[3u * triangle]].Position;
+			const glm::vec3& p1 = vertices[indices[3u * triangle + 1u]].Position;
+			const glm::vec3& p2 = vertices[indices[3u * triangle + 2u]].Position;
+
+			const glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+			const GLfloat triangleArea = glm::length(triangleNormal);
+
+			centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+			normal += triangleNormal;
+			area += triangleArea;
+		}
+
+		const GLfloat normalLength = glm::length(normal);
+		if (area > 0.0f && normalLength > 0.0f)
+		{
+			sortKeys[i] = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+		}
+	}
+
+	std::vector<GLuint> order(clusters.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&sortKeys]( const GLuint first, const GLuint second )
+	{
+		return sortKeys[first] > sortKeys[second];
+	});
+
+	std::vector<GLuint> result;
+	result.reserve(indices.size());
+	for (const GLuint cluster : order)
+	{
+		const GLuint start = clusters[cluster];
+		const GLuint end = cluster + 1u < clusters.size() ? clusters[cluster + 1u] : numberOfTriangles;
+		result.insert(result.end(), indices.begin() + 3u * start, indices.begin() + 3u * end);
+	}
+
+	indices.swap(result);
+}
+
+/// <summary>
+/// Calculates the bounding sphere and the normal cone of a meshlet.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="indices">The triangle list of the mesh.</param>
+/// <param name="meshletVertices">The vertices referenced by the meshlet.</param>
+/// <param name="meshlet">The meshlet whose index range is set.</param>
+GLvoid PBRViewerMeshOptimizer::CalculateMeshletBounds( std::vector<Vertex> const& vertices, std::vector<GLuint> const& indices,
+                                                       std::vector<GLuint> const& meshletVertices, Meshlet& meshlet )
+{
+	// The sphere around the center of the bounding box is not minimal, but tight enough for clusters this small.
+	glm::vec3 minimum = vertices[meshletVertices.front()].Position;
+	glm::vec3 maximum = minimum;
+	for (const GLuint vertex : meshletVertices)
+	{
+		minimum = glm::min(minimum, vertices[vertex].Position);
+		maximum = glm::max(maximum, vertices[vertex].Position);
+	}
+
+	meshlet.Center = 0.5f * (minimum + maximum);
+	meshlet.Radius = 0.0f;
+	for (const GLuint vertex : meshletVertices)
+	{
+		meshlet.Radius = std::max(meshlet.Radius, glm::length(vertices[vertex].Position - meshlet.Center));
+	}
+
+	// The cone axis is the average of the normalized triangle normals, the cutoff follows from the widest deviation.
+	std::vector<glm::vec3> normals;
+	normals.reserve(meshlet.NumberOfIndices / 3u);
+
+	glm::vec3 axis(0.0f);
+	for (GLuint i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.NumberOfIndices; i += 3u)
+	{
+		const glm::vec3& p0 = vertices[indices[i]].Position;
+		const glm::vec3& p1 = vertices[indices[i + 1u]].Position;
+		const glm::vec3& p2 = vertices[indices[i + 2u]].Position;
+
+		const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		const GLfloat length = glm::length(normal);
+
+		// Degenerate triangles are never rasterized, so they do not restrict the cone.
+		if (length > 0.0f)
+		{
+			normals.push_back(normal / length);
+			axis += normals.back();
+		}
+	}
+
+	meshlet.ConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.ConeCutoff = 1.0f;
+
+	const GLfloat axisLength = glm::length(axis);
+	if (false == (axisLength > 0.0f))
+	{
+		return;
+	}
+
+	meshlet.ConeAxis = axis / axisLength;
+
+	GLfloat minimumDot = 1.0f;
+	for (const glm::vec3& normal : normals)
+	{
+		minimumDot = std::min(minimumDot, glm::dot(normal, meshlet.ConeAxis));
+	}
+
+	if (minimumDot > 0.0f)
+	{
+		meshlet.ConeCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+	}
+}
+
+/// <summary>
+/// Sorts the vertices in the order they are first referenced, so the vertex fetch reads the vertex buffer linearly.
+/// </summary>
+/// <param name="vertices">The vertices to reorder.</param>
+/// <param name="indices">The triangle list, which is remapped to the new vertex order.</param>
+GLvoid PBRViewerMeshOptimizer::OptimizeVertexFetch( std::vector<Vertex>& vertices, std::vector<GLuint>& indices )
+{
+	const GLuint unassigned = static_cast<GLuint>(-1);
+	std::vector<GLuint> remap(vertices.size(), unassigned);
+
+	std::vector<Vertex> result;
+	result.reserve(vertices.size());
+
+	for (GLuint& index : indices)
+	{
+		if (unassigned == remap[index])
+		{
+			remap[index] = static_cast<GLuint>(result.size());
+			result.push_back(vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	vertices.swap(result);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerMeshlet.h"
+#include "PBRViewerVertex.h"
+
+#include <vector>
+
+/// <summary>
+/// This class reorders the index and vertex buffers of a mesh for the GPU, following the Tipsify algorithm by Sander, Nehab and Barczak.
+/// Triangles are first ordered for the post-transform vertex cache, then clustered and sorted so front-facing clusters tend to be drawn
+/// first from any view (which reduces the overdraw of the expensive fragment shaders) and finally the vertices are sorted by first use.
+/// The optimized triangle list is then split into meshlets which the renderer culls against the view.
+/// The methods do not need an OpenGL context, so the optimization runs on the import workers.
+/// </summary>
+class PBRViewerMeshOptimizer
+{
+public:
+	/// <summary>
+	/// The post-transform vertex cache efficiency of an index buffer, simulated with a FIFO cache.
+	/// </summary>
+	struct CacheStatistics
+	{
+		/// <summary>
+		/// The number of vertices the vertex shader has to transform (cache misses).
+		/// </summary>
+		GLuint TransformedVertices = 0u;
+
+		/// <summary>
+		/// The number of triangles.
+		/// </summary>
+		GLuint Triangles = 0u;
+
+		/// <summary>
+		/// The number of vertices referenced by the triangles.
+		/// </summary>
+		GLuint Vertices = 0u;
+
+		/// <summary>
+		/// Gets the average cache miss ratio, i. e. the transformed vertices per triangle (0.5 is optimal for large grids, 3.0 the worst case).
+		/// </summary>
+		GLdouble GetACMR() const;
+
+		/// <summary>
+		/// Gets the average transformed vertex ratio, i. e. the transformed vertices per referenced vertex (1.0 is optimal).
+		/// </summary>
+		GLdouble GetATVR() const;
+	};
+
+	/// <summary>
+	/// Reorders the triangles and vertices of a mesh. Vertices not referenced by any triangle are removed.
+	/// Meshes which do not consist of triangles only are left unchanged.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="indices">The triangle list of the mesh.</param>
+	/// <param name="before">The cache efficiency of the original index buffer.</param>
+	/// <param name="after">The cache efficiency of the optimized index buffer.</param>
+	/// <returns>True if the mesh was optimized, false if it was left unchanged.</returns>
+	static GLboolean Optimize( std::vector<Vertex>& vertices, std::vector<GLuint>& indices, CacheStatistics& before, CacheStatistics& after );
+
+	/// <summary>
+	/// Splits the triangle list into meshlets of at most 64 vertices and 124 triangles, keeping the order of the triangles.
+	/// Each meshlet gets a bounding sphere and a normal cone for the frustum and back-face culling.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="indices">The triangle list of the mesh.</param>
+	/// <returns>The meshlets, which are empty if the mesh does not consist of triangles only.</returns>
+	static std::vector<Meshlet> BuildMeshlets( std::vector<Vertex> const& vertices, std::vector<GLuint> const& indices );
+
+	/// <summary>
+	/// Simulates the post-transform vertex cache for an index buffer.
+	/// </summary>
+	/// <param name="indices">The triangle list.</param>
+	/// <param name="numberOfVertices">The number of vertices the indices refer to.</param>
+	/// <returns>The cache efficiency of the index buffer.</returns>
+	static CacheStatistics AnalyzeVertexCache( std::vector<GLuint> const& indices, GLuint numberOfVertices );
+
+private:
+	// The FIFO size the triangle order is optimized for and the analysis simulates. Current GPUs reuse at least this many vertices.
+	static const GLuint CacheSize = 16u;
+
+	// The meshlet limits of common mesh shader pipelines, which keep the bounds of a meshlet tight.
+	static const GLuint MaxMeshletVertices = 64u;
+	static const GLuint MaxMeshletTriangles = 124u;
+
+	/// <summary>
+	/// Calculates the bounding sphere and the normal cone of a meshlet.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="indices">The triangle list of the mesh.</param>
+	/// <param name="meshletVertices">The vertices referenced by the meshlet.</param>
+	/// <param name="meshlet">The meshlet whose index range is set.</param>
+	static GLvoid CalculateMeshletBounds( std::vector<Vertex> const& vertices, std::vector<GLuint> const& indices,
+	                                      std::vector<GLuint> const& meshletVertices, Meshlet& meshlet );
+
+	/// <summary>
+	/// Orders the triangles for the post-transform vertex cache by fanning around the vertex which keeps most of its neighbours in the cache.
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder.</param>
+	/// <param name="numberOfVertices">The number of vertices the indices refer to.</param>
+	/// <param name="clusters">The first triangle of each cluster. A cluster ends where the fan had to restart after a cache flush.</param>
+	static GLvoid OptimizeVertexCache( std::vector<GLuint>& indices, GLuint numberOfVertices, std::vector<GLuint>& clusters );
+
+	/// <summary>
+	/// Splits the clusters further as long as each part keeps the cache efficiency close to the one of the whole cluster.
+	/// </summary>
+	/// <param name="indices">The triangle list ordered for the vertex cache.</param>
+	/// <param name="numberOfVertices">The number of vertices the indices refer to.</param>
+	/// <param name="clusters">The first triangle of each cluster.</param>
+	static GLvoid SplitClusters( std::vector<GLuint> const& indices, GLuint numberOfVertices, std::vector<GLuint>& clusters );
+
+	/// <summary>
+	/// Sorts the clusters so clusters facing away from the center of the mesh are drawn first.
+	/// These clusters are likely to occlude the others from any view, which reduces the overdraw independently of the camera.
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder.</param>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="clusters">The first triangle of each cluster.</param>
+	static GLvoid OptimizeOverdraw( std::vector<GLuint>& indices, std::vector<Vertex> const& vertices, std::vector<GLuint> const& clusters );
+
+	/// <summary>
+	/// Sorts the vertices in the order they are first referenced, so the vertex fetch reads the vertex buffer linearly.
+	/// </summary>
+	/// <param name="vertices">The vertices to reorder.</param>
+	/// <param name="indices">The triangle list, which is remapped to the new vertex order.</param>
+	static GLvoid OptimizeVertexFetch( std::vector<Vertex>& vertices, std::vector<GLuint>& indices );
+};
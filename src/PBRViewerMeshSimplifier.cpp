@@ -0,0 +1,412 @@
+#include "PBRViewerMeshSimplifier.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+// A level has to remove at least this share of the triangles of the previous one, otherwise the locked vertices prevent further levels.
+static const GLdouble MinLodReduction = 0.2;
+
+/// <summary>
+/// Builds up to four coarser levels, each with about half the triangles of the previous one.
+/// The index lists of the coarser levels are appended to the indices.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="indices">The triangle list of the mesh, which is extended by the coarser levels.</param>
+/// <returns>The levels of detail starting with the full detail level or an empty vector if the mesh does not consist of triangles only.</returns>
+std::vector<MeshLod> PBRViewerMeshSimplifier::BuildLods( std::vector<Vertex> const& vertices, std::vector<GLuint>& indices )
+{
+	std::vector<MeshLod> lods;
+
+	const GLuint numberOfVertices = static_cast<GLuint>(vertices.size());
+	if (indices.empty() || 0u != indices.size() % 3u ||
+		std::any_of(indices.begin(), indices.end(), [numberOfVertices]( const GLuint index ) { return index >= numberOfVertices; }))
+	{
+		return lods;
+	}
+
+	MeshLod fullDetail;
+	fullDetail.FirstIndex = 0u;
+	fullDetail.NumberOfIndices = static_cast<GLuint>(indices.size());
+	fullDetail.Error = 0.0f;
+	lods.push_back(fullDetail);
+
+	// The quadrics are built from the original triangles once, so the error of every level is measured against the full detail surface.
+	std::vector<Quadric> quadrics(vertices.size());
+	for (size_t i = 0; i < indices.size(); i += 3u)
+	{
+		const glm::vec3& p0 = vertices[indices[i]].Position;
+		const glm::vec3& p1 = vertices[indices[i + 1u]].Position;
+		const glm::vec3& p2 = vertices[indices[i + 2u]].Position;
+
+		const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		const GLfloat length = glm::length(normal);
+		if (false == (length > 0.0f))
+		{
+			continue;
+		}
+
+		const glm::vec3 unitNormal = normal / length;
+		const GLfloat distance = -glm::dot(unitNormal, p0);
+		for (size_t corner = 0; corner < 3u; corner++)
+		{
+			quadrics[indices[i + corner]].AddPlane(unitNormal, distance, 0.5f * length);
+		}
+	}
+
+	const std::vector<GLboolean> isLocked = FindLockedVertices(vertices, indices);
+
+	std::vector<GLuint> levelIndices(indices.begin(), indices.end());
+	GLfloat error = 0.0f;
+
+	while (lods.size() < MaxNumberOfLods && levelIndices.size() / 3u >= MinNumberOfTriangles)
+	{
+		const size_t previousNumberOfIndices = levelIndices.size();
+		error = std::max(error, Simplify(vertices, isLocked, quadrics, levelIndices, previousNumberOfIndices / 6u * 3u));
+
+		if (static_cast<GLdouble>(levelIndices.size()) > (1.0 - MinLodReduction) * static_cast<GLdouble>(previousNumberOfIndices))
+		{
+			break;
+		}
+
+		MeshLod lod;
+		lod.FirstIndex = static_cast<GLuint>(indices.size());
+		lod.NumberOfIndices = static_cast<GLuint>(levelIndices.size());
+		lod.Error = error;
+		lods.push_back(lod);
+
+		indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+	}
+
+	return lods;
+}
+
+/// <summary>
+/// Adds the plane of a triangle weighted by the area of the triangle.
+/// </summary>
+GLvoid PBRViewerMeshSimplifier::Quadric::AddPlane( glm::vec3 const& normal, const GLfloat distance, const GLfloat weight )
+{
+	const GLdouble x = normal.x;
+	const GLdouble y = normal.y;
+	const GLdouble z = normal.z;
+	const GLdouble d = distance;
+	const GLdouble w = weight;
+
+	A00 += w * x * x;
+	A01 += w * x * y;
+	A02 += w * x * z;
+	A11 += w * y * y;
+	A12 += w * y * z;
+	A22 += w * z * z;
+	B0 += w * x * d;
+	B1 += w * y * d;
+	B2 += w * z * d;
+	C += w * d * d;
+	Weight += w;
+}
+
+/// <summary>
+/// Adds another quadric.
+/// </summary>
+GLvoid PBRViewerMeshSimplifier::Quadric::Add( Quadric const& other )
+{
+	A00 += other.A00;
+	A01 += other.A01;
+	A02 += other.A02;
+	A11 += other.A11;
+	A12 += other.A12;
+	A22 += other.A22;
+	B0 += other.B0;
+	B1 += other.B1;
+	B2 += other.B2;
+	C += other.C;
+	Weight += other.Weight;
+}
+
+/// <summary>
+/// Gets the weighted average of the squared distances of a point to the planes.
+/// </summary>
+GLdouble PBRViewerMeshSimplifier::Quadric::Evaluate( glm::vec3 const& point ) const
+{
+	if (false == (Weight > 0.0))
+	{
+		return 0.0;
+	}
+
+	const GLdouble x = point.x;
+	const GLdouble y = point.y;
+	const GLdouble z = point.z;
+
+	const GLdouble error = A00 * x * x + A11 * y * y + A22 * z * z +
+	                       2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) +
+	                       2.0 * (B0 * x + B1 * y + B2 * z) + C;
+
+	// Rounding can make the error of a point on all planes slightly negative.
+	return std::max(error / Weight, 0.0);
+}
+
+/// <summary>
+/// Finds the vertices which must not be removed: all vertices of a seam and the vertices on open borders.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="indices">The triangle list of the mesh.</param>
+/// <returns>A flag per vertex which is true if the vertex is locked.</returns>
+std::vector<GLboolean> PBRViewerMeshSimplifier::FindLockedVertices( std::vector<Vertex> const& vertices, std::vector<GLuint> const& indices )
+{
+	std::vector<GLboolean> isLocked(vertices.size(), GL_FALSE);
+
+	// Sort the vertices by the bits of their positions, which groups all vertices at the same position without a hash map.
+	std::vector<GLuint> order(vertices.size());
+	std::iota(order.begin(), order.end(), 0u);
+
+	const auto comparePositions = [&vertices]( const GLuint first, const GLuint second )
+	{
+		return std::memcmp(&vertices[first].Position, &vertices[second].Position, sizeof(glm::vec3)) < 0;
+	};
+	std::sort(order.begin(), order.end(), comparePositions);
+
+	// Each vertex is mapped onto the first vertex at its position. Several vertices at one position form a seam.
+	std::vector<GLuint> positionIds(vertices.size());
+	for (size_t start = 0; start < order.size();)
+	{
+		size_t end = start + 1u;
+		while (end < order.size() && false == comparePositions(order[start], order[end]))
+		{
+			end++;
+		}
+
+		for (size_t i = start; i < end; i++)
+		{
+			positionIds[order[i]] = order[start];
+			isLocked[order[i]] = end - start > 1u ? GL_TRUE : GL_FALSE;
+		}
+
+		start = end;
+	}
+
+	// Edges used by a single triangle are open borders, edges used by more than two triangles are not manifold.
+	std::vector<std::uint64_t> edges;
+	edges.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3u)
+	{
+		for (size_t corner = 0; corner < 3u; corner++)
+		{
+			const std::uint64_t first = positionIds[indices[i + corner]];
+			const std::uint64_t second = positionIds[indices[i + (corner + 1u) % 3u]];
+			if (first != second)
+			{
+				edges.push_back(std::min(first, second) << 32u | std::max(first, second));
+			}
+		}
+	}
+
+	std::sort(edges.begin(), edges.end());
+	for (size_t start = 0; start < edges.size();)
+	{
+		size_t end = start + 1u;
+		while (end < edges.size() && edges[end] == edges[start])
+		{
+			end++;
+		}
+
+		if (2u != end - start)
+		{
+			isLocked[static_cast<size_t>(edges[start] >> 32u)] = GL_TRUE;
+			isLocked[static_cast<size_t>(edges[start] & 0xFFFFFFFFu)] = GL_TRUE;
+		}
+
+		start = end;
+	}
+
+	return isLocked;
+}
+
+/// <summary>
+/// Collapses edges in the order of their quadric error until the triangle list reaches the target size or no edge can be collapsed.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="isLocked">The flag per vertex which is true if the vertex must not be removed.</param>
+/// <param name="quadrics">The quadric per vertex, which are merged by the collapses.</param>
+/// <param name="indices">The triangle list to simplify.</param>
+/// <param name="targetNumberOfIndices">The targeted number of indices.</param>
+/// <returns>The largest error of a collapse in model units.</returns>
+GLfloat PBRViewerMeshSimplifier::Simplify( std::vector<Vertex> const& vertices, std::vector<GLboolean> const& isLocked, std::vector<Quadric>& quadrics,
+                                           std::vector<GLuint>& indices, const size_t targetNumberOfIndices )
+{
+	struct Collapse
+	{
+		GLuint From;
+		GLuint To;
+		GLdouble Error;
+	};
+
+	const size_t numberOfVertices = vertices.size();
+	GLdouble largestError = 0.0;
+
+	std::vector<GLuint> triangleOffsets;
+	std::vector<GLuint> triangles;
+	std::vector<GLuint> remap(numberOfVertices);
+	std::vector<GLboolean> isTouched;
+	std::vector<Collapse> collapses;
+
+	// Each pass collapses a set of independent edges with the smallest errors, then the triangle list is rebuilt.
+	while (indices.size() > targetNumberOfIndices)
+	{
+		triangleOffsets.assign(numberOfVertices + 1u, 0u);
+		for (const GLuint index : indices)
+		{
+			triangleOffsets[index + 1u]++;
+		}
+		std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+
+		triangles.resize(indices.size());
+		std::vector<GLuint> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			triangles[fill[indices[i]]++] = static_cast<GLuint>(i / 3u);
+		}
+
+		collapses.clear();
+		for (size_t i = 0; i < indices.size(); i += 3u)
+		{
+			for (size_t corner = 0; corner < 3u; corner++)
+			{
+				const GLuint first = indices[i + corner];
+				const GLuint second = indices[i + (corner + 1u) % 3u];
+
+				for (GLuint direction = 0; direction < 2u; direction++)
+				{
+					const GLuint from = 0u == direction ? first : second;
+					const GLuint to = 0u == direction ? second : first;
+					if (isLocked[from])
+					{
+						continue;
+					}
+
+					Quadric quadric = quadrics[from];
+					quadric.Add(quadrics[to]);
+
+					Collapse collapse;
+					collapse.From = from;
+					collapse.To = to;
+					collapse.Error = quadric.Evaluate(vertices[to].Position);
+					collapses.push_back(collapse);
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), []( Collapse const& first, Collapse const& second )
+		{
+			return first.Error < second.Error;
+		});
+
+		// A collapse removes two triangles of a closed surface.
+		const size_t maxNumberOfCollapses = std::max<size_t>((indices.size() - targetNumberOfIndices) / 6u, 1u);
+		size_t numberOfCollapses = 0u;
+
+		std::iota(remap.begin(), remap.end(), 0u);
+		isTouched.assign(numberOfVertices, GL_FALSE);
+
+		for (const Collapse& collapse : collapses)
+		{
+			if (numberOfCollapses >= maxNumberOfCollapses)
+			{
+				break;
+			}
+
+			if (isTouched[collapse.From] || isTouched[collapse.To] ||
+				IsFlipping(vertices, indices, triangles, triangleOffsets, collapse.From, collapse.To))
+			{
+				continue;
+			}
+
+			remap[collapse.From] = collapse.To;
+			quadrics[collapse.To].Add(quadrics[collapse.From]);
+
+			// The flip test only knows the triangles of this pass, so the whole neighbourhood has to wait for the next one.
+			for (GLuint j = triangleOffsets[collapse.From]; j < triangleOffsets[collapse.From + 1u]; j++)
+			{
+				for (size_t corner = 0; corner < 3u; corner++)
+				{
+					isTouched[indices[3u * triangles[j] + corner]] = GL_TRUE;
+				}
+			}
+
+			largestError = std::max(largestError, collapse.Error);
+			numberOfCollapses++;
+		}
+
+		if (0u == numberOfCollapses)
+		{
+			break;
+		}
+
+		// Remap the triangles and drop the ones which collapsed to a line.
+		size_t numberOfIndices = 0u;
+		for (size_t i = 0; i < indices.size(); i += 3u)
+		{
+			const GLuint a = remap[indices[i]];
+			const GLuint b = remap[indices[i + 1u]];
+			const GLuint c = remap[indices[i + 2u]];
+
+			if (a != b && b != c && a != c)
+			{
+				indices[numberOfIndices++] = a;
+				indices[numberOfIndices++] = b;
+				indices[numberOfIndices++] = c;
+			}
+		}
+
+		indices.resize(numberOfIndices);
+	}
+
+	// The quadric error is a squared distance.
+	return static_cast<GLfloat>(std::sqrt(largestError));
+}
+
+/// <summary>
+/// Checks if moving a vertex onto another one flips any of the remaining triangles around it.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="indices">The triangle list.</param>
+/// <param name="triangles">The triangles around each vertex.</param>
+/// <param name="triangleOffsets">The position of the first triangle of each vertex within the triangles.</param>
+/// <param name="from">The vertex to move.</param>
+/// <param name="to">The vertex it is moved onto.</param>
+/// <returns>True if a triangle would flip or degenerate, false if not.</returns>
+GLboolean PBRViewerMeshSimplifier::IsFlipping( std::vector<Vertex> const& vertices, std::vector<GLuint> const& indices,
+                                               std::vector<GLuint> const& triangles, std::vector<GLuint> const& triangleOffsets,
+                                               const GLuint from, const GLuint to )
+{
+	for (GLuint i = triangleOffsets[from]; i < triangleOffsets[from + 1u]; i++)
+	{
+		const GLuint* triangle = &indices[3u * triangles[i]];
+
+		// The triangles containing the edge vanish.
+		if (to == triangle[0] || to == triangle[1] || to == triangle[2])
+		{
+			continue;
+		}
+
+		glm::vec3 positions[3];
+		glm::vec3 movedPositions[3];
+		for (GLuint corner = 0; corner < 3u; corner++)
+		{
+			positions[corner] = vertices[triangle[corner]].Position;
+			movedPositions[corner] = from == triangle[corner] ? vertices[to].Position : positions[corner];
+		}
+
+		const glm::vec3 normal = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+		const glm::vec3 movedNormal = glm::cross(movedPositions[1] - movedPositions[0], movedPositions[2] - movedPositions[0]);
+		if (false == (glm::dot(normal, movedNormal) > 0.0f))
+		{
+			return GL_TRUE;
+		}
+	}
+
+	return GL_FALSE;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerMeshLod.h"
+#include "PBRViewerVertex.h"
+
+#include <glm/vec3.hpp>
+
+#include <vector>
+
+/// <summary>
+/// This class builds the levels of detail of a mesh by quadric error simplification (Garland and Heckbert).
+/// Vertices are collapsed onto neighbouring vertices, so all levels share the vertex buffer of the mesh.
+/// Vertices on open borders and on attribute seams (several vertices at the same position) are never removed, which keeps the levels free of cracks.
+/// The methods do not need an OpenGL context, so the simplification runs on the import workers.
+/// </summary>
+class PBRViewerMeshSimplifier
+{
+public:
+	/// <summary>
+	/// Builds up to four coarser levels, each with about half the triangles of the previous one.
+	/// The index lists of the coarser levels are appended to the indices.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="indices">The triangle list of the mesh, which is extended by the coarser levels.</param>
+	/// <returns>The levels of detail starting with the full detail level or an empty vector if the mesh does not consist of triangles only.</returns>
+	static std::vector<MeshLod> BuildLods( std::vector<Vertex> const& vertices, std::vector<GLuint>& indices );
+
+private:
+	// The full detail level and up to four simplified ones.
+	static const GLuint MaxNumberOfLods = 5u;
+
+	// Meshes and levels smaller than this are not simplified any further.
+	static const GLuint MinNumberOfTriangles = 128u;
+
+	/// <summary>
+	/// The quadric measuring the squared distance of a point to a set of weighted planes.
+	/// </summary>
+	struct Quadric
+	{
+		GLdouble A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+		GLdouble B0 = 0.0, B1 = 0.0, B2 = 0.0;
+		GLdouble C = 0.0;
+		GLdouble Weight = 0.0;
+
+		/// <summary>
+		/// Adds the plane of a triangle weighted by the area of the triangle.
+		/// </summary>
+		GLvoid AddPlane( glm::vec3 const& normal, GLfloat distance, GLfloat weight );
+
+		/// <summary>
+		/// Adds another quadric.
+		/// </summary>
+		GLvoid Add( Quadric const& other );
+
+		/// <summary>
+		/// Gets the weighted average of the squared distances of a point to the planes.
+		/// </summary>
+		GLdouble Evaluate( glm::vec3 const& point ) const;
+	};
+
+	/// <summary>
+	/// Finds the vertices which must not be removed: all vertices of a seam and the vertices on open borders.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="indices">The triangle list of the mesh.</param>
+	/// <returns>A flag per vertex which is true if the vertex is locked.</returns>
+	static std::vector<GLboolean> FindLockedVertices( std::vector<Vertex> const& vertices, std::vector<GLuint> const& indices );
+
+	/// <summary>
+	/// Collapses edges in the order of their quadric error until the triangle list reaches the target size or no edge can be collapsed.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="isLocked">The flag per vertex which is true if the vertex must not be removed.</param>
+	/// <param name="quadrics">The quadric per vertex, which are merged by the collapses.</param>
+	/// <param name="indices">The triangle list to simplify.</param>
+	/// <param name="targetNumberOfIndices">The targeted number of indices.</param>
+	/// <returns>The largest error of a collapse in model units.</returns>
+	static GLfloat Simplify( std::vector<Vertex> const& vertices, std::vector<GLboolean> const& isLocked, std::vector<Quadric>& quadrics,
+	                         std::vector<GLuint>& indices, size_t targetNumberOfIndices );
+
+	/// <summary>
+	/// Checks if moving a vertex onto another one flips any of the remaining triangles around it.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="indices">The triangle list.</param>
+	/// <param name="triangles">The triangles around each vertex.</param>
+	/// <param name="triangleOffsets">The position of the first triangle of each vertex within the triangles.</param>
+	/// <param name="from">The vertex to move.</param>
+	/// <param name="to">The vertex it is moved onto.</param>
+	/// <returns>True if a triangle would flip or degenerate, false if not.</returns>
+	static GLboolean IsFlipping( std::vector<Vertex> const& vertices, std::vector<GLuint> const& indices,
+	                             std::vector<GLuint> const& triangles, std::vector<GLuint> const& triangleOffsets, GLuint from, GLuint to );
+};
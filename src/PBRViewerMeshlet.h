@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <glm/vec3.hpp>
+
+/// <summary>
+/// This struct represents a small cluster of triangles of a mesh which is culled as a whole.
+/// The triangles of a meshlet are stored consecutively within the index buffer of the mesh.
+/// </summary>
+struct Meshlet
+{
+	/// <summary>
+	/// The position of the first index of the meshlet within the index buffer.
+	/// </summary>
+	GLuint FirstIndex;
+
+	/// <summary>
+	/// The number of indices, i. e. three times the number of triangles.
+	/// </summary>
+	GLuint NumberOfIndices;
+
+	/// <summary>
+	/// The center of the bounding sphere in model space.
+	/// </summary>
+	glm::vec3 Center;
+
+	/// <summary>
+	/// The radius of the bounding sphere in model space.
+	/// </summary>
+	GLfloat Radius;
+
+	/// <summary>
+	/// The average direction of the triangle normals.
+	/// </summary>
+	glm::vec3 ConeAxis;
+
+	/// <summary>
+	/// The sine of the largest angle between the cone axis and a triangle normal.
+	/// A value of one disables the back-face test, e. g. if the normals spread over more than a hemisphere.
+	/// </summary>
+	GLfloat ConeCutoff;
+};
+
+static_assert(sizeof(Meshlet) == 40, "The meshlet must not contain any padding.");
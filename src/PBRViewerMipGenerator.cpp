@@ -0,0 +1,368 @@
+#include "PBRViewerMipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <xmmintrin.h>
+
+// The Kaiser window covers 1.5 pixels of the smaller level on each side of a pixel center.
+static const GLfloat KaiserRadius = 1.5f;
+static const GLfloat KaiserAlpha = 4.0f;
+
+static const GLint LinearToSRGBTableSize = 16384;
+
+/// <summary>
+/// The lookup tables converting between 8-bit sRGB and linear values.
+/// </summary>
+struct PBRViewerSRGBTables
+{
+	GLfloat ToLinear[256];
+	GLubyte ToSRGB[LinearToSRGBTableSize + 1];
+
+	PBRViewerSRGBTables()
+	{
+		for (GLint i = 0; i < 256; i++)
+		{
+			const GLfloat value = static_cast<GLfloat>(i) / 255.0f;
+			ToLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		for (GLint i = 0; i <= LinearToSRGBTableSize; i++)
+		{
+			const GLfloat value = static_cast<GLfloat>(i) / static_cast<GLfloat>(LinearToSRGBTableSize);
+			const GLfloat sRGB = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+			ToSRGB[i] = static_cast<GLubyte>(std::min(std::max(sRGB, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+	}
+};
+
+/// <summary>
+/// Gets the sRGB lookup tables. They are built once on first use.
+/// </summary>
+/// <returns>The sRGB lookup tables.</returns>
+static const PBRViewerSRGBTables& GetSRGBTables()
+{
+	static const PBRViewerSRGBTables tables;
+	return tables;
+}
+
+/// <summary>
+/// Gets the number of components of an image which hold sRGB color. An alpha channel (second or fourth component) is always linear.
+/// </summary>
+/// <param name="components">The number of components per pixel.</param>
+/// <returns>The number of color components.</returns>
+static GLint GetNumberOfColorComponents( const GLint components )
+{
+	return (2 == components || 4 == components) ? components - 1 : components;
+}
+
+/// <summary>
+/// Evaluates the modified Bessel function of the first kind and order zero.
+/// </summary>
+/// <param name="x">The argument.</param>
+/// <returns>The function value.</returns>
+static GLfloat BesselI0( const GLfloat x )
+{
+	GLfloat sum = 1.0f;
+	GLfloat term = 1.0f;
+	for (GLint k = 1; k < 20; k++)
+	{
+		term *= (x * 0.5f) / static_cast<GLfloat>(k);
+		sum += term * term;
+	}
+
+	return sum;
+}
+
+/// <summary>
+/// Evaluates the Kaiser-windowed sinc kernel.
+/// </summary>
+/// <param name="t">The distance from the pixel center in pixels of the smaller level.</param>
+/// <returns>The unnormalized weight.</returns>
+static GLfloat KaiserSinc( const GLfloat t )
+{
+	const GLfloat x = t / KaiserRadius;
+	if (std::abs(x) >= 1.0f)
+	{
+		return 0.0f;
+	}
+
+	const GLfloat pi = 3.14159265358979f;
+	const GLfloat sinc = std::abs(t) < 1e-5f ? 1.0f : std::sin(pi * t) / (pi * t);
+	return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0f - x * x)) / BesselI0(KaiserAlpha);
+}
+
+/// <summary>
+/// Generates all mip levels of an image down to 1x1.
+/// </summary>
+/// <param name="pixels">The pixels of the base level, row by row.</param>
+/// <param name="width">The width of the base level.</param>
+/// <param name="height">The height of the base level.</param>
+/// <param name="components">The number of 8-bit components per pixel (1 to 4).</param>
+/// <param name="content">The content of the image, which decides in which space it is filtered.</param>
+/// <param name="filter">The filter kernel.</param>
+/// <returns>The tightly packed mip levels, starting with a copy of the base level.</returns>
+std::vector<std::vector<GLubyte>> PBRViewerMipGenerator::Generate( const GLubyte* pixels, GLint width, GLint height, const GLint components,
+                                                                   const PBRViewerEnumerations::TextureContent content,
+                                                                   const PBRViewerEnumerations::MipFilter filter )
+{
+	std::vector<std::vector<GLubyte>> levels;
+	levels.reserve(GetNumberOfLevels(width, height));
+	levels.emplace_back(pixels, pixels + static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(components));
+
+	std::vector<GLfloat> level = ConvertToFloat(pixels, width, height, components, content);
+	while (width > 1 || height > 1)
+	{
+		const GLint nextWidth = std::max(width / 2, 1);
+		const GLint nextHeight = std::max(height / 2, 1);
+
+		std::vector<GLfloat> nextLevel = Resample(level, width, height, nextWidth, nextHeight, filter);
+		if (PBRViewerEnumerations::TangentSpaceNormals == content)
+		{
+			Renormalize(nextLevel);
+		}
+
+		levels.push_back(ConvertToBytes(nextLevel, components, content));
+
+		level.swap(nextLevel);
+		width = nextWidth;
+		height = nextHeight;
+	}
+
+	return levels;
+}
+
+/// <summary>
+/// Gets the number of levels of a full mip chain.
+/// </summary>
+/// <param name="width">The width of the base level.</param>
+/// <param name="height">The height of the base level.</param>
+/// <returns>The number of mip levels down to 1x1.</returns>
+GLuint PBRViewerMipGenerator::GetNumberOfLevels( GLint width, GLint height )
+{
+	GLuint numberOfLevels = 1u;
+	while (width > 1 || height > 1)
+	{
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+		numberOfLevels++;
+	}
+
+	return numberOfLevels;
+}
+
+/// <summary>
+/// Computes the filter taps to resample a row or column.
+/// </summary>
+/// <param name="sourceSize">The number of source pixels.</param>
+/// <param name="targetSize">The number of target pixels.</param>
+/// <param name="filter">The filter kernel.</param>
+/// <returns>The filter taps of all target pixels. Indices wrap around like the repeat texture mode.</returns>
+PBRViewerMipGenerator::FilterTaps PBRViewerMipGenerator::ComputeTaps( const GLint sourceSize, const GLint targetSize, const PBRViewerEnumerations::MipFilter filter )
+{
+	const GLfloat scale = static_cast<GLfloat>(sourceSize) / static_cast<GLfloat>(targetSize);
+	const GLfloat radius = PBRViewerEnumerations::KaiserFilter == filter ? KaiserRadius * scale : 0.5f * scale;
+
+	FilterTaps taps;
+	taps.NumberOfTaps = static_cast<GLint>(std::ceil(2.0f * radius)) + 1;
+	taps.Indices.resize(static_cast<size_t>(targetSize) * static_cast<size_t>(taps.NumberOfTaps));
+	taps.Weights.resize(taps.Indices.size());
+
+	for (GLint i = 0; i < targetSize; i++)
+	{
+		const GLfloat center = (static_cast<GLfloat>(i) + 0.5f) * scale;
+		const GLint first = static_cast<GLint>(std::floor(center - radius));
+
+		GLfloat sum = 0.0f;
+		for (GLint k = 0; k < taps.NumberOfTaps; k++)
+		{
+			const GLint source = first + k;
+
+			GLfloat weight;
+			if (PBRViewerEnumerations::KaiserFilter == filter)
+			{
+				weight = KaiserSinc((static_cast<GLfloat>(source) + 0.5f - center) / scale);
+			}
+			else
+			{
+				// The overlap of the source pixel with the footprint of the target pixel.
+				const GLfloat overlap = std::min(static_cast<GLfloat>(source + 1), center + radius) - std::max(static_cast<GLfloat>(source), center - radius);
+				weight = std::max(overlap, 0.0f);
+			}
+
+			const size_t tap = static_cast<size_t>(i) * static_cast<size_t>(taps.NumberOfTaps) + static_cast<size_t>(k);
+			taps.Indices[tap] = ((source % sourceSize) + sourceSize) % sourceSize;
+			taps.Weights[tap] = weight;
+			sum += weight;
+		}
+
+		for (GLint k = 0; k < taps.NumberOfTaps; k++)
+		{
+			taps.Weights[static_cast<size_t>(i) * static_cast<size_t>(taps.NumberOfTaps) + static_cast<size_t>(k)] /= sum;
+		}
+	}
+
+	return taps;
+}
+
+/// <summary>
+/// Converts 8-bit pixels into four linear floats per pixel.
+/// </summary>
+std::vector<GLfloat> PBRViewerMipGenerator::ConvertToFloat( const GLubyte* pixels, const GLint width, const GLint height, const GLint components,
+                                                            const PBRViewerEnumerations::TextureContent content )
+{
+	const PBRViewerSRGBTables& tables = GetSRGBTables();
+	const GLint colorComponents = GetNumberOfColorComponents(components);
+	const size_t numberOfPixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+
+	std::vector<GLfloat> level(numberOfPixels * FloatsPerPixel, 0.0f);
+	for (size_t i = 0; i < numberOfPixels; i++)
+	{
+		const GLubyte* source = pixels + i * static_cast<size_t>(components);
+		GLfloat* target = &level[i * FloatsPerPixel];
+
+		for (GLint c = 0; c < components; c++)
+		{
+			const GLfloat value = static_cast<GLfloat>(source[c]) / 255.0f;
+			if (PBRViewerEnumerations::SRGBColor == content && c < colorComponents)
+			{
+				target[c] = tables.ToLinear[source[c]];
+			}
+			else if (PBRViewerEnumerations::TangentSpaceNormals == content && c < 3)
+			{
+				target[c] = value * 2.0f - 1.0f;
+			}
+			else
+			{
+				target[c] = value;
+			}
+		}
+
+		if (PBRViewerEnumerations::TangentSpaceNormals == content && components < 3)
+		{
+			// Two-channel normal maps only store X and Y.
+			target[2] = std::sqrt(std::max(1.0f - target[0] * target[0] - target[1] * target[1], 0.0f));
+		}
+	}
+
+	return level;
+}
+
+/// <summary>
+/// Converts four linear floats per pixel back into 8-bit pixels.
+/// </summary>
+std::vector<GLubyte> PBRViewerMipGenerator::ConvertToBytes( std::vector<GLfloat> const& level, const GLint components,
+                                                            const PBRViewerEnumerations::TextureContent content )
+{
+	const PBRViewerSRGBTables& tables = GetSRGBTables();
+	const GLint colorComponents = GetNumberOfColorComponents(components);
+	const size_t numberOfPixels = level.size() / FloatsPerPixel;
+
+	std::vector<GLubyte> pixels(numberOfPixels * static_cast<size_t>(components));
+	for (size_t i = 0; i < numberOfPixels; i++)
+	{
+		const GLfloat* source = &level[i * FloatsPerPixel];
+		GLubyte* target = &pixels[i * static_cast<size_t>(components)];
+
+		for (GLint c = 0; c < components; c++)
+		{
+			GLfloat value = source[c];
+			if (PBRViewerEnumerations::SRGBColor == content && c < colorComponents)
+			{
+				const GLfloat clamped = std::min(std::max(value, 0.0f), 1.0f);
+				target[c] = tables.ToSRGB[static_cast<GLint>(clamped * static_cast<GLfloat>(LinearToSRGBTableSize) + 0.5f)];
+				continue;
+			}
+
+			if (PBRViewerEnumerations::TangentSpaceNormals == content && c < 3)
+			{
+				value = value * 0.5f + 0.5f;
+			}
+
+			target[c] = static_cast<GLubyte>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+	}
+
+	return pixels;
+}
+
+/// <summary>
+/// Resamples a level with a separable filter, first horizontally and then vertically.
+/// </summary>
+std::vector<GLfloat> PBRViewerMipGenerator::Resample( std::vector<GLfloat> const& level, const GLint width, const GLint height,
+                                                      const GLint targetWidth, const GLint targetHeight, const PBRViewerEnumerations::MipFilter filter )
+{
+	const FilterTaps horizontalTaps = ComputeTaps(width, targetWidth, filter);
+	const FilterTaps verticalTaps = ComputeTaps(height, targetHeight, filter);
+
+	// Horizontal pass: width x height -> targetWidth x height
+	std::vector<GLfloat> intermediate(static_cast<size_t>(targetWidth) * static_cast<size_t>(height) * FloatsPerPixel);
+	for (GLint y = 0; y < height; y++)
+	{
+		const GLfloat* sourceRow = &level[static_cast<size_t>(y) * static_cast<size_t>(width) * FloatsPerPixel];
+		GLfloat* targetRow = &intermediate[static_cast<size_t>(y) * static_cast<size_t>(targetWidth) * FloatsPerPixel];
+
+		for (GLint x = 0; x < targetWidth; x++)
+		{
+			const GLint* indices = &horizontalTaps.Indices[static_cast<size_t>(x) * static_cast<size_t>(horizontalTaps.NumberOfTaps)];
+			const GLfloat* weights = &horizontalTaps.Weights[static_cast<size_t>(x) * static_cast<size_t>(horizontalTaps.NumberOfTaps)];
+
+			__m128 sum = _mm_setzero_ps();
+			for (GLint k = 0; k < horizontalTaps.NumberOfTaps; k++)
+			{
+				const __m128 pixel = _mm_loadu_ps(sourceRow + static_cast<size_t>(indices[k]) * FloatsPerPixel);
+				sum = _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(weights[k])));
+			}
+
+			_mm_storeu_ps(targetRow + static_cast<size_t>(x) * FloatsPerPixel, sum);
+		}
+	}
+
+	// Vertical pass: targetWidth x height -> targetWidth x targetHeight
+	const size_t rowLength = static_cast<size_t>(targetWidth) * FloatsPerPixel;
+	std::vector<GLfloat> result(rowLength * static_cast<size_t>(targetHeight));
+	for (GLint y = 0; y < targetHeight; y++)
+	{
+		const GLint* indices = &verticalTaps.Indices[static_cast<size_t>(y) * static_cast<size_t>(verticalTaps.NumberOfTaps)];
+		const GLfloat* weights = &verticalTaps.Weights[static_cast<size_t>(y) * static_cast<size_t>(verticalTaps.NumberOfTaps)];
+		GLfloat* targetRow = &result[static_cast<size_t>(y) * rowLength];
+
+		for (size_t x = 0; x < rowLength; x += FloatsPerPixel)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (GLint k = 0; k < verticalTaps.NumberOfTaps; k++)
+			{
+				const __m128 pixel = _mm_loadu_ps(&intermediate[static_cast<size_t>(indices[k]) * rowLength + x]);
+				sum = _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(weights[k])));
+			}
+
+			_mm_storeu_ps(targetRow + x, sum);
+		}
+	}
+
+	return result;
+}
+
+/// <summary>
+/// Normalizes the XYZ components of all pixels.
+/// </summary>
+GLvoid PBRViewerMipGenerator::Renormalize( std::vector<GLfloat>& level )
+{
+	for (size_t i = 0; i < level.size(); i += FloatsPerPixel)
+	{
+		GLfloat* normal = &level[i];
+
+		const GLfloat length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 1e-6f)
+		{
+			normal[0] /= length;
+			normal[1] /= length;
+			normal[2] /= length;
+		}
+		else
+		{
+			normal[0] = 0.0f;
+			normal[1] = 0.0f;
+			normal[2] = 1.0f;
+		}
+	}
+}
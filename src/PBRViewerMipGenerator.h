@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerEnumerations.h"
+
+#include <vector>
+
+/// <summary>
+/// This class generates the full mip chain of an 8-bit image on the CPU.
+/// Each level is filtered from the floating point result of the previous one with SSE, so quantization errors do not accumulate.
+/// sRGB color is filtered in linear space and tangent-space normals are renormalized after each level.
+/// The methods do not need an OpenGL context, so the chain can be built on the texture decode workers or by an offline cooking step.
+/// </summary>
+class PBRViewerMipGenerator
+{
+public:
+	/// <summary>
+	/// Generates all mip levels of an image down to 1x1.
+	/// </summary>
+	/// <param name="pixels">The pixels of the base level, row by row.</param>
+	/// <param name="width">The width of the base level.</param>
+	/// <param name="height">The height of the base level.</param>
+	/// <param name="components">The number of 8-bit components per pixel (1 to 4).</param>
+	/// <param name="content">The content of the image, which decides in which space it is filtered.</param>
+	/// <param name="filter">The filter kernel.</param>
+	/// <returns>The tightly packed mip levels, starting with a copy of the base level.</returns>
+	static std::vector<std::vector<GLubyte>> Generate( const GLubyte* pixels, GLint width, GLint height, GLint components,
+	                                                   PBRViewerEnumerations::TextureContent content, PBRViewerEnumerations::MipFilter filter );
+
+	/// <summary>
+	/// Gets the number of levels of a full mip chain.
+	/// </summary>
+	/// <param name="width">The width of the base level.</param>
+	/// <param name="height">The height of the base level.</param>
+	/// <returns>The number of mip levels down to 1x1.</returns>
+	static GLuint GetNumberOfLevels( GLint width, GLint height );
+
+private:
+	// Every pixel is filtered as four floats, regardless of the number of components of the image.
+	static const GLint FloatsPerPixel = 4;
+
+	/// <summary>
+	/// The source pixels and weights contributing to each pixel of a resampled row or column.
+	/// </summary>
+	struct FilterTaps
+	{
+		GLint NumberOfTaps = 0;
+		std::vector<GLint> Indices;
+		std::vector<GLfloat> Weights;
+	};
+
+	/// <summary>
+	/// Computes the filter taps to resample a row or column.
+	/// </summary>
+	/// <param name="sourceSize">The number of source pixels.</param>
+	/// <param name="targetSize">The number of target pixels.</param>
+	/// <param name="filter">The filter kernel.</param>
+	/// <returns>The filter taps of all target pixels. Indices wrap around like the repeat texture mode.</returns>
+	static FilterTaps ComputeTaps( GLint sourceSize, GLint targetSize, PBRViewerEnumerations::MipFilter filter );
+
+	/// <summary>
+	/// Converts 8-bit pixels into four linear floats per pixel.
+	/// </summary>
+	static std::vector<GLfloat> ConvertToFloat( const GLubyte* pixels, GLint width, GLint height, GLint components, PBRViewerEnumerations::TextureContent content );
+
+	/// <summary>
+	/// Converts four linear floats per pixel back into 8-bit pixels.
+	/// </summary>
+	static std::vector<GLubyte> ConvertToBytes( std::vector<GLfloat> const& level, GLint components, PBRViewerEnumerations::TextureContent content );
+
+	/// <summary>
+	/// Resamples a level with a separable filter, first horizontally and then vertically.
+	/// </summary>
+	static std::vector<GLfloat> Resample( std::vector<GLfloat> const& level, GLint width, GLint height, GLint targetWidth, GLint targetHeight,
+	                                      PBRViewerEnumerations::MipFilter filter );
+
+	/// <summary>
+	/// Normalizes the XYZ components of all pixels.
+	/// </summary>
+	static GLvoid Renormalize( std::vector<GLfloat>& level );
+};
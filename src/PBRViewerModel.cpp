@@ -4,9 +4,19 @@
 #include <glad/glad.h>
 
 #include "PBRViewerOpenGLUtilities.h"
+#include "PBRViewerStateCache.h"
 #include "PBRViewerLogger.h"
+#include "PBRViewerGeometryBuffer.h"
+#include "PBRViewerTextureCache.h"
 #include <stb_image.h>
 
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// The largest geometric error of a level of detail visible in the camera pass, in pixels.
+static const GLfloat MaximumLodPixelError = 1.0f;
+
 GLvoid PBRViewerModel::CreateShader()
 {
 	// Read needed files
@@ -36,6 +46,7 @@ GLvoid PBRViewerModel::CreateShader()
 		lightingShader->AddFileAtTheEnd(GL_FRAGMENT_SHADER, "ChooseRenderOutput.gl");
 		lightingShader->AddFileAtTheEnd(GL_FRAGMENT_SHADER, "VectorTransformation.gl");
 		lightingShader->AddFileAtTheEnd(GL_FRAGMENT_SHADER, "FresnelApproximations.gl");
+		lightingShader->AddFileAtTheEnd(GL_VERTEX_SHADER, "DecodeOctahedral.gl");
 	}
 
 	// Append common code implementations to PBR shaders
@@ -47,18 +58,24 @@ GLvoid PBRViewerModel::CreateShader()
 
 	// Append common code implementations to single shaders
 	myDebugShader->AddFileAtTheEnd(GL_FRAGMENT_SHADER, "GetNormalFromMap.gl");
+	myDebugShader->AddFileAtTheEnd(GL_VERTEX_SHADER, "DecodeOctahedral.gl");
+	myDebugNormalVectorShader->AddFileAtTheEnd(GL_VERTEX_SHADER, "DecodeOctahedral.gl");
 
 	// Compile shaders afterwards
 	for (const auto& shader : myShaders)
 	{
 		shader->Compile();
 	}
+
+	// The uniform blocks are shared by all shaders through their binding points.
+	myFrameBuffer = std::make_unique<PBRViewerUniformBuffer>(PBRViewerEnumerations::UniformBlockFrame, sizeof(FrameBlock));
+	myLightBuffer = std::make_unique<PBRViewerUniformBuffer>(PBRViewerEnumerations::UniformBlockLights, sizeof(LightBlock));
+	myBrdfBuffer = std::make_unique<PBRViewerUniformBuffer>(PBRViewerEnumerations::UniformBlockBrdf, sizeof(BrdfBlock));
 }
 
 GLvoid PBRViewerModel::CreateLightSources()
 {
-	const GLuint numberOfLights = 4;
-	myLightSources.reserve(numberOfLights);
+	myLightSources.reserve(NumberOfLights);
 
 	// All lights share the same color.
 	const glm::vec3 lightColor = glm::vec3(5.0f);
@@ -89,14 +106,6 @@ GLvoid PBRViewerModel::CreateLightSources()
 	myLightSources.push_back(fourthLight);
 }
 
-GLvoid PBRViewerModel::RemoveShadowTexturesFromModel()
-{
-	for (const PBRViewerTexture& texture : myShadowDepthCubeMaps)
-	{
-		myLoadedModel->RemoveTextureFromAllMeshes(texture);
-	}
-}
-
 GLboolean PBRViewerModel::CreateGlfwWindow()
 {
 	if (GLFW_FALSE == glfwInit())
@@ -189,7 +198,7 @@ GLboolean PBRViewerModel::Init()
 
 	glGetError(); // pull and ignore unhandled errors like GL_INVALID_ENUM
 
-	glEnable(GL_DEPTH_TEST);
+	PBRViewerStateCache::SetCapability(GL_DEPTH_TEST, GL_TRUE);
 	glEnable(GL_MULTISAMPLE);
 
 	CreateLightSources();
@@ -203,7 +212,7 @@ GLboolean PBRViewerModel::Init()
 
 	GLint width, height;
 	glfwGetWindowSize(myWindowContext, &width, &height);
-	glViewport(0, 0, width, height);
+	PBRViewerStateCache::SetViewport(0, 0, width, height);
 	glfwSwapInterval(0);
 	glfwSwapBuffers(myWindowContext);
 
@@ -229,40 +238,15 @@ GLvoid PBRViewerModel::DrawOpenGL()
 	// Check if any events have been activated (key pressed, mouse moved etc.) and call corresponding response functions
 	glfwPollEvents();
 
-	if (myNewModelShouldBeLoaded)
-	{
-		if (myLoadedModel)
-		{
-			myLoadedModel->Cleanup();
-			myLoadedModel.reset();
-		}
-
-		myLoadedModel = std::make_shared<PBRViewerScene>(myNewModelFilepath);
-
-		if (mySkybox)
-		{
-			// Set IBL textures for ambient lighting within PBR shader if a model is already available.
-			myLoadedModel->AddTextureToAllMeshes(mySkybox->GetIrradianceTexture());
-			myLoadedModel->AddTextureToAllMeshes(mySkybox->GetPreFilteredEnvironmentMap());
-			myLoadedModel->AddTextureToAllMeshes(mySkybox->GetBRDFLookupTexture());
-		}
+	ReleaseCancelledSceneImporters();
 
-		if (myShadows)
-		{
-			myShadows->Cleanup();
-			myShadows.reset();
-		}
-
-		// Generate shadow textures for the new model
-		myShadows = std::make_unique<PBRViewerShadows>(myLoadedModel);
-
-		std::vector<PBRViewerTexture> shadowTextures = myShadows->CreateSelfShadowingTextures(static_cast<GLuint>(myLightSources.size()));
-		for (const PBRViewerTexture& texture : shadowTextures)
-		{
-			myLoadedModel->AddTextureToAllMeshes(texture);
-		}
+	// The previous model keeps rendering until the import has finished.
+	if (mySceneImporter && mySceneImporter->IsFinished())
+	{
+		SwapInImportedModel();
 
-		myNewModelShouldBeLoaded = GL_FALSE;
+		// Creating the textures of the model binds them without the state cache.
+		PBRViewerStateCache::Invalidate();
 	}
 
 	if (myNewSkyboxShouldBeLoaded)
@@ -274,7 +258,12 @@ GLvoid PBRViewerModel::DrawOpenGL()
 		}
 
 		mySkybox = std::make_unique<PBRViewerSkybox>(myNewSkyboxFilepath);
-		if (GL_FALSE == mySkybox->Init())
+		const GLboolean isSkyboxCreated = mySkybox->Init();
+
+		// Creating the textures of the skybox binds them without the state cache.
+		PBRViewerStateCache::Invalidate();
+
+		if (GL_FALSE == isSkyboxCreated)
 		{
 			mySkybox->Cleanup();
 			mySkybox.reset();
@@ -282,34 +271,17 @@ GLvoid PBRViewerModel::DrawOpenGL()
 			return;
 		}
 
-		if (myLoadedModel)
-		{
-			// Set IBL textures for ambient lighting within PBR shader if a model is already available.
-			myLoadedModel->AddTextureToAllMeshes(mySkybox->GetIrradianceTexture());
-			myLoadedModel->AddTextureToAllMeshes(mySkybox->GetPreFilteredEnvironmentMap());
-			myLoadedModel->AddTextureToAllMeshes(mySkybox->GetBRDFLookupTexture());
-		}
-
 		myNewSkyboxShouldBeLoaded = GL_FALSE;
 	}
 
 	GLint currentWindowWidth, currentWindowHeight;
 	glfwGetWindowSize(myWindowContext, &currentWindowWidth, &currentWindowHeight);
 
-	// Prevent divide-by-zero error within glm (aspect ratio).
-	if (currentWindowHeight == 0)
-	{
-		currentWindowHeight = 1;
-	}
-
-	const glm::mat4 projection = glm::perspective(glm::radians(myCamera->GetZoom()),
-	                                              static_cast<GLfloat>(currentWindowWidth) /
-	                                              static_cast<GLfloat>(currentWindowHeight),
-	                                              0.1f,
-	                                              50.0f);
+	const glm::mat4 projection = GetProjectionMatrix(currentWindowWidth, currentWindowHeight);
 	const glm::mat4 view = myCamera->GetViewMatrix();
 
-	DrawLightSources(view, projection);
+	UpdateUniformBlocks(view, projection);
+	DrawLightSources();
 
 	if (myLoadedModel)
 	{
@@ -320,14 +292,13 @@ GLvoid PBRViewerModel::DrawOpenGL()
 		}
 
 		SetLightingShader();
-		DrawModel(view, projection);
-		RemoveShadowTexturesFromModel();
+		DrawModel(view, projection, currentWindowHeight);
 	}
 
 	// Draw the skybox last
 	if (mySkybox)
 	{
-		DrawSkybox(projection);
+		DrawSkybox();
 	}
 }
 
@@ -349,21 +320,35 @@ PBRViewerEnumerations::LightingVariant PBRViewerModel::GetCurrentLightingVariant
 	return myLightingVariant;
 }
 
-GLvoid PBRViewerModel::DrawSkybox( const glm::mat4 projection ) const
+/// <summary>
+/// Gets the projection matrix of the camera for the current window size.
+/// </summary>
+/// <param name="windowWidth">The width of the window.</param>
+/// <param name="windowHeight">The height of the window.</param>
+/// <returns>The projection matrix.</returns>
+glm::mat4 PBRViewerModel::GetProjectionMatrix( const GLint windowWidth, GLint windowHeight ) const
 {
-	mySkyboxShader->Use();
+	// Prevent divide-by-zero error within glm (aspect ratio).
+	if (windowHeight == 0)
+	{
+		windowHeight = 1;
+	}
 
-	// Remove translation from the view matrix
-	const glm::mat4 viewMatrixSkybox = glm::mat4(glm::mat3(myCamera->GetViewMatrix()));
-	mySkyboxShader->setMat4("view", viewMatrixSkybox);
-	mySkyboxShader->setMat4("projection", projection);
-	mySkyboxShader->setFloat("gamma", myGamma);
-	mySkyboxShader->setFloat("exposure", myExposure);
+	return glm::perspective(glm::radians(myCamera->GetZoom()),
+	                        static_cast<GLfloat>(windowWidth) /
+	                        static_cast<GLfloat>(windowHeight),
+	                        0.1f,
+	                        50.0f);
+}
 
+GLvoid PBRViewerModel::DrawSkybox() const
+{
+	// The matrices, gamma and exposure are read from the frame block. The shader removes the translation from the view matrix itself.
+	mySkyboxShader->Use();
 	mySkybox->Draw(mySkyboxShader);
 }
 
-GLvoid PBRViewerModel::DrawLightSources( const glm::mat4 view, const glm::mat4 projection ) const
+GLvoid PBRViewerModel::DrawLightSources() const
 {
 	for (const PBRViewerPointLight& light : myLightSources)
 	{
@@ -377,81 +362,144 @@ GLvoid PBRViewerModel::DrawLightSources( const glm::mat4 view, const glm::mat4 p
 		// =================================================================================================
 		model = translate(model, glm::vec3(0.0f, 0.5f, 0.0f));
 
-		light.Draw(model, view, projection);
+		light.Draw(model);
 	}
 }
 
-GLvoid PBRViewerModel::DrawModel( const glm::mat4 view, const glm::mat4 projection ) const
+/// <summary>
+/// Writes the frame, light and BRDF blocks shared by all shaders. Each block is written with a single call and only if one of its fields is dirty.
+/// The camera and the model matrix are compared with their values of the last frame, since they are changed by the callbacks of the mouse directly.
+/// </summary>
+/// <param name="view">The view matrix of the camera.</param>
+/// <param name="projection">The projection matrix of the camera.</param>
+GLvoid PBRViewerModel::UpdateUniformBlocks( const glm::mat4 view, const glm::mat4 projection )
 {
-	myCurrentLightShader->Use();
-	myCurrentLightShader->setMat4("model", myLoadedModel->GetModelMatrix());
-	myCurrentLightShader->setMat4("view", view);
-	myCurrentLightShader->setMat4("projection", projection);
-	myCurrentLightShader->setVec3("camPos", myCamera->GetCameraPosition());
+	myNumberOfBlockUploads = 0u;
+	PBRViewerShader::ResetStatistics();
 
-	for (GLuint i = 0; i < myLightSources.size(); ++i)
+	myParameters.Set(PBRViewerEnumerations::ParameterView, myViewMatrix, view);
+	myParameters.Set(PBRViewerEnumerations::ParameterProjection, myProjectionMatrix, projection);
+	myParameters.Set(PBRViewerEnumerations::ParameterCameraPosition, myCameraPosition, myCamera->GetCameraPosition());
+	if (myLoadedModel)
 	{
-		myCurrentLightShader->setVec3("lightPositions[" + std::to_string(i) + "]", myLightSources[i].GetPosition());
-		myCurrentLightShader->setVec3("lightColors[" + std::to_string(i) + "]", myLightSources[i].GetLightColor());
-		myCurrentLightShader->setBool("isLightActive[" + std::to_string(i) + "]", myLightSources[i].GetIsActive());
+		myParameters.Set(PBRViewerEnumerations::ParameterModelMatrix, myModelMatrix, myLoadedModel->GetModelMatrix());
+	}
 
-		if (myLightSources[i].GetIsActive())
-		{
-			// Light space matrices for shadow calculation.
-			glm::mat4 lightSpaceMatrix = myShadows->GetShadowProjectionMatrix() * lookAt(myLightSources[i].GetPosition(),
-			                                                                             glm::vec3(0.0f),
-			                                                                             glm::vec3(0.0f, 1.0f, 0.0f));
+	const GLuint version = myParameters.GetVersion();
 
-			myCurrentLightShader->setMat4("lightSpaceMatrices[" + std::to_string(i) + "]", lightSpaceMatrix);
-		}
+	if (myParameters.IsDirty(PBRViewerEnumerations::ParameterView, PBRViewerEnumerations::ParameterDebugOutput, myFrameBuffer->GetUploadedVersion()))
+	{
+		FrameBlock frame = {};
+		frame.View = myViewMatrix;
+		frame.Projection = myProjectionMatrix;
+		frame.CameraPosition = myCameraPosition;
+		frame.Gamma = myGamma;
+		frame.Exposure = myExposure;
+		frame.RenderOutput = myRenderOutput;
+		frame.DebugOutput = myDebugOutput;
+		myFrameBuffer->Update(&frame, version);
+		myNumberOfBlockUploads++;
 	}
 
-	// Blinn-Phong
-	myCurrentLightShader->setInt("blinnPhongExponent", myBlinnPhongExponent);
+	if (myParameters.IsDirty(PBRViewerEnumerations::ParameterLights, PBRViewerEnumerations::ParameterShadowsEnabled, myLightBuffer->GetUploadedVersion()))
+	{
+		LightBlock lights = {};
+		const size_t numberOfLights = std::min(myLightSources.size(), static_cast<size_t>(NumberOfLights));
+		for (size_t i = 0; i < numberOfLights; ++i)
+		{
+			lights.Positions[i] = glm::vec4(myLightSources[i].GetPosition(), 1.0f);
+			lights.Colors[i] = glm::vec4(myLightSources[i].GetLightColor(), 1.0f);
+			lights.IsActive[i].x = myLightSources[i].GetIsActive();
 
-	// Ashikhmin-Shirley
-	myCurrentLightShader->setInt("n_u", myAshikhminShirleyNu);
-	myCurrentLightShader->setInt("n_v", myAshikhminShirleyNv);
+			// Light space matrices for shadow calculation.
+			lights.LightSpaceMatrices[i] = glm::mat4(1.0f);
+			if (myShadows && myLightSources[i].GetIsActive())
+			{
+				lights.LightSpaceMatrices[i] = myShadows->GetShadowProjectionMatrix() * lookAt(myLightSources[i].GetPosition(),
+				                                                                               glm::vec3(0.0f),
+				                                                                               glm::vec3(0.0f, 1.0f, 0.0f));
+			}
+		}
 
-	// Cook-Torrance
-	myCurrentLightShader->setInt("diffuseTerm", myCookTorranceDiffuseTerm);
-	myCurrentLightShader->setInt("fresnelTerm", myCookTorranceFresnelTerm);
-	myCurrentLightShader->setInt("normalDistributionTerm", myCookTorranceNormalDistributionTerm);
-	myCurrentLightShader->setInt("geometryTerm", myCookTorranceGeometryTerm);
+		lights.ShadowsEnabled = myAreShadowsEnabled;
+		myLightBuffer->Update(&lights, version);
+		myNumberOfBlockUploads++;
+	}
 
-	if (myCookTorranceAreCustomMaterialValuesEnabled)
+	if (myParameters.IsDirty(PBRViewerEnumerations::ParameterBlinnPhongExponent, PBRViewerEnumerations::ParameterClearcoatGloss, myBrdfBuffer->GetUploadedVersion()))
 	{
-		myCurrentLightShader->setBool("customMaterialValuesEnabled", GL_TRUE);
-		myCurrentLightShader->setFloat("customMetalness", myCookTorranceMetalness);
-		myCurrentLightShader->setFloat("customRoughness", myCookTorranceRoughness);
+		BrdfBlock brdf = {};
+		brdf.BlinnPhongExponent = static_cast<GLint>(myBlinnPhongExponent);
+		brdf.Nu = static_cast<GLint>(myAshikhminShirleyNu);
+		brdf.Nv = static_cast<GLint>(myAshikhminShirleyNv);
+		brdf.DiffuseTerm = myCookTorranceDiffuseTerm;
+		brdf.FresnelTerm = myCookTorranceFresnelTerm;
+		brdf.NormalDistributionTerm = myCookTorranceNormalDistributionTerm;
+		brdf.GeometryTerm = myCookTorranceGeometryTerm;
+		brdf.CustomMaterialValuesEnabled = myCookTorranceAreCustomMaterialValuesEnabled;
+		brdf.CustomMetalness = myCookTorranceMetalness;
+		brdf.CustomRoughness = myCookTorranceRoughness;
+		brdf.Subsurface = myDisneySubsurface;
+		brdf.Metallic = myDisneyMetallic;
+		brdf.Specular = myDisneySpecular;
+		brdf.SpecularTint = myDisneySpecularTint;
+		brdf.Roughness = myDisneyRoughness;
+		brdf.Anisotropic = myDisneyAnisotropic;
+		brdf.Sheen = myDisneySheen;
+		brdf.SheenTint = myDisneySheenTint;
+		brdf.Clearcoat = myDisneyClearcoat;
+		brdf.ClearcoatGloss = myDisneyClearcoatGloss;
+		myBrdfBuffer->Update(&brdf, version);
+		myNumberOfBlockUploads++;
 	}
-	else
+}
+
+GLvoid PBRViewerModel::DrawModel( const glm::mat4 view, const glm::mat4 projection, const GLint viewportHeight )
+{
+	myCurrentLightShader->Use();
+
+	// Each program holds its own model matrix, so it is uploaded if the matrix has changed since the program was drawn last.
+	// Everything else is read from the uniform blocks, which are up to date for the whole frame.
+	if (myParameters.IsDirty(PBRViewerEnumerations::ParameterModelMatrix, PBRViewerEnumerations::ParameterModelMatrix, myCurrentLightShader->GetUploadedVersion()))
 	{
-		myCurrentLightShader->setBool("customMaterialValuesEnabled", GL_FALSE);
+		myCurrentLightShader->setMat4(PBRViewerEnumerations::UniformModel, myModelMatrix);
+		myCurrentLightShader->SetUploadedVersion(myParameters.GetVersion());
 	}
 
-	// Disney
-	myCurrentLightShader->setFloat("subsurface", myDisneySubsurface);
-	myCurrentLightShader->setFloat("metallic", myDisneyMetallic);
-	myCurrentLightShader->setFloat("specular", myDisneySpecular);
-	myCurrentLightShader->setFloat("specularTint", myDisneySpecularTint);
-	myCurrentLightShader->setFloat("roughness", myDisneyRoughness);
-	myCurrentLightShader->setFloat("anisotropic", myDisneyAnisotropic);
-	myCurrentLightShader->setFloat("sheen", myDisneySheen);
-	myCurrentLightShader->setFloat("sheenTint", myDisneySheenTint);
-	myCurrentLightShader->setFloat("clearcoat", myDisneyClearcoat);
-	myCurrentLightShader->setFloat("clearcoatGloss", myDisneyClearcoatGloss);
+	BindSharedTextures();
+
+	// The light passes cull whole meshes only, the meshlet cone and frustum culling is done for the camera pass alone.
+	myLoadedModel->Cull(view, projection, viewportHeight, MaximumLodPixelError);
+	myLoadedModel->Draw(myCurrentLightShader, GL_TRUE);
+}
 
-	// General settings
-	myCurrentLightShader->setBool("shadowsEnabled", myAreShadowsEnabled);
+/// <summary>
+/// Binds the textures shared by all meshes to their slots, i. e. the image based lighting textures of the skybox and the shadow maps.
+/// The meshes only bind their material slots, so these bindings last for the whole pass.
+/// </summary>
+GLvoid PBRViewerModel::BindSharedTextures() const
+{
+	const GLboolean hasSkybox = nullptr != mySkybox;
+	if (hasSkybox)
+	{
+		// The irradiance map and the prefiltered environment map are cubemap textures and not plain 2D ones.
+		PBRViewerStateCache::BindTexture(PBRViewerEnumerations::TextureIrradiance, GL_TEXTURE_CUBE_MAP, mySkybox->GetIrradianceTexture().ID);
+		PBRViewerStateCache::BindTexture(PBRViewerEnumerations::TexturePreFilterEnvironment, GL_TEXTURE_CUBE_MAP,
+		                                 mySkybox->GetPreFilteredEnvironmentMap().ID);
+		PBRViewerStateCache::BindTexture(PBRViewerEnumerations::TextureBRDFLookup, GL_TEXTURE_2D, mySkybox->GetBRDFLookupTexture().ID);
+	}
 
-	myCurrentLightShader->setInt("renderOutput", myRenderOutput);
-	myCurrentLightShader->setInt("debugOutput", myDebugOutput);
+	myCurrentLightShader->SetTextureAvailable(PBRViewerEnumerations::TextureIrradiance, hasSkybox);
+	myCurrentLightShader->SetTextureAvailable(PBRViewerEnumerations::TexturePreFilterEnvironment, hasSkybox);
+	myCurrentLightShader->SetTextureAvailable(PBRViewerEnumerations::TextureBRDFLookup, hasSkybox);
 
-	myCurrentLightShader->setFloat("gamma", myGamma);
-	myCurrentLightShader->setFloat("exposure", myExposure);
+	// The shadow map of each light source has its own unit.
+	for (GLuint i = 0; i < myShadowTextures.size(); ++i)
+	{
+		PBRViewerStateCache::BindTexture(PBRViewerEnumerations::TextureShadows + i, GL_TEXTURE_2D, myShadowTextures[i].ID);
+	}
 
-	myLoadedModel->Draw(myCurrentLightShader);
+	myCurrentLightShader->SetTextureAvailable(PBRViewerEnumerations::TextureShadows, !myShadowTextures.empty());
 }
 
 GLvoid PBRViewerModel::SetLightingShader()
@@ -491,24 +539,221 @@ GLvoid PBRViewerModel::SetLightingShader()
 /// <param name="filepathNewModel">The filepath of the new model.</param>
 GLvoid PBRViewerModel::LoadNewModel( const std::string& filepathNewModel )
 {
-	myNewModelFilepath = filepathNewModel;
-	myNewModelShouldBeLoaded = GL_TRUE;
+	CancelModelLoading();
+
+	mySceneImporter = std::make_unique<PBRViewerSceneImporter>(filepathNewModel, myImportPreset, myUseNativeLoaders);
+	mySceneImporter->ImportAsync();
 
 	// Reset transformations in case a model was loaded beforehand.
 	ResetModelTransformations();
 }
 
+/// <summary>
+/// Sets the import preset used for the next loaded model.
+/// </summary>
+/// <param name="importPreset">The import preset.</param>
+GLvoid PBRViewerModel::SetImportPreset( const PBRViewerEnumerations::ImportPreset importPreset )
+{
+	myImportPreset = importPreset;
+}
+
+/// <summary>
+/// Sets if glTF and OBJ files of the next loaded model are read without ASSIMP.
+/// </summary>
+/// <param name="useNativeLoaders">True to use the native glTF and OBJ loaders, false to read every model with ASSIMP.</param>
+GLvoid PBRViewerModel::SetUseNativeLoaders( const GLboolean useNativeLoaders )
+{
+	myUseNativeLoaders = useNativeLoaders;
+}
+
 /// <summary>
 /// Clears the model.
 /// </summary>
 GLvoid PBRViewerModel::ClearModel()
 {
-	if (mySkybox)
+	CancelModelLoading();
+
+	ReleaseLoadedModel();
+}
+
+/// <summary>
+/// Gets a flag indicating if a model is currently imported in the background.
+/// </summary>
+/// <returns>True if a model is being imported, false if not.</returns>
+GLboolean PBRViewerModel::IsModelLoading() const
+{
+	return nullptr != mySceneImporter;
+}
+
+/// <summary>
+/// Gets the progress of the current model import in the range [0, 1].
+/// </summary>
+/// <returns>The progress of the import or 0 if no model is being imported.</returns>
+GLfloat PBRViewerModel::GetModelLoadingProgress() const
+{
+	if (nullptr == mySceneImporter)
 	{
-		myLoadedModel->RemoveTextureFromAllMeshes(mySkybox->GetIrradianceTexture());
+		return 0.0f;
 	}
 
-	myLoadedModel.reset();
+	return mySceneImporter->GetProgress();
+}
+
+/// <summary>
+/// Gets the number of triangles of the loaded model which were culled by the camera pass within the last frame, as shown by the model loader window.
+/// The shadow passes are not included. The triangles are counted at the levels of detail the camera pass selected within the same frame.
+/// </summary>
+/// <returns>The number of culled triangles or 0 if no model is loaded.</returns>
+GLuint PBRViewerModel::GetNumberOfCulledTriangles() const
+{
+	if (nullptr == myLoadedModel)
+	{
+		return 0u;
+	}
+
+	return myLoadedModel->GetNumberOfCulledTriangles();
+}
+
+/// <summary>
+/// Gets the number of meshes of the loaded model which passed the frustum culling of the camera within the last frame.
+/// </summary>
+/// <returns>The number of visible meshes or 0 if no model is loaded.</returns>
+GLuint PBRViewerModel::GetNumberOfVisibleMeshes() const
+{
+	if (nullptr == myLoadedModel)
+	{
+		return 0u;
+	}
+
+	return myLoadedModel->GetNumberOfVisibleMeshes();
+}
+
+/// <summary>
+/// Gets the number of meshes of the loaded model.
+/// </summary>
+/// <returns>The number of meshes or 0 if no model is loaded.</returns>
+GLuint PBRViewerModel::GetNumberOfMeshes() const
+{
+	if (nullptr == myLoadedModel)
+	{
+		return 0u;
+	}
+
+	return myLoadedModel->GetNumberOfMeshes();
+}
+
+/// <summary>
+/// Gets the number of meshes which passed the frustum culling of the light sources within the last frame, summed over all light sources.
+/// </summary>
+/// <returns>The number of meshes drawn into the shadow maps or 0 if no model is loaded or the shadows are disabled.</returns>
+GLuint PBRViewerModel::GetNumberOfVisibleShadowMeshes() const
+{
+	if (nullptr == myLoadedModel || nullptr == myShadows || !myAreShadowsEnabled)
+	{
+		return 0u;
+	}
+
+	return myShadows->GetNumberOfVisibleMeshes();
+}
+
+/// <summary>
+/// Gets the number of meshes tested against the frustums of the light sources within the last frame, summed over all light sources.
+/// </summary>
+/// <returns>The number of tested meshes or 0 if no model is loaded or the shadows are disabled.</returns>
+GLuint PBRViewerModel::GetNumberOfShadowMeshes() const
+{
+	if (nullptr == myLoadedModel || nullptr == myShadows || !myAreShadowsEnabled)
+	{
+		return 0u;
+	}
+
+	return myShadows->GetNumberOfTestedMeshes();
+}
+
+/// <summary>
+/// Gets the number of parameter uploads within the last frame, i. e. the written uniform blocks and the uniforms uploaded to any program.
+/// The uniform blocks and the model matrix are only uploaded if their parameters have changed. The uniforms set per draw batch or per pass,
+/// e. g. the texture flags or the light space matrix of each shadow pass, are uploaded every frame.
+/// </summary>
+/// <returns>The number of parameter uploads.</returns>
+GLuint PBRViewerModel::GetNumberOfParameterUploads() const
+{
+	return myNumberOfBlockUploads + PBRViewerShader::GetNumberOfUniformUploads();
+}
+
+/// <summary>
+/// Cancels the running model import (if any).
+/// The importer is kept alive until its worker thread has stopped so the render thread never waits for it.
+/// </summary>
+GLvoid PBRViewerModel::CancelModelLoading()
+{
+	if (mySceneImporter)
+	{
+		mySceneImporter->Cancel();
+		myCancelledSceneImporters.push_back(std::move(mySceneImporter));
+	}
+}
+
+/// <summary>
+/// Destroys cancelled importers whose worker thread has finished.
+/// </summary>
+GLvoid PBRViewerModel::ReleaseCancelledSceneImporters()
+{
+	myCancelledSceneImporters.erase(std::remove_if(myCancelledSceneImporters.begin(),
+	                                               myCancelledSceneImporters.end(),
+	                                               []( std::unique_ptr<PBRViewerSceneImporter> const& importer )
+	                                               {
+		                                               return importer->IsFinished();
+	                                               }),
+	                                myCancelledSceneImporters.end());
+}
+
+/// <summary>
+/// Uploads the finished import to the GPU and replaces the currently loaded model with it.
+/// </summary>
+GLvoid PBRViewerModel::SwapInImportedModel()
+{
+	if (GL_FALSE == mySceneImporter->IsSuccessful())
+	{
+		mySceneImporter.reset();
+		return;
+	}
+
+	// Release the old model before the new one is uploaded, so its ranges of the shared buffers are reused instead of growing them.
+	// Its textures stay within the texture cache, so the new model still acquires the ones they share.
+	// Both happen within the same frame, so the old model is still replaced in a single step.
+	ReleaseLoadedModel();
+
+	myLoadedModel = std::make_shared<PBRViewerScene>(mySceneImporter->TakeSceneData());
+	mySceneImporter.reset();
+
+	// Generate shadow textures for the new model. The light space matrices depend on the shadows.
+	myShadows = std::make_unique<PBRViewerShadows>(myLoadedModel);
+	myParameters.MarkChanged(PBRViewerEnumerations::ParameterLights);
+
+	myShadowTextures = myShadows->CreateSelfShadowingTextures(static_cast<GLuint>(myLightSources.size()));
+}
+
+/// <summary>
+/// Releases the loaded model and its shadows (if any).
+/// The shadows hold the model as well, so both are cleaned up to return the ranges of the shared buffers and the references to the cached textures.
+/// </summary>
+GLvoid PBRViewerModel::ReleaseLoadedModel()
+{
+	if (myShadows)
+	{
+		myShadows->Cleanup();
+		myShadows.reset();
+		myParameters.MarkChanged(PBRViewerEnumerations::ParameterLights);
+	}
+
+	myShadowTextures.clear();
+
+	if (myLoadedModel)
+	{
+		myLoadedModel->Cleanup();
+		myLoadedModel.reset();
+	}
 }
 
 /// <summary>
@@ -526,13 +771,6 @@ GLvoid PBRViewerModel::LoadNewSkybox( const std::string& filepathNewSkybox )
 /// </summary>
 GLvoid PBRViewerModel::ClearSkybox()
 {
-	if (myLoadedModel)
-	{
-		myLoadedModel->RemoveTextureFromAllMeshes(mySkybox->GetIrradianceTexture());
-		myLoadedModel->RemoveTextureFromAllMeshes(mySkybox->GetPreFilteredEnvironmentMap());
-		myLoadedModel->RemoveTextureFromAllMeshes(mySkybox->GetBRDFLookupTexture());
-	}
-
 	mySkybox->Cleanup();
 	mySkybox.reset();
 }
@@ -553,7 +791,7 @@ GLvoid PBRViewerModel::ChangeLighting( const PBRViewerEnumerations::LightingVari
 GLvoid PBRViewerModel::ChangeNormalDistributionTerm(
 	const PBRViewerEnumerations::NormalDistributionTerm normalDistributionTerm )
 {
-	myCookTorranceNormalDistributionTerm = normalDistributionTerm;
+	myParameters.Set(PBRViewerEnumerations::ParameterNormalDistributionTerm, myCookTorranceNormalDistributionTerm, normalDistributionTerm);
 }
 
 /// <summary>
@@ -567,6 +805,7 @@ GLvoid PBRViewerModel::SetLightingColor( glm::vec3 rgb )
 		// Multiply by five because our light strength equals five and not one.
 		light.SetLightColor(rgb.operator*=(5));
 	}
+	myParameters.MarkChanged(PBRViewerEnumerations::ParameterLights);
 }
 
 /// <summary>
@@ -575,7 +814,7 @@ GLvoid PBRViewerModel::SetLightingColor( glm::vec3 rgb )
 /// <param name="renderOutput">The render output.</param>
 GLvoid PBRViewerModel::ChangeRenderOutput( const PBRViewerEnumerations::RenderOutput renderOutput )
 {
-	myRenderOutput = renderOutput;
+	myParameters.Set(PBRViewerEnumerations::ParameterRenderOutput, myRenderOutput, renderOutput);
 }
 
 /// <summary>
@@ -597,6 +836,114 @@ GLboolean PBRViewerModel::GetMouseProcessing() const
 	return myMouseShouldBeProcessed;
 }
 
+/// <summary>
+/// Picks the surface point of the loaded model under the cursor and prints its mesh, material textures, normal and the BRDF inputs to the log.
+/// </summary>
+/// <param name="cursorPosX">The x-coordinate of the cursor in screen coordinates of the window.</param>
+/// <param name="cursorPosY">The y-coordinate of the cursor in screen coordinates of the window.</param>
+/// <returns>True if the cursor is over the model, false if not.</returns>
+GLboolean PBRViewerModel::Pick( const GLdouble cursorPosX, const GLdouble cursorPosY ) const
+{
+	if (nullptr == myLoadedModel)
+	{
+		return GL_FALSE;
+	}
+
+	GLint currentWindowWidth, currentWindowHeight;
+	glfwGetWindowSize(myWindowContext, &currentWindowWidth, &currentWindowHeight);
+
+	if (currentWindowWidth <= 0 || currentWindowHeight <= 0)
+	{
+		return GL_FALSE;
+	}
+
+	// Unproject the cursor onto the near and the far plane. The y-coordinates of the cursor go from top to bottom.
+	const glm::mat4 inverseViewProjection = glm::inverse(GetProjectionMatrix(currentWindowWidth, currentWindowHeight) * myCamera->GetViewMatrix());
+	const GLfloat x = 2.0f * static_cast<GLfloat>(cursorPosX) / static_cast<GLfloat>(currentWindowWidth) - 1.0f;
+	const GLfloat y = 1.0f - 2.0f * static_cast<GLfloat>(cursorPosY) / static_cast<GLfloat>(currentWindowHeight);
+
+	const glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+	const glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+	const glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+	const glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+
+	PBRViewerRayHit hit;
+	if (GL_FALSE == myLoadedModel->Pick(origin, direction, hit))
+	{
+		PBRViewerLogger::PrintInfoMessage("No surface under the cursor.");
+		return GL_FALSE;
+	}
+
+	std::stringstream message;
+	message << std::fixed << std::setprecision(3);
+	message << "Picked mesh " << hit.Mesh << ", triangle " << hit.Triangle << std::endl;
+	message << "Position: (" << hit.Position.x << ", " << hit.Position.y << ", " << hit.Position.z << ")" << std::endl;
+	message << "Normal: (" << hit.Normal.x << ", " << hit.Normal.y << ", " << hit.Normal.z << ")" << std::endl;
+
+	const std::vector<PBRViewerTexture> materialTextures = myLoadedModel->GetMaterialTextures(hit.Mesh);
+	if (materialTextures.empty())
+	{
+		message << "Material: no textures" << std::endl;
+	}
+
+	for (const PBRViewerTexture& texture : materialTextures)
+	{
+		message << "Material: " << PBRViewerTexture::GetSlotName(texture.Slot) << " " << texture.Filepath << std::endl;
+	}
+
+	message << "BRDF inputs: " << GetBrdfInputs();
+	PBRViewerLogger::PrintInfoMessage(message.str());
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Describes the inputs of the current lighting variant which are not read from the material textures.
+/// </summary>
+/// <returns>The name of the lighting variant and its parameters.</returns>
+std::string PBRViewerModel::GetBrdfInputs() const
+{
+	std::stringstream inputs;
+	inputs << std::fixed << std::setprecision(2);
+
+	switch (myLightingVariant)
+	{
+		case PBRViewerEnumerations::LightingVariant::NoLighting:
+			inputs << "No lighting";
+			break;
+		case PBRViewerEnumerations::LightingVariant::BlinnPhong:
+			inputs << "Blinn-Phong, exponent " << myBlinnPhongExponent;
+			break;
+		case PBRViewerEnumerations::LightingVariant::CookTorrance:
+			inputs << "Cook-Torrance, ";
+			if (myCookTorranceAreCustomMaterialValuesEnabled)
+			{
+				inputs << "metalness " << myCookTorranceMetalness << ", roughness " << myCookTorranceRoughness;
+			}
+			else
+			{
+				inputs << "metalness and roughness of the material";
+			}
+			break;
+		case PBRViewerEnumerations::LightingVariant::OrenNayar:
+			inputs << "Oren-Nayar, roughness of the material";
+			break;
+		case PBRViewerEnumerations::LightingVariant::AshikhminShirley:
+			inputs << "Ashikhmin-Shirley, n_u " << myAshikhminShirleyNu << ", n_v " << myAshikhminShirleyNv;
+			break;
+		case PBRViewerEnumerations::LightingVariant::Debug:
+			inputs << "Debug output " << myDebugOutput;
+			break;
+		case PBRViewerEnumerations::LightingVariant::Disney:
+			inputs << "Disney, subsurface " << myDisneySubsurface << ", metallic " << myDisneyMetallic << ", specular " << myDisneySpecular
+				<< ", specular tint " << myDisneySpecularTint << ", roughness " << myDisneyRoughness << ", anisotropic " << myDisneyAnisotropic
+				<< ", sheen " << myDisneySheen << ", sheen tint " << myDisneySheenTint << ", clearcoat " << myDisneyClearcoat
+				<< ", clearcoat gloss " << myDisneyClearcoatGloss;
+			break;
+	}
+
+	return inputs.str();
+}
+
 /// <summary>
 /// Rotates the model.
 /// </summary>
@@ -735,6 +1082,7 @@ GLvoid PBRViewerModel::ResetModelTransformations() const
 GLvoid PBRViewerModel::ActivateLightSource( const GLint number )
 {
 	myLightSources[number].SetIsActive(GL_TRUE);
+	myParameters.MarkChanged(PBRViewerEnumerations::ParameterLights);
 }
 
 /// <summary>
@@ -744,6 +1092,7 @@ GLvoid PBRViewerModel::ActivateLightSource( const GLint number )
 GLvoid PBRViewerModel::DisableLightSource( const GLint number )
 {
 	myLightSources[number].SetIsActive(GL_FALSE);
+	myParameters.MarkChanged(PBRViewerEnumerations::ParameterLights);
 }
 
 /// <summary>
@@ -752,7 +1101,7 @@ GLvoid PBRViewerModel::DisableLightSource( const GLint number )
 /// <param name="value">The gamma value.</param>
 GLvoid PBRViewerModel::SetGamma( const GLfloat value )
 {
-	myGamma = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterGamma, myGamma, value);
 }
 
 /// <summary>
@@ -761,7 +1110,7 @@ GLvoid PBRViewerModel::SetGamma( const GLfloat value )
 /// <param name="value">The exposure value.</param>	
 GLvoid PBRViewerModel::SetExposure( const GLfloat value )
 {
-	myExposure = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterExposure, myExposure, value);
 }
 
 /// <summary>
@@ -770,7 +1119,7 @@ GLvoid PBRViewerModel::SetExposure( const GLfloat value )
 /// <param name="value">The user-defined metalness value.</param>
 GLvoid PBRViewerModel::SetCustomMetalness( const GLfloat value )
 {
-	myCookTorranceMetalness = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterCustomMetalness, myCookTorranceMetalness, value);
 }
 
 /// <summary>
@@ -779,7 +1128,7 @@ GLvoid PBRViewerModel::SetCustomMetalness( const GLfloat value )
 /// <param name="value">The user-defined roughness value.</param>
 GLvoid PBRViewerModel::SetCustomRoughness( const GLfloat value )
 {
-	myCookTorranceRoughness = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterCustomRoughness, myCookTorranceRoughness, value);
 }
 
 /// <summary>
@@ -788,7 +1137,7 @@ GLvoid PBRViewerModel::SetCustomRoughness( const GLfloat value )
 /// <param name="activated">The value of the flag.</param>	
 GLvoid PBRViewerModel::SetEnableCustomMaterialValues( const GLboolean activated )
 {
-	myCookTorranceAreCustomMaterialValuesEnabled = activated;
+	myParameters.Set(PBRViewerEnumerations::ParameterCustomMaterialValuesEnabled, myCookTorranceAreCustomMaterialValuesEnabled, activated);
 }
 
 /// <summary>
@@ -825,7 +1174,7 @@ GLvoid PBRViewerModel::SetSkyboxTextureMipMapLevel( const GLuint currentMipMapLe
 /// <param name="currentExponent">The value of the exponent.</param>
 GLvoid PBRViewerModel::SetBlinnPhongExponent( const GLuint currentExponent )
 {
-	myBlinnPhongExponent = currentExponent;
+	myParameters.Set(PBRViewerEnumerations::ParameterBlinnPhongExponent, myBlinnPhongExponent, currentExponent);
 }
 
 /// <summary>
@@ -834,7 +1183,7 @@ GLvoid PBRViewerModel::SetBlinnPhongExponent( const GLuint currentExponent )
 /// <param name="activated">The value of the flag.</param>	
 GLvoid PBRViewerModel::SetEnableShadows( const GLboolean activated )
 {
-	myAreShadowsEnabled = activated;
+	myParameters.Set(PBRViewerEnumerations::ParameterShadowsEnabled, myAreShadowsEnabled, activated);
 }
 
 /// <summary>
@@ -843,7 +1192,7 @@ GLvoid PBRViewerModel::SetEnableShadows( const GLboolean activated )
 /// <param name="currentDebugOutput">The output of the debug shader.</param>
 GLvoid PBRViewerModel::SetDebugOutput( const PBRViewerEnumerations::DebugOutput currentDebugOutput )
 {
-	myDebugOutput = currentDebugOutput;
+	myParameters.Set(PBRViewerEnumerations::ParameterDebugOutput, myDebugOutput, currentDebugOutput);
 }
 
 /// <summary>
@@ -852,7 +1201,7 @@ GLvoid PBRViewerModel::SetDebugOutput( const PBRViewerEnumerations::DebugOutput
 /// <param name="currentDiffuseTerm">The diffuse term to use.</param>
 GLvoid PBRViewerModel::SetDiffuseTerm( const PBRViewerEnumerations::DiffuseTerm currentDiffuseTerm )
 {
-	myCookTorranceDiffuseTerm = currentDiffuseTerm;
+	myParameters.Set(PBRViewerEnumerations::ParameterDiffuseTerm, myCookTorranceDiffuseTerm, currentDiffuseTerm);
 }
 
 /// <summary>
@@ -861,7 +1210,7 @@ GLvoid PBRViewerModel::SetDiffuseTerm( const PBRViewerEnumerations::DiffuseTerm
 /// <param name="currentNu">The value of n_u.</param>	
 GLvoid PBRViewerModel::SetAshikhminShirleyNu( const GLuint currentNu )
 {
-	myAshikhminShirleyNu = currentNu;
+	myParameters.Set(PBRViewerEnumerations::ParameterNu, myAshikhminShirleyNu, currentNu);
 }
 
 /// <summary>
@@ -870,7 +1219,7 @@ GLvoid PBRViewerModel::SetAshikhminShirleyNu( const GLuint currentNu )
 /// <param name="currentNv">The value of n_v.</param>
 GLvoid PBRViewerModel::SetAshikhminShirleyNv( const GLuint currentNv )
 {
-	myAshikhminShirleyNv = currentNv;
+	myParameters.Set(PBRViewerEnumerations::ParameterNv, myAshikhminShirleyNv, currentNv);
 }
 
 /// <summary>
@@ -879,7 +1228,7 @@ GLvoid PBRViewerModel::SetAshikhminShirleyNv( const GLuint currentNv )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneySubsurface( const GLfloat value )
 {
-	myDisneySubsurface = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterSubsurface, myDisneySubsurface, value);
 }
 
 /// <summary>
@@ -888,7 +1237,7 @@ GLvoid PBRViewerModel::SetDisneySubsurface( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneyMetallic( const GLfloat value )
 {
-	myDisneyMetallic = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterMetallic, myDisneyMetallic, value);
 }
 
 /// <summary>
@@ -897,7 +1246,7 @@ GLvoid PBRViewerModel::SetDisneyMetallic( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneySpecular( const GLfloat value )
 {
-	myDisneySpecular = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterSpecular, myDisneySpecular, value);
 }
 
 /// <summary>
@@ -906,7 +1255,7 @@ GLvoid PBRViewerModel::SetDisneySpecular( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneySpecularTint( const GLfloat value )
 {
-	myDisneySpecularTint = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterSpecularTint, myDisneySpecularTint, value);
 }
 
 /// <summary>
@@ -915,7 +1264,7 @@ GLvoid PBRViewerModel::SetDisneySpecularTint( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneyRoughness( const GLfloat value )
 {
-	myDisneyRoughness = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterRoughness, myDisneyRoughness, value);
 }
 
 /// <summary>
@@ -924,7 +1273,7 @@ GLvoid PBRViewerModel::SetDisneyRoughness( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneyAnisotropic( const GLfloat value )
 {
-	myDisneyAnisotropic = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterAnisotropic, myDisneyAnisotropic, value);
 }
 
 /// <summary>
@@ -933,7 +1282,7 @@ GLvoid PBRViewerModel::SetDisneyAnisotropic( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneySheen( const GLfloat value )
 {
-	myDisneySheen = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterSheen, myDisneySheen, value);
 }
 
 /// <summary>
@@ -942,7 +1291,7 @@ GLvoid PBRViewerModel::SetDisneySheen( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneySheenTint( const GLfloat value )
 {
-	myDisneySheenTint = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterSheenTint, myDisneySheenTint, value);
 }
 
 /// <summary>
@@ -951,7 +1300,7 @@ GLvoid PBRViewerModel::SetDisneySheenTint( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneyClearcoat( const GLfloat value )
 {
-	myDisneyClearcoat = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterClearcoat, myDisneyClearcoat, value);
 }
 
 /// <summary>
@@ -960,7 +1309,7 @@ GLvoid PBRViewerModel::SetDisneyClearcoat( const GLfloat value )
 /// <param name="value">The value.</param>	
 GLvoid PBRViewerModel::SetDisneyClearcoatGloss( const GLfloat value )
 {
-	myDisneyClearcoatGloss = value;
+	myParameters.Set(PBRViewerEnumerations::ParameterClearcoatGloss, myDisneyClearcoatGloss, value);
 }
 
 /// <summary>
@@ -982,6 +1331,20 @@ GLvoid PBRViewerModel::Cleanup() const
 	{
 		mySkybox->Cleanup();
 	}
+
+	if (myFrameBuffer)
+	{
+		myFrameBuffer->Cleanup();
+		myLightBuffer->Cleanup();
+		myBrdfBuffer->Cleanup();
+	}
+
+	// Delete the textures which are kept resident for later models.
+	PBRViewerTextureCache::GetInstance().Clear();
+
+	// Delete the vertex and index buffers shared by all meshes.
+	PBRViewerGeometryBuffer::GetInstance(PBRViewerEnumerations::FullPrecision).Clear();
+	PBRViewerGeometryBuffer::GetInstance(PBRViewerEnumerations::Quantized).Clear();
 }
 
 /// <summary>
@@ -990,7 +1353,7 @@ GLvoid PBRViewerModel::Cleanup() const
 /// <param name="fresnelTerm">The fresnel term.</param>
 GLvoid PBRViewerModel::ChangeFresnelTerm( const PBRViewerEnumerations::FresnelTerm fresnelTerm )
 {
-	myCookTorranceFresnelTerm = fresnelTerm;
+	myParameters.Set(PBRViewerEnumerations::ParameterFresnelTerm, myCookTorranceFresnelTerm, fresnelTerm);
 }
 
 /// <summary>
@@ -999,5 +1362,5 @@ GLvoid PBRViewerModel::ChangeFresnelTerm( const PBRViewerEnumerations::FresnelTe
 /// <param name="geometryTerm">The fresnel term.</param>
 GLvoid PBRViewerModel::ChangeGeometryTerm( const PBRViewerEnumerations::GeometryTerm geometryTerm )
 {
-	myCookTorranceGeometryTerm = geometryTerm;
+	myParameters.Set(PBRViewerEnumerations::ParameterGeometryTerm, myCookTorranceGeometryTerm, geometryTerm);
 }
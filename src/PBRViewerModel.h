@@ -6,11 +6,14 @@
 
 #include "PBRViewerShader.h"
 #include "PBRViewerScene.h"
+#include "PBRViewerSceneImporter.h"
 
 #include "PBRViewerArcballCamera.h"
 #include "PBRViewerSkybox.h"
 #include "PBRViewerShadows.h"
 #include "PBRViewerPointLight.h"
+#include "PBRViewerUniformBuffer.h"
+#include "PBRViewerParameterStore.h"
 
 // This class is the model in the MVC pattern.
 // It contains the OpenGL logic and the GLFW window.
@@ -54,11 +57,75 @@ public:
 	/// <param name="filepathNewModel">The filepath of the new model.</param>
 	GLvoid LoadNewModel( const std::string& filepathNewModel );
 
+	/// <summary>
+	/// Sets the import preset used for the next loaded model.
+	/// </summary>
+	/// <param name="importPreset">The import preset.</param>
+	GLvoid SetImportPreset( PBRViewerEnumerations::ImportPreset importPreset );
+
+	/// <summary>
+	/// Sets if glTF and OBJ files of the next loaded model are read without ASSIMP.
+	/// </summary>
+	/// <param name="useNativeLoaders">True to use the native glTF and OBJ loaders, false to read every model with ASSIMP.</param>
+	GLvoid SetUseNativeLoaders( GLboolean useNativeLoaders );
+
 	/// <summary>
 	/// Clears the model.
+	/// A running import is cancelled as well.
 	/// </summary>
 	GLvoid ClearModel();
 
+	/// <summary>
+	/// Gets a flag indicating if a model is currently imported in the background.
+	/// </summary>
+	/// <returns>True if a model is being imported, false if not.</returns>
+	GLboolean IsModelLoading() const;
+
+	/// <summary>
+	/// Gets the progress of the current model import in the range [0, 1].
+	/// </summary>
+	/// <returns>The progress of the import or 0 if no model is being imported.</returns>
+	GLfloat GetModelLoadingProgress() const;
+
+	/// <summary>
+	/// Gets the number of triangles of the loaded model which were culled by the camera pass within the last frame, as shown by the model loader window.
+	/// The shadow passes are not included. The triangles are counted at the levels of detail the camera pass selected within the same frame.
+	/// </summary>
+	/// <returns>The number of culled triangles or 0 if no model is loaded.</returns>
+	GLuint GetNumberOfCulledTriangles() const;
+
+	/// <summary>
+	/// Gets the number of meshes of the loaded model which passed the frustum culling of the camera within the last frame.
+	/// </summary>
+	/// <returns>The number of visible meshes or 0 if no model is loaded.</returns>
+	GLuint GetNumberOfVisibleMeshes() const;
+
+	/// <summary>
+	/// Gets the number of meshes of the loaded model.
+	/// </summary>
+	/// <returns>The number of meshes or 0 if no model is loaded.</returns>
+	GLuint GetNumberOfMeshes() const;
+
+	/// <summary>
+	/// Gets the number of meshes which passed the frustum culling of the light sources within the last frame, summed over all light sources.
+	/// </summary>
+	/// <returns>The number of meshes drawn into the shadow maps or 0 if no model is loaded or the shadows are disabled.</returns>
+	GLuint GetNumberOfVisibleShadowMeshes() const;
+
+	/// <summary>
+	/// Gets the number of meshes tested against the frustums of the light sources within the last frame, summed over all light sources.
+	/// </summary>
+	/// <returns>The number of tested meshes or 0 if no model is loaded or the shadows are disabled.</returns>
+	GLuint GetNumberOfShadowMeshes() const;
+
+	/// <summary>
+	/// Gets the number of parameter uploads within the last frame, i. e. the written uniform blocks and the uniforms uploaded to any program.
+	/// The uniform blocks and the model matrix are only uploaded if their parameters have changed. The uniforms set per draw batch or per pass,
+	/// e. g. the texture flags or the light space matrix of each shadow pass, are uploaded every frame.
+	/// </summary>
+	/// <returns>The number of parameter uploads.</returns>
+	GLuint GetNumberOfParameterUploads() const;
+
 	/// <summary>
 	/// Loads a new skybox from the specified filepath.
 	/// </summary>
@@ -118,6 +185,14 @@ public:
 	/// </summary>
 	/// <returns>True if the mouse should be processed, false if not.</returns>
 	GLboolean GetMouseProcessing() const;
+
+	/// <summary>
+	/// Picks the surface point of the loaded model under the cursor and prints its mesh, material textures, normal and the BRDF inputs to the log.
+	/// </summary>
+	/// <param name="cursorPosX">The x-coordinate of the cursor in screen coordinates of the window.</param>
+	/// <param name="cursorPosY">The y-coordinate of the cursor in screen coordinates of the window.</param>
+	/// <returns>True if the cursor is over the model, false if not.</returns>
+	GLboolean Pick( GLdouble cursorPosX, GLdouble cursorPosY ) const;
 	
 	/// <summary>
 	/// Rotates the model.
@@ -341,9 +416,15 @@ private:
 	GLvoid SetLightingShader();
 
 	// Draw components
-	GLvoid DrawModel( glm::mat4 view, glm::mat4 projection) const;
-	GLvoid DrawLightSources( glm::mat4 view, glm::mat4 projection) const;
-	GLvoid DrawSkybox( glm::mat4 projection ) const;
+	GLvoid UpdateUniformBlocks( glm::mat4 view, glm::mat4 projection );
+	GLvoid DrawModel( glm::mat4 view, glm::mat4 projection, GLint viewportHeight );
+	GLvoid BindSharedTextures() const;
+	GLvoid DrawLightSources() const;
+	GLvoid DrawSkybox() const;
+	glm::mat4 GetProjectionMatrix( GLint windowWidth, GLint windowHeight ) const;
+
+	// Picking
+	std::string GetBrdfInputs() const;
 
 	// Frame time
 	GLdouble myDeltaTime = 0.0;
@@ -355,10 +436,18 @@ private:
 	GLboolean myNewPressedMouseCmd = GL_FALSE;
 
 	// Loaded model
-	GLboolean myNewModelShouldBeLoaded = GL_FALSE;
-	std::string myNewModelFilepath = "";
 	std::shared_ptr<PBRViewerScene> myLoadedModel;	
 
+	// Model import running on a worker thread. Cancelled imports are kept until their worker has finished.
+	std::unique_ptr<PBRViewerSceneImporter> mySceneImporter;
+	std::vector<std::unique_ptr<PBRViewerSceneImporter>> myCancelledSceneImporters;
+	PBRViewerEnumerations::ImportPreset myImportPreset = PBRViewerEnumerations::FullOptimize;
+	GLboolean myUseNativeLoaders = GL_TRUE;
+	GLvoid CancelModelLoading();
+	GLvoid ReleaseCancelledSceneImporters();
+	GLvoid SwapInImportedModel();
+	GLvoid ReleaseLoadedModel();
+
 	// Loaded skybox
 	GLboolean myNewSkyboxShouldBeLoaded = GL_FALSE;
 	std::string myNewSkyboxFilepath;
@@ -393,10 +482,74 @@ private:
 	GLvoid CreateLightSources();
 	std::vector<PBRViewerPointLight> myLightSources;	
 
+	// The number of point lights, which is the size of the light arrays within the shaders.
+	static const GLuint NumberOfLights = 4u;
+
+	// Uniform blocks in the std140 layout, shared by all shaders. Vectors with three components are padded to four if another vector follows,
+	// the elements of arrays are always padded to four components.
+	struct FrameBlock
+	{
+		glm::mat4 View;
+		glm::mat4 Projection;
+		glm::vec3 CameraPosition;
+		GLfloat Gamma;
+		GLfloat Exposure;
+		GLint RenderOutput;
+		GLint DebugOutput;
+		GLint Padding;
+	};
+
+	struct LightBlock
+	{
+		glm::vec4 Positions[NumberOfLights];
+		glm::vec4 Colors[NumberOfLights];
+		glm::ivec4 IsActive[NumberOfLights];
+		glm::mat4 LightSpaceMatrices[NumberOfLights];
+		GLint ShadowsEnabled;
+		GLint Padding[3];
+	};
+
+	struct BrdfBlock
+	{
+		GLint BlinnPhongExponent;
+		GLint Nu;
+		GLint Nv;
+		GLint DiffuseTerm;
+		GLint FresnelTerm;
+		GLint NormalDistributionTerm;
+		GLint GeometryTerm;
+		GLint CustomMaterialValuesEnabled;
+		GLfloat CustomMetalness;
+		GLfloat CustomRoughness;
+		GLfloat Subsurface;
+		GLfloat Metallic;
+		GLfloat Specular;
+		GLfloat SpecularTint;
+		GLfloat Roughness;
+		GLfloat Anisotropic;
+		GLfloat Sheen;
+		GLfloat SheenTint;
+		GLfloat Clearcoat;
+		GLfloat ClearcoatGloss;
+	};
+
+	std::unique_ptr<PBRViewerUniformBuffer> myFrameBuffer;
+	std::unique_ptr<PBRViewerUniformBuffer> myLightBuffer;
+	std::unique_ptr<PBRViewerUniformBuffer> myBrdfBuffer;
+
+	// The changes of the parameters and of the per-frame values the shaders read, which are set from the camera and the loaded model.
+	PBRViewerParameterStore myParameters;
+	glm::mat4 myViewMatrix = glm::mat4(1.0f);
+	glm::mat4 myProjectionMatrix = glm::mat4(1.0f);
+	glm::vec3 myCameraPosition = glm::vec3(0.0f);
+	glm::mat4 myModelMatrix = glm::mat4(1.0f);
+
+	// The uniform blocks written within the last frame. The uniforms are counted by the programs.
+	GLuint myNumberOfBlockUploads = 0u;
+
 	// Shadows
 	std::unique_ptr<PBRViewerShadows> myShadows;
-	GLvoid RemoveShadowTexturesFromModel();
-	std::vector<PBRViewerTexture> myShadowDepthCubeMaps;
+	std::vector<PBRViewerTexture> myShadowTextures;
 	GLboolean myAreShadowsEnabled = GL_TRUE;
 	
 	// Blinn/Phong variables
@@ -47,6 +47,7 @@ PBRViewerModelLoader::PBRViewerModelLoader( Widget* parent ) : Window(parent, "M
 		helpText << "* Press and hold left mouse button to rotate the camera" << std::endl;		
 		helpText << "* Press and hold middle mouse button to rotate the loaded 3D model" << std::endl;	
 		helpText << "* Press and hold right mouse button to move the view" << std::endl;
+		helpText << "* Ctrl + left mouse button: Print the material, normal and BRDF inputs of the surface under the cursor to the log" << std::endl;
 		helpText << std::endl;
 		helpText << "* Numpad plus: Enlarge Model" << std::endl;
 		helpText << "* Numpad minus: Shrink Model" << std::endl;
@@ -60,6 +61,45 @@ PBRViewerModelLoader::PBRViewerModelLoader( Widget* parent ) : Window(parent, "M
 		helpWindow->setModal(GL_TRUE);	
 	});
 
+	// Triangles removed by the mesh and meshlet culling of the camera pass within the last frame, counted at the levels of detail selected for it
+	new nanogui::Label(this, "Culled triangles ", "sans-bold");
+	myCulledTrianglesCounter = new nanogui::TextBox(this, "0");
+	myCulledTrianglesCounter->setFixedSize(Eigen::Vector2i(200, PBRViewerOverlayConstants::ButtonHeight));
+	myCulledTrianglesCounter->setUnits("triangles");
+	myCulledTrianglesCounter->setAlignment(nanogui::TextBox::Alignment::Left);
+	myCulledTrianglesCounter->setFontSize(18);
+
+	// Meshes which passed the frustum culling of the camera and of the light sources within the last frame
+	new nanogui::Label(this, "Visible meshes ", "sans-bold");
+	myVisibleMeshesCounter = new nanogui::TextBox(this, "0 / 0");
+	myVisibleMeshesCounter->setFixedSize(Eigen::Vector2i(200, PBRViewerOverlayConstants::ButtonHeight));
+	myVisibleMeshesCounter->setUnits("meshes");
+	myVisibleMeshesCounter->setAlignment(nanogui::TextBox::Alignment::Left);
+	myVisibleMeshesCounter->setFontSize(18);
+
+	new nanogui::Label(this, "Visible shadow meshes ", "sans-bold");
+	myVisibleShadowMeshesCounter = new nanogui::TextBox(this, "0 / 0");
+	myVisibleShadowMeshesCounter->setFixedSize(Eigen::Vector2i(200, PBRViewerOverlayConstants::ButtonHeight));
+	myVisibleShadowMeshesCounter->setUnits("meshes");
+	myVisibleShadowMeshesCounter->setAlignment(nanogui::TextBox::Alignment::Left);
+	myVisibleShadowMeshesCounter->setFontSize(18);
+
+	// Uniform blocks and uniforms written within the last frame, unchanged blocks are not uploaded again
+	new nanogui::Label(this, "Parameter uploads ", "sans-bold");
+	myParameterUploadsCounter = new nanogui::TextBox(this, "0");
+	myParameterUploadsCounter->setFixedSize(Eigen::Vector2i(200, PBRViewerOverlayConstants::ButtonHeight));
+	myParameterUploadsCounter->setUnits("uploads");
+	myParameterUploadsCounter->setAlignment(nanogui::TextBox::Alignment::Left);
+	myParameterUploadsCounter->setFontSize(18);
+
+	// State changes skipped by the state cache within the last frame, since they would not have changed anything
+	new nanogui::Label(this, "Filtered GL calls ", "sans-bold");
+	myFilteredCallsCounter = new nanogui::TextBox(this, "0 / 0");
+	myFilteredCallsCounter->setFixedSize(Eigen::Vector2i(200, PBRViewerOverlayConstants::ButtonHeight));
+	myFilteredCallsCounter->setUnits("calls");
+	myFilteredCallsCounter->setAlignment(nanogui::TextBox::Alignment::Left);
+	myFilteredCallsCounter->setFontSize(18);
+
 	// Load model
 	new nanogui::Label(this, "Currently loaded model: ", "sans-bold");
 	myTextBoxLoadModel = new nanogui::TextBox(this);
@@ -68,6 +108,10 @@ PBRViewerModelLoader::PBRViewerModelLoader( Widget* parent ) : Window(parent, "M
 	myTextBoxLoadModel->setFontSize(16);
 	myTextBoxLoadModel->setValue("No model");
 
+	myModelLoadingProgressBar = new nanogui::ProgressBar(this);
+	myModelLoadingProgressBar->setFixedWidth(200);
+	myModelLoadingProgressBar->setValue(0.0f);
+
 	auto* horizontalLayoutModel = new Widget(this);
 	horizontalLayoutModel->setLayout(new nanogui::BoxLayout(nanogui::Orientation::Horizontal, nanogui::Alignment::Maximum, 0, 6));
 
@@ -82,6 +126,21 @@ PBRViewerModelLoader::PBRViewerModelLoader( Widget* parent ) : Window(parent, "M
 	myClearModelButton->setTooltip("Clear currently loaded model.");
 	myClearModelButton->setFontSize(PBRViewerOverlayConstants::ButtonFontSize);
 
+	new nanogui::Label(this, "Import preset", "sans");
+	myImportPreset = new nanogui::ComboBox(this);
+	myImportPreset->setItems({"Fast preview", "Balanced", "Full optimize"});
+	myImportPreset->setSelectedIndex(PBRViewerEnumerations::ImportPreset::FullOptimize);
+	myImportPreset->setFixedWidth(200);
+	myImportPreset->setFontSize(PBRViewerOverlayConstants::ButtonFontSize);
+	myImportPreset->setFixedHeight(PBRViewerOverlayConstants::ButtonHeight);
+	myImportPreset->setTooltip("Fast preview skips the mesh optimizations and the texture compression. "
+	                           "Full optimize takes longer, but renders faster and needs less memory. Applies to the next loaded model.");
+
+	myNativeLoaders = new nanogui::CheckBox(this, "Native glTF/OBJ loaders");
+	myNativeLoaders->setChecked(GL_TRUE);
+	myNativeLoaders->setTooltip("Reads glTF and OBJ files without ASSIMP. Disable it to compare the load times of the loaders in the import reports. "
+	                            "Applies to the next loaded model.");
+
 	new nanogui::Label(this, "");
 
 	// Load skybox
@@ -125,6 +184,15 @@ GLvoid PBRViewerModelLoader::SetTextBoxOpenModelContent( const std::string& cont
 	myTextBoxLoadModel->setValue(content);
 }
 
+/// <summary>
+/// Sets the progress of the model import shown by the progress bar.
+/// </summary>
+/// <param name="progress">The progress in the range [0, 1].</param>	
+GLvoid PBRViewerModelLoader::SetModelLoadingProgress( const GLfloat progress ) const
+{
+	myModelLoadingProgressBar->setValue(progress);
+}
+
 /// <summary>
 /// Sets the callback for the button clearing a loaded model.
 /// </summary>
@@ -134,6 +202,27 @@ GLvoid PBRViewerModelLoader::SetClearModelButtonCallback( const std::function<GL
 	myClearModelButton->setCallback(callback);
 }
 
+/// <summary>
+/// Sets the callback for the combobox representing the import preset.
+/// </summary>
+/// <param name="callback">The callback to set.</param>	
+GLvoid PBRViewerModelLoader::SetImportPresetComboBoxCallback( const std::function<GLvoid( PBRViewerEnumerations::ImportPreset )>& callback ) const
+{
+	myImportPreset->setCallback([callback]( const GLint currentImportPreset )
+	{
+		callback(static_cast<PBRViewerEnumerations::ImportPreset>(currentImportPreset));
+	});
+}
+
+/// <summary>
+/// Sets the callback for the checkbox enabling the native glTF and OBJ loaders.
+/// </summary>
+/// <param name="callback">The callback to set.</param>	
+GLvoid PBRViewerModelLoader::SetNativeLoadersCheckBoxCallback( const std::function<GLvoid( GLboolean )>& callback ) const
+{
+	myNativeLoaders->setCallback(callback);
+}
+
 /// <summary>
 /// Sets the callback for the button loading a skybox texture.
 /// </summary>
@@ -169,3 +258,48 @@ GLvoid PBRViewerModelLoader::SetFpsCounterContent( const std::string& content )
 {
 	myFpsCounter->setValue(content);
 }
+
+/// <summary>
+/// Sets the content of the culled triangles counter.
+/// </summary>
+/// <param name="content">The number of triangles culled within the last frame.</param>	
+GLvoid PBRViewerModelLoader::SetCulledTrianglesCounterContent( const std::string& content ) const
+{
+	myCulledTrianglesCounter->setValue(content);
+}
+
+/// <summary>
+/// Sets the content of the visible meshes counter.
+/// </summary>
+/// <param name="content">The number of meshes which passed the frustum culling of the camera within the last frame.</param>	
+GLvoid PBRViewerModelLoader::SetVisibleMeshesCounterContent( const std::string& content ) const
+{
+	myVisibleMeshesCounter->setValue(content);
+}
+
+/// <summary>
+/// Sets the content of the visible shadow meshes counter.
+/// </summary>
+/// <param name="content">The number of meshes which passed the frustum culling of the light sources within the last frame.</param>	
+GLvoid PBRViewerModelLoader::SetVisibleShadowMeshesCounterContent( const std::string& content ) const
+{
+	myVisibleShadowMeshesCounter->setValue(content);
+}
+
+/// <summary>
+/// Sets the content of the parameter uploads counter.
+/// </summary>
+/// <param name="content">The number of uniform blocks and uniforms written within the last frame.</param>	
+GLvoid PBRViewerModelLoader::SetParameterUploadsCounterContent( const std::string& content ) const
+{
+	myParameterUploadsCounter->setValue(content);
+}
+
+/// <summary>
+/// Sets the content of the filtered calls counter.
+/// </summary>
+/// <param name="content">The number of OpenGL calls filtered by the state cache within the last frame.</param>	
+GLvoid PBRViewerModelLoader::SetFilteredCallsCounterContent( const std::string& content ) const
+{
+	myFilteredCallsCounter->setValue(content);
+}
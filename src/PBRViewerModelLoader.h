@@ -4,6 +4,11 @@
 
 #include <nanogui/window.h>
 #include <nanogui/textbox.h>
+#include <nanogui/progressbar.h>
+#include <nanogui/combobox.h>
+#include <nanogui/checkbox.h>
+
+#include "PBRViewerEnumerations.h"
 
 /// <summary>
 /// This class represents the window used to load a 3D model or a skybox texture.
@@ -23,6 +28,36 @@ public:
 	/// <param name="content">The current amount of frames per second.</param>	
 	GLvoid SetFpsCounterContent( const std::string& content ) const;
 
+	/// <summary>
+	/// Sets the content of the culled triangles counter.
+	/// </summary>
+	/// <param name="content">The number of triangles culled within the last frame.</param>	
+	GLvoid SetCulledTrianglesCounterContent( const std::string& content ) const;
+
+	/// <summary>
+	/// Sets the content of the visible meshes counter.
+	/// </summary>
+	/// <param name="content">The number of meshes which passed the frustum culling of the camera within the last frame.</param>	
+	GLvoid SetVisibleMeshesCounterContent( const std::string& content ) const;
+
+	/// <summary>
+	/// Sets the content of the visible shadow meshes counter.
+	/// </summary>
+	/// <param name="content">The number of meshes which passed the frustum culling of the light sources within the last frame.</param>	
+	GLvoid SetVisibleShadowMeshesCounterContent( const std::string& content ) const;
+
+	/// <summary>
+	/// Sets the content of the parameter uploads counter.
+	/// </summary>
+	/// <param name="content">The number of uniform blocks and uniforms written within the last frame.</param>	
+	GLvoid SetParameterUploadsCounterContent( const std::string& content ) const;
+
+	/// <summary>
+	/// Sets the content of the filtered calls counter.
+	/// </summary>
+	/// <param name="content">The number of OpenGL calls filtered by the state cache within the last frame.</param>	
+	GLvoid SetFilteredCallsCounterContent( const std::string& content ) const;
+
 	/// <summary>
 	/// Sets the callback for the button loading a model.
 	/// </summary>
@@ -35,12 +70,30 @@ public:
 	/// <param name="content">The name of the currently loaded model.</param>	
 	GLvoid SetTextBoxOpenModelContent( const std::string& content ) const;
 
+	/// <summary>
+	/// Sets the progress of the model import shown by the progress bar.
+	/// </summary>
+	/// <param name="progress">The progress in the range [0, 1].</param>	
+	GLvoid SetModelLoadingProgress( GLfloat progress ) const;
+
 	/// <summary>
 	/// Sets the callback for the button clearing a loaded model.
 	/// </summary>
 	/// <param name="callback">The callback to set.</param>	
 	GLvoid SetClearModelButtonCallback( const std::function<GLvoid()>& callback ) const;
 
+	/// <summary>
+	/// Sets the callback for the combobox representing the import preset.
+	/// </summary>
+	/// <param name="callback">The callback to set.</param>	
+	GLvoid SetImportPresetComboBoxCallback( const std::function<GLvoid( PBRViewerEnumerations::ImportPreset )>& callback ) const;
+
+	/// <summary>
+	/// Sets the callback for the checkbox enabling the native glTF and OBJ loaders.
+	/// </summary>
+	/// <param name="callback">The callback to set.</param>	
+	GLvoid SetNativeLoadersCheckBoxCallback( const std::function<GLvoid( GLboolean )>& callback ) const;
+
 	/// <summary>
 	/// Sets the callback for the button loading a skybox texture.
 	/// </summary>
@@ -62,10 +115,18 @@ public:
 private:
 	nanogui::TextBox* myFpsCounter;
 	nanogui::Button* myHelpButton;
+	nanogui::TextBox* myCulledTrianglesCounter;
+	nanogui::TextBox* myVisibleMeshesCounter;
+	nanogui::TextBox* myVisibleShadowMeshesCounter;
+	nanogui::TextBox* myParameterUploadsCounter;
+	nanogui::TextBox* myFilteredCallsCounter;
 
 	nanogui::Button* myLoadModelButton;
 	nanogui::TextBox* myTextBoxLoadModel;
+	nanogui::ProgressBar* myModelLoadingProgressBar;
 	nanogui::Button* myClearModelButton;
+	nanogui::ComboBox* myImportPreset;
+	nanogui::CheckBox* myNativeLoaders;
 
 	nanogui::Button* myLoadSkyboxButton;
 	nanogui::TextBox* myTextBoxSkybox;
@@ -115,6 +115,17 @@ GLvoid PBRViewerMouseCallbacks::RegisterCallbacks( GLFWwindow* currentWindow,
 				}
 			}
 
+			// Ctrl + left click picks the surface point under the cursor instead of rotating the camera.
+			if (button == GLFW_MOUSE_BUTTON_1 && action == GLFW_PRESS && 0 != (modifiers & GLFW_MOD_CONTROL))
+			{
+				GLdouble cursorPosX, cursorPosY;
+				glfwGetCursorPos(window, &cursorPosX, &cursorPosY);
+
+				myModel->Pick(cursorPosX, cursorPosY);
+				myModel->SetMouseProcessing(GL_FALSE);
+				return;
+			}
+
 			if (action == GLFW_RELEASE)
 			{
 				// Restore cursor from camera movement
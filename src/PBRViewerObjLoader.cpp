@@ -0,0 +1,1096 @@
+#include "PBRViewerObjLoader.h"
+
+#include "PBRViewerLogger.h"
+#include "PBRViewerMappedFile.h"
+#include "PBRViewerTangentSpace.h"
+#include "PBRViewerThreadPool.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <limits>
+
+// Marks the missing texture coordinates and normals of a corner. Resolved indices never reach this value.
+static const GLint NoIndex = INT_MIN;
+
+// The flags of the attributes given as relative index.
+static const GLubyte RelativePosition = 1u;
+static const GLubyte RelativeTexCoords = 2u;
+static const GLubyte RelativeNormal = 4u;
+
+// The powers of ten which are exactly representable as double.
+static const GLdouble PowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/// <summary>
+/// Checks if a character separates the arguments of a statement.
+/// </summary>
+/// <param name="character">The character to check.</param>
+/// <returns>True if the character is a space or a tab, false if not.</returns>
+static GLboolean IsBlank( const char character )
+{
+	return ' ' == character || '\t' == character;
+}
+
+/// <summary>
+/// Moves behind the blanks at the position.
+/// </summary>
+/// <param name="position">The first character.</param>
+/// <param name="end">The end of the line.</param>
+/// <returns>The first character which is no blank.</returns>
+static const char* SkipBlanks( const char* position, const char* end )
+{
+	while (position < end && IsBlank(*position))
+	{
+		position++;
+	}
+
+	return position;
+}
+
+/// <summary>
+/// Checks if a line starts with a keyword followed by a blank or the end of the line.
+/// </summary>
+/// <param name="position">The first character of the line.</param>
+/// <param name="end">The end of the line.</param>
+/// <param name="keyword">The keyword to check.</param>
+/// <returns>The character behind the keyword or nullptr if the line starts with another keyword.</returns>
+static const char* MatchKeyword( const char* position, const char* end, const char* keyword )
+{
+	const size_t length = std::strlen(keyword);
+	if (static_cast<size_t>(end - position) < length || 0 != std::memcmp(position, keyword, length))
+	{
+		return nullptr;
+	}
+
+	position += length;
+	return position == end || IsBlank(*position) ? position : nullptr;
+}
+
+/// <summary>
+/// Removes the leading and trailing blanks of the arguments of a statement.
+/// </summary>
+/// <param name="position">The first character of the arguments.</param>
+/// <param name="end">The end of the line.</param>
+/// <returns>The trimmed arguments.</returns>
+static std::string TrimArguments( const char* position, const char* end )
+{
+	position = SkipBlanks(position, end);
+	while (end > position && IsBlank(end[-1]))
+	{
+		end--;
+	}
+
+	return std::string(position, end);
+}
+
+/// <summary>
+/// Turns an index of a face into an index of the attributes of its chunk.
+/// </summary>
+/// <param name="index">The index of the face, starting at 1 or counting backwards from -1.</param>
+/// <param name="count">The number of attributes the chunk has read so far.</param>
+/// <param name="flag">The flag of the attribute.</param>
+/// <param name="result">The index starting at 0. Relative indices are relative to the start of the chunk and may be negative.</param>
+/// <param name="relativeIndices">The flags of the corner, which receive the flag of the attribute if the index is relative.</param>
+/// <returns>True if the index can be resolved, false if not.</returns>
+static GLboolean ResolveIndex( const GLint index, const size_t count, const GLubyte flag, GLint& result, GLubyte& relativeIndices )
+{
+	if (index > 0)
+	{
+		result = index - 1;
+		return GL_TRUE;
+	}
+
+	const GLint64 relativeIndex = static_cast<GLint64>(count) + index;
+	if (relativeIndex <= std::numeric_limits<GLint>::min() || relativeIndex >= std::numeric_limits<GLint>::max())
+	{
+		return GL_FALSE;
+	}
+
+	result = static_cast<GLint>(relativeIndex);
+	relativeIndices |= flag;
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Moves a resolved index to the concatenated attributes and checks its range.
+/// </summary>
+/// <param name="index">The index to move.</param>
+/// <param name="isRelative">True if the index is relative to the start of its chunk.</param>
+/// <param name="offset">The number of attributes of all previous chunks.</param>
+/// <param name="count">The number of attributes of all chunks.</param>
+/// <param name="isRequired">True if the index must not be missing.</param>
+/// <returns>True if the index is in range, false if not.</returns>
+static GLboolean MoveIndex( GLint& index, const GLboolean isRelative, const size_t offset, const size_t count, const GLboolean isRequired )
+{
+	if (isRelative)
+	{
+		index = static_cast<GLint>(static_cast<GLint64>(index) + static_cast<GLint64>(offset));
+	}
+	else if (NoIndex == index)
+	{
+		return GL_FALSE == isRequired;
+	}
+
+	return index >= 0 && static_cast<size_t>(index) < count;
+}
+
+/// <summary>
+/// Hashes the attribute indices of a corner.
+/// </summary>
+/// <param name="position">The index of the position.</param>
+/// <param name="textureCoordinates">The index of the texture coordinates.</param>
+/// <param name="normal">The index of the normal.</param>
+/// <returns>The hash value.</returns>
+static GLuint HashIndices( const GLint position, const GLint textureCoordinates, const GLint normal )
+{
+	GLuint hash = static_cast<GLuint>(position) * 0x9E3779B1u;
+	hash ^= static_cast<GLuint>(textureCoordinates) * 0x85EBCA77u + (hash << 6) + (hash >> 2);
+	hash ^= static_cast<GLuint>(normal) * 0xC2B2AE3Du + (hash << 6) + (hash >> 2);
+	return hash ^ (hash >> 16);
+}
+
+/// <summary>
+/// Checks by the file extension if a file is an OBJ model.
+/// </summary>
+/// <param name="filepath">The filepath of the model.</param>
+/// <returns>True if the file is a .obj file, false if not.</returns>
+GLboolean PBRViewerObjLoader::IsObjFile( std::string const& filepath )
+{
+	const size_t extensionStart = filepath.find_last_of('.');
+	if (std::string::npos == extensionStart)
+	{
+		return GL_FALSE;
+	}
+
+	std::string extension = filepath.substr(extensionStart + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), []( const char character )
+	{
+		return static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+	});
+
+	return "obj" == extension;
+}
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerObjLoader"/> class.
+/// </summary>
+/// <param name="filepath">The filepath of the OBJ model.</param>
+PBRViewerObjLoader::PBRViewerObjLoader( std::string const& filepath )
+	: myFilepath(filepath)
+{
+}
+
+/// <summary>
+/// Loads the meshes and the material textures of the model. The textures are registered, but not decoded.
+/// </summary>
+/// <param name="sceneData">The scene data to fill. The directory has to be set.</param>
+/// <returns>True if the model could be loaded, false if it is malformed or contains no triangles.</returns>
+GLboolean PBRViewerObjLoader::Load( PBRViewerSceneData& sceneData )
+{
+	PBRViewerImportReport& report = sceneData.Report;
+
+	auto startTime = std::chrono::steady_clock::now();
+	PBRViewerMappedFile file;
+	if (GL_FALSE == file.Open(myFilepath) || 0u == file.GetSize())
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not map the OBJ file:", myFilepath);
+		return GL_FALSE;
+	}
+
+	const GLboolean isParsed = ParseChunks(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+	report.AddPhase("OBJ parse", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+	report.AddStatistic("OBJ chunks", static_cast<GLdouble>(myChunks.size()));
+
+	if (GL_FALSE == isParsed)
+	{
+		return GL_FALSE;
+	}
+
+	// The statements are copied out of the file, so the mapping is not needed anymore.
+	file.Close();
+
+	startTime = std::chrono::steady_clock::now();
+	const GLboolean isMerged = MergeChunks();
+	const std::vector<MeshPart> parts = isMerged ? CollectMeshParts() : std::vector<MeshPart>();
+	report.AddPhase("OBJ merge", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	if (GL_FALSE == isMerged)
+	{
+		return GL_FALSE;
+	}
+
+	if (parts.empty())
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "The OBJ file contains no triangles:", myFilepath);
+		return GL_FALSE;
+	}
+
+	startTime = std::chrono::steady_clock::now();
+	std::vector<std::string> materialLibraries;
+	for (const Chunk& chunk : myChunks)
+	{
+		for (const std::string& materialLibrary : chunk.MaterialLibraries)
+		{
+			if (std::find(materialLibraries.begin(), materialLibraries.end(), materialLibrary) == materialLibraries.end())
+			{
+				materialLibraries.push_back(materialLibrary);
+				ReadMaterialLibrary(materialLibrary, sceneData.Directory);
+			}
+		}
+	}
+
+	std::vector<PBRViewerMeshData> meshes(parts.size());
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		meshes[i].Textures = LoadMaterialTextures(parts[i].Material, sceneData);
+	}
+
+	report.AddPhase("OBJ material read", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	const GLboolean hasMissingNormals = std::any_of(myChunks.begin(), myChunks.end(), []( const Chunk& chunk )
+	{
+		return std::any_of(chunk.Corners.begin(), chunk.Corners.end(), []( const Corner& corner )
+		{
+			return corner.Normal < 0;
+		});
+	});
+
+	if (hasMissingNormals)
+	{
+		startTime = std::chrono::steady_clock::now();
+		GeneratePositionNormals();
+		report.AddPhase("OBJ normal generation", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+	}
+
+	// Each part is welded on a worker of its own. The importer runs outside of the thread pool, so waiting here cannot deadlock.
+	startTime = std::chrono::steady_clock::now();
+	std::vector<std::future<GLvoid>> pendingWelds;
+	pendingWelds.reserve(parts.size());
+
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		pendingWelds.push_back(PBRViewerThreadPool::GetInstance().Enqueue([this, &parts, &meshes, i]()
+		{
+			WeldMeshPart(parts[i], meshes[i]);
+		}));
+	}
+
+	for (std::future<GLvoid>& pendingWeld : pendingWelds)
+	{
+		pendingWeld.get();
+	}
+
+	size_t numberOfVertices = 0u;
+	for (PBRViewerMeshData& meshData : meshes)
+	{
+		numberOfVertices += meshData.Vertices.size();
+		sceneData.Meshes.push_back(std::move(meshData));
+	}
+
+	report.AddPhase("OBJ vertex weld (" + std::to_string(numberOfVertices) + " vertices)",
+	                std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	myChunks.clear();
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Splits the file into line-aligned chunks and parses them in parallel.
+/// </summary>
+/// <param name="data">The content of the file.</param>
+/// <param name="size">The size of the file in bytes.</param>
+/// <returns>True if all chunks could be parsed, false if not.</returns>
+GLboolean PBRViewerObjLoader::ParseChunks( const char* data, const size_t size )
+{
+	// A few chunks per worker even out the load if the statements are not spread evenly, e. g. all positions in front of all faces.
+	PBRViewerThreadPool& threadPool = PBRViewerThreadPool::GetInstance();
+	const size_t maximumNumberOfChunks = 4u * threadPool.GetNumberOfThreads();
+	const size_t numberOfChunks = std::max(static_cast<size_t>(1u), std::min(size / MinimumChunkSize, maximumNumberOfChunks));
+
+	const char* end = data + size;
+	const char* begin = data;
+	myChunks.resize(numberOfChunks);
+
+	for (size_t i = 0; i < numberOfChunks; i++)
+	{
+		const char* chunkEnd = end;
+		if (i + 1u < numberOfChunks)
+		{
+			chunkEnd = std::max(begin, data + size / numberOfChunks * (i + 1u));
+			const char* lineEnd = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+			chunkEnd = nullptr == lineEnd ? end : lineEnd + 1;
+		}
+
+		Chunk& chunk = myChunks[i];
+		chunk.Begin = begin;
+		chunk.End = chunkEnd;
+
+		MaterialRun inheritedRun;
+		inheritedRun.IsInherited = GL_TRUE;
+		chunk.MaterialRuns.push_back(inheritedRun);
+
+		begin = chunkEnd;
+	}
+
+	std::vector<std::future<GLvoid>> pendingChunks;
+	pendingChunks.reserve(numberOfChunks);
+
+	for (Chunk& chunk : myChunks)
+	{
+		pendingChunks.push_back(threadPool.Enqueue([&chunk]()
+		{
+			ParseChunk(chunk);
+		}));
+	}
+
+	for (std::future<GLvoid>& pendingChunk : pendingChunks)
+	{
+		pendingChunk.get();
+	}
+
+	const GLboolean areChunksValid = std::all_of(myChunks.begin(), myChunks.end(), []( const Chunk& chunk )
+	{
+		return chunk.IsValid;
+	});
+
+	if (GL_FALSE == areChunksValid)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Malformed statement in the OBJ file:", myFilepath);
+	}
+
+	return areChunksValid;
+}
+
+/// <summary>
+/// Parses the statements of a chunk. Relative indices are resolved against the start of the chunk.
+/// </summary>
+/// <param name="chunk">The chunk to parse.</param>
+GLvoid PBRViewerObjLoader::ParseChunk( Chunk& chunk )
+{
+	std::vector<Corner> face;
+	std::vector<GLubyte> faceRelativeIndices;
+
+	const char* lineStart = chunk.Begin;
+	while (lineStart < chunk.End && chunk.IsValid)
+	{
+		const char* lineEnd = static_cast<const char*>(std::memchr(lineStart, '\n', chunk.End - lineStart));
+		const char* nextLine = nullptr == lineEnd ? chunk.End : lineEnd + 1;
+		lineEnd = nullptr == lineEnd ? chunk.End : lineEnd;
+
+		if (lineEnd > lineStart && '\r' == lineEnd[-1])
+		{
+			lineEnd--;
+		}
+
+		const char* position = SkipBlanks(lineStart, lineEnd);
+		lineStart = nextLine;
+
+		const char* arguments;
+		if (nullptr != (arguments = MatchKeyword(position, lineEnd, "v")))
+		{
+			// Optional weights or vertex colors behind the coordinates are ignored.
+			glm::vec3 value;
+			for (GLint i = 0; i < 3 && nullptr != arguments; i++)
+			{
+				arguments = ParseFloat(arguments, lineEnd, value[i]);
+			}
+
+			chunk.IsValid = nullptr != arguments;
+			chunk.Positions.push_back(value);
+		}
+		else if (nullptr != (arguments = MatchKeyword(position, lineEnd, "vt")))
+		{
+			glm::vec2 value(0.0f);
+			arguments = ParseFloat(arguments, lineEnd, value.x);
+			if (nullptr != arguments && SkipBlanks(arguments, lineEnd) < lineEnd)
+			{
+				arguments = ParseFloat(arguments, lineEnd, value.y);
+			}
+
+			chunk.IsValid = nullptr != arguments;
+			chunk.TexCoords.push_back(value);
+		}
+		else if (nullptr != (arguments = MatchKeyword(position, lineEnd, "vn")))
+		{
+			glm::vec3 value;
+			for (GLint i = 0; i < 3 && nullptr != arguments; i++)
+			{
+				arguments = ParseFloat(arguments, lineEnd, value[i]);
+			}
+
+			chunk.IsValid = nullptr != arguments;
+			chunk.Normals.push_back(value);
+		}
+		else if (nullptr != (arguments = MatchKeyword(position, lineEnd, "f")))
+		{
+			face.clear();
+			faceRelativeIndices.clear();
+			GLubyte relativeIndicesOfFace = 0u;
+
+			// Each corner is given as v, v/vt, v//vn or v/vt/vn.
+			while (chunk.IsValid)
+			{
+				arguments = SkipBlanks(arguments, lineEnd);
+				if (arguments == lineEnd || '#' == *arguments)
+				{
+					break;
+				}
+
+				Corner corner = { NoIndex, NoIndex, NoIndex };
+				GLubyte relativeIndices = 0u;
+				GLint index;
+
+				arguments = ParseIndex(arguments, lineEnd, index);
+				chunk.IsValid = nullptr != arguments && ResolveIndex(index, chunk.Positions.size(), RelativePosition, corner.Position, relativeIndices);
+
+				if (chunk.IsValid && arguments < lineEnd && '/' == *arguments)
+				{
+					arguments++;
+					if (arguments < lineEnd && '/' != *arguments && GL_FALSE == IsBlank(*arguments))
+					{
+						arguments = ParseIndex(arguments, lineEnd, index);
+						chunk.IsValid = nullptr != arguments && ResolveIndex(index, chunk.TexCoords.size(), RelativeTexCoords, corner.TexCoords, relativeIndices);
+					}
+
+					// Some exporters write an empty index behind the last slash, e. g. v/vt/, which is skipped like a missing one.
+					if (chunk.IsValid && arguments < lineEnd && '/' == *arguments && ++arguments < lineEnd && GL_FALSE == IsBlank(*arguments))
+					{
+						arguments = ParseIndex(arguments, lineEnd, index);
+						chunk.IsValid = nullptr != arguments && ResolveIndex(index, chunk.Normals.size(), RelativeNormal, corner.Normal, relativeIndices);
+					}
+				}
+
+				chunk.IsValid = chunk.IsValid && (arguments == lineEnd || IsBlank(*arguments));
+				face.push_back(corner);
+				faceRelativeIndices.push_back(relativeIndices);
+				relativeIndicesOfFace |= relativeIndices;
+			}
+
+			if (GL_FALSE == chunk.IsValid || face.size() < 3u)
+			{
+				continue;
+			}
+
+			// The corners of chunks without any relative index are not flagged at all.
+			if (0u != relativeIndicesOfFace)
+			{
+				chunk.RelativeIndices.resize(chunk.Corners.size(), 0u);
+			}
+
+			for (size_t i = 2; i < face.size(); i++)
+			{
+				chunk.Corners.push_back(face[0]);
+				chunk.Corners.push_back(face[i - 1u]);
+				chunk.Corners.push_back(face[i]);
+
+				if (0u != relativeIndicesOfFace)
+				{
+					chunk.RelativeIndices.push_back(faceRelativeIndices[0]);
+					chunk.RelativeIndices.push_back(faceRelativeIndices[i - 1u]);
+					chunk.RelativeIndices.push_back(faceRelativeIndices[i]);
+				}
+			}
+		}
+		else if (nullptr != (arguments = MatchKeyword(position, lineEnd, "usemtl")))
+		{
+			MaterialRun run;
+			run.Material = TrimArguments(arguments, lineEnd);
+			run.FirstCorner = chunk.Corners.size();
+			chunk.MaterialRuns.push_back(run);
+		}
+		else if (nullptr != (arguments = MatchKeyword(position, lineEnd, "mtllib")))
+		{
+			chunk.MaterialLibraries.push_back(TrimArguments(arguments, lineEnd));
+		}
+	}
+}
+
+/// <summary>
+/// Concatenates the attributes of all chunks and turns the indices of the corners into indices of the concatenated attributes.
+/// </summary>
+/// <returns>True if all indices are in range, false if not.</returns>
+GLboolean PBRViewerObjLoader::MergeChunks()
+{
+	std::vector<size_t> positionOffsets(myChunks.size());
+	std::vector<size_t> texCoordOffsets(myChunks.size());
+	std::vector<size_t> normalOffsets(myChunks.size());
+
+	size_t numberOfPositions = 0u;
+	size_t numberOfTexCoords = 0u;
+	size_t numberOfNormals = 0u;
+
+	for (size_t i = 0; i < myChunks.size(); i++)
+	{
+		positionOffsets[i] = numberOfPositions;
+		texCoordOffsets[i] = numberOfTexCoords;
+		normalOffsets[i] = numberOfNormals;
+
+		numberOfPositions += myChunks[i].Positions.size();
+		numberOfTexCoords += myChunks[i].TexCoords.size();
+		numberOfNormals += myChunks[i].Normals.size();
+	}
+
+	const size_t maximumIndex = static_cast<size_t>(std::numeric_limits<GLint>::max());
+	if (numberOfPositions > maximumIndex || numberOfTexCoords > maximumIndex || numberOfNormals > maximumIndex)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Too many vertex attributes in the OBJ file:", myFilepath);
+		return GL_FALSE;
+	}
+
+	myPositions.resize(numberOfPositions);
+	myTexCoords.resize(numberOfTexCoords);
+	myNormals.resize(numberOfNormals);
+
+	std::vector<std::future<GLvoid>> pendingChunks;
+	pendingChunks.reserve(myChunks.size());
+
+	for (size_t i = 0; i < myChunks.size(); i++)
+	{
+		pendingChunks.push_back(PBRViewerThreadPool::GetInstance().Enqueue([&, i]()
+		{
+			Chunk& chunk = myChunks[i];
+			std::copy(chunk.Positions.begin(), chunk.Positions.end(), myPositions.begin() + positionOffsets[i]);
+			std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), myTexCoords.begin() + texCoordOffsets[i]);
+			std::copy(chunk.Normals.begin(), chunk.Normals.end(), myNormals.begin() + normalOffsets[i]);
+
+			std::vector<glm::vec3>().swap(chunk.Positions);
+			std::vector<glm::vec2>().swap(chunk.TexCoords);
+			std::vector<glm::vec3>().swap(chunk.Normals);
+
+			for (size_t j = 0; j < chunk.Corners.size() && chunk.IsValid; j++)
+			{
+				Corner& corner = chunk.Corners[j];
+				const GLubyte relativeIndices = j < chunk.RelativeIndices.size() ? chunk.RelativeIndices[j] : 0u;
+
+				chunk.IsValid = MoveIndex(corner.Position, 0u != (relativeIndices & RelativePosition), positionOffsets[i], numberOfPositions, GL_TRUE) &&
+				                MoveIndex(corner.TexCoords, 0u != (relativeIndices & RelativeTexCoords), texCoordOffsets[i], numberOfTexCoords, GL_FALSE) &&
+				                MoveIndex(corner.Normal, 0u != (relativeIndices & RelativeNormal), normalOffsets[i], numberOfNormals, GL_FALSE);
+			}
+
+			std::vector<GLubyte>().swap(chunk.RelativeIndices);
+		}));
+	}
+
+	for (std::future<GLvoid>& pendingChunk : pendingChunks)
+	{
+		pendingChunk.get();
+	}
+
+	const GLboolean areIndicesValid = std::all_of(myChunks.begin(), myChunks.end(), []( const Chunk& chunk )
+	{
+		return chunk.IsValid;
+	});
+
+	if (GL_FALSE == areIndicesValid)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Index out of range in the OBJ file:", myFilepath);
+	}
+
+	return areIndicesValid;
+}
+
+/// <summary>
+/// Assigns the triangles of all chunks to the mesh parts of their materials.
+/// </summary>
+/// <returns>The mesh parts in the order their materials appear in the file.</returns>
+std::vector<PBRViewerObjLoader::MeshPart> PBRViewerObjLoader::CollectMeshParts() const
+{
+	const size_t maximumCornersPerPart = 3u * MaximumTrianglesPerPart;
+
+	std::vector<MeshPart> parts;
+
+	// Maps a material to the part which is currently filled with its triangles.
+	std::unordered_map<std::string, size_t> openParts;
+	std::string material;
+
+	for (size_t i = 0; i < myChunks.size(); i++)
+	{
+		const Chunk& chunk = myChunks[i];
+		for (size_t j = 0; j < chunk.MaterialRuns.size(); j++)
+		{
+			const MaterialRun& run = chunk.MaterialRuns[j];
+			if (GL_FALSE == run.IsInherited)
+			{
+				material = run.Material;
+			}
+
+			size_t firstCorner = run.FirstCorner;
+			const size_t lastCorner = j + 1u < chunk.MaterialRuns.size() ? chunk.MaterialRuns[j + 1u].FirstCorner : chunk.Corners.size();
+
+			while (firstCorner < lastCorner)
+			{
+				const auto openPart = openParts.find(material);
+				if (openPart == openParts.end() || parts[openPart->second].NumberOfCorners == maximumCornersPerPart)
+				{
+					MeshPart part;
+					part.Material = material;
+					parts.push_back(part);
+					openParts[material] = parts.size() - 1u;
+				}
+
+				MeshPart& part = parts[openParts[material]];
+				const size_t numberOfCorners = std::min(lastCorner - firstCorner, maximumCornersPerPart - part.NumberOfCorners);
+
+				CornerRange range;
+				range.Chunk = i;
+				range.FirstCorner = firstCorner;
+				range.LastCorner = firstCorner + numberOfCorners;
+				part.Ranges.push_back(range);
+
+				part.NumberOfCorners += numberOfCorners;
+				firstCorner += numberOfCorners;
+			}
+		}
+	}
+
+	return parts;
+}
+
+/// <summary>
+/// Reads the texture maps of all materials of a material library.
+/// </summary>
+/// <param name="filename">The filename of the material library relative to the directory of the model.</param>
+/// <param name="directory">The directory of the model.</param>
+GLvoid PBRViewerObjLoader::ReadMaterialLibrary( std::string const& filename, std::string const& directory )
+{
+	// A missing library only costs the textures, just like with ASSIMP.
+	const std::string filepath = directory + '\\' + filename;
+	std::ifstream file(filepath);
+	if (!file)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not open the material library:", filepath);
+		return;
+	}
+
+	Material* material = nullptr;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const char* lineEnd = line.data() + line.size();
+		if (lineEnd > line.data() && '\r' == lineEnd[-1])
+		{
+			lineEnd--;
+		}
+
+		const char* keyword = SkipBlanks(line.data(), lineEnd);
+		const char* arguments = keyword;
+		while (arguments < lineEnd && GL_FALSE == IsBlank(*arguments))
+		{
+			arguments++;
+		}
+
+		std::string statement(keyword, arguments);
+		std::transform(statement.begin(), statement.end(), statement.begin(), []( const char character )
+		{
+			return static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+		});
+
+		if ("newmtl" == statement)
+		{
+			material = &myMaterials[TrimArguments(arguments, lineEnd)];
+		}
+		else if (nullptr == material)
+		{
+			continue;
+		}
+		else if ("map_kd" == statement)
+		{
+			material->DiffuseMap = GetTextureFilename(TrimArguments(arguments, lineEnd));
+		}
+		else if ("norm" == statement)
+		{
+			material->NormalMap = GetTextureFilename(TrimArguments(arguments, lineEnd));
+		}
+		else if ("map_ke" == statement)
+		{
+			material->EmissiveMap = GetTextureFilename(TrimArguments(arguments, lineEnd));
+		}
+	}
+}
+
+/// <summary>
+/// Calculates the smooth normals of all positions, accumulating the area-weighted normals of all triangles.
+/// The normals are generated before the faces are split into parts, so there are no seams along the borders of the parts.
+/// </summary>
+GLvoid PBRViewerObjLoader::GeneratePositionNormals()
+{
+	myPositionNormals.assign(myPositions.size(), glm::vec3(0.0f));
+
+	// The length of the cross product is twice the area of the triangle, so larger triangles weigh more.
+	for (const Chunk& chunk : myChunks)
+	{
+		for (size_t i = 0; i + 2u < chunk.Corners.size(); i += 3u)
+		{
+			const GLint i0 = chunk.Corners[i].Position;
+			const GLint i1 = chunk.Corners[i + 1u].Position;
+			const GLint i2 = chunk.Corners[i + 2u].Position;
+
+			const glm::vec3 faceNormal = glm::cross(myPositions[i1] - myPositions[i0], myPositions[i2] - myPositions[i0]);
+			myPositionNormals[i0] += faceNormal;
+			myPositionNormals[i1] += faceNormal;
+			myPositionNormals[i2] += faceNormal;
+		}
+	}
+
+	for (glm::vec3& normal : myPositionNormals)
+	{
+		const GLfloat length = glm::length(normal);
+		normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+}
+
+/// <summary>
+/// Registers the textures of a material, mapping the OBJ texture maps onto the texture types of the shaders like ASSIMP does.
+/// </summary>
+/// <param name="materialName">The name of the material.</param>
+/// <param name="sceneData">The scene data the textures are registered with.</param>
+/// <returns>The references to the textures of the material.</returns>
+std::vector<PBRViewerTextureReference> PBRViewerObjLoader::LoadMaterialTextures( std::string const& materialName, PBRViewerSceneData& sceneData )
+{
+	std::vector<PBRViewerTextureReference> textures;
+
+	const auto material = myMaterials.find(materialName);
+	if (material == myMaterials.end())
+	{
+		return textures;
+	}
+
+	// 1. diffuse (albedo) maps
+	RegisterTexture(material->second.DiffuseMap, PBRViewerEnumerations::TextureDiffuse, sceneData, textures);
+
+	// 2. normal maps ('norm', since ASSIMP reads 'map_Bump' as height map)
+	RegisterTexture(material->second.NormalMap, PBRViewerEnumerations::TextureNormal, sceneData, textures);
+
+	// 3. Emissive maps
+	RegisterTexture(material->second.EmissiveMap, PBRViewerEnumerations::TextureEmissive, sceneData, textures);
+
+	return textures;
+}
+
+/// <summary>
+/// Registers a texture file once for the whole scene.
+/// </summary>
+/// <param name="filepath">The filepath of the texture relative to the directory of the model.</param>
+/// <param name="slot">The slot the texture is bound to.</param>
+/// <param name="sceneData">The scene data the texture is registered with.</param>
+/// <param name="textures">The references of the material, which the texture is added to.</param>
+GLvoid PBRViewerObjLoader::RegisterTexture( std::string const& filepath, const PBRViewerEnumerations::TextureSlot slot, PBRViewerSceneData& sceneData,
+                                            std::vector<PBRViewerTextureReference>& textures )
+{
+	if (filepath.empty())
+	{
+		return;
+	}
+
+	// check if texture was registered before and if so, reuse it: skip decoding the same file twice
+	auto registeredTexture = myTextureIndices.find(filepath);
+	if (registeredTexture == myTextureIndices.end())
+	{
+		PBRViewerTextureData texture;
+		texture.Slot = slot;
+		texture.Filepath = filepath;
+
+		registeredTexture = myTextureIndices.emplace(filepath, static_cast<GLuint>(sceneData.Textures.size())).first;
+		sceneData.Textures.push_back(texture);
+	}
+
+	PBRViewerTextureReference reference;
+	reference.Slot = slot;
+	reference.TextureIndex = registeredTexture->second;
+	textures.push_back(reference);
+}
+
+/// <summary>
+/// Welds the corners of a mesh part into vertices and indices and generates the tangents.
+/// </summary>
+/// <param name="part">The mesh part to weld.</param>
+/// <param name="meshData">The mesh data receiving the vertices and indices.</param>
+GLvoid PBRViewerObjLoader::WeldMeshPart( MeshPart const& part, PBRViewerMeshData& meshData ) const
+{
+	// Open addressing with linear probing, the table is kept at most half full.
+	size_t tableSize = 1u;
+	while (tableSize < 2u * part.NumberOfCorners)
+	{
+		tableSize <<= 1;
+	}
+
+	const GLuint emptySlot = std::numeric_limits<GLuint>::max();
+	const size_t mask = tableSize - 1u;
+	std::vector<GLuint> slots(tableSize, emptySlot);
+
+	// The first corner of each vertex, in the order the vertices are first used.
+	std::vector<Corner> vertexCorners;
+	GLboolean hasTexCoords = GL_FALSE;
+
+	std::vector<GLuint>& indices = meshData.Indices;
+	indices.reserve(part.NumberOfCorners);
+
+	for (const CornerRange& range : part.Ranges)
+	{
+		const std::vector<Corner>& corners = myChunks[range.Chunk].Corners;
+		for (size_t i = range.FirstCorner; i < range.LastCorner; i++)
+		{
+			const Corner& corner = corners[i];
+			size_t slot = HashIndices(corner.Position, corner.TexCoords, corner.Normal) & mask;
+
+			while (emptySlot != slots[slot])
+			{
+				const Corner& vertexCorner = vertexCorners[slots[slot]];
+				if (vertexCorner.Position == corner.Position && vertexCorner.TexCoords == corner.TexCoords && vertexCorner.Normal == corner.Normal)
+				{
+					break;
+				}
+
+				slot = (slot + 1u) & mask;
+			}
+
+			if (emptySlot == slots[slot])
+			{
+				slots[slot] = static_cast<GLuint>(vertexCorners.size());
+				vertexCorners.push_back(corner);
+				hasTexCoords = hasTexCoords || corner.TexCoords >= 0;
+			}
+
+			indices.push_back(slots[slot]);
+		}
+	}
+
+	std::vector<GLuint>().swap(slots);
+
+	// ASSIMP's FlipUVs step turns the texture coordinates upside down, so the native loader does the same.
+	std::vector<Vertex>& vertices = meshData.Vertices;
+	vertices.resize(vertexCorners.size());
+
+	for (size_t i = 0; i < vertexCorners.size(); i++)
+	{
+		const Corner& corner = vertexCorners[i];
+		Vertex& vertex = vertices[i];
+
+		vertex.Position = myPositions[corner.Position];
+		vertex.Normal = corner.Normal >= 0 ? myNormals[corner.Normal] : myPositionNormals[corner.Position];
+		vertex.TexCoords = corner.TexCoords >= 0 ? glm::vec2(myTexCoords[corner.TexCoords].x, 1.0f - myTexCoords[corner.TexCoords].y) : glm::vec2(0.0f);
+		vertex.Tangent = glm::vec3(0.0f);
+		vertex.Bitangent = glm::vec3(0.0f);
+	}
+
+	// Without texture coordinates there is no tangent space, just like with ASSIMP's CalcTangentSpace step.
+	if (GL_FALSE == hasTexCoords)
+	{
+		return;
+	}
+
+	std::vector<glm::vec3> positions(vertices.size());
+	std::vector<glm::vec3> normals(vertices.size());
+	std::vector<glm::vec2> textureCoordinates(vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		positions[i] = vertices[i].Position;
+		normals[i] = vertices[i].Normal;
+		textureCoordinates[i] = vertices[i].TexCoords;
+	}
+
+	const std::vector<glm::vec4> tangents = PBRViewerTangentSpace::GenerateTangents(positions, normals, textureCoordinates, indices);
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		vertices[i].Tangent = glm::vec3(tangents[i]);
+		vertices[i].Bitangent = glm::cross(vertices[i].Normal, vertices[i].Tangent) * tangents[i].w;
+	}
+}
+
+/// <summary>
+/// Parses a decimal floating point number in the C locale, which is considerably faster than the standard library.
+/// </summary>
+/// <param name="position">The first character, leading blanks are skipped.</param>
+/// <param name="end">The end of the line.</param>
+/// <param name="value">The parsed number.</param>
+/// <returns>The character behind the number or nullptr if there is no valid number.</returns>
+const char* PBRViewerObjLoader::ParseFloat( const char* position, const char* end, GLfloat& value )
+{
+	position = SkipBlanks(position, end);
+
+	const GLboolean isNegative = position < end && '-' == *position;
+	if (position < end && ('-' == *position || '+' == *position))
+	{
+		position++;
+	}
+
+	// Digits beyond the precision of the mantissa only shift the exponent.
+	GLuint64 mantissa = 0u;
+	GLint exponent = 0;
+	GLboolean hasDigits = GL_FALSE;
+
+	for (; position < end && std::isdigit(static_cast<unsigned char>(*position)); position++)
+	{
+		hasDigits = GL_TRUE;
+		if (mantissa < 100000000000000000ull)
+		{
+			mantissa = mantissa * 10u + static_cast<GLuint64>(*position - '0');
+		}
+		else
+		{
+			exponent++;
+		}
+	}
+
+	if (position < end && '.' == *position)
+	{
+		for (position++; position < end && std::isdigit(static_cast<unsigned char>(*position)); position++)
+		{
+			hasDigits = GL_TRUE;
+			if (mantissa < 100000000000000000ull)
+			{
+				mantissa = mantissa * 10u + static_cast<GLuint64>(*position - '0');
+				exponent--;
+			}
+		}
+	}
+
+	if (GL_FALSE == hasDigits)
+	{
+		return nullptr;
+	}
+
+	if (position < end && ('e' == *position || 'E' == *position))
+	{
+		position++;
+
+		const GLboolean isExponentNegative = position < end && '-' == *position;
+		if (position < end && ('-' == *position || '+' == *position))
+		{
+			position++;
+		}
+
+		if (position == end || !std::isdigit(static_cast<unsigned char>(*position)))
+		{
+			return nullptr;
+		}
+
+		GLint explicitExponent = 0;
+		for (; position < end && std::isdigit(static_cast<unsigned char>(*position)); position++)
+		{
+			explicitExponent = std::min(explicitExponent * 10 + (*position - '0'), 100000);
+		}
+
+		exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+	}
+
+	if (position < end && GL_FALSE == IsBlank(*position))
+	{
+		return nullptr;
+	}
+
+	// The powers of ten up to 1e22 are exact, so the common case is a single correctly rounded operation.
+	GLdouble result = static_cast<GLdouble>(mantissa);
+	if (0u == mantissa)
+	{
+		result = 0.0;
+	}
+	else if (exponent < 0 && exponent >= -22)
+	{
+		result /= PowersOfTen[-exponent];
+	}
+	else if (exponent > 0 && exponent <= 22)
+	{
+		result *= PowersOfTen[exponent];
+	}
+	else if (0 != exponent)
+	{
+		result *= std::pow(10.0, static_cast<GLdouble>(exponent));
+	}
+
+	value = static_cast<GLfloat>(isNegative ? -result : result);
+	return position;
+}
+
+/// <summary>
+/// Parses a (possibly negative) index of a face.
+/// </summary>
+/// <param name="position">The first character of the index.</param>
+/// <param name="end">The end of the line.</param>
+/// <param name="value">The parsed index, which is never zero.</param>
+/// <returns>The character behind the index or nullptr if there is no valid index.</returns>
+const char* PBRViewerObjLoader::ParseIndex( const char* position, const char* end, GLint& value )
+{
+	const GLboolean isNegative = position < end && '-' == *position;
+	if (isNegative)
+	{
+		position++;
+	}
+
+	if (position == end || !std::isdigit(static_cast<unsigned char>(*position)))
+	{
+		return nullptr;
+	}
+
+	GLint64 index = 0;
+	for (; position < end && std::isdigit(static_cast<unsigned char>(*position)); position++)
+	{
+		index = index * 10 + (*position - '0');
+		if (index > std::numeric_limits<GLint>::max())
+		{
+			return nullptr;
+		}
+	}
+
+	if (0 == index)
+	{
+		return nullptr;
+	}
+
+	value = static_cast<GLint>(isNegative ? -index : index);
+	return position;
+}
+
+/// <summary>
+/// Gets the texture filename of a texture map statement, skipping the options in front of it, e. g. '-bm 1.0'.
+/// </summary>
+/// <param name="arguments">The arguments of the statement.</param>
+/// <returns>The filename of the texture.</returns>
+std::string PBRViewerObjLoader::GetTextureFilename( std::string const& arguments )
+{
+	const char* position = arguments.data();
+	const char* end = position + arguments.size();
+
+	// Options take numbers or on/off as values, except for the type and the channel, which take a word.
+	GLboolean takesWord = GL_FALSE;
+	GLboolean isOption = GL_FALSE;
+
+	while (position < end)
+	{
+		const char* tokenEnd = position;
+		while (tokenEnd < end && GL_FALSE == IsBlank(*tokenEnd))
+		{
+			tokenEnd++;
+		}
+
+		const std::string token(position, tokenEnd);
+		GLfloat number;
+
+		if ('-' == token[0] && token.size() > 1u && !std::isdigit(static_cast<unsigned char>(token[1])) && '.' != token[1])
+		{
+			takesWord = "-type" == token || "-imfchan" == token;
+			isOption = GL_TRUE;
+		}
+		else if (isOption && (takesWord || "on" == token || "off" == token || nullptr != ParseFloat(position, tokenEnd, number)))
+		{
+			takesWord = GL_FALSE;
+		}
+		else
+		{
+			break;
+		}
+
+		position = SkipBlanks(tokenEnd, end);
+	}
+
+	return std::string(position, end);
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerSceneData.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// This class loads Wavefront OBJ models without ASSIMP, e. g. the huge meshes of photogrammetry scans.
+/// The file is memory-mapped and split into line-aligned chunks, which are parsed in parallel on the <see cref="PBRViewerThreadPool"/>.
+/// The faces are split by material into parts of at most one million triangles, like ASSIMP's SplitLargeMeshes step does,
+/// and the parts are welded in parallel into the vertex layout: each distinct combination of position, texture coordinates and normal
+/// becomes one vertex. Polygons are triangulated as fans, points and lines are skipped. Missing normals and tangents are generated.
+/// Files the loader cannot read, e. g. with malformed numbers or out of range indices, are rejected, so the importer can fall back to ASSIMP.
+/// </summary>
+class PBRViewerObjLoader
+{
+public:
+	/// <summary>
+	/// Checks by the file extension if a file is an OBJ model.
+	/// </summary>
+	/// <param name="filepath">The filepath of the model.</param>
+	/// <returns>True if the file is a .obj file, false if not.</returns>
+	static GLboolean IsObjFile( std::string const& filepath );
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerObjLoader"/> class.
+	/// </summary>
+	/// <param name="filepath">The filepath of the OBJ model.</param>
+	explicit PBRViewerObjLoader( std::string const& filepath );
+
+	/// <summary>
+	/// Loads the meshes and the material textures of the model. The textures are registered, but not decoded.
+	/// </summary>
+	/// <param name="sceneData">The scene data to fill. The directory has to be set.</param>
+	/// <returns>True if the model could be loaded, false if it is malformed or contains no triangles.</returns>
+	GLboolean Load( PBRViewerSceneData& sceneData );
+
+private:
+	/// <summary>
+	/// A corner of a triangle referencing its attributes. Missing texture coordinates and normals are marked with a negative index.
+	/// </summary>
+	struct Corner
+	{
+		GLint Position;
+		GLint TexCoords;
+		GLint Normal;
+	};
+
+	/// <summary>
+	/// The corners following a usemtl statement. The first run of a chunk continues the material of the previous chunk.
+	/// </summary>
+	struct MaterialRun
+	{
+		std::string Material;
+		GLboolean IsInherited = GL_FALSE;
+		size_t FirstCorner = 0u;
+	};
+
+	/// <summary>
+	/// A line-aligned part of the file and the statements parsed from it.
+	/// </summary>
+	struct Chunk
+	{
+		const char* Begin = nullptr;
+		const char* End = nullptr;
+
+		std::vector<glm::vec3> Positions;
+		std::vector<glm::vec2> TexCoords;
+		std::vector<glm::vec3> Normals;
+		std::vector<Corner> Corners;
+
+		// Flags the attributes of each corner given as relative (negative) index. Only filled if the chunk uses any.
+		std::vector<GLubyte> RelativeIndices;
+
+		std::vector<MaterialRun> MaterialRuns;
+		std::vector<std::string> MaterialLibraries;
+
+		GLboolean IsValid = GL_TRUE;
+	};
+
+	/// <summary>
+	/// A range of corners within a chunk.
+	/// </summary>
+	struct CornerRange
+	{
+		size_t Chunk;
+		size_t FirstCorner;
+		size_t LastCorner;
+	};
+
+	/// <summary>
+	/// The triangles of a material which become one mesh of the scene.
+	/// </summary>
+	struct MeshPart
+	{
+		std::string Material;
+		std::vector<CornerRange> Ranges;
+		size_t NumberOfCorners = 0u;
+	};
+
+	/// <summary>
+	/// The texture maps of a material of the material library.
+	/// </summary>
+	struct Material
+	{
+		std::string DiffuseMap;
+		std::string NormalMap;
+		std::string EmissiveMap;
+	};
+
+	// Parts are split like ASSIMP's SplitLargeMeshes step does by default, which also spreads the weld across the workers.
+	static const size_t MaximumTrianglesPerPart = 1000000u;
+
+	// Chunks smaller than this are not worth a task of their own.
+	static const size_t MinimumChunkSize = 1u << 20;
+
+	std::string myFilepath;
+	std::vector<Chunk> myChunks;
+
+	std::vector<glm::vec3> myPositions;
+	std::vector<glm::vec2> myTexCoords;
+	std::vector<glm::vec3> myNormals;
+
+	// The smooth normals of the positions, used by the corners without a normal.
+	std::vector<glm::vec3> myPositionNormals;
+
+	std::unordered_map<std::string, Material> myMaterials;
+
+	// Maps the filepath of a texture to its index within the scene data.
+	std::unordered_map<std::string, GLuint> myTextureIndices;
+
+	/// <summary>
+	/// Splits the file into line-aligned chunks and parses them in parallel.
+	/// </summary>
+	/// <param name="data">The content of the file.</param>
+	/// <param name="size">The size of the file in bytes.</param>
+	/// <returns>True if all chunks could be parsed, false if not.</returns>
+	GLboolean ParseChunks( const char* data, size_t size );
+
+	/// <summary>
+	/// Parses the statements of a chunk. Relative indices are resolved against the start of the chunk.
+	/// </summary>
+	/// <param name="chunk">The chunk to parse.</param>
+	static GLvoid ParseChunk( Chunk& chunk );
+
+	/// <summary>
+	/// Concatenates the attributes of all chunks and turns the indices of the corners into indices of the concatenated attributes.
+	/// </summary>
+	/// <returns>True if all indices are in range, false if not.</returns>
+	GLboolean MergeChunks();
+
+	/// <summary>
+	/// Assigns the triangles of all chunks to the mesh parts of their materials.
+	/// </summary>
+	/// <returns>The mesh parts in the order their materials appear in the file.</returns>
+	std::vector<MeshPart> CollectMeshParts() const;
+
+	/// <summary>
+	/// Reads the texture maps of all materials of a material library.
+	/// </summary>
+	/// <param name="filename">The filename of the material library relative to the directory of the model.</param>
+	/// <param name="directory">The directory of the model.</param>
+	GLvoid ReadMaterialLibrary( std::string const& filename, std::string const& directory );
+
+	/// <summary>
+	/// Calculates the smooth normals of all positions, accumulating the area-weighted normals of all triangles.
+	/// The normals are generated before the faces are split into parts, so there are no seams along the borders of the parts.
+	/// </summary>
+	GLvoid GeneratePositionNormals();
+
+	/// <summary>
+	/// Registers the textures of a material, mapping the OBJ texture maps onto the texture types of the shaders like ASSIMP does.
+	/// </summary>
+	/// <param name="materialName">The name of the material.</param>
+	/// <param name="sceneData">The scene data the textures are registered with.</param>
+	/// <returns>The references to the textures of the material.</returns>
+	std::vector<PBRViewerTextureReference> LoadMaterialTextures( std::string const& materialName, PBRViewerSceneData& sceneData );
+
+	/// <summary>
+	/// Registers a texture file once for the whole scene.
+	/// </summary>
+	/// <param name="filepath">The filepath of the texture relative to the directory of the model.</param>
+	/// <param name="slot">The slot the texture is bound to.</param>
+	/// <param name="sceneData">The scene data the texture is registered with.</param>
+	/// <param name="textures">The references of the material, which the texture is added to.</param>
+	GLvoid RegisterTexture( std::string const& filepath, PBRViewerEnumerations::TextureSlot slot, PBRViewerSceneData& sceneData,
+	                        std::vector<PBRViewerTextureReference>& textures );
+
+	/// <summary>
+	/// Welds the corners of a mesh part into vertices and indices and generates the tangents.
+	/// </summary>
+	/// <param name="part">The mesh part to weld.</param>
+	/// <param name="meshData">The mesh data receiving the vertices and indices.</param>
+	GLvoid WeldMeshPart( MeshPart const& part, PBRViewerMeshData& meshData ) const;
+
+	/// <summary>
+	/// Parses a decimal floating point number in the C locale, which is considerably faster than the standard library.
+	/// </summary>
+	/// <param name="position">The first character, leading blanks are skipped.</param>
+	/// <param name="end">The end of the line.</param>
+	/// <param name="value">The parsed number.</param>
+	/// <returns>The character behind the number or nullptr if there is no valid number.</returns>
+	static const char* ParseFloat( const char* position, const char* end, GLfloat& value );
+
+	/// <summary>
+	/// Parses a (possibly negative) index of a face.
+	/// </summary>
+	/// <param name="position">The first character of the index.</param>
+	/// <param name="end">The end of the line.</param>
+	/// <param name="value">The parsed index, which is never zero.</param>
+	/// <returns>The character behind the index or nullptr if there is no valid index.</returns>
+	static const char* ParseIndex( const char* position, const char* end, GLint& value );
+
+	/// <summary>
+	/// Gets the texture filename of a texture map statement, skipping the options in front of it, e. g. '-bm 1.0'.
+	/// </summary>
+	/// <param name="arguments">The arguments of the statement.</param>
+	/// <returns>The filename of the texture.</returns>
+	static std::string GetTextureFilename( std::string const& arguments );
+};
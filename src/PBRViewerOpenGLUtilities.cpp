@@ -1,6 +1,7 @@
 # include "PBRViewerOpenGLUtilities.h"
 
 #include <glad/glad.h>
+#include "PBRViewerStateCache.h"
 #include <glm/ext/matrix_transform.inl>
 
 /// <summary>
@@ -25,7 +26,7 @@ GLvoid PBRViewerOpenGLUtilities::RenderFullScreenQuad()
 		// setup plane VAO
 		glGenVertexArrays(1, &myFullScreenQuadVAO);
 		glGenBuffers(1, &quadVBO);
-		glBindVertexArray(myFullScreenQuadVAO);
+		PBRViewerStateCache::BindVertexArray(myFullScreenQuadVAO);
 		glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof quadVertices, &quadVertices, GL_STATIC_DRAW);
 		glEnableVertexAttribArray(0);
@@ -59,7 +60,7 @@ GLvoid PBRViewerOpenGLUtilities::RenderQuadBottomRight()
 		// setup plane VAO
 		glGenVertexArrays(1, &myQuarterQuadTopRightVAO);
 		glGenBuffers(1, &quadVBO);
-		glBindVertexArray(myQuarterQuadTopRightVAO);
+		PBRViewerStateCache::BindVertexArray(myQuarterQuadTopRightVAO);
 		glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
 		glBufferData(GL_ARRAY_BUFFER, sizeof quadVertices, &quadVertices, GL_STATIC_DRAW);
 		glEnableVertexAttribArray(0);
@@ -117,11 +118,10 @@ std::vector<glm::mat4> PBRViewerOpenGLUtilities::GetCaptureViewsForCubeMap()
 /// </summary>
 /// <param name="textureId">The id of the texture to show.</param>
 /// <param name="shader">The shader to use.</param>	
-GLvoid PBRViewerOpenGLUtilities::ShowTextureBottomRight( const GLuint textureId, PBRViewerShader shader )
+GLvoid PBRViewerOpenGLUtilities::ShowTextureBottomRight( const GLuint textureId, PBRViewerShader const& shader )
 {
 	shader.Use();
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+	PBRViewerStateCache::BindTexture(0u, GL_TEXTURE_CUBE_MAP, textureId);
 	shader.setInt("textureBottomRight", 0);
 
 	RenderQuadBottomRight();
@@ -129,7 +129,6 @@ GLvoid PBRViewerOpenGLUtilities::ShowTextureBottomRight( const GLuint textureId,
 
 GLvoid PBRViewerOpenGLUtilities::RenderQuad( const GLuint vao )
 {
-	glBindVertexArray(vao);
+	PBRViewerStateCache::BindVertexArray(vao);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	glBindVertexArray(0);
 }
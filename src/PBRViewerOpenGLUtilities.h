@@ -32,7 +32,7 @@ public:
 	/// </summary>
 	/// <param name="textureId">The id of the texture to show.</param>
 	/// <param name="shader">The shader to use.</param>	
-	static GLvoid ShowTextureBottomRight(GLuint textureId, PBRViewerShader shader);
+	static GLvoid ShowTextureBottomRight(GLuint textureId, PBRViewerShader const& shader);
 
 private:
 	static GLvoid RenderQuad( GLuint vao );
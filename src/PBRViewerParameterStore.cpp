@@ -0,0 +1,52 @@
+#include "PBRViewerParameterStore.h"
+
+#include <algorithm>
+#include <iterator>
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerParameterStore"/> class.
+/// All fields are dirty for consumers which have not uploaded anything yet.
+/// </summary>
+PBRViewerParameterStore::PBRViewerParameterStore()
+{
+	std::fill(std::begin(myFieldVersions), std::end(myFieldVersions), myVersion);
+}
+
+/// <summary>
+/// Marks a field as changed whose value is held somewhere else, e. g. within the light sources.
+/// </summary>
+/// <param name="field">The changed field.</param>
+GLvoid PBRViewerParameterStore::MarkChanged( const PBRViewerEnumerations::Parameter field )
+{
+	myFieldVersions[field] = ++myVersion;
+}
+
+/// <summary>
+/// Gets the current version. A consumer which uploads all fields stores it as its uploaded version.
+/// </summary>
+/// <returns>The version of the latest change.</returns>
+GLuint PBRViewerParameterStore::GetVersion() const
+{
+	return myVersion;
+}
+
+/// <summary>
+/// Checks if any field of a range has changed since a consumer uploaded it.
+/// </summary>
+/// <param name="first">The first field of the range.</param>
+/// <param name="last">The last field of the range, which is included.</param>
+/// <param name="uploadedVersion">The version the consumer uploaded last, 0 if it has not uploaded anything yet.</param>
+/// <returns>True if at least one field is dirty for the consumer, false if not.</returns>
+GLboolean PBRViewerParameterStore::IsDirty( const PBRViewerEnumerations::Parameter first, const PBRViewerEnumerations::Parameter last,
+                                            const GLuint uploadedVersion ) const
+{
+	for (GLuint field = first; field <= last; field++)
+	{
+		if (myFieldVersions[field] > uploadedVersion)
+		{
+			return GL_TRUE;
+		}
+	}
+
+	return GL_FALSE;
+}
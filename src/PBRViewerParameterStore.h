@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerEnumerations.h"
+
+/// <summary>
+/// This class tracks the changes of the parameters read by the shaders, e. g. the BRDF parameters set within the user interface.
+/// Each change advances the version of the store and stamps the changed field with it. The consumers of the parameters, i. e. the uniform buffers
+/// and the programs, remember the version they uploaded last, so every field stamped with a newer version is dirty for them.
+/// Setting a field to its current value does not advance the version, so a frame without any change uploads nothing.
+/// </summary>
+class PBRViewerParameterStore
+{
+public:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerParameterStore"/> class.
+	/// All fields are dirty for consumers which have not uploaded anything yet.
+	/// </summary>
+	PBRViewerParameterStore();
+
+	/// <summary>
+	/// Sets the value of a field, which is held by the caller. The field is only marked as changed if the value differs.
+	/// </summary>
+	/// <param name="field">The field to set.</param>
+	/// <param name="member">The variable holding the value of the field.</param>
+	/// <param name="value">The new value.</param>
+	/// <returns>True if the value has changed, false if not.</returns>
+	template <typename T>
+	GLboolean Set( const PBRViewerEnumerations::Parameter field, T& member, const T& value )
+	{
+		if (member == value)
+		{
+			return GL_FALSE;
+		}
+
+		member = value;
+		MarkChanged(field);
+		return GL_TRUE;
+	}
+
+	/// <summary>
+	/// Marks a field as changed whose value is held somewhere else, e. g. within the light sources.
+	/// </summary>
+	/// <param name="field">The changed field.</param>
+	GLvoid MarkChanged( PBRViewerEnumerations::Parameter field );
+
+	/// <summary>
+	/// Gets the current version. A consumer which uploads all fields stores it as its uploaded version.
+	/// </summary>
+	/// <returns>The version of the latest change.</returns>
+	GLuint GetVersion() const;
+
+	/// <summary>
+	/// Checks if any field of a range has changed since a consumer uploaded it.
+	/// </summary>
+	/// <param name="first">The first field of the range.</param>
+	/// <param name="last">The last field of the range, which is included.</param>
+	/// <param name="uploadedVersion">The version the consumer uploaded last, 0 if it has not uploaded anything yet.</param>
+	/// <returns>True if at least one field is dirty for the consumer, false if not.</returns>
+	GLboolean IsDirty( PBRViewerEnumerations::Parameter first, PBRViewerEnumerations::Parameter last, GLuint uploadedVersion ) const;
+
+private:
+	// Starts above 0, so every field is dirty for a consumer which has not uploaded anything yet.
+	GLuint myVersion = 1u;
+
+	// The version of the latest change of each field.
+	GLuint myFieldVersions[PBRViewerEnumerations::NumberOfParameters];
+};
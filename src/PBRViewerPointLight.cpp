@@ -24,6 +24,7 @@ PBRViewerPointLight::PBRViewerPointLight( const std::string& pathToModel )
 	if (nullptr == myShader)
 	{
 		myShader = std::make_shared<PBRViewerShader>("CommonVertexShader.vert", "lightsource.frag");
+		myShader->AddFileAtTheEnd(GL_VERTEX_SHADER, "DecodeOctahedral.gl");
 		myShader->Compile();
 	}
 
@@ -97,14 +98,10 @@ GLvoid PBRViewerPointLight::SetLightColor( const glm::vec3 newColor )
 }
 
 /// <summary>
-/// Draws the light source.
+/// Draws the light source. The view and projection matrices are read from the frame uniform block.
 /// </summary>
 /// <param name="modelMatrix">The model matrix used to draw the light.</param>
-/// <param name="viewMatrix">The view matrix used to draw the light.</param>
-/// <param name="projectionMatrix">The projection matrix used to draw the light.</param>	
-GLvoid PBRViewerPointLight::Draw( const glm::mat4 modelMatrix,
-                                  const glm::mat4 viewMatrix,
-                                  const glm::mat4 projectionMatrix ) const
+GLvoid PBRViewerPointLight::Draw( const glm::mat4 modelMatrix ) const
 {
 	if (GL_FALSE == myIsActive)
 	{
@@ -114,8 +111,6 @@ GLvoid PBRViewerPointLight::Draw( const glm::mat4 modelMatrix,
 	myShader->Use();
 
 	myShader->setMat4("model", modelMatrix);
-	myShader->setMat4("view", viewMatrix);
-	myShader->setMat4("projection", projectionMatrix);
 
 	myShader->setVec3("lightColor", myLightColor);
 
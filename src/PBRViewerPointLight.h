@@ -66,12 +66,10 @@ public:
 	GLvoid SetLightColor(glm::vec3 newColor);	
 
 	/// <summary>
-	/// Draws the light source.
+	/// Draws the light source. The view and projection matrices are read from the frame uniform block.
 	/// </summary>
 	/// <param name="modelMatrix">The model matrix used to draw the light.</param>
-	/// <param name="viewMatrix">The view matrix used to draw the light.</param>
-	/// <param name="projectionMatrix">The projection matrix used to draw the light.</param>	
-	GLvoid Draw(glm::mat4 modelMatrix, glm::mat4 viewMatrix, glm::mat4 projectionMatrix) const;
+	GLvoid Draw(glm::mat4 modelMatrix) const;
 
 private:
 	glm::vec3 myPosition = glm::vec3(0.0f);
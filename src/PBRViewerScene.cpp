@@ -1,32 +1,59 @@
 #include "PBRViewerScene.h"
 
-#include "assimp/Importer.hpp"
-#include "assimp/postprocess.h"
-#include <stb_image.h>
+#include "PBRViewerGeometryBuffer.h"
+#include "PBRViewerSceneImporter.h"
 #include "PBRViewerLogger.h"
+#include "PBRViewerStateCache.h"
+#include "PBRViewerTextureCache.h"
+#include "PBRViewerThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <thread>
 #include <glm/ext/quaternion_geometric.inl>
 
 /// <summary>
 /// Initializes a new instance of the <see cref="LearnOpenGLModel"/> class.
 /// </summary>
 /// <param name="path">The filepath to the model.</param>
-PBRViewerScene::PBRViewerScene( std::string const& path )
+/// <param name="keepGeometryOnCpu">True to keep a CPU-side copy of the vertices and indices after the upload.</param>
+PBRViewerScene::PBRViewerScene( std::string const& path, const GLboolean keepGeometryOnCpu )
 {
-	if (loadModel(path))
+	PBRViewerSceneImporter importer(path);
+	if (importer.Import())
 	{
+		Upload(importer.TakeSceneData(), keepGeometryOnCpu);
 		myIsReady = GL_TRUE;
 	}
 }
 
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerScene"/> class from already imported data.
+/// The data is uploaded to the GPU, so this constructor has to be called on the render thread.
+/// </summary>
+/// <param name="sceneData">The scene data as produced by the <see cref="PBRViewerSceneImporter"/>.</param>
+/// <param name="keepGeometryOnCpu">True to keep a CPU-side copy of the vertices and indices after the upload.</param>
+PBRViewerScene::PBRViewerScene( PBRViewerSceneData&& sceneData, const GLboolean keepGeometryOnCpu )
+{
+	Upload(std::move(sceneData), keepGeometryOnCpu);
+	myIsReady = GL_TRUE;
+}
+
 /// <summary>
 /// Disposes internal instances and frees memory.
 /// </summary>	
 GLvoid PBRViewerScene::Cleanup()
 {
-	// Textures
+	// Textures are shared with other scenes by the texture cache, so only the references are released.
 	for (auto& texture : myTextures)
 	{
-		glDeleteTextures(1, &texture.ID);
+		if (GL_FALSE == PBRViewerTextureCache::GetInstance().Release(texture.ID))
+		{
+			glDeleteTextures(1, &texture.ID);
+		}
 	}
 
 	// Meshes
@@ -34,43 +61,273 @@ GLvoid PBRViewerScene::Cleanup()
 	{
 		mesh.Cleanup();
 	}
+
+	glDeleteBuffers(1, &myIndirectBuffer);
+	myIndirectBuffer = 0u;
+	myIndirectBufferSize = 0u;
+	myUploadedDrawCommands.clear();
 }
 
 /// <summary>
-/// Draws the 3D model with the specified shader.
+/// Draws the 3D model with the specified shader. Meshes outside of the frustum of the last <see cref="Cull"/> call are skipped.
+/// The meshes sharing their textures are drawn by a single indirect draw call. The commands have been uploaded by the last <see cref="Cull"/> call,
+/// so drawing the same culling result in several passes does not upload them again.
 /// </summary>
 /// <param name="shader">The shader which will be used to draw the 3D model.</param>	
-GLvoid PBRViewerScene::Draw( std::shared_ptr<PBRViewerShader> const& shader )
+/// <param name="useCulling">True to draw only the meshlets which passed the last <see cref="Cull"/> call. The batched meshes use the commands
+/// uploaded by <see cref="Cull"/>, the flag only affects the meshes in the stream format.</param>	
+GLvoid PBRViewerScene::Draw( std::shared_ptr<PBRViewerShader> const& shader, const GLboolean useCulling )
 {
 	shader->Use();
-	for (auto& mesh : myMeshes)
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, myIndirectBuffer);
+
+	// Most meshes share the vertex array of their vertex format, the state cache only binds it if the format changes.
+	for (const DrawBatch& batch : myDrawBatches)
 	{
-		mesh.Draw(shader);
+		PBRViewerMesh& firstMesh = myMeshes[batch.Meshes.front()];
+		if (batch.IsIndirect && 0u == batch.NumberOfCommands)
+		{
+			continue;
+		}
+
+		PBRViewerStateCache::BindVertexArray(firstMesh.GetVertexArray());
+
+		if (GL_FALSE == batch.IsIndirect)
+		{
+			firstMesh.Draw(shader, useCulling);
+			continue;
+		}
+
+		// All meshes of the batch share the textures of the first one.
+		firstMesh.BindTextures(shader);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, firstMesh.GetIndexType(),
+		                            reinterpret_cast<const GLvoid*>(batch.FirstCommand * sizeof(DrawElementsIndirectCommand)),
+		                            static_cast<GLsizei>(batch.NumberOfCommands), 0);
 	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
 
 /// <summary>
-/// Adds the texture to all meshes so it can be used for rendering.
+/// Selects the level of detail of each mesh by its geometric error projected onto the screen and culls the meshes against the view frustum by their bounds.
+/// The meshlets of the visible meshes are culled against the view frustum and their back faces by the render thread and the workers of the shared thread pool.
+/// The draw commands of the visible meshes, and of their visible meshlets if they have been culled, are uploaded once.
+/// All following <see cref="Draw"/> calls reuse them until the next call.
 /// </summary>
-/// <param name="textureToAdd">The texture to add.</param>
-GLvoid PBRViewerScene::AddTextureToAllMeshes( PBRViewerTexture const& textureToAdd )
+/// <param name="view">The view matrix of the camera.</param>
+/// <param name="projection">The perspective projection matrix of the camera.</param>
+/// <param name="viewportHeight">The height of the viewport in pixels.</param>
+/// <param name="maximumPixelError">The largest acceptable error of the levels of detail in pixels.</param>
+/// <param name="cullMeshlets">True to cull the meshlets as well, false to cull whole meshes only.</param>
+GLvoid PBRViewerScene::Cull( const glm::mat4 view, const glm::mat4 projection, const GLint viewportHeight, const GLfloat maximumPixelError,
+                              const GLboolean cullMeshlets )
 {
+	// The meshlet bounds and the errors of the levels of detail are in model space, so the planes and the camera are transformed into it instead.
+	// The ratio of error and distance does not change with a uniform scale of the model matrix.
+	const glm::mat4 modelViewProjection = projection * view * myModelMatrix;
+	const glm::vec3 cameraPosition = glm::vec3(glm::inverse(view * myModelMatrix)[3]);
+	const GLfloat pixelsPerUnit = 0.5f * projection[1][1] * static_cast<GLfloat>(viewportHeight);
+
+	// Extract the planes from the rows of the matrix (Gribb and Hartmann). glm matrices are column-major.
+	const glm::vec4 rows[4] =
+	{
+		glm::vec4(modelViewProjection[0][0], modelViewProjection[1][0], modelViewProjection[2][0], modelViewProjection[3][0]),
+		glm::vec4(modelViewProjection[0][1], modelViewProjection[1][1], modelViewProjection[2][1], modelViewProjection[3][1]),
+		glm::vec4(modelViewProjection[0][2], modelViewProjection[1][2], modelViewProjection[2][2], modelViewProjection[3][2]),
+		glm::vec4(modelViewProjection[0][3], modelViewProjection[1][3], modelViewProjection[2][3], modelViewProjection[3][3])
+	};
+
+	glm::vec4 frustumPlanes[6] =
+	{
+		rows[3] + rows[0], rows[3] - rows[0],
+		rows[3] + rows[1], rows[3] - rows[1],
+		rows[3] + rows[2], rows[3] - rows[2]
+	};
+
+	for (glm::vec4& plane : frustumPlanes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+
+	myNumberOfCulledTriangles = 0u;
+	myNumberOfVisibleMeshes = 0u;
+
+	// A helper of an earlier call which has not started yet still holds its job, the ranges must not change under it.
+	if (nullptr == myCullingJob || 1 != myCullingJob.use_count())
+	{
+		myCullingJob = std::make_shared<CullingJob>();
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	CullingJob& job = *myCullingJob;
+	job.Ranges.clear();
+	std::copy(std::begin(frustumPlanes), std::end(frustumPlanes), job.FrustumPlanes);
+	job.CameraPosition = cameraPosition;
+	job.NextRange = 0u;
+	job.NumberOfFinishedRanges = 0u;
+	job.NumberOfCulledTriangles = 0u;
+
 	for (auto& mesh : myMeshes)
 	{
-		mesh.AddTexture(textureToAdd);
+		// The level of detail is selected first, so a culled mesh counts the triangles this pass would have drawn.
+		mesh.SelectLod(cameraPosition, pixelsPerUnit, maximumPixelError);
+
+		// The bounds are tested on the render thread, a few plane tests per mesh are not worth a task.
+		if (GL_FALSE == mesh.CullBounds(frustumPlanes))
+		{
+			myNumberOfCulledTriangles += mesh.GetNumberOfTriangles();
+			continue;
+		}
+
+		myNumberOfVisibleMeshes++;
+
+		// The meshlets belong to the full detail level, coarser levels are drawn as a whole.
+		const GLuint numberOfMeshlets = cullMeshlets && 0u == mesh.GetCurrentLod() ? mesh.GetNumberOfMeshlets() : 0u;
+		for (GLuint firstMeshlet = 0; firstMeshlet < numberOfMeshlets; firstMeshlet += MeshletsPerCullingTask)
+		{
+			MeshletRange range;
+			range.Mesh = &mesh;
+			range.FirstMeshlet = firstMeshlet;
+			range.LastMeshlet = std::min(firstMeshlet + MeshletsPerCullingTask, numberOfMeshlets);
+			job.Ranges.push_back(range);
+		}
 	}
+
+	if (false == job.Ranges.empty())
+	{
+		// The workers of the shared pool help out instead of running a pool of their own, which would oversubscribe the cores during an import.
+		// The render thread takes part as well, so it only waits for the ranges which are being culled.
+		PBRViewerThreadPool& threadPool = PBRViewerThreadPool::GetInstance();
+		const size_t numberOfHelpers = std::min(static_cast<size_t>(threadPool.GetNumberOfThreads()), job.Ranges.size() - 1u);
+		for (size_t i = 0; i < numberOfHelpers; i++)
+		{
+			std::shared_ptr<CullingJob> helperJob = myCullingJob;
+			threadPool.Enqueue([helperJob]()
+			{
+				CullMeshletRanges(*helperJob);
+			});
+		}
+
+		CullMeshletRanges(job);
+		while (job.NumberOfFinishedRanges < job.Ranges.size())
+		{
+			std::this_thread::yield();
+		}
+
+		myNumberOfCulledTriangles += job.NumberOfCulledTriangles;
+	}
+
+	UploadDrawCommands(cullMeshlets);
 }
 
 /// <summary>
-/// Removes the texture from all meshes.
+/// Gets the number of triangles removed by the last <see cref="Cull"/> call.
+/// The triangles are counted at the levels of detail selected by the same call, i. e. the triangles its pass would have drawn without culling.
 /// </summary>
-/// <param name="textureToRemove">The texture to remove.</param>
-GLvoid PBRViewerScene::RemoveTextureFromAllMeshes( PBRViewerTexture const& textureToRemove )
+/// <returns>The number of culled triangles.</returns>
+GLuint PBRViewerScene::GetNumberOfCulledTriangles() const
 {
-	for (auto& mesh : myMeshes)
+	return myNumberOfCulledTriangles;
+}
+
+/// <summary>
+/// Gets the number of meshes which passed the last <see cref="Cull"/> call.
+/// </summary>
+/// <returns>The number of visible meshes.</returns>
+GLuint PBRViewerScene::GetNumberOfVisibleMeshes() const
+{
+	return myNumberOfVisibleMeshes;
+}
+
+/// <summary>
+/// Gets the number of meshes of the scene.
+/// </summary>
+/// <returns>The number of meshes.</returns>
+GLuint PBRViewerScene::GetNumberOfMeshes() const
+{
+	return static_cast<GLuint>(myMeshes.size());
+}
+
+/// <summary>
+/// Gets the minimum corner of the axis-aligned bounding box of all meshes in model space.
+/// </summary>
+/// <returns>The minimum corner of the bounding box.</returns>
+glm::vec3 PBRViewerScene::GetBoundingBoxMin() const
+{
+	return myBoundingBoxMin;
+}
+
+/// <summary>
+/// Gets the maximum corner of the axis-aligned bounding box of all meshes in model space.
+/// </summary>
+/// <returns>The maximum corner of the bounding box.</returns>
+glm::vec3 PBRViewerScene::GetBoundingBoxMax() const
+{
+	return myBoundingBoxMax;
+}
+
+/// <summary>
+/// Gets the center of the bounding sphere of all meshes in model space.
+/// </summary>
+/// <returns>The center of the bounding sphere.</returns>
+glm::vec3 PBRViewerScene::GetBoundingSphereCenter() const
+{
+	return myBoundingSphereCenter;
+}
+
+/// <summary>
+/// Gets the radius of the bounding sphere of all meshes in model units.
+/// </summary>
+/// <returns>The radius of the bounding sphere.</returns>
+GLfloat PBRViewerScene::GetBoundingSphereRadius() const
+{
+	return myBoundingSphereRadius;
+}
+
+/// <summary>
+/// Finds the closest surface point of the full detail meshes hit by a ray, e. g. the one under the cursor.
+/// </summary>
+/// <param name="origin">The origin of the ray in world space.</param>
+/// <param name="direction">The direction of the ray in world space.</param>
+/// <param name="hit">The closest intersection in world space, only valid if the ray hit a mesh.</param>
+/// <returns>True if the ray hit a mesh, false if not or if the scene has no bounding volume hierarchy.</returns>
+GLboolean PBRViewerScene::Pick( const glm::vec3 origin, const glm::vec3 direction, PBRViewerRayHit& hit ) const
+{
+	if (nullptr == myBvh)
 	{
-		mesh.RemoveTexture(textureToRemove);
+		return GL_FALSE;
 	}
+
+	// The hierarchy is built in model space, so the ray is moved into it instead of transforming the triangles.
+	// The distance along the ray stays the same, since the direction is transformed as well.
+	const glm::mat4 inverseModelMatrix = glm::inverse(myModelMatrix);
+	const glm::vec3 modelOrigin = glm::vec3(inverseModelMatrix * glm::vec4(origin, 1.0f));
+	const glm::vec3 modelDirection = glm::mat3(inverseModelMatrix) * direction;
+
+	if (GL_FALSE == myBvh->Intersect(modelOrigin, modelDirection, hit))
+	{
+		return GL_FALSE;
+	}
+
+	hit.Position = origin + hit.Distance * direction;
+	hit.Normal = glm::normalize(glm::transpose(glm::mat3(inverseModelMatrix)) * hit.Normal);
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Gets the material textures of a mesh, i. e. the textures read from the model.
+/// </summary>
+/// <param name="meshIndex">The index of the mesh.</param>
+/// <returns>The material textures of the mesh.</returns>
+std::vector<PBRViewerTexture> PBRViewerScene::GetMaterialTextures( const GLuint meshIndex ) const
+{
+	if (meshIndex >= myMeshes.size())
+	{
+		return std::vector<PBRViewerTexture>();
+	}
+
+	return myMeshes[meshIndex].GetTextures();
 }
 
 /// <summary>
@@ -207,266 +464,389 @@ GLvoid PBRViewerScene::UpdateVectors()
 }
 
 /// <summary>
-///  Loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
+/// Calculates the bounds of the scene from the bounds of its meshes.
 /// </summary>
-/// <param name="path">The filepath to the model.</param>
-GLboolean PBRViewerScene::loadModel( std::string const& path )
-{
-	// Read file via ASSIMP
-	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(path,
-	                                         aiProcess_Triangulate |
-	                                         aiProcess_JoinIdenticalVertices |
-	                                         aiProcess_SplitLargeMeshes |
-	                                         aiProcess_FlipUVs |
-	                                         aiProcess_OptimizeMeshes |
-	                                         aiProcess_OptimizeGraph |
-	                                         aiProcess_CalcTangentSpace |
-	                                         aiProcess_ValidateDataStructure);
-
-	// Check for errors
-	if (nullptr == scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || nullptr == scene->mRootNode)
+GLvoid PBRViewerScene::CalculateBounds()
+{
+	if (myMeshes.empty())
 	{
-		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, importer.GetErrorString());
-		return GL_FALSE;
+		return;
 	}
 
-	// retrieve the directory path of the filepath
-	myDirectory = path.substr(0, path.find_last_of('\\'));
+	myBoundingBoxMin = myMeshes.front().GetBoundingBoxMin();
+	myBoundingBoxMax = myMeshes.front().GetBoundingBoxMax();
+	for (const auto& mesh : myMeshes)
+	{
+		myBoundingBoxMin = glm::min(myBoundingBoxMin, mesh.GetBoundingBoxMin());
+		myBoundingBoxMax = glm::max(myBoundingBoxMax, mesh.GetBoundingBoxMax());
+	}
 
-	// process ASSIMP's root node recursively
-	processNode(scene->mRootNode, scene);
+	// The sphere around the center of the box encloses the spheres of all meshes.
+	myBoundingSphereCenter = 0.5f * (myBoundingBoxMin + myBoundingBoxMax);
+	myBoundingSphereRadius = 0.0f;
+	for (const auto& mesh : myMeshes)
+	{
+		myBoundingSphereRadius = std::max(myBoundingSphereRadius,
+		                                  glm::length(mesh.GetBoundingSphereCenter() - myBoundingSphereCenter) + mesh.GetBoundingSphereRadius());
+	}
+}
 
-	return GL_TRUE;
+/// <summary>
+/// Groups the meshes into draw batches by their textures, vertex format and index type.
+/// The batches keep the order in which their first meshes appear in the scene.
+/// </summary>
+GLvoid PBRViewerScene::BuildDrawBatches()
+{
+	myDrawBatches.clear();
+
+	for (size_t meshIndex = 0; meshIndex < myMeshes.size(); meshIndex++)
+	{
+		const PBRViewerMesh& mesh = myMeshes[meshIndex];
+		const auto batch = std::find_if(myDrawBatches.begin(), myDrawBatches.end(), [this, &mesh]( DrawBatch const& candidate )
+		{
+			return candidate.IsIndirect && mesh.CanBatchWith(myMeshes[candidate.Meshes.front()]);
+		});
+
+		if (batch != myDrawBatches.end())
+		{
+			batch->Meshes.push_back(meshIndex);
+			continue;
+		}
+
+		DrawBatch newBatch;
+		newBatch.Meshes.push_back(meshIndex);
+		newBatch.IsIndirect = PBRViewerEnumerations::Streams != mesh.GetVertexFormat();
+		myDrawBatches.push_back(newBatch);
+	}
 }
 
 /// <summary>
-/// Processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+/// Fills the indirect buffer with the draw commands of all batches. The buffer is only changed if the commands differ from the uploaded ones.
 /// </summary>
-/// <param name="node">The node to process.</param>
-/// <param name="scene">The scene as returned by ASSIMP.</param>
-GLvoid PBRViewerScene::processNode( aiNode* node, const aiScene* scene )
+/// <param name="useCulling">True to draw only the meshlets which passed the last <see cref="Cull"/> call.</param>	
+GLvoid PBRViewerScene::UploadDrawCommands( const GLboolean useCulling )
 {
-	// process each mesh located at the current node
-	for (GLuint i = 0; i < node->mNumMeshes; i++)
+	myDrawCommands.clear();
+	for (DrawBatch& batch : myDrawBatches)
 	{
-		// the node object only contains indices to index the actual objects in the scene. 
-		// the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-		myMeshes.push_back(processMesh(mesh, scene));
+		batch.FirstCommand = myDrawCommands.size();
+		if (batch.IsIndirect)
+		{
+			for (const size_t meshIndex : batch.Meshes)
+			{
+				myMeshes[meshIndex].AppendDrawCommands(myDrawCommands, useCulling);
+			}
+		}
+
+		batch.NumberOfCommands = myDrawCommands.size() - batch.FirstCommand;
 	}
 
-	// after we've processed all of the meshes (if any) we then recursively process each of the children nodes
-	for (GLuint i = 0; i < node->mNumChildren; i++)
+	// The shadow passes often see the same meshes at the same levels of detail, so their commands do not change.
+	if (myDrawCommands.size() == myUploadedDrawCommands.size() && (myDrawCommands.empty() ||
+		0 == std::memcmp(myDrawCommands.data(), myUploadedDrawCommands.data(), myDrawCommands.size() * sizeof(DrawElementsIndirectCommand))))
 	{
-		processNode(node->mChildren[i], scene);
+		return;
 	}
+
+	std::swap(myDrawCommands, myUploadedDrawCommands);
+
+	if (0u == myIndirectBuffer)
+	{
+		glGenBuffers(1, &myIndirectBuffer);
+	}
+
+	// Reallocating the storage lets the driver keep the commands of the previous pass alive until they have been read.
+	const size_t commandsSize = myUploadedDrawCommands.size() * sizeof(DrawElementsIndirectCommand);
+	myIndirectBufferSize = std::max(myIndirectBufferSize, commandsSize);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, myIndirectBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(myIndirectBufferSize), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(commandsSize), myUploadedDrawCommands.data());
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
 
 /// <summary>
-/// Extracts all properties from a mesh like vertices, texture coordinates, textures, ...
+/// Uploads the imported scene data to the GPU and stores the resulting meshes in the meshes vector.
+/// The vertices and indices are moved into the meshes.
 /// </summary>
-/// <param name="mesh">The mesh to process.</param>
-/// <param name="scene">The scene as returned by ASSIMP.</param>
-/// <returns>The transformed mesh with all important properties in PBRViewer format.</returns>
-PBRViewerMesh PBRViewerScene::processMesh( aiMesh* mesh, const aiScene* scene )
+/// <param name="sceneData">The imported scene data.</param>
+/// <param name="keepGeometryOnCpu">True to keep a CPU-side copy of the vertices and indices after the upload.</param>
+GLvoid PBRViewerScene::Upload( PBRViewerSceneData&& sceneData, const GLboolean keepGeometryOnCpu )
 {
-	std::vector<Vertex> vertices;
-	std::vector<GLuint> indices;
-	std::vector<PBRViewerTexture> textures;
+	myDirectory = sceneData.Directory;
+	myBvh = sceneData.Bvh;
 
-	// Walk through each of the mesh's vertices
-	for (GLuint i = 0; i < mesh->mNumVertices; i++)
+	PBRViewerTextureCache& textureCache = PBRViewerTextureCache::GetInstance();
+	PBRViewerImportReport& report = sceneData.Report;
+
+	// Upload the textures in the order their decoding has finished.
+	const auto textureStartTime = std::chrono::steady_clock::now();
+	myTextures.resize(sceneData.Textures.size());
+	for (const GLuint textureIndex : sceneData.TextureUploadOrder)
 	{
-		Vertex vertex{};
-		glm::vec3 vector;
-		// we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
-
-		// Vertex positions
-		vector.x = mesh->mVertices[i].x;
-		vector.y = mesh->mVertices[i].y;
-		vector.z = mesh->mVertices[i].z;
-		vertex.Position = vector;
-
-		// Vertex normals
-		if (mesh->mNormals)
+		PBRViewerTextureData& textureData = sceneData.Textures[textureIndex];
+		const auto startTime = std::chrono::steady_clock::now();
+
+		PBRViewerTexture& texture = myTextures[textureIndex];
+		texture.Slot = textureData.Slot;
+		texture.Filepath = textureData.Filepath;
+
+		if (!textureData.CacheKey.empty() && textureCache.Acquire(textureData.CacheKey, texture.ID))
 		{
-			vector.x = mesh->mNormals[i].x;
-			vector.y = mesh->mNormals[i].y;
-			vector.z = mesh->mNormals[i].z;
-			vertex.Normal = vector;
+			report.AddTexture(textureData.Filepath, 0.0, 0.0, GL_TRUE);
+			continue;
 		}
 
-		// Vertex texture coordinates
-		if (mesh->mTextureCoords[0]) // does the mesh contain texture coordinates?
+		if (textureData.IsResident)
 		{
-			glm::vec2 vec;
-
-			// a vertex can contain up to 8 different texture coordinates. We thus make the assumption that we won't 
-			// use models where a vertex can have multiple texture coordinates so we always take the first set (0).
-			vec.x = mesh->mTextureCoords[0][i].x;
-			vec.y = mesh->mTextureCoords[0][i].y;
-			vertex.TexCoords = vec;
+			// The texture was evicted from the cache after the import had skipped its decoding.
+			PBRViewerSceneImporter::DecodeTexture(myDirectory, sceneData.CompressTextures, textureData);
 		}
-		else
+
+		texture.ID = TextureFromData(textureData);
+
+		if (!textureData.MipLevels.empty() && !textureData.CacheKey.empty())
 		{
-			vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+			size_t size = 0u;
+			for (const std::vector<GLubyte>& level : textureData.MipLevels)
+			{
+				size += level.size();
+			}
+
+			textureCache.Add(textureData.CacheKey, texture.ID, size);
 		}
 
-		if (mesh->mTangents)
-		{
-			glm::vec3 tangent;
+		const GLdouble uploadTime = std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		report.AddTexture(textureData.Filepath, textureData.DecodeTime, uploadTime, GL_FALSE);
+	}
 
-			tangent.x = mesh->mTangents[i].x;
-			tangent.y = mesh->mTangents[i].y;
-			tangent.z = mesh->mTangents[i].z;
+	report.AddPhase("Texture upload", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - textureStartTime).count());
 
-			vertex.Tangent = tangent;
-		}
+	const auto meshStartTime = std::chrono::steady_clock::now();
+	size_t releasedBytes = 0u;
+	myMeshes.reserve(sceneData.Meshes.size());
 
-		if (mesh->mBitangents)
+	// Make room for all meshes at once, so the shared buffers are not reallocated and copied while the meshes are uploaded.
+	size_t numberOfVertices[2] = {};
+	size_t indexSizes[2] = {};
+	size_t numberOfMeshes[2] = {};
+	for (const auto& meshData : sceneData.Meshes)
+	{
+		if (PBRViewerEnumerations::Streams == meshData.VertexFormat)
 		{
-			glm::vec3 bitangent;
-
-			bitangent.x = mesh->mBitangents[i].x;
-			bitangent.y = mesh->mBitangents[i].y;
-			bitangent.z = mesh->mBitangents[i].z;
+			continue;
+		}
 
-			vertex.Bitangent = bitangent;
+		size_t meshVertices = PBRViewerEnumerations::Quantized == meshData.VertexFormat ? meshData.CompactVertices.size() : meshData.Vertices.size();
+		size_t meshIndices = meshData.Indices.size();
+		if (meshData.MappedVertices || meshData.MappedCompactVertices)
+		{
+			meshVertices = meshData.NumberOfMappedVertices;
+			meshIndices = meshData.NumberOfMappedIndices;
 		}
 
-		vertices.push_back(vertex);
+		const size_t indexSize = GL_UNSIGNED_SHORT == PBRViewerMesh::GetIndexTypeForVertices(static_cast<GLuint>(meshVertices)) ? sizeof(GLushort) : sizeof(GLuint);
+
+		numberOfVertices[meshData.VertexFormat] += meshVertices;
+		indexSizes[meshData.VertexFormat] += (meshIndices * indexSize + 3u) / 4u * 4u;
+		numberOfMeshes[meshData.VertexFormat]++;
 	}
 
-	// Now walk through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
-	for (GLuint i = 0; i < mesh->mNumFaces; i++)
-	{
-		aiFace face = mesh->mFaces[i];
+	PBRViewerGeometryBuffer::GetInstance(PBRViewerEnumerations::FullPrecision).Reserve(numberOfVertices[PBRViewerEnumerations::FullPrecision],
+	                                                                                   indexSizes[PBRViewerEnumerations::FullPrecision],
+	                                                                                   numberOfMeshes[PBRViewerEnumerations::FullPrecision]);
+	PBRViewerGeometryBuffer::GetInstance(PBRViewerEnumerations::Quantized).Reserve(numberOfVertices[PBRViewerEnumerations::Quantized],
+	                                                                               indexSizes[PBRViewerEnumerations::Quantized],
+	                                                                               numberOfMeshes[PBRViewerEnumerations::Quantized]);
 
-		// retrieve all indices of the face and store them in the indices vector
-		for (GLuint j = 0; j < face.mNumIndices; j++)
+	for (auto& meshData : sceneData.Meshes)
+	{
+		std::vector<PBRViewerTexture> textures;
+		textures.reserve(meshData.Textures.size());
+		for (const auto& textureReference : meshData.Textures)
 		{
-			indices.push_back(face.mIndices[j]);
+			// The same image may be used with different types by different materials.
+			PBRViewerTexture texture = myTextures[textureReference.TextureIndex];
+			texture.Slot = textureReference.Slot;
+			textures.push_back(texture);
 		}
-	}
 
-	// process materials
-	aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+		if (PBRViewerEnumerations::Streams == meshData.VertexFormat)
+		{
+			// The glTF attributes go straight from the mapped buffers into the vertex buffer, the indices as well if OpenGL can read them.
+			const GLboolean isMapped = nullptr != meshData.MappedStreamIndices;
+			myMeshes.emplace_back(meshData.Streams, meshData.NumberOfMappedVertices,
+			                      isMapped ? meshData.MappedStreamIndices : meshData.Indices.data(),
+			                      isMapped ? meshData.MappedStreamIndexType : static_cast<GLenum>(GL_UNSIGNED_INT),
+			                      isMapped ? meshData.NumberOfMappedIndices : static_cast<GLuint>(meshData.Indices.size()),
+			                      meshData.BoundingBoxMin, meshData.BoundingBoxMax, std::move(textures));
+		}
+		else if (PBRViewerEnumerations::Quantized == meshData.VertexFormat)
+		{
+			// Compact vertices are not kept on the CPU, they are released together with the scene data.
+			const GLboolean isMapped = nullptr != meshData.MappedCompactVertices;
+			myMeshes.emplace_back(isMapped ? meshData.MappedCompactVertices : meshData.CompactVertices.data(),
+			                      isMapped ? meshData.NumberOfMappedVertices : static_cast<GLuint>(meshData.CompactVertices.size()),
+			                      meshData.PositionOffset, meshData.PositionScale,
+			                      isMapped ? meshData.MappedIndices : meshData.Indices.data(),
+			                      isMapped ? meshData.NumberOfMappedIndices : static_cast<GLuint>(meshData.Indices.size()),
+			                      std::move(textures));
+		}
+		else if (meshData.MappedVertices)
+		{
+			// Geometry from the mesh cache goes straight from the mapped file into the buffers.
+			myMeshes.emplace_back(meshData.MappedVertices, meshData.NumberOfMappedVertices,
+			                      meshData.MappedIndices, meshData.NumberOfMappedIndices, std::move(textures));
+		}
+		else
+		{
+			myMeshes.emplace_back(std::move(meshData.Vertices), std::move(meshData.Indices), std::move(textures));
 
-	// 1. diffuse (albedo) maps
-	std::vector<PBRViewerTexture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "textureDiffuse");
-	textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+			if (GL_FALSE == keepGeometryOnCpu)
+			{
+				releasedBytes += myMeshes.back().ReleaseGeometry();
+			}
+		}
 
-	// 2. normal maps
-	std::vector<PBRViewerTexture> normalMaps = loadMaterialTextures(material, aiTextureType_NORMALS, "textureNormal");
-	textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+		PBRViewerMesh& mesh = myMeshes.back();
+		if (meshData.MappedMeshlets)
+		{
+			mesh.SetMeshlets(meshData.MappedMeshlets, meshData.NumberOfMappedMeshlets);
+		}
+		else
+		{
+			mesh.SetMeshlets(meshData.Meshlets.data(), static_cast<GLuint>(meshData.Meshlets.size()));
+		}
 
-	// 3. Roughness maps (also include AO and metallic components on different color channels)
-	std::vector<PBRViewerTexture> roughnessMaps = loadMaterialTextures(material, aiTextureType_UNKNOWN, "textureRoughness");
-	textures.insert(textures.end(), roughnessMaps.begin(), roughnessMaps.end());
+		if (meshData.MappedLods)
+		{
+			mesh.SetLods(meshData.MappedLods, meshData.NumberOfMappedLods);
+		}
+		else
+		{
+			mesh.SetLods(meshData.Lods.data(), static_cast<GLuint>(meshData.Lods.size()));
+		}
 
-	// 4. Emissive maps
-	std::vector<PBRViewerTexture> emissiveMaps = loadMaterialTextures(material, aiTextureType_EMISSIVE, "textureEmissive");
-	textures.insert(textures.end(), emissiveMaps.begin(), emissiveMaps.end());
+		const GLboolean hasShortIndices = GL_UNSIGNED_SHORT == mesh.GetIndexType();
+		report.AddMesh(mesh.GetNumberOfVertices(), mesh.GetNumberOfIndices(), mesh.GetVertexSize(),
+		               static_cast<GLuint>(hasShortIndices ? sizeof(GLushort) : sizeof(GLuint)));
+	}
 
-	// return a mesh object created from the extracted mesh data
-	return PBRViewerMesh(vertices, indices, textures);
+	report.AddPhase("Mesh upload (" + std::to_string(myMeshes.size()) + " meshes)",
+	                std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - meshStartTime).count());
+	CalculateBounds();
+	BuildDrawBatches();
+	UploadDrawCommands(GL_FALSE);
+	myNumberOfVisibleMeshes = static_cast<GLuint>(myMeshes.size());
+	report.AddStatistic("Draw batches", static_cast<GLdouble>(myDrawBatches.size()));
+	report.AddStatistic("Shared geometry buffers (MB)",
+	                    static_cast<GLdouble>(PBRViewerGeometryBuffer::GetInstance(PBRViewerEnumerations::FullPrecision).GetCapacity() +
+	                                          PBRViewerGeometryBuffer::GetInstance(PBRViewerEnumerations::Quantized).GetCapacity()) / (1024.0 * 1024.0));
+	report.Print();
+	report.Write();
+
+	if (releasedBytes > 0u)
+	{
+		std::stringstream message;
+		message << std::fixed << std::setprecision(1);
+		message << "Released " << static_cast<GLdouble>(releasedBytes) / (1024.0 * 1024.0) << " MB of CPU-side geometry after the upload";
+		PBRViewerLogger::PrintInfoMessage(message.str());
+	}
 }
 
 /// <summary>
-/// Loads a texture from a filepath.
-/// Usually, the textures are stored in the same directory as the 3D model.
+/// Creates an OpenGL texture from a mip chain generated on the CPU. The levels may be block-compressed.
 /// </summary>
-/// <param name="path">The filepath to the texture.</param>
+/// <param name="textureData">The decoded texture.</param>
 /// <returns>The id of the texture.</returns>
-GLuint PBRViewerScene::TextureFromFile( const GLchar* path ) const
+GLuint PBRViewerScene::TextureFromData( PBRViewerTextureData const& textureData ) const
 {
-	std::string filename = std::string(path);
-	filename = myDirectory + '\\' + filename;
-
 	GLuint textureID;
 	glGenTextures(1, &textureID);
 
-	GLint width, height, nrComponents;	
-	GLubyte* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-	if (data)
+	if (textureData.MipLevels.empty())
 	{
-		GLenum format = GL_RED;
-		if (nrComponents == 1)
+		return textureID;
+	}
+
+	GLenum internalFormat = textureData.CompressedFormat;
+	GLenum format = GL_RED;
+	if (0 == textureData.CompressedFormat)
+	{
+		if (textureData.Components == 1)
 		{
+			internalFormat = GL_R8;
 			format = GL_RED;
 		}
-		else if (nrComponents == 3)
+		else if (textureData.Components == 2)
 		{
+			internalFormat = GL_RG8;
+			format = GL_RG;
+		}
+		else if (textureData.Components == 3)
+		{
+			internalFormat = GL_RGB8;
 			format = GL_RGB;
 		}
-		else if (nrComponents == 4)
+		else if (textureData.Components == 4)
 		{
+			internalFormat = GL_RGBA8;
 			format = GL_RGBA;
 		}
+	}
 
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(textureData.MipLevels.size()), internalFormat, textureData.Width, textureData.Height);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// The rows of small or odd-sized levels are not aligned to four bytes.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-		stbi_image_free(data);
-	}
-	else
+	GLint levelWidth = textureData.Width;
+	GLint levelHeight = textureData.Height;
+	for (size_t level = 0; level < textureData.MipLevels.size(); level++)
 	{
-		std::string message = "Texture failed to load at path: ";
-		message += path;
-		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, message);
-		stbi_image_free(data);
+		const std::vector<GLubyte>& levelData = textureData.MipLevels[level];
+		if (textureData.CompressedFormat)
+		{
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0, levelWidth, levelHeight, textureData.CompressedFormat,
+			                          static_cast<GLsizei>(levelData.size()), levelData.data());
+		}
+		else
+		{
+			glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0, levelWidth, levelHeight, format, GL_UNSIGNED_BYTE, levelData.data());
+		}
+
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
 	}
 
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
 	return textureID;
 }
 
 /// <summary>
-/// Loads the material textures (if any).
+/// Claims and culls meshlet ranges of the job until none is left.
 /// </summary>
-/// <param name="mat">The material to process.</param>
-/// <param name="type">The type of the texture to extract from the material.</param>
-/// <param name="typeName">The internal name of the texture type as string.</param>
-/// <returns>A vector containing all textures extracted from the material (if any).</returns>
-std::vector<PBRViewerTexture> PBRViewerScene::loadMaterialTextures( aiMaterial* mat,
-                                                                    const aiTextureType type,
-                                                                    const std::string& typeName )
+/// <param name="job">The culling job.</param>
+GLvoid PBRViewerScene::CullMeshletRanges( CullingJob& job )
 {
-	std::vector<PBRViewerTexture> textures;
-	for (GLuint i = 0; i < mat->GetTextureCount(type); ++i)
-	{
-		aiString str;
-		mat->GetTexture(type, i, &str);
-
-		// check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-		GLboolean textureAlreadyLoaded = GL_FALSE;
-		for (auto& loadedTexture : textures)
-		{
-			if (std::strcmp(loadedTexture.Filepath.data(), str.C_Str()) == 0)
-			{
-				textureAlreadyLoaded = GL_TRUE;
-				break;
-			}
-		}
+	GLuint numberOfCulledTriangles = 0u;
+	size_t numberOfFinishedRanges = 0u;
 
-		// if texture hasn't been loaded already, load it
-		if (GL_FALSE == textureAlreadyLoaded)
-		{
-			PBRViewerTexture texture;
-			texture.ID = TextureFromFile(str.C_Str());
-			texture.Type = typeName;
-			texture.Filepath = str.C_Str();
-			textures.push_back(texture);
-			myTextures.push_back(texture);
-			// store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
-		}
+	for (size_t i = job.NextRange++; i < job.Ranges.size(); i = job.NextRange++)
+	{
+		const MeshletRange& range = job.Ranges[i];
+		numberOfCulledTriangles += range.Mesh->CullMeshlets(job.FrustumPlanes, job.CameraPosition, range.FirstMeshlet, range.LastMeshlet);
+		numberOfFinishedRanges++;
 	}
 
-	return textures;
+	// The triangles are added first, the render thread reads them as soon as the last range has been counted.
+	job.NumberOfCulledTriangles += numberOfCulledTriangles;
+	job.NumberOfFinishedRanges += numberOfFinishedRanges;
 }
@@ -4,14 +4,16 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
 
+#include "PBRViewerBvh.h"
 #include "PBRViewerMesh.h"
+#include "PBRViewerSceneData.h"
 
 #include "PBRViewerShader.h"
 #include "PBRViewerTexture.h"
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 #include "PBRViewerEnumerations.h"
@@ -27,7 +29,16 @@ public:
 	/// Initializes a new instance of the <see cref="LearnOpenGLModel"/> class.
 	/// </summary>
 	/// <param name="path">The filepath to the model.</param>
-	explicit PBRViewerScene( std::string const& path );
+	/// <param name="keepGeometryOnCpu">True to keep a CPU-side copy of the vertices and indices after the upload.</param>
+	explicit PBRViewerScene( std::string const& path, GLboolean keepGeometryOnCpu = GL_FALSE );
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerScene"/> class from already imported data.
+	/// The data is uploaded to the GPU, so this constructor has to be called on the render thread.
+	/// </summary>
+	/// <param name="sceneData">The scene data as produced by the <see cref="PBRViewerSceneImporter"/>.</param>
+	/// <param name="keepGeometryOnCpu">True to keep a CPU-side copy of the vertices and indices after the upload.</param>
+	explicit PBRViewerScene( PBRViewerSceneData&& sceneData, GLboolean keepGeometryOnCpu = GL_FALSE );
 
 	/// <summary>
 	/// Disposes internal instances and frees memory.
@@ -35,22 +46,86 @@ public:
 	GLvoid Cleanup();
 
 	/// <summary>
-	/// Draws the 3D model with the specified shader.
+	/// Draws the 3D model with the specified shader. Meshes outside of the frustum of the last <see cref="Cull"/> call are skipped.
+	/// The meshes sharing their textures are drawn by a single indirect draw call. The commands have been uploaded by the last <see cref="Cull"/> call,
+	/// so drawing the same culling result in several passes does not upload them again.
 	/// </summary>
 	/// <param name="shader">The shader which will be used to draw the 3D model.</param>	
-	GLvoid Draw( std::shared_ptr<PBRViewerShader> const& shader );
+	/// <param name="useCulling">True to draw only the meshlets which passed the last <see cref="Cull"/> call. The batched meshes use the commands
+	/// uploaded by <see cref="Cull"/>, the flag only affects the meshes in the stream format.</param>	
+	GLvoid Draw( std::shared_ptr<PBRViewerShader> const& shader, GLboolean useCulling = GL_FALSE );
+
+	/// <summary>
+	/// Selects the level of detail of each mesh by its geometric error projected onto the screen and culls the meshes against the view frustum by their bounds.
+	/// The meshlets of the visible meshes are culled against the view frustum and their back faces by the render thread and the workers of the shared thread pool.
+	/// The draw commands of the visible meshes, and of their visible meshlets if they have been culled, are uploaded once.
+	/// All following <see cref="Draw"/> calls reuse them until the next call.
+	/// </summary>
+	/// <param name="view">The view matrix of the camera.</param>
+	/// <param name="projection">The perspective projection matrix of the camera.</param>
+	/// <param name="viewportHeight">The height of the viewport in pixels.</param>
+	/// <param name="maximumPixelError">The largest acceptable error of the levels of detail in pixels.</param>
+	/// <param name="cullMeshlets">True to cull the meshlets as well, false to cull whole meshes only.</param>
+	GLvoid Cull( glm::mat4 view, glm::mat4 projection, GLint viewportHeight, GLfloat maximumPixelError, GLboolean cullMeshlets = GL_TRUE );
+
+	/// <summary>
+	/// Gets the number of triangles removed by the last <see cref="Cull"/> call.
+	/// The triangles are counted at the levels of detail selected by the same call, i. e. the triangles its pass would have drawn without culling.
+	/// </summary>
+	/// <returns>The number of culled triangles.</returns>
+	GLuint GetNumberOfCulledTriangles() const;
+
+	/// <summary>
+	/// Gets the number of meshes which passed the last <see cref="Cull"/> call.
+	/// </summary>
+	/// <returns>The number of visible meshes.</returns>
+	GLuint GetNumberOfVisibleMeshes() const;
+
+	/// <summary>
+	/// Gets the number of meshes of the scene.
+	/// </summary>
+	/// <returns>The number of meshes.</returns>
+	GLuint GetNumberOfMeshes() const;
+
+	/// <summary>
+	/// Gets the minimum corner of the axis-aligned bounding box of all meshes in model space.
+	/// </summary>
+	/// <returns>The minimum corner of the bounding box.</returns>
+	glm::vec3 GetBoundingBoxMin() const;
+
+	/// <summary>
+	/// Gets the maximum corner of the axis-aligned bounding box of all meshes in model space.
+	/// </summary>
+	/// <returns>The maximum corner of the bounding box.</returns>
+	glm::vec3 GetBoundingBoxMax() const;
+
+	/// <summary>
+	/// Gets the center of the bounding sphere of all meshes in model space.
+	/// </summary>
+	/// <returns>The center of the bounding sphere.</returns>
+	glm::vec3 GetBoundingSphereCenter() const;
+
+	/// <summary>
+	/// Gets the radius of the bounding sphere of all meshes in model units.
+	/// </summary>
+	/// <returns>The radius of the bounding sphere.</returns>
+	GLfloat GetBoundingSphereRadius() const;
 
 	/// <summary>
-	/// Adds the texture to all meshes so it can be used for rendering.
+	/// Finds the closest surface point of the full detail meshes hit by a ray, e. g. the one under the cursor.
 	/// </summary>
-	/// <param name="textureToAdd">The texture to add.</param>	
-	GLvoid AddTextureToAllMeshes( PBRViewerTexture const& textureToAdd );
+	/// <param name="origin">The origin of the ray in world space.</param>
+	/// <param name="direction">The direction of the ray in world space.</param>
+	/// <param name="hit">The closest intersection in world space, only valid if the ray hit a mesh.</param>
+	/// <returns>True if the ray hit a mesh, false if not or if the scene has no bounding volume hierarchy.</returns>
+	GLboolean Pick( glm::vec3 origin, glm::vec3 direction, PBRViewerRayHit& hit ) const;
 
 	/// <summary>
-	/// Removes the texture from all meshes.
+	/// Gets the material textures of a mesh, i. e. the textures read from the model.
 	/// </summary>
-	/// <param name="textureToRemove">The texture to remove.</param>	
-	GLvoid RemoveTextureFromAllMeshes( PBRViewerTexture const& textureToRemove );
+	/// <param name="meshIndex">The index of the mesh.</param>
+	/// <returns>The material textures of the mesh.</returns>
+	std::vector<PBRViewerTexture> GetMaterialTextures( GLuint meshIndex ) const;
 
 	/// <summary>
 	/// Gets the model matrix of this 3D model.
@@ -141,47 +216,105 @@ private:
 	std::vector<PBRViewerMesh> myMeshes;
 	std::string myDirectory;
 
+	GLuint myNumberOfCulledTriangles = 0u;
+	GLuint myNumberOfVisibleMeshes = 0u;
+
+	glm::vec3 myBoundingBoxMin = glm::vec3(0.0f);
+	glm::vec3 myBoundingBoxMax = glm::vec3(0.0f);
+	glm::vec3 myBoundingSphereCenter = glm::vec3(0.0f);
+	GLfloat myBoundingSphereRadius = 0.0f;
+
+	std::shared_ptr<PBRViewerBvh> myBvh;
+
+	/// <summary>
+	/// The meshes drawn by one indirect draw call and their commands within the indirect buffer.
+	/// Meshes in the stream format cannot be batched, they form a batch of their own and are drawn directly.
+	/// </summary>
+	struct DrawBatch
+	{
+		std::vector<size_t> Meshes;
+		GLboolean IsIndirect = GL_TRUE;
+		size_t FirstCommand = 0u;
+		size_t NumberOfCommands = 0u;
+	};
+
+	std::vector<DrawBatch> myDrawBatches;
+	std::vector<DrawElementsIndirectCommand> myDrawCommands;
+	std::vector<DrawElementsIndirectCommand> myUploadedDrawCommands;
+	GLuint myIndirectBuffer = 0u;
+	size_t myIndirectBufferSize = 0u;
+
+	// Each claim tests this many meshlets, so large meshes are spread over all culling threads.
+	static const GLuint MeshletsPerCullingTask = 2048u;
+
+	/// <summary>
+	/// A range of meshlets of one mesh which is tested by a single claim.
+	/// </summary>
+	struct MeshletRange
+	{
+		PBRViewerMesh* Mesh = nullptr;
+		GLuint FirstMeshlet = 0u;
+		GLuint LastMeshlet = 0u;
+	};
+
+	/// <summary>
+	/// The meshlet ranges of one <see cref="Cull"/> call. The render thread and the helper tasks on the shared thread pool claim the ranges one by one,
+	/// so the culling never waits for a helper which is queued behind the tasks of a running import.
+	/// A helper starting after the culling has finished finds no range left, until then it keeps the job alive.
+	/// </summary>
+	struct CullingJob
+	{
+		std::vector<MeshletRange> Ranges;
+		glm::vec4 FrustumPlanes[6];
+		glm::vec3 CameraPosition = glm::vec3(0.0f);
+		std::atomic<size_t> NextRange { 0u };
+		std::atomic<size_t> NumberOfFinishedRanges { 0u };
+		std::atomic<GLuint> NumberOfCulledTriangles { 0u };
+	};
+
+	// Reused by the next call unless a late helper still holds it, so the ranges are not reallocated every frame.
+	std::shared_ptr<CullingJob> myCullingJob;
+
+	/// <summary>
+	/// Claims and culls meshlet ranges of the job until none is left.
+	/// </summary>
+	/// <param name="job">The culling job.</param>
+	static GLvoid CullMeshletRanges( CullingJob& job );
+
 	/// <summary>
 	/// Updates the front-, right- and up vector of the model.
 	/// </summary>
 	GLvoid UpdateVectors();
 
 	/// <summary>
-	///  Loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
+	/// Calculates the bounds of the scene from the bounds of its meshes.
 	/// </summary>
-	/// <param name="path">The filepath to the model.</param>	
-	/// <returns>True if the model could be loaded, false if not.</returns>
-	GLboolean loadModel( std::string const& path );
+	GLvoid CalculateBounds();
 
 	/// <summary>
-	/// Processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+	/// Groups the meshes into draw batches by their textures, vertex format and index type.
+	/// The batches keep the order in which their first meshes appear in the scene.
 	/// </summary>
-	/// <param name="node">The node to process.</param>
-	/// <param name="scene">The scene as returned by ASSIMP.</param>	
-	GLvoid processNode( aiNode* node, const aiScene* scene );
+	GLvoid BuildDrawBatches();
 
 	/// <summary>
-	/// Extracts all properties from a mesh like vertices, texture coordinates, textures, ...
+	/// Fills the indirect buffer with the draw commands of all batches. The buffer is only changed if the commands differ from the uploaded ones.
 	/// </summary>
-	/// <param name="mesh">The mesh to process.</param>
-	/// <param name="scene">The scene as returned by ASSIMP.</param>
-	/// <returns>The transformed mesh with all important properties in PBRViewer format.</returns>
-	PBRViewerMesh processMesh( aiMesh* mesh, const aiScene* scene );
+	/// <param name="useCulling">True to draw only the meshlets which passed the last <see cref="Cull"/> call.</param>	
+	GLvoid UploadDrawCommands( GLboolean useCulling );
 
 	/// <summary>
-	/// Loads a texture from a filepath.
-	/// Usually, the textures are stored in the same directory as the 3D model.
+	/// Uploads the imported scene data to the GPU and stores the resulting meshes in the meshes vector.
+	/// The vertices and indices are moved into the meshes.
 	/// </summary>
-	/// <param name="path">The filepath to the texture.</param>
-	/// <returns>The id of the texture.</returns>
-	GLuint TextureFromFile( const GLchar* path ) const;
+	/// <param name="sceneData">The imported scene data.</param>
+	/// <param name="keepGeometryOnCpu">True to keep a CPU-side copy of the vertices and indices after the upload.</param>
+	GLvoid Upload( PBRViewerSceneData&& sceneData, GLboolean keepGeometryOnCpu );
 
 	/// <summary>
-	/// Loads the material textures (if any).
+	/// Creates an OpenGL texture from a mip chain generated on the CPU. The levels may be block-compressed.
 	/// </summary>
-	/// <param name="mat">The material to process.</param>
-	/// <param name="type">The type of the texture to extract from the material.</param>
-	/// <param name="typeName">The internal name of the texture type as string.</param>
-	/// <returns>A vector containing all textures extracted from the material (if any).</returns>
-	std::vector<PBRViewerTexture> loadMaterialTextures( aiMaterial* mat, aiTextureType type, const std::string& typeName );
+	/// <param name="textureData">The decoded texture.</param>
+	/// <returns>The id of the texture.</returns>
+	GLuint TextureFromData( PBRViewerTextureData const& textureData ) const;
 };
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerEnumerations.h"
+#include "PBRViewerImportReport.h"
+#include "PBRViewerMeshLod.h"
+#include "PBRViewerMeshlet.h"
+#include "PBRViewerVertex.h"
+
+#include <glm/vec3.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class PBRViewerBvh;
+class PBRViewerMappedFile;
+
+/// <summary>
+/// This struct represents a decoded texture image which is not yet uploaded to the GPU.
+/// Each image file of a scene is decoded only once, even if it is referenced by several meshes.
+/// </summary>
+struct PBRViewerTextureData
+{
+	/// <summary>
+	/// The slot the texture is bound to, e. g. the diffuse map.
+	/// </summary>
+	PBRViewerEnumerations::TextureSlot Slot = PBRViewerEnumerations::TextureDiffuse;
+
+	/// <summary>
+	/// The filepath of the texture as referenced by the material.
+	/// </summary>
+	std::string Filepath;
+
+	/// <summary>
+	/// The key of the texture within the <see cref="PBRViewerTextureCache"/>. Empty if the file does not exist.
+	/// </summary>
+	std::string CacheKey;
+
+	/// <summary>
+	/// True if the texture was already resident in the texture cache during the import, so decoding was skipped.
+	/// </summary>
+	GLboolean IsResident = GL_FALSE;
+
+	GLint Width = 0;
+	GLint Height = 0;
+	GLint Components = 0;
+
+	/// <summary>
+	/// The encoded image of a texture embedded into the model file, e. g. a PNG within a GLB file. Null if the image is read from its file.
+	/// The data is owned by the buffers of the <see cref="PBRViewerSceneData"/>.
+	/// </summary>
+	const GLubyte* EncodedData = nullptr;
+	size_t EncodedSize = 0u;
+
+	/// <summary>
+	/// The decoded pixels of the base level. Released as soon as the mip levels are generated.
+	/// </summary>
+	std::shared_ptr<GLubyte> Pixels;
+
+	/// <summary>
+	/// The block-compressed format of the mip levels, e. g. GL_COMPRESSED_RGBA_BPTC_UNORM. Zero if the texture is not compressed.
+	/// </summary>
+	GLenum CompressedFormat = 0;
+
+	/// <summary>
+	/// The mip levels down to 1x1, starting with the base level.
+	/// The levels are block-compressed if <see cref="CompressedFormat"/> is set, otherwise they hold tightly packed 8-bit pixels.
+	/// </summary>
+	std::vector<std::vector<GLubyte>> MipLevels;
+
+	/// <summary>
+	/// The time in milliseconds needed to decode the image.
+	/// </summary>
+	GLdouble DecodeTime = 0.0;
+};
+
+/// <summary>
+/// This struct represents the usage of a decoded texture by a mesh.
+/// </summary>
+struct PBRViewerTextureReference
+{
+	/// <summary>
+	/// The slot the texture is bound to, e. g. the diffuse map.
+	/// </summary>
+	PBRViewerEnumerations::TextureSlot Slot = PBRViewerEnumerations::TextureDiffuse;
+
+	/// <summary>
+	/// The index of the texture within <see cref="PBRViewerSceneData::Textures"/>.
+	/// </summary>
+	GLuint TextureIndex = 0u;
+};
+
+/// <summary>
+/// This struct represents the CPU-side data of a single mesh.
+/// </summary>
+struct PBRViewerMeshData
+{
+	/// <summary>
+	/// The format the mesh is uploaded with. Quantized meshes use the compact vertices instead of the full precision ones.
+	/// </summary>
+	PBRViewerEnumerations::VertexFormat VertexFormat = PBRViewerEnumerations::FullPrecision;
+
+	std::vector<Vertex> Vertices;
+	std::vector<CompactVertex> CompactVertices;
+	std::vector<GLuint> Indices;
+
+	/// <summary>
+	/// The meshlets the index buffer is split into for the culling. Empty if the mesh is drawn as a whole.
+	/// </summary>
+	std::vector<Meshlet> Meshlets;
+
+	/// <summary>
+	/// The levels of detail starting with the full detail level. Empty if the mesh has no coarser levels.
+	/// </summary>
+	std::vector<MeshLod> Lods;
+
+	/// <summary>
+	/// The vertex attributes of a mesh in the stream format, indexed by <see cref="PBRViewerEnumerations::VertexStreamLocation"/>.
+	/// They point into the glTF buffers, the indices are either mapped as well or stored in the indices above.
+	/// The numbers of vertices and mapped indices are kept in the members of the mapped mesh cache data below.
+	/// </summary>
+	VertexStream Streams[PBRViewerEnumerations::NumberOfVertexStreams];
+	const GLvoid* MappedStreamIndices = nullptr;
+	GLenum MappedStreamIndexType = GL_UNSIGNED_INT;
+
+	/// <summary>
+	/// The axis-aligned bounding box of a mesh in the stream format, taken from the position accessor.
+	/// </summary>
+	glm::vec3 BoundingBoxMin = glm::vec3(0.0f);
+	glm::vec3 BoundingBoxMax = glm::vec3(0.0f);
+
+	/// <summary>
+	/// The offset and scale which dequantize the positions of the compact vertices.
+	/// </summary>
+	glm::vec3 PositionOffset = glm::vec3(0.0f);
+	glm::vec3 PositionScale = glm::vec3(1.0f);
+
+	/// <summary>
+	/// The vertices, indices, meshlets and levels of detail within a memory-mapped mesh cache file.
+	/// If set, they are used instead of the vectors above.
+	/// </summary>
+	const Vertex* MappedVertices = nullptr;
+	const CompactVertex* MappedCompactVertices = nullptr;
+	GLuint NumberOfMappedVertices = 0u;
+	const GLuint* MappedIndices = nullptr;
+	GLuint NumberOfMappedIndices = 0u;
+	const Meshlet* MappedMeshlets = nullptr;
+	GLuint NumberOfMappedMeshlets = 0u;
+	const MeshLod* MappedLods = nullptr;
+	GLuint NumberOfMappedLods = 0u;
+
+	std::vector<PBRViewerTextureReference> Textures;
+};
+
+/// <summary>
+/// This struct represents the CPU-side data of a whole scene as produced by the <see cref="PBRViewerSceneImporter"/>.
+/// The data does not contain any OpenGL objects and can therefore be created on any thread.
+/// </summary>
+struct PBRViewerSceneData
+{
+	std::string Directory;
+	std::vector<PBRViewerMeshData> Meshes;
+	std::vector<PBRViewerTextureData> Textures;
+
+	/// <summary>
+	/// The indices of the textures in the order their decoding has finished. The textures are uploaded in this order.
+	/// </summary>
+	std::vector<GLuint> TextureUploadOrder;
+
+	/// <summary>
+	/// The mesh cache file the mapped vertices and indices of the meshes point into (if any).
+	/// </summary>
+	std::shared_ptr<PBRViewerMappedFile> MappedFile;
+
+	/// <summary>
+	/// The glTF buffers the vertex streams, the mapped indices and the embedded images point into.
+	/// Buffers given as data URI and attributes converted by the loader are kept in memory.
+	/// </summary>
+	std::vector<std::shared_ptr<PBRViewerMappedFile>> MappedBuffers;
+	std::vector<std::shared_ptr<std::vector<GLubyte>>> DecodedBuffers;
+
+	/// <summary>
+	/// True if the textures are block-compressed, false if their mip levels are uploaded uncompressed.
+	/// </summary>
+	GLboolean CompressTextures = GL_TRUE;
+
+	/// <summary>
+	/// The bounding volume hierarchy over the triangles of the full detail levels, used for the mouse picking. Null if it was not built.
+	/// </summary>
+	std::shared_ptr<PBRViewerBvh> Bvh;
+
+	/// <summary>
+	/// The timings of the import. The GPU upload is added by the <see cref="PBRViewerScene"/>.
+	/// </summary>
+	PBRViewerImportReport Report;
+};
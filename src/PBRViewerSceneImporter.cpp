@@ -0,0 +1,1062 @@
+#include "PBRViewerSceneImporter.h"
+
+#include <assimp/ProgressHandler.hpp>
+#include <stb_image.h>
+
+#include "PBRViewerBvh.h"
+#include "PBRViewerGltfLoader.h"
+#include "PBRViewerLogger.h"
+#include "PBRViewerMeshCache.h"
+#include "PBRViewerMeshOptimizer.h"
+#include "PBRViewerMeshSimplifier.h"
+#include "PBRViewerObjLoader.h"
+#include "PBRViewerTexture.h"
+#include "PBRViewerTextureCache.h"
+#include "PBRViewerTextureCooker.h"
+#include "PBRViewerThreadPool.h"
+#include "PBRViewerVertexQuantizer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <xmmintrin.h>
+
+// The bulk conversion writes the ASSIMP streams directly into the memory layout of the vertex.
+static_assert(sizeof(aiVector3D) == 3 * sizeof(GLfloat), "ASSIMP has to be built with single precision.");
+static_assert(sizeof(Vertex) == 14 * sizeof(GLfloat), "The vertex must not contain any padding.");
+static_assert(offsetof(Vertex, Normal) == 3 * sizeof(GLfloat) &&
+              offsetof(Vertex, TexCoords) == 6 * sizeof(GLfloat) &&
+              offsetof(Vertex, Tangent) == 8 * sizeof(GLfloat) &&
+              offsetof(Vertex, Bitangent) == 11 * sizeof(GLfloat), "Unexpected vertex layout.");
+
+/// <summary>
+/// This class forwards the progress reported by ASSIMP to the importer and aborts the import if it was cancelled.
+/// The ASSIMP importer takes ownership of an instance of this class.
+/// </summary>
+class PBRViewerImportProgressHandler : public Assimp::ProgressHandler
+{
+public:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerImportProgressHandler"/> class.
+	/// </summary>
+	/// <param name="progress">The progress to update.</param>
+	/// <param name="isCancelled">The flag indicating if the import was cancelled.</param>
+	/// <param name="progressShare">The share of the overall progress covered by ASSIMP.</param>
+	PBRViewerImportProgressHandler( std::atomic<GLfloat>& progress,
+	                                std::atomic<GLboolean> const& isCancelled,
+	                                const GLfloat progressShare )
+		: myProgress(progress), myIsCancelled(isCancelled), myProgressShare(progressShare)
+	{
+	}
+
+	/// <summary>
+	/// Called by ASSIMP to report the current progress.
+	/// </summary>
+	/// <param name="percentage">The progress of ASSIMP in the range [0, 1] or -1 if unknown.</param>
+	/// <returns>False to abort the import, true to continue.</returns>
+	bool Update( const float percentage ) override
+	{
+		if (percentage >= 0.0f)
+		{
+			myProgress = percentage * myProgressShare;
+		}
+
+		return GL_FALSE == myIsCancelled;
+	}
+
+private:
+	std::atomic<GLfloat>& myProgress;
+	std::atomic<GLboolean> const& myIsCancelled;
+	GLfloat myProgressShare;
+};
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerSceneImporter"/> class.
+/// </summary>
+/// <param name="path">The filepath to the model.</param>
+/// <param name="preset">The import preset which decides the ASSIMP post processing steps and the texture compression.</param>
+/// <param name="useNativeLoaders">True to read glTF assets and OBJ models without ASSIMP, false to read every model with ASSIMP.</param>
+PBRViewerSceneImporter::PBRViewerSceneImporter( std::string const& path,
+                                                const PBRViewerEnumerations::ImportPreset preset,
+                                                const GLboolean useNativeLoaders )
+	: myFilepath(path),
+	  myPreset(preset),
+	  myUseNativeLoader(useNativeLoaders && (PBRViewerGltfLoader::IsGltfFile(path) || PBRViewerObjLoader::IsObjFile(path))),
+	  myPostProcessFlags(GetPostProcessFlags(preset))
+{
+	// Compressing the textures takes longer than decoding them, so the fast preview uploads them uncompressed.
+	mySceneData.CompressTextures = PBRViewerEnumerations::FastPreview != preset;
+	mySceneData.Report.SetModel(path, GetPresetName(preset));
+
+	// Switching the loader must not read the cached meshes of the other one.
+	if (myUseNativeLoader)
+	{
+		myPostProcessFlags |= NativeLoaderCacheFlag;
+	}
+}
+
+/// <summary>
+/// Finalizes an instance of the <see cref="PBRViewerSceneImporter"/> class.
+/// A running import is cancelled and the worker thread is joined.
+/// </summary>
+PBRViewerSceneImporter::~PBRViewerSceneImporter()
+{
+	Cancel();
+
+	if (myWorker.joinable())
+	{
+		myWorker.join();
+	}
+}
+
+/// <summary>
+/// Imports the model on the calling thread.
+/// </summary>
+/// <returns>True if the model could be imported, false if not.</returns>
+GLboolean PBRViewerSceneImporter::Import()
+{
+	GLboolean isSuccessful = GL_FALSE;
+
+	try
+	{
+		isSuccessful = loadModel();
+
+		if (isSuccessful && GL_FALSE == myIsCancelled)
+		{
+			BuildBvh();
+		}
+	}
+	catch (...)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Unexpected error while importing the model:", myFilepath);
+	}
+
+	if (isSuccessful && GL_FALSE == myIsCancelled)
+	{
+		myProgress = 1.0f;
+		myIsSuccessful = GL_TRUE;
+	}
+	else
+	{
+		mySceneData = PBRViewerSceneData();
+	}
+
+	myIsFinished = GL_TRUE;
+	return myIsSuccessful;
+}
+
+/// <summary>
+/// Starts the import on a worker thread. Use <see cref="IsFinished"/> to poll for the result.
+/// </summary>
+GLvoid PBRViewerSceneImporter::ImportAsync()
+{
+	if (myWorker.joinable())
+	{
+		return;
+	}
+
+	myWorker = std::thread([this]()
+	{
+		Import();
+	});
+}
+
+/// <summary>
+/// Requests the cancellation of a running import. The import stops at the next progress update.
+/// </summary>
+GLvoid PBRViewerSceneImporter::Cancel()
+{
+	myIsCancelled = GL_TRUE;
+}
+
+/// <summary>
+/// Gets a flag indicating if the import has finished (successfully, with an error or cancelled).
+/// </summary>
+/// <returns>True if the import has finished, false if not.</returns>
+GLboolean PBRViewerSceneImporter::IsFinished() const
+{
+	return myIsFinished;
+}
+
+/// <summary>
+/// Gets a flag indicating if the import has finished successfully and was not cancelled.
+/// Only valid after <see cref="IsFinished"/> returned true.
+/// </summary>
+/// <returns>True if the scene data is ready for upload, false if not.</returns>
+GLboolean PBRViewerSceneImporter::IsSuccessful() const
+{
+	return myIsSuccessful && GL_FALSE == myIsCancelled;
+}
+
+/// <summary>
+/// Gets the progress of the import in the range [0, 1].
+/// </summary>
+/// <returns>The current progress.</returns>
+GLfloat PBRViewerSceneImporter::GetProgress() const
+{
+	return myProgress;
+}
+
+/// <summary>
+/// Gets the filepath of the model to import.
+/// </summary>
+/// <returns>The filepath of the model.</returns>
+std::string const& PBRViewerSceneImporter::GetFilepath() const
+{
+	return myFilepath;
+}
+
+/// <summary>
+/// Moves the imported scene data out of the importer. Only valid after <see cref="IsFinished"/> returned true.
+/// </summary>
+/// <returns>The imported scene data.</returns>
+PBRViewerSceneData PBRViewerSceneImporter::TakeSceneData()
+{
+	if (myWorker.joinable())
+	{
+		myWorker.join();
+	}
+
+	return std::move(mySceneData);
+}
+
+/// <summary>
+/// Loads a model with supported ASSIMP extensions from file and converts it into staging data.
+/// </summary>
+/// <returns>True if the model could be loaded, false if not.</returns>
+GLboolean PBRViewerSceneImporter::loadModel()
+{
+	// retrieve the directory path of the filepath
+	mySceneData.Directory = myFilepath.substr(0, myFilepath.find_last_of('\\'));
+	PBRViewerImportReport& report = mySceneData.Report;
+
+	// The fast preview reads the glTF buffers in place, which is as fast as reading the mesh cache, so it neither reads nor writes the cache.
+	const GLboolean keepStreams = myUseNativeLoader && PBRViewerGltfLoader::IsGltfFile(myFilepath) && PBRViewerEnumerations::FastPreview == myPreset;
+
+	// A valid mesh cache replaces the whole ASSIMP import. Only the textures have to be decoded.
+	if (GL_FALSE == keepStreams)
+	{
+		const auto startTime = std::chrono::steady_clock::now();
+		const GLboolean isCached = PBRViewerMeshCache::Read(myFilepath, myPostProcessFlags, mySceneData);
+		report.AddPhase("Mesh cache read", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+		if (isCached)
+		{
+			PBRViewerLogger::PrintInfoMessage("Loaded meshes from cache: " + myFilepath);
+			report.SetLoader("Mesh cache");
+			myProgress = AssimpProgressShare + MeshProgressShare;
+			return DecodeTextures();
+		}
+	}
+
+	const GLboolean isNativeLoaded = myUseNativeLoader && loadNativeModel(keepStreams);
+
+	if (myIsCancelled)
+	{
+		return GL_FALSE;
+	}
+
+	if (GL_FALSE == isNativeLoaded && GL_FALSE == loadAssimpModel())
+	{
+		return GL_FALSE;
+	}
+
+	// The streams are uploaded as they are, so there is nothing to optimize or to cache.
+	if (isNativeLoaded && keepStreams)
+	{
+		myProgress = AssimpProgressShare + MeshProgressShare;
+		return DecodeTextures();
+	}
+
+	// The fast preview skips the optimization, the levels of detail and the quantization to save import time.
+	if (PBRViewerEnumerations::FastPreview != myPreset)
+	{
+		OptimizeMeshes();
+
+		if (myIsCancelled)
+		{
+			return GL_FALSE;
+		}
+
+		// The meshlets refer to the full detail level, so the coarser levels are appended after the optimization.
+		GenerateLods();
+
+		if (myIsCancelled)
+		{
+			return GL_FALSE;
+		}
+
+		QuantizeVertices();
+
+		if (myIsCancelled)
+		{
+			return GL_FALSE;
+		}
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+	PBRViewerMeshCache::Write(myFilepath, myPostProcessFlags, mySceneData);
+	report.AddPhase("Mesh cache write", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	return DecodeTextures();
+}
+
+/// <summary>
+/// Reads the meshes of a model with ASSIMP.
+/// </summary>
+/// <returns>True if the meshes could be read, false if not.</returns>
+GLboolean PBRViewerSceneImporter::loadAssimpModel()
+{
+	PBRViewerImportReport& report = mySceneData.Report;
+	report.SetLoader("ASSIMP");
+
+	// Read file via ASSIMP without any post processing. The importer takes ownership of the progress handler.
+	Assimp::Importer importer;
+	importer.SetProgressHandler(new PBRViewerImportProgressHandler(myProgress, myIsCancelled, AssimpProgressShare));
+
+	auto startTime = std::chrono::steady_clock::now();
+	const aiScene* scene = importer.ReadFile(myFilepath, 0u);
+	report.AddPhase("File read", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	if (myIsCancelled)
+	{
+		return GL_FALSE;
+	}
+
+	if (nullptr != scene)
+	{
+		scene = ApplyPostProcessing(importer);
+
+		if (myIsCancelled)
+		{
+			return GL_FALSE;
+		}
+	}
+
+	// Check for errors
+	if (nullptr == scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || nullptr == scene->mRootNode)
+	{
+		PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, importer.GetErrorString());
+		return GL_FALSE;
+	}
+
+	// Meshes referenced by several nodes are converted several times, so the node tree is counted to size the vector once.
+	myNumberOfProcessedMeshes = 0u;
+	myNumberOfMeshes = CountMeshReferences(scene->mRootNode);
+	mySceneData.Meshes.reserve(myNumberOfMeshes);
+	myNumberOfConvertedVertices = 0u;
+	myMeshConversionTime = 0.0;
+
+	// process ASSIMP's root node recursively
+	startTime = std::chrono::steady_clock::now();
+	if (GL_FALSE == processNode(scene->mRootNode, scene))
+	{
+		return GL_FALSE;
+	}
+
+	// The conversion of the meshes is measured separately, the remaining time is spent walking the node tree.
+	const GLdouble nodeTime = std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	report.AddPhase("processNode (node traversal)", nodeTime - myMeshConversionTime);
+	report.AddPhase("processMesh (" + std::to_string(myNumberOfConvertedVertices) + " vertices)", myMeshConversionTime);
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Reads the meshes of a glTF asset with the <see cref="PBRViewerGltfLoader"/> or of an OBJ model with the <see cref="PBRViewerObjLoader"/>.
+/// Whatever the loader read is discarded if it fails, so ASSIMP can start over.
+/// </summary>
+/// <param name="keepStreams">True to upload the vertex attributes straight from the glTF buffers.</param>
+/// <returns>True if the meshes could be read, false if the model has to be read with ASSIMP.</returns>
+GLboolean PBRViewerSceneImporter::loadNativeModel( const GLboolean keepStreams )
+{
+	GLboolean isLoaded;
+	if (PBRViewerObjLoader::IsObjFile(myFilepath))
+	{
+		mySceneData.Report.SetLoader("Native OBJ");
+
+		PBRViewerObjLoader loader(myFilepath);
+		isLoaded = loader.Load(mySceneData);
+	}
+	else
+	{
+		mySceneData.Report.SetLoader("Native glTF");
+
+		PBRViewerGltfLoader loader(myFilepath);
+		isLoaded = loader.Load(keepStreams, mySceneData);
+	}
+
+	if (isLoaded)
+	{
+		myProgress = AssimpProgressShare + MeshProgressShare;
+		return GL_TRUE;
+	}
+
+	PBRViewerLogger::PrintInfoMessage("Falling back to ASSIMP for the model: " + myFilepath);
+
+	mySceneData.Meshes.clear();
+	mySceneData.Textures.clear();
+	mySceneData.MappedBuffers.clear();
+	mySceneData.DecodedBuffers.clear();
+
+	// ASSIMP writes its meshes under its own key of the mesh cache.
+	myPostProcessFlags &= ~NativeLoaderCacheFlag;
+	return GL_FALSE;
+}
+
+/// <summary>
+/// Applies the post processing steps of the preset within a single call, so ASSIMP runs them in its own order like within ReadFile.
+/// The steps are timed as a whole, since ASSIMP runs some of them in several parts, e. g. SplitLargeMeshes before and after JoinIdenticalVertices.
+/// </summary>
+/// <param name="importer">The ASSIMP importer holding the scene which was read without post processing.</param>
+/// <returns>The post processed scene or nullptr if a step failed.</returns>
+const aiScene* PBRViewerSceneImporter::ApplyPostProcessing( Assimp::Importer& importer )
+{
+	// Reading the file covers the first half of ASSIMP's progress share, the post processing the second one.
+	const auto startTime = std::chrono::steady_clock::now();
+	const aiScene* scene = importer.ApplyPostProcessing(myPostProcessFlags);
+	mySceneData.Report.AddPhase("Post processing", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	return scene;
+}
+
+/// <summary>
+/// Gets the ASSIMP post processing steps of an import preset.
+/// </summary>
+/// <param name="preset">The import preset.</param>
+/// <returns>The post processing flags.</returns>
+GLuint PBRViewerSceneImporter::GetPostProcessFlags( const PBRViewerEnumerations::ImportPreset preset )
+{
+	// The steps every preset needs to render the model: triangles, upright texture coordinates and tangents for normal mapping.
+	const GLuint requiredFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+
+	switch (preset)
+	{
+		case PBRViewerEnumerations::FastPreview:
+			return requiredFlags;
+		case PBRViewerEnumerations::Balanced:
+			return requiredFlags | aiProcess_JoinIdenticalVertices | aiProcess_SplitLargeMeshes;
+		default:
+			return requiredFlags |
+			       aiProcess_JoinIdenticalVertices |
+			       aiProcess_SplitLargeMeshes |
+			       aiProcess_OptimizeMeshes |
+			       aiProcess_OptimizeGraph |
+			       aiProcess_ValidateDataStructure;
+	}
+}
+
+/// <summary>
+/// Gets the display name of an import preset.
+/// </summary>
+/// <param name="preset">The import preset.</param>
+/// <returns>The name of the preset.</returns>
+std::string PBRViewerSceneImporter::GetPresetName( const PBRViewerEnumerations::ImportPreset preset )
+{
+	switch (preset)
+	{
+		case PBRViewerEnumerations::FastPreview:
+			return "Fast preview";
+		case PBRViewerEnumerations::Balanced:
+			return "Balanced";
+		default:
+			return "Full optimize";
+	}
+}
+
+/// <summary>
+/// Counts the meshes referenced by a node and all of its children.
+/// </summary>
+/// <param name="node">The node to count.</param>
+/// <returns>The number of mesh references.</returns>
+GLuint PBRViewerSceneImporter::CountMeshReferences( const aiNode* node )
+{
+	GLuint numberOfMeshReferences = node->mNumMeshes;
+	for (GLuint i = 0; i < node->mNumChildren; i++)
+	{
+		numberOfMeshReferences += CountMeshReferences(node->mChildren[i]);
+	}
+
+	return numberOfMeshReferences;
+}
+
+/// <summary>
+/// Processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+/// </summary>
+/// <param name="node">The node to process.</param>
+/// <param name="scene">The scene as returned by ASSIMP.</param>
+/// <returns>False if the import was cancelled, true if not.</returns>
+GLboolean PBRViewerSceneImporter::processNode( aiNode* node, const aiScene* scene )
+{
+	// process each mesh located at the current node
+	for (GLuint i = 0; i < node->mNumMeshes; i++)
+	{
+		if (myIsCancelled)
+		{
+			return GL_FALSE;
+		}
+
+		// the node object only contains indices to index the actual objects in the scene.
+		// the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
+		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+
+		const auto startTime = std::chrono::steady_clock::now();
+		mySceneData.Meshes.push_back(processMesh(mesh, scene));
+		myMeshConversionTime += std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		myNumberOfConvertedVertices += mesh->mNumVertices;
+
+		myNumberOfProcessedMeshes++;
+		const GLfloat meshProgress = static_cast<GLfloat>(myNumberOfProcessedMeshes) / static_cast<GLfloat>(myNumberOfMeshes);
+		myProgress = AssimpProgressShare + MeshProgressShare * meshProgress;
+	}
+
+	// after we've processed all of the meshes (if any) we then recursively process each of the children nodes
+	for (GLuint i = 0; i < node->mNumChildren; i++)
+	{
+		if (GL_FALSE == processNode(node->mChildren[i], scene))
+		{
+			return GL_FALSE;
+		}
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Extracts all properties from a mesh like vertices, texture coordinates, textures, ...
+/// </summary>
+/// <param name="mesh">The mesh to process.</param>
+/// <param name="scene">The scene as returned by ASSIMP.</param>
+/// <returns>The extracted mesh data.</returns>
+PBRViewerMeshData PBRViewerSceneImporter::processMesh( aiMesh* mesh, const aiScene* scene )
+{
+	PBRViewerMeshData meshData;
+	std::vector<Vertex>& vertices = meshData.Vertices;
+	std::vector<GLuint>& indices = meshData.Indices;
+	std::vector<PBRViewerTextureReference>& textures = meshData.Textures;
+
+	// Size the buffers once and convert all vertices in bulk.
+	vertices.resize(mesh->mNumVertices);
+	InterleaveVertices(mesh, vertices.data());
+
+	// Now walk through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
+	GLuint numberOfIndices = 0u;
+	if (aiPrimitiveType_TRIANGLE == mesh->mPrimitiveTypes)
+	{
+		numberOfIndices = 3u * mesh->mNumFaces;
+	}
+	else
+	{
+		for (GLuint i = 0; i < mesh->mNumFaces; i++)
+		{
+			numberOfIndices += mesh->mFaces[i].mNumIndices;
+		}
+	}
+
+	indices.resize(numberOfIndices);
+	GLuint* index = indices.data();
+	for (GLuint i = 0; i < mesh->mNumFaces; i++)
+	{
+		// retrieve all indices of the face and store them in the indices vector
+		const aiFace& face = mesh->mFaces[i];
+		std::memcpy(index, face.mIndices, sizeof(GLuint) * face.mNumIndices);
+		index += face.mNumIndices;
+	}
+
+	// process materials
+	aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+
+	// 1. diffuse (albedo) maps
+	std::vector<PBRViewerTextureReference> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, PBRViewerEnumerations::TextureDiffuse);
+	textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+
+	// 2. normal maps
+	std::vector<PBRViewerTextureReference> normalMaps = loadMaterialTextures(material, aiTextureType_NORMALS, PBRViewerEnumerations::TextureNormal);
+	textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+
+	// 3. Roughness maps (also include AO and metallic components on different color channels)
+	std::vector<PBRViewerTextureReference> roughnessMaps = loadMaterialTextures(material, aiTextureType_UNKNOWN, PBRViewerEnumerations::TextureRoughness);
+	textures.insert(textures.end(), roughnessMaps.begin(), roughnessMaps.end());
+
+	// 4. Emissive maps
+	std::vector<PBRViewerTextureReference> emissiveMaps = loadMaterialTextures(material, aiTextureType_EMISSIVE, PBRViewerEnumerations::TextureEmissive);
+	textures.insert(textures.end(), emissiveMaps.begin(), emissiveMaps.end());
+
+	return meshData;
+}
+
+/// <summary>
+/// Interleaves the position, normal, texture coordinate, tangent and bitangent streams of a mesh into the vertex layout.
+/// Each attribute is copied with a single unaligned 16 byte store. The fourth lane spills into the following attribute
+/// and is overwritten by the next store, so the attributes have to be written in memory order.
+/// The last vertex is converted without SIMD since its loads and stores would exceed the streams and the buffer.
+/// </summary>
+/// <param name="mesh">The mesh to convert.</param>
+/// <param name="vertices">The buffer receiving the vertices. It has to hold the number of vertices of the mesh.</param>
+GLvoid PBRViewerSceneImporter::InterleaveVertices( const aiMesh* mesh, Vertex* vertices )
+{
+	const GLuint numberOfVertices = mesh->mNumVertices;
+	if (0u == numberOfVertices)
+	{
+		return;
+	}
+
+	const GLfloat* positions = reinterpret_cast<const GLfloat*>(mesh->mVertices);
+	const GLfloat* normals = reinterpret_cast<const GLfloat*>(mesh->mNormals);
+	const GLfloat* textureCoordinates = reinterpret_cast<const GLfloat*>(mesh->mTextureCoords[0]);
+	const GLfloat* tangents = reinterpret_cast<const GLfloat*>(mesh->mTangents);
+	const GLfloat* bitangents = reinterpret_cast<const GLfloat*>(mesh->mBitangents);
+
+	const __m128 zero = _mm_setzero_ps();
+
+	for (GLuint i = 0; i + 1u < numberOfVertices; i++)
+	{
+		GLfloat* vertex = reinterpret_cast<GLfloat*>(vertices + i);
+		const GLuint stream = 3u * i;
+
+		_mm_storeu_ps(vertex + 0, _mm_loadu_ps(positions + stream));
+		_mm_storeu_ps(vertex + 3, normals ? _mm_loadu_ps(normals + stream) : zero);
+		_mm_storeu_ps(vertex + 6, textureCoordinates ? _mm_loadu_ps(textureCoordinates + stream) : zero);
+		_mm_storeu_ps(vertex + 8, tangents ? _mm_loadu_ps(tangents + stream) : zero);
+
+		// The spilled lane lands on the position of the next vertex, which is written in the next iteration.
+		_mm_storeu_ps(vertex + 11, bitangents ? _mm_loadu_ps(bitangents + stream) : zero);
+	}
+
+	const GLuint last = numberOfVertices - 1u;
+	Vertex& vertex = vertices[last];
+	vertex = Vertex{};
+	vertex.Position = glm::vec3(mesh->mVertices[last].x, mesh->mVertices[last].y, mesh->mVertices[last].z);
+
+	if (normals)
+	{
+		vertex.Normal = glm::vec3(mesh->mNormals[last].x, mesh->mNormals[last].y, mesh->mNormals[last].z);
+	}
+
+	if (textureCoordinates)
+	{
+		vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][last].x, mesh->mTextureCoords[0][last].y);
+	}
+
+	if (tangents)
+	{
+		vertex.Tangent = glm::vec3(mesh->mTangents[last].x, mesh->mTangents[last].y, mesh->mTangents[last].z);
+	}
+
+	if (bitangents)
+	{
+		vertex.Bitangent = glm::vec3(mesh->mBitangents[last].x, mesh->mBitangents[last].y, mesh->mBitangents[last].z);
+	}
+}
+
+/// <summary>
+/// Reorders the triangles and vertices of all meshes in parallel for the vertex cache, the overdraw and the vertex fetch
+/// and splits them into meshlets. The cache miss ratios before and after are added to the import report.
+/// </summary>
+GLvoid PBRViewerSceneImporter::OptimizeMeshes()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	const size_t numberOfMeshes = mySceneData.Meshes.size();
+
+	std::vector<PBRViewerMeshOptimizer::CacheStatistics> before(numberOfMeshes);
+	std::vector<PBRViewerMeshOptimizer::CacheStatistics> after(numberOfMeshes);
+
+	std::vector<std::future<GLvoid>> pendingOptimizations;
+	pendingOptimizations.reserve(numberOfMeshes);
+
+	for (size_t i = 0; i < numberOfMeshes; i++)
+	{
+		pendingOptimizations.push_back(PBRViewerThreadPool::GetInstance().Enqueue([this, i, &before, &after]()
+		{
+			if (myIsCancelled)
+			{
+				return;
+			}
+
+			PBRViewerMeshData& mesh = mySceneData.Meshes[i];
+			PBRViewerMeshOptimizer::Optimize(mesh.Vertices, mesh.Indices, before[i], after[i]);
+
+			// The meshlets follow the optimized triangle order, so drawing the visible ones keeps the cache and overdraw benefits.
+			mesh.Meshlets = PBRViewerMeshOptimizer::BuildMeshlets(mesh.Vertices, mesh.Indices);
+		}));
+	}
+
+	for (std::future<GLvoid>& pendingOptimization : pendingOptimizations)
+	{
+		pendingOptimization.wait();
+	}
+
+	if (myIsCancelled)
+	{
+		return;
+	}
+
+	// The ratios of the whole scene, i. e. weighted by the size of each mesh. Meshes left unchanged are not counted.
+	PBRViewerMeshOptimizer::CacheStatistics sceneBefore;
+	PBRViewerMeshOptimizer::CacheStatistics sceneAfter;
+	size_t numberOfMeshlets = 0u;
+	for (size_t i = 0; i < numberOfMeshes; i++)
+	{
+		numberOfMeshlets += mySceneData.Meshes[i].Meshlets.size();
+		sceneBefore.TransformedVertices += before[i].TransformedVertices;
+		sceneBefore.Triangles += before[i].Triangles;
+		sceneBefore.Vertices += before[i].Vertices;
+		sceneAfter.TransformedVertices += after[i].TransformedVertices;
+		sceneAfter.Triangles += after[i].Triangles;
+		sceneAfter.Vertices += after[i].Vertices;
+	}
+
+	PBRViewerImportReport& report = mySceneData.Report;
+	report.AddPhase("Mesh optimization (" + std::to_string(sceneAfter.Triangles) + " triangles)",
+	                std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	report.AddStatistic("ACMR before optimization", sceneBefore.GetACMR());
+	report.AddStatistic("ACMR after optimization", sceneAfter.GetACMR());
+	report.AddStatistic("ATVR before optimization", sceneBefore.GetATVR());
+	report.AddStatistic("ATVR after optimization", sceneAfter.GetATVR());
+	report.AddStatistic("Meshlets", static_cast<GLdouble>(numberOfMeshlets));
+}
+
+/// <summary>
+/// Builds the levels of detail of all meshes in parallel. The number of levels, the triangles
+/// and the largest error of each level are added to the import report.
+/// </summary>
+GLvoid PBRViewerSceneImporter::GenerateLods()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	const size_t numberOfMeshes = mySceneData.Meshes.size();
+
+	std::vector<std::future<GLvoid>> pendingSimplifications;
+	pendingSimplifications.reserve(numberOfMeshes);
+
+	for (size_t i = 0; i < numberOfMeshes; i++)
+	{
+		pendingSimplifications.push_back(PBRViewerThreadPool::GetInstance().Enqueue([this, i]()
+		{
+			if (myIsCancelled)
+			{
+				return;
+			}
+
+			PBRViewerMeshData& mesh = mySceneData.Meshes[i];
+			mesh.Lods = PBRViewerMeshSimplifier::BuildLods(mesh.Vertices, mesh.Indices);
+
+			// A single level is the mesh itself and needs no selection.
+			if (mesh.Lods.size() < 2u)
+			{
+				mesh.Lods.clear();
+			}
+		}));
+	}
+
+	for (std::future<GLvoid>& pendingSimplification : pendingSimplifications)
+	{
+		pendingSimplification.wait();
+	}
+
+	if (myIsCancelled)
+	{
+		return;
+	}
+
+	// The triangles and the largest error of each level summed up over the meshes. Meshes with fewer levels count their coarsest one.
+	std::vector<size_t> numberOfTriangles;
+	std::vector<GLfloat> maximumErrors;
+	GLuint numberOfMeshesWithLods = 0u;
+	for (const PBRViewerMeshData& mesh : mySceneData.Meshes)
+	{
+		if (mesh.Lods.empty())
+		{
+			continue;
+		}
+
+		numberOfMeshesWithLods++;
+		if (numberOfTriangles.size() < mesh.Lods.size())
+		{
+			numberOfTriangles.resize(mesh.Lods.size(), 0u);
+			maximumErrors.resize(mesh.Lods.size(), 0.0f);
+		}
+
+		for (size_t level = 0; level < mesh.Lods.size(); level++)
+		{
+			numberOfTriangles[level] += mesh.Lods[level].NumberOfIndices / 3u;
+			maximumErrors[level] = std::max(maximumErrors[level], mesh.Lods[level].Error);
+		}
+	}
+
+	PBRViewerImportReport& report = mySceneData.Report;
+	report.AddPhase("LOD generation", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	report.AddStatistic("Meshes with LODs", numberOfMeshesWithLods);
+	for (size_t level = 1; level < numberOfTriangles.size(); level++)
+	{
+		report.AddStatistic("LOD" + std::to_string(level) + " triangles", static_cast<GLdouble>(numberOfTriangles[level]));
+		report.AddStatistic("LOD" + std::to_string(level) + " max error", maximumErrors[level]);
+	}
+}
+
+/// <summary>
+/// Converts the vertices of all meshes into the compact format in parallel.
+/// Meshes whose texture coordinates would lose too much precision keep the full precision vertices.
+/// The largest precision errors are added to the import report.
+/// </summary>
+GLvoid PBRViewerSceneImporter::QuantizeVertices()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	const size_t numberOfMeshes = mySceneData.Meshes.size();
+
+	std::vector<PBRViewerVertexQuantizer::QuantizationError> errors(numberOfMeshes);
+	std::vector<size_t> fullPrecisionSizes(numberOfMeshes, 0u);
+
+	std::vector<std::future<GLvoid>> pendingQuantizations;
+	pendingQuantizations.reserve(numberOfMeshes);
+
+	for (size_t i = 0; i < numberOfMeshes; i++)
+	{
+		pendingQuantizations.push_back(PBRViewerThreadPool::GetInstance().Enqueue([this, i, &errors, &fullPrecisionSizes]()
+		{
+			if (myIsCancelled)
+			{
+				return;
+			}
+
+			// Every task writes to its own mesh only, so the vectors need no locking.
+			PBRViewerMeshData& mesh = mySceneData.Meshes[i];
+			fullPrecisionSizes[i] = sizeof(Vertex) * mesh.Vertices.size();
+
+			if (GL_FALSE == PBRViewerVertexQuantizer::Quantize(mesh.Vertices.data(), static_cast<GLuint>(mesh.Vertices.size()), mesh.CompactVertices,
+			                                                   mesh.PositionOffset, mesh.PositionScale, errors[i]))
+			{
+				std::vector<CompactVertex>().swap(mesh.CompactVertices);
+				mesh.PositionOffset = glm::vec3(0.0f);
+				mesh.PositionScale = glm::vec3(1.0f);
+				return;
+			}
+
+			mesh.VertexFormat = PBRViewerEnumerations::Quantized;
+			std::vector<Vertex>().swap(mesh.Vertices);
+		}));
+	}
+
+	for (std::future<GLvoid>& pendingQuantization : pendingQuantizations)
+	{
+		pendingQuantization.wait();
+	}
+
+	if (myIsCancelled)
+	{
+		return;
+	}
+
+	// Only the errors of the quantized meshes are reported, the others are rendered with full precision.
+	PBRViewerVertexQuantizer::QuantizationError maximumError;
+	GLuint numberOfQuantizedMeshes = 0u;
+	size_t fullPrecisionSize = 0u;
+	size_t vertexSize = 0u;
+	for (size_t i = 0; i < numberOfMeshes; i++)
+	{
+		const PBRViewerMeshData& mesh = mySceneData.Meshes[i];
+		fullPrecisionSize += fullPrecisionSizes[i];
+
+		if (PBRViewerEnumerations::Quantized != mesh.VertexFormat)
+		{
+			vertexSize += fullPrecisionSizes[i];
+			continue;
+		}
+
+		numberOfQuantizedMeshes++;
+		vertexSize += sizeof(CompactVertex) * mesh.CompactVertices.size();
+
+		const PBRViewerVertexQuantizer::QuantizationError& error = errors[i];
+		maximumError.Position = std::max(maximumError.Position, error.Position);
+		maximumError.RelativePosition = std::max(maximumError.RelativePosition, error.RelativePosition);
+		maximumError.Normal = std::max(maximumError.Normal, error.Normal);
+		maximumError.Tangent = std::max(maximumError.Tangent, error.Tangent);
+		maximumError.Bitangent = std::max(maximumError.Bitangent, error.Bitangent);
+		maximumError.TexCoords = std::max(maximumError.TexCoords, error.TexCoords);
+	}
+
+	PBRViewerImportReport& report = mySceneData.Report;
+	report.AddPhase("Vertex quantization", std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	const GLdouble bytesPerMegabyte = 1024.0 * 1024.0;
+	report.AddStatistic("Quantized meshes", numberOfQuantizedMeshes);
+	report.AddStatistic("Full precision meshes", static_cast<GLdouble>(numberOfMeshes - numberOfQuantizedMeshes));
+	report.AddStatistic("Vertex memory before quantization (MB)", static_cast<GLdouble>(fullPrecisionSize) / bytesPerMegabyte);
+	report.AddStatistic("Vertex memory after quantization (MB)", static_cast<GLdouble>(vertexSize) / bytesPerMegabyte);
+	report.AddStatistic("Max position error", maximumError.Position);
+	report.AddStatistic("Max position error (bounding box relative)", maximumError.RelativePosition);
+	report.AddStatistic("Max normal error (degrees)", maximumError.Normal);
+	report.AddStatistic("Max tangent error (degrees)", maximumError.Tangent);
+	report.AddStatistic("Max bitangent error (degrees)", maximumError.Bitangent);
+	report.AddStatistic("Max texture coordinate error", maximumError.TexCoords);
+}
+
+/// <summary>
+/// Collects the material textures (if any). Each texture file is registered once for the whole scene and decoded later on.
+/// </summary>
+/// <param name="mat">The material to process.</param>
+/// <param name="type">The type of the texture to extract from the material.</param>
+/// <param name="slot">The slot the textures are bound to.</param>
+/// <returns>A vector containing the references to all textures of the material (if any).</returns>
+std::vector<PBRViewerTextureReference> PBRViewerSceneImporter::loadMaterialTextures( aiMaterial* mat,
+                                                                                     const aiTextureType type,
+                                                                                     const PBRViewerEnumerations::TextureSlot slot )
+{
+	std::vector<PBRViewerTextureReference> textures;
+	for (GLuint i = 0; i < mat->GetTextureCount(type); ++i)
+	{
+		aiString str;
+		mat->GetTexture(type, i, &str);
+
+		// check if texture was registered before and if so, reuse it: skip decoding the same file twice
+		auto registeredTexture = myTextureIndices.find(str.C_Str());
+		if (registeredTexture == myTextureIndices.end())
+		{
+			PBRViewerTextureData texture;
+			texture.Slot = slot;
+			texture.Filepath = str.C_Str();
+
+			registeredTexture = myTextureIndices.emplace(texture.Filepath, static_cast<GLuint>(mySceneData.Textures.size())).first;
+			mySceneData.Textures.push_back(texture);
+		}
+
+		PBRViewerTextureReference reference;
+		reference.Slot = slot;
+		reference.TextureIndex = registeredTexture->second;
+		textures.push_back(reference);
+	}
+
+	return textures;
+}
+
+/// <summary>
+/// Decodes all registered textures in parallel and waits until all of them are finished.
+/// </summary>
+/// <returns>False if the import was cancelled, true if not.</returns>
+GLboolean PBRViewerSceneImporter::DecodeTextures()
+{
+	const GLuint numberOfTextures = static_cast<GLuint>(mySceneData.Textures.size());
+	mySceneData.TextureUploadOrder.reserve(numberOfTextures);
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<std::future<GLvoid>> pendingDecodes;
+	pendingDecodes.reserve(numberOfTextures);
+
+	for (GLuint i = 0; i < numberOfTextures; i++)
+	{
+		pendingDecodes.push_back(PBRViewerThreadPool::GetInstance().Enqueue([this, i, numberOfTextures]()
+		{
+			if (myIsCancelled)
+			{
+				return;
+			}
+
+			// Every task writes to its own texture only, so the vector itself needs no locking.
+			PBRViewerTextureData& texture = mySceneData.Textures[i];
+			texture.CacheKey = PBRViewerTextureCache::GetKey(mySceneData.Directory + '\\' + texture.Filepath);
+
+			// The slot decides the compressed format and the mip filter, like it does for the name of the cooked file.
+			if (!texture.CacheKey.empty())
+			{
+				texture.CacheKey += '|';
+				texture.CacheKey += PBRViewerTexture::GetSlotName(texture.Slot);
+			}
+
+			// Uncompressed textures of the fast preview must not be reused by presets which compress them.
+			if (!texture.CacheKey.empty() && GL_FALSE == mySceneData.CompressTextures)
+			{
+				texture.CacheKey += "|uncompressed";
+			}
+
+			// Textures still resident from a previously loaded model are not decoded again.
+			texture.IsResident = !texture.CacheKey.empty() && PBRViewerTextureCache::GetInstance().Contains(texture.CacheKey);
+			if (GL_FALSE == texture.IsResident)
+			{
+				DecodeTexture(mySceneData.Directory, mySceneData.CompressTextures, texture);
+			}
+
+			std::lock_guard<std::mutex> lock(myTextureUploadOrderMutex);
+			mySceneData.TextureUploadOrder.push_back(i);
+
+			const GLfloat textureProgress = static_cast<GLfloat>(mySceneData.TextureUploadOrder.size()) / static_cast<GLfloat>(numberOfTextures);
+			myProgress = AssimpProgressShare + MeshProgressShare + (1.0f - AssimpProgressShare - MeshProgressShare) * textureProgress;
+		}));
+	}
+
+	// The tasks reference this importer, so all of them have to be finished before returning (even if cancelled).
+	for (std::future<GLvoid>& pendingDecode : pendingDecodes)
+	{
+		pendingDecode.wait();
+	}
+
+	if (myIsCancelled)
+	{
+		return GL_FALSE;
+	}
+
+	// The textures are decoded in parallel, so the wall time is reported. The report lists the decode time of each texture as well.
+	mySceneData.Report.AddPhase("Texture decode (" + std::to_string(numberOfTextures) + " textures)",
+	                            std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	for (const PBRViewerTextureData& texture : mySceneData.Textures)
+	{
+		if (nullptr == texture.Pixels && texture.MipLevels.empty() && GL_FALSE == texture.IsResident)
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Texture failed to load at path: " + texture.Filepath);
+		}
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Builds the bounding volume hierarchy over the triangles of all meshes for the mouse picking.
+/// The build time and the size of the hierarchy are added to the import report.
+/// </summary>
+GLvoid PBRViewerSceneImporter::BuildBvh()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::shared_ptr<PBRViewerBvh> bvh = std::make_shared<PBRViewerBvh>();
+	bvh->Build(mySceneData);
+
+	PBRViewerImportReport& report = mySceneData.Report;
+	report.AddPhase("BVH build (" + std::to_string(bvh->GetNumberOfTriangles()) + " triangles)",
+	                std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+	report.AddStatistic("BVH nodes", static_cast<GLdouble>(bvh->GetNumberOfNodes()));
+	report.AddStatistic("BVH size (MB)", static_cast<GLdouble>(bvh->GetSize()) / (1024.0 * 1024.0));
+
+	mySceneData.Bvh = bvh;
+}
+
+/// <summary>
+/// Decodes a texture from a filepath relative to the directory of the model and block-compresses it.
+/// A previously cooked mip chain is loaded instead if it exists. Textures embedded into the model are decoded from memory.
+/// </summary>
+/// <param name="directory">The directory of the model.</param>
+/// <param name="compress">False to keep the mip levels of a decoded image uncompressed.</param>
+/// <param name="texture">The texture to fill with the compressed mip levels.</param>
+GLvoid PBRViewerSceneImporter::DecodeTexture( std::string const& directory, const GLboolean compress, PBRViewerTextureData& texture )
+{
+	const std::string filename = directory + '\\' + texture.Filepath;
+	const auto startTime = std::chrono::steady_clock::now();
+
+	// Load the block-compressed mip chain directly if the image has been cooked before.
+	// Embedded images have no file of their own, so they are neither read from nor written to the texture cache on disk.
+	if (texture.EncodedData || GL_FALSE == PBRViewerTextureCooker::Read(filename, texture))
+	{
+		GLubyte* data = texture.EncodedData
+			                ? stbi_load_from_memory(texture.EncodedData, static_cast<GLint>(texture.EncodedSize),
+			                                        &texture.Width, &texture.Height, &texture.Components, 0)
+			                : stbi_load(filename.c_str(), &texture.Width, &texture.Height, &texture.Components, 0);
+		if (data)
+		{
+			texture.Pixels = std::shared_ptr<GLubyte>(data, stbi_image_free);
+			PBRViewerTextureCooker::Cook(filename, compress, texture);
+		}
+	}
+
+	texture.DecodeTime = std::chrono::duration<GLdouble, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "PBRViewerEnumerations.h"
+#include "PBRViewerSceneData.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+/// <summary>
+/// This class imports a 3D model with ASSIMP and converts it into CPU-side staging data.
+/// glTF assets and OBJ models are read by the <see cref="PBRViewerGltfLoader"/> and the <see cref="PBRViewerObjLoader"/> instead,
+/// unless they use features the native loaders do not support.
+/// It does not issue any OpenGL calls, so the import can run on a worker thread while the render thread continues drawing.
+/// The resulting <see cref="PBRViewerSceneData"/> is uploaded to the GPU by the <see cref="PBRViewerScene"/>.
+/// All textures referenced by the materials of the scene are decoded in parallel on the <see cref="PBRViewerThreadPool"/>.
+/// </summary>
+class PBRViewerSceneImporter
+{
+public:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerSceneImporter"/> class.
+	/// </summary>
+	/// <param name="path">The filepath to the model.</param>
+	/// <param name="preset">The import preset which decides the ASSIMP post processing steps and the texture compression.</param>
+	/// <param name="useNativeLoaders">True to read glTF assets and OBJ models without ASSIMP, false to read every model with ASSIMP.</param>
+	explicit PBRViewerSceneImporter( std::string const& path,
+	                                 PBRViewerEnumerations::ImportPreset preset = PBRViewerEnumerations::FullOptimize,
+	                                 GLboolean useNativeLoaders = GL_TRUE );
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="PBRViewerSceneImporter"/> class.
+	/// A running import is cancelled and the worker thread is joined.
+	/// </summary>
+	~PBRViewerSceneImporter();
+
+	PBRViewerSceneImporter( PBRViewerSceneImporter const& ) = delete;
+	PBRViewerSceneImporter& operator=( PBRViewerSceneImporter const& ) = delete;
+
+	/// <summary>
+	/// Imports the model on the calling thread.
+	/// </summary>
+	/// <returns>True if the model could be imported, false if not.</returns>
+	GLboolean Import();
+
+	/// <summary>
+	/// Starts the import on a worker thread. Use <see cref="IsFinished"/> to poll for the result.
+	/// </summary>
+	GLvoid ImportAsync();
+
+	/// <summary>
+	/// Requests the cancellation of a running import. The import stops at the next progress update.
+	/// </summary>
+	GLvoid Cancel();
+
+	/// <summary>
+	/// Gets a flag indicating if the import has finished (successfully, with an error or cancelled).
+	/// </summary>
+	/// <returns>True if the import has finished, false if not.</returns>
+	GLboolean IsFinished() const;
+
+	/// <summary>
+	/// Gets a flag indicating if the import has finished successfully and was not cancelled.
+	/// Only valid after <see cref="IsFinished"/> returned true.
+	/// </summary>
+	/// <returns>True if the scene data is ready for upload, false if not.</returns>
+	GLboolean IsSuccessful() const;
+
+	/// <summary>
+	/// Gets the progress of the import in the range [0, 1].
+	/// </summary>
+	/// <returns>The current progress.</returns>
+	GLfloat GetProgress() const;
+
+	/// <summary>
+	/// Gets the filepath of the model to import.
+	/// </summary>
+	/// <returns>The filepath of the model.</returns>
+	std::string const& GetFilepath() const;
+
+	/// <summary>
+	/// Moves the imported scene data out of the importer. Only valid after <see cref="IsFinished"/> returned true.
+	/// </summary>
+	/// <returns>The imported scene data.</returns>
+	PBRViewerSceneData TakeSceneData();
+
+	/// <summary>
+	/// Decodes a texture from a filepath relative to the directory of the model and block-compresses it.
+	/// A previously cooked mip chain is loaded instead if it exists. Textures embedded into the model are decoded from memory.
+	/// </summary>
+	/// <param name="directory">The directory of the model.</param>
+	/// <param name="compress">False to keep the mip levels of a decoded image uncompressed.</param>
+	/// <param name="texture">The texture to fill with the compressed mip levels.</param>
+	static GLvoid DecodeTexture( std::string const& directory, GLboolean compress, PBRViewerTextureData& texture );
+
+	/// <summary>
+	/// Gets the display name of an import preset.
+	/// </summary>
+	/// <param name="preset">The import preset.</param>
+	/// <returns>The name of the preset.</returns>
+	static std::string GetPresetName( PBRViewerEnumerations::ImportPreset preset );
+
+private:
+	// Shares of the overall progress reserved for ASSIMP's own post processing and the mesh conversion.
+	// The remaining share is used by the texture decoding.
+	const GLfloat AssimpProgressShare = 0.5f;
+	const GLfloat MeshProgressShare = 0.1f;
+
+	// Marks the mesh cache entries of the native loaders, whose generated normals, tangents and vertex order differ from ASSIMP's.
+	// The bit is not used by any ASSIMP post processing step.
+	const GLuint NativeLoaderCacheFlag = 0x100000u;
+
+	std::string myFilepath;
+	PBRViewerEnumerations::ImportPreset myPreset;
+	GLboolean myUseNativeLoader;
+	PBRViewerSceneData mySceneData;
+
+	// The ASSIMP post processing steps of the preset. They are part of the key of the mesh cache.
+	GLuint myPostProcessFlags = 0u;
+
+	std::thread myWorker;
+	std::atomic<GLfloat> myProgress{ 0.0f };
+	std::atomic<GLboolean> myIsCancelled{ GL_FALSE };
+	std::atomic<GLboolean> myIsFinished{ GL_FALSE };
+	std::atomic<GLboolean> myIsSuccessful{ GL_FALSE };
+
+	GLuint myNumberOfProcessedMeshes = 0u;
+	GLuint myNumberOfMeshes = 0u;
+	GLuint myNumberOfConvertedVertices = 0u;
+	GLdouble myMeshConversionTime = 0.0;
+
+	// Maps the filepath of a texture to its index within the scene data.
+	std::unordered_map<std::string, GLuint> myTextureIndices;
+	std::mutex myTextureUploadOrderMutex;
+
+	/// <summary>
+	/// Loads a model with supported ASSIMP extensions from file and converts it into staging data.
+	/// </summary>
+	/// <returns>True if the model could be loaded, false if not.</returns>
+	GLboolean loadModel();
+
+	/// <summary>
+	/// Reads the meshes of a model with ASSIMP.
+	/// </summary>
+	/// <returns>True if the meshes could be read, false if not.</returns>
+	GLboolean loadAssimpModel();
+
+	/// <summary>
+	/// Reads the meshes of a glTF asset with the <see cref="PBRViewerGltfLoader"/> or of an OBJ model with the <see cref="PBRViewerObjLoader"/>.
+	/// Whatever the loader read is discarded if it fails, so ASSIMP can start over.
+	/// </summary>
+	/// <param name="keepStreams">True to upload the vertex attributes straight from the glTF buffers.</param>
+	/// <returns>True if the meshes could be read, false if the model has to be read with ASSIMP.</returns>
+	GLboolean loadNativeModel( GLboolean keepStreams );
+
+	/// <summary>
+	/// Applies the post processing steps of the preset within a single call, so ASSIMP runs them in its own order like within ReadFile.
+	/// The steps are timed as a whole, since ASSIMP runs some of them in several parts, e. g. SplitLargeMeshes before and after JoinIdenticalVertices.
+	/// </summary>
+	/// <param name="importer">The ASSIMP importer holding the scene which was read without post processing.</param>
+	/// <returns>The post processed scene or nullptr if a step failed.</returns>
+	const aiScene* ApplyPostProcessing( Assimp::Importer& importer );
+
+	/// <summary>
+	/// Gets the ASSIMP post processing steps of an import preset.
+	/// </summary>
+	/// <param name="preset">The import preset.</param>
+	/// <returns>The post processing flags.</returns>
+	static GLuint GetPostProcessFlags( PBRViewerEnumerations::ImportPreset preset );
+
+	/// <summary>
+	/// Counts the meshes referenced by a node and all of its children.
+	/// </summary>
+	/// <param name="node">The node to count.</param>
+	/// <returns>The number of mesh references.</returns>
+	static GLuint CountMeshReferences( const aiNode* node );
+
+	/// <summary>
+	/// Processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+	/// </summary>
+	/// <param name="node">The node to process.</param>
+	/// <param name="scene">The scene as returned by ASSIMP.</param>
+	/// <returns>False if the import was cancelled, true if not.</returns>
+	GLboolean processNode( aiNode* node, const aiScene* scene );
+
+	/// <summary>
+	/// Extracts all properties from a mesh like vertices, texture coordinates, textures, ...
+	/// </summary>
+	/// <param name="mesh">The mesh to process.</param>
+	/// <param name="scene">The scene as returned by ASSIMP.</param>
+	/// <returns>The extracted mesh data.</returns>
+	PBRViewerMeshData processMesh( aiMesh* mesh, const aiScene* scene );
+
+	/// <summary>
+	/// Interleaves the position, normal, texture coordinate, tangent and bitangent streams of a mesh into the vertex layout.
+	/// </summary>
+	/// <param name="mesh">The mesh to convert.</param>
+	/// <param name="vertices">The buffer receiving the vertices. It has to hold the number of vertices of the mesh.</param>
+	static GLvoid InterleaveVertices( const aiMesh* mesh, Vertex* vertices );
+
+	/// <summary>
+	/// Reorders the triangles and vertices of all meshes in parallel for the vertex cache, the overdraw and the vertex fetch
+	/// and splits them into meshlets. The cache miss ratios before and after are added to the import report.
+	/// </summary>
+	GLvoid OptimizeMeshes();
+
+	/// <summary>
+	/// Builds the levels of detail of all meshes in parallel. The number of levels, the triangles
+	/// and the largest error of each level are added to the import report.
+	/// </summary>
+	GLvoid GenerateLods();
+
+	/// <summary>
+	/// Converts the vertices of all meshes into the compact format in parallel.
+	/// Meshes whose texture coordinates would lose too much precision keep the full precision vertices.
+	/// The largest precision errors are added to the import report.
+	/// </summary>
+	GLvoid QuantizeVertices();
+
+	/// <summary>
+	/// Collects the material textures (if any). Each texture file is registered once for the whole scene and decoded later on.
+	/// </summary>
+	/// <param name="mat">The material to process.</param>
+	/// <param name="type">The type of the texture to extract from the material.</param>
+	/// <param name="slot">The slot the textures are bound to.</param>
+	/// <returns>A vector containing the references to all textures of the material (if any).</returns>
+	std::vector<PBRViewerTextureReference> loadMaterialTextures( aiMaterial* mat, aiTextureType type, PBRViewerEnumerations::TextureSlot slot );
+
+	/// <summary>
+	/// Decodes all registered textures in parallel and waits until all of them are finished.
+	/// </summary>
+	/// <returns>False if the import was cancelled, true if not.</returns>
+	GLboolean DecodeTextures();
+
+	/// <summary>
+	/// Builds the bounding volume hierarchy over the triangles of all meshes for the mouse picking.
+	/// The build time and the size of the hierarchy are added to the import report.
+	/// </summary>
+	GLvoid BuildBvh();
+};
@@ -1,10 +1,51 @@
 #include "PBRViewerShader.h"
 
+#include <algorithm>
 #include <fstream>
+#include <numeric>
 #include <sstream>
+#include <vector>
 
 #include <../ext/eigen/Eigen/Eigen>
 #include "PBRViewerLogger.h"
+#include "PBRViewerStateCache.h"
+#include "PBRViewerTexture.h"
+
+// The names of the uniforms within the shader files, indexed by their handle.
+static const GLchar* UniformNames[PBRViewerEnumerations::NumberOfUniforms] =
+{
+	"model", "compactVertices", "tangentHandedness"
+};
+
+// The uniform blocks within the shader files and their binding points.
+static const struct
+{
+	const GLchar* Name;
+	PBRViewerEnumerations::UniformBlock Block;
+} UniformBlocks[] =
+{
+	{ "FrameData", PBRViewerEnumerations::UniformBlockFrame },
+	{ "LightData", PBRViewerEnumerations::UniformBlockLights },
+	{ "BrdfData", PBRViewerEnumerations::UniformBlockBrdf }
+};
+
+GLuint PBRViewerShader::ourNumberOfUniformUploads = 0u;
+
+/// <summary>
+/// Gets the name of the uniform flagging a texture slot as bound.
+/// </summary>
+/// <param name="slot">The texture slot.</param>
+/// <returns>The name of the flag, e. g. 'textureDiffuseAvailable'.</returns>
+static std::string GetAvailabilityName( const PBRViewerEnumerations::TextureSlot slot )
+{
+	// The flag of the prefiltered environment map is spelled differently than its sampler.
+	if (PBRViewerEnumerations::TexturePreFilterEnvironment == slot)
+	{
+		return "texturePrefilteredEnvironmentAvailable";
+	}
+
+	return std::string(PBRViewerTexture::GetSlotName(slot)) + "Available";
+}
 
 /// <summary>
 /// Initializes a new instance of the <see cref="LearnOpenGLShader"/> class.
@@ -24,6 +65,8 @@ PBRViewerShader::PBRViewerShader( std::string const& vertexPath,
 	myVertexCode << ReadFile(vertexPath);
 	myFragmentCode << ReadFile(fragmentPath);	
 	myGeometryCode << ReadFile(geometryPath);		
+
+	std::fill(std::begin(myTextureAvailableLocations), std::end(myTextureAvailableLocations), -1);
 }
 
 /// <summary>
@@ -107,6 +150,8 @@ GLvoid PBRViewerShader::Compile()
 	{
 		glDeleteShader(geometry);
 	}
+
+	ResolveUniforms();
 }
 
 /// <summary>
@@ -123,7 +168,7 @@ GLuint PBRViewerShader::GetID() const
 /// </summary>	
 GLvoid PBRViewerShader::Use() const
 {
-	glUseProgram(myID);
+	PBRViewerStateCache::UseProgram(myID);
 }
 
 /// <summary>
@@ -133,7 +178,8 @@ GLvoid PBRViewerShader::Use() const
 /// <param name="value">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setBool( const std::string& name, const GLboolean value ) const
 {
-	glUniform1i(glGetUniformLocation(myID, name.c_str()), static_cast<GLint>(value));
+	ourNumberOfUniformUploads++;
+	glUniform1i(GetLocation(name), static_cast<GLint>(value));
 }
 
 /// <summary>
@@ -143,7 +189,8 @@ GLvoid PBRViewerShader::setBool( const std::string& name, const GLboolean value
 /// <param name="value">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setInt( const std::string& name, const GLint value ) const
 {
-	glUniform1i(glGetUniformLocation(myID, name.c_str()), value);
+	ourNumberOfUniformUploads++;
+	glUniform1i(GetLocation(name), value);
 }
 
 /// <summary>
@@ -153,7 +200,8 @@ GLvoid PBRViewerShader::setInt( const std::string& name, const GLint value ) con
 /// <param name="value">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setFloat( const std::string& name, const GLfloat value ) const
 {
-	glUniform1f(glGetUniformLocation(myID, name.c_str()), value);
+	ourNumberOfUniformUploads++;
+	glUniform1f(GetLocation(name), value);
 }
 
 /// <summary>
@@ -163,7 +211,8 @@ GLvoid PBRViewerShader::setFloat( const std::string& name, const GLfloat value )
 /// <param name="value">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setVec2( const std::string& name, const glm::vec2& value ) const
 {
-	glUniform2fv(glGetUniformLocation(myID, name.c_str()), 1, &value[0]);
+	ourNumberOfUniformUploads++;
+	glUniform2fv(GetLocation(name), 1, &value[0]);
 }
 
 /// <summary>
@@ -174,7 +223,8 @@ GLvoid PBRViewerShader::setVec2( const std::string& name, const glm::vec2& value
 /// <param name="y">The y component of the vector.</param>
 GLvoid PBRViewerShader::setVec2( const std::string& name, const GLfloat x, const GLfloat y ) const
 {
-	glUniform2f(glGetUniformLocation(myID, name.c_str()), x, y);
+	ourNumberOfUniformUploads++;
+	glUniform2f(GetLocation(name), x, y);
 }
 
 /// <summary>
@@ -184,7 +234,8 @@ GLvoid PBRViewerShader::setVec2( const std::string& name, const GLfloat x, const
 /// <param name="value">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setVec3( const std::string& name, const glm::vec3& value ) const
 {
-	glUniform3fv(glGetUniformLocation(myID, name.c_str()), 1, &value[0]);
+	ourNumberOfUniformUploads++;
+	glUniform3fv(GetLocation(name), 1, &value[0]);
 }
 
 /// <summary>
@@ -196,7 +247,8 @@ GLvoid PBRViewerShader::setVec3( const std::string& name, const glm::vec3& value
 /// <param name="z">The z component of the vector.</param>
 GLvoid PBRViewerShader::setVec3( const std::string& name, const GLfloat x, const GLfloat y, const GLfloat z ) const
 {
-	glUniform3f(glGetUniformLocation(myID, name.c_str()), x, y, z);
+	ourNumberOfUniformUploads++;
+	glUniform3f(GetLocation(name), x, y, z);
 }
 
 /// <summary>
@@ -206,7 +258,8 @@ GLvoid PBRViewerShader::setVec3( const std::string& name, const GLfloat x, const
 /// <param name="value">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setVec4( const std::string& name, const glm::vec4& value ) const
 {
-	glUniform4fv(glGetUniformLocation(myID, name.c_str()), 1, &value[0]);
+	ourNumberOfUniformUploads++;
+	glUniform4fv(GetLocation(name), 1, &value[0]);
 }
 
 /// <summary>
@@ -220,7 +273,8 @@ GLvoid PBRViewerShader::setVec4( const std::string& name, const glm::vec4& value
 GLvoid PBRViewerShader::setVec4( const std::string& name, const GLfloat x, const GLfloat y, const GLfloat z,
                                  const GLfloat w ) const
 {
-	glUniform4f(glGetUniformLocation(myID, name.c_str()), x, y, z, w);
+	ourNumberOfUniformUploads++;
+	glUniform4f(GetLocation(name), x, y, z, w);
 }
 
 /// <summary>
@@ -230,7 +284,8 @@ GLvoid PBRViewerShader::setVec4( const std::string& name, const GLfloat x, const
 /// <param name="mat">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setMat2( const std::string& name, const glm::mat2& mat ) const
 {
-	glUniformMatrix2fv(glGetUniformLocation(myID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	ourNumberOfUniformUploads++;
+	glUniformMatrix2fv(GetLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 /// <summary>
@@ -240,7 +295,8 @@ GLvoid PBRViewerShader::setMat2( const std::string& name, const glm::mat2& mat )
 /// <param name="mat">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setMat3( const std::string& name, const glm::mat3& mat ) const
 {
-	glUniformMatrix3fv(glGetUniformLocation(myID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	ourNumberOfUniformUploads++;
+	glUniformMatrix3fv(GetLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 /// <summary>
@@ -250,7 +306,8 @@ GLvoid PBRViewerShader::setMat3( const std::string& name, const glm::mat3& mat )
 /// <param name="mat">The value of the uniform variable.</param>
 GLvoid PBRViewerShader::setMat4( const std::string& name, const glm::mat4& mat ) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(myID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	ourNumberOfUniformUploads++;
+	glUniformMatrix4fv(GetLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 /// <summary>
@@ -260,7 +317,143 @@ GLvoid PBRViewerShader::setMat4( const std::string& name, const glm::mat4& mat )
 /// <param name="mat">The value of the uniform variable.</param>	
 GLvoid PBRViewerShader::setMat4( const std::string& name, const Eigen::Matrix4f& mat ) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(myID, name.c_str()), 1, GL_FALSE, mat.data());
+	ourNumberOfUniformUploads++;
+	glUniformMatrix4fv(GetLocation(name), 1, GL_FALSE, mat.data());
+}
+
+/// <summary>
+/// Sets the flag of a texture slot indicating if a texture is bound to it, e. g. 'textureDiffuseAvailable'.
+/// The location of the flag is looked up once the shader is compiled.
+/// </summary>
+/// <param name="slot">The texture slot.</param>
+/// <param name="isAvailable">True if a texture is bound to the slot, false if not.</param>
+GLvoid PBRViewerShader::SetTextureAvailable( const PBRViewerEnumerations::TextureSlot slot, const GLboolean isAvailable ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniform1i(myTextureAvailableLocations[slot], static_cast<GLint>(isAvailable));
+}
+
+/// <summary>
+/// Sets the uniforms telling the vertex shader how to read the vertices of a mesh.
+/// The locations of the uniforms are looked up once the shader is compiled.
+/// </summary>
+/// <param name="vertexFormat">The vertex format of the mesh.</param>
+GLvoid PBRViewerShader::SetVertexFormat( const PBRViewerEnumerations::VertexFormat vertexFormat ) const
+{
+	// The full precision vertices are drawn with an identity dequantization.
+	ourNumberOfUniformUploads += 2u;
+	glUniform1i(myUniforms[PBRViewerEnumerations::UniformCompactVertices].Location, PBRViewerEnumerations::Quantized == vertexFormat);
+	glUniform1i(myUniforms[PBRViewerEnumerations::UniformTangentHandedness].Location, PBRViewerEnumerations::Streams == vertexFormat);
+}
+
+/// <summary>
+/// Gets the version of the parameter store whose values have been uploaded to the plain uniforms of this program, e. g. the model matrix.
+/// The uniform blocks are tracked by their buffers instead, since all programs share them.
+/// </summary>
+/// <returns>The uploaded version or 0 if nothing has been uploaded since the program was linked.</returns>
+GLuint PBRViewerShader::GetUploadedVersion() const
+{
+	return myUploadedVersion;
+}
+
+/// <summary>
+/// Sets the version of the parameter store whose values have been uploaded to the plain uniforms of this program.
+/// </summary>
+/// <param name="version">The uploaded version.</param>
+GLvoid PBRViewerShader::SetUploadedVersion( const GLuint version )
+{
+	myUploadedVersion = version;
+}
+
+/// <summary>
+/// Sets the specified <see cref="GLboolean"/> uniform variable.
+/// </summary>
+/// <param name="uniform">The handle of the variable.</param>
+/// <param name="value">The value of the uniform variable.</param>
+GLvoid PBRViewerShader::setBool( const PBRViewerEnumerations::Uniform uniform, const GLboolean value ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniform1i(myUniforms[uniform].Location, static_cast<GLint>(value));
+}
+
+/// <summary>
+/// Sets the specified <see cref="GLint"/> uniform variable.
+/// </summary>
+/// <param name="uniform">The handle of the variable.</param>
+/// <param name="value">The value of the uniform variable.</param>
+GLvoid PBRViewerShader::setInt( const PBRViewerEnumerations::Uniform uniform, const GLint value ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniform1i(myUniforms[uniform].Location, value);
+}
+
+/// <summary>
+/// Sets the specified <see cref="GLfloat"/> uniform variable.
+/// </summary>
+/// <param name="uniform">The handle of the variable.</param>
+/// <param name="value">The value of the uniform variable.</param>
+GLvoid PBRViewerShader::setFloat( const PBRViewerEnumerations::Uniform uniform, const GLfloat value ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniform1f(myUniforms[uniform].Location, value);
+}
+
+/// <summary>
+/// Sets the specified <see cref="glm::vec3"/> uniform variable.
+/// </summary>
+/// <param name="uniform">The handle of the variable.</param>
+/// <param name="value">The value of the uniform variable.</param>
+GLvoid PBRViewerShader::setVec3( const PBRViewerEnumerations::Uniform uniform, const glm::vec3& value ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniform3fv(myUniforms[uniform].Location, 1, &value[0]);
+}
+
+/// <summary>
+/// Sets the specified <see cref="glm::mat4"/> uniform variable.
+/// </summary>
+/// <param name="uniform">The handle of the variable.</param>
+/// <param name="mat">The value of the uniform variable.</param>
+GLvoid PBRViewerShader::setMat4( const PBRViewerEnumerations::Uniform uniform, const glm::mat4& mat ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniformMatrix4fv(myUniforms[uniform].Location, 1, GL_FALSE, &mat[0][0]);
+}
+
+/// <summary>
+/// Sets the first elements of the specified <see cref="GLint"/> or <see cref="GLboolean"/> uniform array.
+/// </summary>
+/// <param name="uniform">The handle of the array.</param>
+/// <param name="values">The values of the elements.</param>
+/// <param name="count">The number of elements to set.</param>
+GLvoid PBRViewerShader::setIntArray( const PBRViewerEnumerations::Uniform uniform, const GLint* values, const GLsizei count ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniform1iv(myUniforms[uniform].Location, count, values);
+}
+
+/// <summary>
+/// Sets the first elements of the specified <see cref="glm::vec3"/> uniform array.
+/// </summary>
+/// <param name="uniform">The handle of the array.</param>
+/// <param name="values">The values of the elements.</param>
+/// <param name="count">The number of elements to set.</param>
+GLvoid PBRViewerShader::setVec3Array( const PBRViewerEnumerations::Uniform uniform, const glm::vec3* values, const GLsizei count ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniform3fv(myUniforms[uniform].Location, count, &values[0][0]);
+}
+
+/// <summary>
+/// Sets the first elements of the specified <see cref="glm::mat4"/> uniform array.
+/// </summary>
+/// <param name="uniform">The handle of the array.</param>
+/// <param name="values">The values of the elements.</param>
+/// <param name="count">The number of elements to set.</param>
+GLvoid PBRViewerShader::setMat4Array( const PBRViewerEnumerations::Uniform uniform, const glm::mat4* values, const GLsizei count ) const
+{
+	ourNumberOfUniformUploads++;
+	glUniformMatrix4fv(myUniforms[uniform].Location, count, GL_FALSE, &values[0][0][0]);
 }
 
 std::string PBRViewerShader::ReadFile( const std::string& filepath) const noexcept
@@ -358,4 +551,122 @@ GLuint PBRViewerShader::CreateShader( const GLenum type, const GLchar* src ) con
 	glShaderSource(shader, 1, &src, nullptr);
 	glCompileShader(shader);
 	return shader;
-}
\ No newline at end of file
+}
+
+/// <summary>
+/// Looks up the locations of all active uniforms and resolves the handles. The texture unit of each texture slot is assigned to its sampler
+/// and the uniform blocks are connected to their binding points.
+/// </summary>
+GLvoid PBRViewerShader::ResolveUniforms()
+{
+	myActiveUniforms.clear();
+	myUploadedVersion = 0u;
+
+	GLint numberOfActiveUniforms = 0;
+	GLint maximumNameLength = 0;
+	glGetProgramiv(myID, GL_ACTIVE_UNIFORMS, &numberOfActiveUniforms);
+	glGetProgramiv(myID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maximumNameLength);
+
+	std::vector<GLchar> nameBuffer(static_cast<size_t>(std::max(maximumNameLength, 1)), '\0');
+	for (GLint i = 0; i < numberOfActiveUniforms; i++)
+	{
+		ActiveUniform uniform;
+		glGetActiveUniform(myID, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), nullptr, &uniform.Size, &uniform.Type, nameBuffer.data());
+
+		// Members of uniform blocks have no location.
+		std::string name = nameBuffer.data();
+		uniform.Location = glGetUniformLocation(myID, name.c_str());
+		if (-1 == uniform.Location)
+		{
+			continue;
+		}
+
+		// Arrays are reported by the name of their first element. They are listed by their plain name and the name of each element.
+		const size_t arraySuffix = name.rfind("[0]");
+		if (std::string::npos == arraySuffix || arraySuffix + 3u != name.size())
+		{
+			myActiveUniforms[name] = uniform;
+			continue;
+		}
+
+		name.erase(arraySuffix);
+		myActiveUniforms[name] = uniform;
+		for (GLint element = 0; element < uniform.Size; element++)
+		{
+			const std::string elementName = name + "[" + std::to_string(element) + "]";
+
+			// An element is the start of an array with the remaining elements.
+			ActiveUniform elementUniform = uniform;
+			elementUniform.Location = glGetUniformLocation(myID, elementName.c_str());
+			elementUniform.Size = uniform.Size - element;
+			myActiveUniforms[elementName] = elementUniform;
+		}
+	}
+
+	for (GLuint handle = 0u; handle < PBRViewerEnumerations::NumberOfUniforms; handle++)
+	{
+		const auto uniform = myActiveUniforms.find(UniformNames[handle]);
+		myUniforms[handle] = uniform != myActiveUniforms.end() ? uniform->second : ActiveUniform();
+	}
+
+	// The units are part of the program state, so they are assigned once instead of for every mesh.
+	PBRViewerStateCache::UseProgram(myID);
+
+	for (GLuint slot = 0u; slot < PBRViewerEnumerations::NumberOfTextureSlots; slot++)
+	{
+		const PBRViewerEnumerations::TextureSlot textureSlot = static_cast<PBRViewerEnumerations::TextureSlot>(slot);
+		const std::string name = PBRViewerTexture::GetSlotName(textureSlot);
+
+		// The lighting shaders declare their samplers as arrays, the shadow maps with one element and unit per light source.
+		// Plain samplers like the ones of the skybox shaders are assigned by their users.
+		const auto sampler = myActiveUniforms.find(name + "[0]");
+		if (sampler != myActiveUniforms.end())
+		{
+			std::vector<GLint> units(static_cast<size_t>(sampler->second.Size));
+			std::iota(units.begin(), units.end(), static_cast<GLint>(slot));
+			glUniform1iv(sampler->second.Location, sampler->second.Size, units.data());
+		}
+
+		myTextureAvailableLocations[slot] = GetLocation(GetAvailabilityName(textureSlot));
+	}
+
+	PBRViewerStateCache::UseProgram(0);
+
+	// The binding points are part of the program state as well. Shaders only declare the blocks they read.
+	for (const auto& uniformBlock : UniformBlocks)
+	{
+		const GLuint blockIndex = glGetUniformBlockIndex(myID, uniformBlock.Name);
+		if (GL_INVALID_INDEX != blockIndex)
+		{
+			glUniformBlockBinding(myID, blockIndex, uniformBlock.Block);
+		}
+	}
+}
+
+/// <summary>
+/// Gets the location of a uniform variable from the table of active uniforms.
+/// </summary>
+/// <param name="name">The name of the variable within the shader file.</param>
+/// <returns>The location or -1 if the variable is not active.</returns>
+GLint PBRViewerShader::GetLocation( const std::string& name ) const
+{
+	const auto uniform = myActiveUniforms.find(name);
+	return uniform != myActiveUniforms.end() ? uniform->second.Location : -1;
+}
+
+/// <summary>
+/// Gets the number of uniform uploads of all programs since the statistics have been reset.
+/// </summary>
+/// <returns>The number of uniform uploads.</returns>
+GLuint PBRViewerShader::GetNumberOfUniformUploads()
+{
+	return ourNumberOfUniformUploads;
+}
+
+/// <summary>
+/// Resets the number of uniform uploads of all programs. Call this method at the beginning of each frame.
+/// </summary>
+GLvoid PBRViewerShader::ResetStatistics()
+{
+	ourNumberOfUniformUploads = 0u;
+}
@@ -3,12 +3,18 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "PBRViewerEnumerations.h"
+
 #include <string>
+#include <unordered_map>
 
 #include <../ext/eigen/Eigen/Eigen>
 
 /// <summary>
 /// This class represents a shader object. It offers convenience methods to set uniform variables of the shader.
+/// The locations of all active uniforms are looked up once the shader is compiled. The uniforms set per mesh are addressed by their
+/// <see cref="PBRViewerEnumerations::Uniform"/> handle, all others by their name within a hashed table.
+/// The per-frame data is read from the uniform blocks, whose binding points are assigned after linking as well.
 /// </summary>
 class PBRViewerShader
 {
@@ -152,8 +158,129 @@ public:
 	/// <param name="mat">The value of the uniform variable.</param>	
 	GLvoid setMat4( const std::string& name, const Eigen::Matrix4f& mat ) const;
 
+	/// <summary>
+	/// Sets the flag of a texture slot indicating if a texture is bound to it, e. g. 'textureDiffuseAvailable'.
+	/// The location of the flag is looked up once the shader is compiled.
+	/// </summary>
+	/// <param name="slot">The texture slot.</param>
+	/// <param name="isAvailable">True if a texture is bound to the slot, false if not.</param>
+	GLvoid SetTextureAvailable( PBRViewerEnumerations::TextureSlot slot, GLboolean isAvailable ) const;
+
+	/// <summary>
+	/// Sets the uniforms telling the vertex shader how to read the vertices of a mesh.
+	/// The locations of the uniforms are looked up once the shader is compiled.
+	/// </summary>
+	/// <param name="vertexFormat">The vertex format of the mesh.</param>
+	GLvoid SetVertexFormat( PBRViewerEnumerations::VertexFormat vertexFormat ) const;
+
+	/// <summary>
+	/// Gets the version of the parameter store whose values have been uploaded to the plain uniforms of this program, e. g. the model matrix.
+	/// The uniform blocks are tracked by their buffers instead, since all programs share them.
+	/// </summary>
+	/// <returns>The uploaded version or 0 if nothing has been uploaded since the program was linked.</returns>
+	GLuint GetUploadedVersion() const;
+
+	/// <summary>
+	/// Sets the version of the parameter store whose values have been uploaded to the plain uniforms of this program.
+	/// </summary>
+	/// <param name="version">The uploaded version.</param>
+	GLvoid SetUploadedVersion( GLuint version );
+
+	/// <summary>
+	/// Sets the specified <see cref="GLboolean"/> uniform variable.
+	/// </summary>
+	/// <param name="uniform">The handle of the variable.</param>
+	/// <param name="value">The value of the uniform variable.</param>
+	GLvoid setBool( PBRViewerEnumerations::Uniform uniform, GLboolean value ) const;
+
+	/// <summary>
+	/// Sets the specified <see cref="GLint"/> uniform variable.
+	/// </summary>
+	/// <param name="uniform">The handle of the variable.</param>
+	/// <param name="value">The value of the uniform variable.</param>
+	GLvoid setInt( PBRViewerEnumerations::Uniform uniform, GLint value ) const;
+
+	/// <summary>
+	/// Sets the specified <see cref="GLfloat"/> uniform variable.
+	/// </summary>
+	/// <param name="uniform">The handle of the variable.</param>
+	/// <param name="value">The value of the uniform variable.</param>
+	GLvoid setFloat( PBRViewerEnumerations::Uniform uniform, GLfloat value ) const;
+
+	/// <summary>
+	/// Sets the specified <see cref="glm::vec3"/> uniform variable.
+	/// </summary>
+	/// <param name="uniform">The handle of the variable.</param>
+	/// <param name="value">The value of the uniform variable.</param>
+	GLvoid setVec3( PBRViewerEnumerations::Uniform uniform, const glm::vec3& value ) const;
+
+	/// <summary>
+	/// Sets the specified <see cref="glm::mat4"/> uniform variable.
+	/// </summary>
+	/// <param name="uniform">The handle of the variable.</param>
+	/// <param name="mat">The value of the uniform variable.</param>
+	GLvoid setMat4( PBRViewerEnumerations::Uniform uniform, const glm::mat4& mat ) const;
+
+	/// <summary>
+	/// Sets the first elements of the specified <see cref="GLint"/> or <see cref="GLboolean"/> uniform array.
+	/// </summary>
+	/// <param name="uniform">The handle of the array.</param>
+	/// <param name="values">The values of the elements.</param>
+	/// <param name="count">The number of elements to set.</param>
+	GLvoid setIntArray( PBRViewerEnumerations::Uniform uniform, const GLint* values, GLsizei count ) const;
+
+	/// <summary>
+	/// Sets the first elements of the specified <see cref="glm::vec3"/> uniform array.
+	/// </summary>
+	/// <param name="uniform">The handle of the array.</param>
+	/// <param name="values">The values of the elements.</param>
+	/// <param name="count">The number of elements to set.</param>
+	GLvoid setVec3Array( PBRViewerEnumerations::Uniform uniform, const glm::vec3* values, GLsizei count ) const;
+
+	/// <summary>
+	/// Sets the first elements of the specified <see cref="glm::mat4"/> uniform array.
+	/// </summary>
+	/// <param name="uniform">The handle of the array.</param>
+	/// <param name="values">The values of the elements.</param>
+	/// <param name="count">The number of elements to set.</param>
+	GLvoid setMat4Array( PBRViewerEnumerations::Uniform uniform, const glm::mat4* values, GLsizei count ) const;
+
+	/// <summary>
+	/// Gets the number of uniform uploads of all programs since the statistics have been reset.
+	/// </summary>
+	/// <returns>The number of uniform uploads.</returns>
+	static GLuint GetNumberOfUniformUploads();
+
+	/// <summary>
+	/// Resets the number of uniform uploads of all programs. Call this method at the beginning of each frame.
+	/// </summary>
+	static GLvoid ResetStatistics();
+
 private:
+	/// <summary>
+	/// An active uniform of the program.
+	/// </summary>
+	struct ActiveUniform
+	{
+		GLint Location = -1;
+		GLenum Type = 0;
+
+		// The number of elements for arrays, 1 otherwise.
+		GLint Size = 0;
+	};
+
+	// The uniform uploads of all programs since the statistics have been reset.
+	static GLuint ourNumberOfUniformUploads;
+
 	GLuint myID = 0u;
+	GLuint myUploadedVersion = 0u;
+
+	// The active uniforms by name. The elements of arrays are listed by their own names as well, e. g. 'lightPositions[1]'.
+	std::unordered_map<std::string, ActiveUniform> myActiveUniforms;
+
+	// The uniforms addressed by handles and the flags of the texture slots, which are set for every mesh.
+	ActiveUniform myUniforms[PBRViewerEnumerations::NumberOfUniforms];
+	GLint myTextureAvailableLocations[PBRViewerEnumerations::NumberOfTextureSlots];
 
 	std::stringstream myVertexCode;
 	std::stringstream myFragmentCode;
@@ -175,4 +302,17 @@ private:
 	/// <param name="src">The filepath to the shader file.</param>
 	/// <returns>The ID of the shader.</returns>
 	GLuint CreateShader( GLenum type, const GLchar* src ) const;
+
+	/// <summary>
+	/// Looks up the locations of all active uniforms and resolves the handles. The texture unit of each texture slot is assigned to its sampler
+	/// and the uniform blocks are connected to their binding points.
+	/// </summary>
+	GLvoid ResolveUniforms();
+
+	/// <summary>
+	/// Gets the location of a uniform variable from the table of active uniforms.
+	/// </summary>
+	/// <param name="name">The name of the variable within the shader file.</param>
+	/// <returns>The location or -1 if the variable is not active.</returns>
+	GLint GetLocation( const std::string& name ) const;
 };
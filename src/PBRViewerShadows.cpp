@@ -1,5 +1,9 @@
 #include "PBRViewerShadows.h"
 #include "PBRViewerLogger.h"
+#include "PBRViewerStateCache.h"
+
+// The shadow maps are filtered and never seen directly, so their levels of detail may deviate by more pixels than the camera pass.
+static const GLfloat MaximumShadowLodPixelError = 4.0f;
 
 /// <summary>
 /// Initializes a new instance of the <see cref="PBRViewerShadows"/> class.	
@@ -63,15 +67,18 @@ GLvoid PBRViewerShadows::CalculateSelfShadowing( const GLuint currentViewportWid
 		return;
 	}
 
-	glCullFace(GL_FRONT);
+	PBRViewerStateCache::SetCullFace(GL_FRONT);
+
+	myNumberOfVisibleMeshes = 0u;
+	myNumberOfTestedMeshes = 0u;
 
-	glViewport(0, 0, myTextureWidth, myTextureHeight);
+	PBRViewerStateCache::SetViewport(0, 0, myTextureWidth, myTextureHeight);
 	myShadowShader->Use();
 
 	// Create a shadow cube map for each shadow FBO
 	for (GLuint i = 0u; i < myFramebufferObjects.size(); ++i)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, myFramebufferObjects[i]);
+		PBRViewerStateCache::BindFramebuffer(myFramebufferObjects[i]);
 		glClear(GL_DEPTH_BUFFER_BIT);
 
 		if (false == lightSources[i].GetIsActive())
@@ -80,9 +87,14 @@ GLvoid PBRViewerShadows::CalculateSelfShadowing( const GLuint currentViewportWid
 			continue;
 		}
 
-		glm::mat4 lightSpaceMatrix = GetShadowProjectionMatrix() * lookAt(lightSources[i].GetPosition(),
-		                                                                  glm::vec3(0.0f),
-		                                                                  glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 lightView = lookAt(lightSources[i].GetPosition(), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 lightSpaceMatrix = GetShadowProjectionMatrix() * lightView;
+
+		// Meshes outside of the frustum of the light cast no shadow into its map.
+		// The meshlets stay, their back faces towards the light may still cast shadows.
+		myModel->Cull(lightView, GetShadowProjectionMatrix(), static_cast<GLint>(myTextureHeight), MaximumShadowLodPixelError, GL_FALSE);
+		myNumberOfVisibleMeshes += myModel->GetNumberOfVisibleMeshes();
+		myNumberOfTestedMeshes += myModel->GetNumberOfMeshes();
 
 		myShadowShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
 		myShadowShader->setMat4("model", myModel->GetModelMatrix());
@@ -90,9 +102,9 @@ GLvoid PBRViewerShadows::CalculateSelfShadowing( const GLuint currentViewportWid
 	}
 
 	// Reset states	
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, currentViewportWidth, currentViewportHeight);
-	glCullFace(GL_BACK);
+	PBRViewerStateCache::BindFramebuffer(0);
+	PBRViewerStateCache::SetViewport(0, 0, currentViewportWidth, currentViewportHeight);
+	PBRViewerStateCache::SetCullFace(GL_BACK);
 }
 
 std::vector<PBRViewerTexture> PBRViewerShadows::CreateDepthTextures( const GLuint amountLightSources,
@@ -122,7 +134,7 @@ std::vector<PBRViewerTexture> PBRViewerShadows::CreateDepthTextures( const GLuin
 
 		PBRViewerTexture shadowTexture;
 		shadowTexture.ID = depthMap;
-		shadowTexture.Type = "textureShadows";
+		shadowTexture.Slot = PBRViewerEnumerations::TextureShadows;
 
 		shadowTextures.push_back(shadowTexture);
 	}
@@ -142,7 +154,7 @@ std::vector<GLuint> PBRViewerShadows::CreateShadowFrameBuffers( std::vector<PBRV
 	{
 		GLuint depthMapFBO;
 		glGenFramebuffers(1, &depthMapFBO);
-		glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+		PBRViewerStateCache::BindFramebuffer(depthMapFBO);
 
 		// Attach depth texture as FBO's depth buffer		
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowDepthCubeMap.ID, 0);
@@ -153,7 +165,7 @@ std::vector<GLuint> PBRViewerShadows::CreateShadowFrameBuffers( std::vector<PBRV
 	}
 
 	// Reset states	
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	PBRViewerStateCache::BindFramebuffer(0);
 
 	return shadowFBOs;
 }
@@ -174,6 +186,24 @@ GLvoid PBRViewerShadows::Cleanup()
 	}
 }
 
+/// <summary>
+/// Gets the number of meshes drawn into the shadow maps by the last <see cref="CalculateSelfShadowing"/> call, summed over all lights.
+/// </summary>
+/// <returns>The number of visible meshes.</returns>
+GLuint PBRViewerShadows::GetNumberOfVisibleMeshes() const
+{
+	return myNumberOfVisibleMeshes;
+}
+
+/// <summary>
+/// Gets the number of meshes tested against the light frustums by the last <see cref="CalculateSelfShadowing"/> call, summed over all lights.
+/// </summary>
+/// <returns>The number of tested meshes.</returns>
+GLuint PBRViewerShadows::GetNumberOfTestedMeshes() const
+{
+	return myNumberOfTestedMeshes;
+}
+
 /// <summary>
 /// Gets the width of a shadow texture.
 /// All textures share the same width.
@@ -48,6 +48,18 @@ public:
 	                               GLuint currentViewportHeight,
 	                               const std::vector<PBRViewerPointLight>& lightSources );
 
+	/// <summary>
+	/// Gets the number of meshes drawn into the shadow maps by the last <see cref="CalculateSelfShadowing"/> call, summed over all lights.
+	/// </summary>
+	/// <returns>The number of visible meshes.</returns>
+	GLuint GetNumberOfVisibleMeshes() const;
+
+	/// <summary>
+	/// Gets the number of meshes tested against the light frustums by the last <see cref="CalculateSelfShadowing"/> call, summed over all lights.
+	/// </summary>
+	/// <returns>The number of tested meshes.</returns>
+	GLuint GetNumberOfTestedMeshes() const;
+
 	/// <summary>
 	/// Gets the width of a shadow texture.
 	/// All textures share the same width.
@@ -112,6 +124,9 @@ private:
 	GLfloat myNearPlane = 0.0f;
 	GLfloat myFarPlane = 0.0f;
 
+	GLuint myNumberOfVisibleMeshes = 0u;
+	GLuint myNumberOfTestedMeshes = 0u;
+
 	std::vector<PBRViewerTexture> CreateDepthTextures( GLuint amountLightSources,
 	                                                   GLuint textureWidth,
 	                                                   GLuint textureHeight ) const;
@@ -3,6 +3,7 @@
 #include "PBRViewerObjectCreator.h"
 #include "PBRViewerOpenGLUtilities.h"
 #include "PBRViewerLogger.h"
+#include "PBRViewerStateCache.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -50,7 +51,7 @@ GLboolean PBRViewerSkybox::LoadEnvironmentTexture()
 	}
 
 	myEnvironmentTexture.Filepath = myFilepathEnvironmentTexture;
-	myEnvironmentTexture.Type = "textureEnvironment";
+	myEnvironmentTexture.Slot = PBRViewerEnumerations::TextureEnvironment;
 	ConvertEquirectangularTextureToCubemap(equirectangularTexture, myEnvironmentTexture);
 
 	// Create mipmap sampling for the environment map. This is needed for the specular reflections based on the roughness level of the surface.
@@ -115,7 +116,7 @@ GLboolean PBRViewerSkybox::LoadEquirectangularTexture( std::string& filepath, PB
 
 		texture.ID = hdrTexture;
 		texture.Filepath = filepath;
-		texture.Type = "textureEquirectangular";
+		texture.Slot = PBRViewerEnumerations::TextureEquirectangular;
 
 		textureResult = texture;
 
@@ -152,7 +153,7 @@ GLboolean PBRViewerSkybox::CreateIrradianceTexture()
 	glGenFramebuffers(1, &captureFBO);
 	glGenRenderbuffers(1, &captureRBO);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	PBRViewerStateCache::BindFramebuffer(captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
 
@@ -167,8 +168,8 @@ GLboolean PBRViewerSkybox::CreateIrradianceTexture()
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, myEnvironmentTexture.ID);
 
-	glViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	PBRViewerStateCache::SetViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
+	PBRViewerStateCache::BindFramebuffer(captureFBO);
 
 	std::vector<glm::mat4> captureViews = PBRViewerOpenGLUtilities::GetCaptureViewsForCubeMap();
 	for (GLuint i = 0; i < 6; ++i)
@@ -181,12 +182,12 @@ GLboolean PBRViewerSkybox::CreateIrradianceTexture()
 	}
 
 	// Reset variables
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	PBRViewerStateCache::BindFramebuffer(0);
 	glDeleteRenderbuffers(1, &captureRBO);
 	glDeleteFramebuffers(1, &captureFBO);
 
 	myIrradianceTexture.ID = irradianceMap;
-	myIrradianceTexture.Type = "textureIrradiance";
+	myIrradianceTexture.Slot = PBRViewerEnumerations::TextureIrradiance;
 
 	return GL_TRUE;
 }
@@ -219,23 +220,23 @@ GLboolean PBRViewerSkybox::CreateBRDFLookupTexture()
 	glGenFramebuffers(1, &captureFBO);
 	glGenRenderbuffers(1, &captureRBO);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	PBRViewerStateCache::BindFramebuffer(captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUTTexture, 0);
 
-	glViewport(0, 0, 512, 512);
+	PBRViewerStateCache::SetViewport(0, 0, 512, 512);
 	brdfLookupShader.Use();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	PBRViewerOpenGLUtilities::RenderFullScreenQuad();
 
 	// Reset variables
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	PBRViewerStateCache::BindFramebuffer(0);
 	glDeleteRenderbuffers(1, &captureRBO);
 	glDeleteFramebuffers(1, &captureFBO);
 
 	myBRDFLookupTexture.ID = brdfLUTTexture;
-	myBRDFLookupTexture.Type = "textureBRDFLookup";
+	myBRDFLookupTexture.Slot = PBRViewerEnumerations::TextureBRDFLookup;
 
 	return GL_TRUE;
 }
@@ -282,12 +283,12 @@ GLboolean PBRViewerSkybox::CreatePreFilteredEnvironmentMap()
 	glGenFramebuffers(1, &captureFBO);
 	glGenRenderbuffers(1, &captureRBO);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	PBRViewerStateCache::BindFramebuffer(captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	PBRViewerStateCache::BindFramebuffer(captureFBO);
 	const GLuint maxMipLevels = 5;
 	for (GLuint mip = 0u; mip < maxMipLevels; ++mip)
 	{
@@ -296,7 +297,7 @@ GLboolean PBRViewerSkybox::CreatePreFilteredEnvironmentMap()
 		const auto mipHeight = static_cast<GLuint>(textureHeight * std::pow(0.5, mip));
 		glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-		glViewport(0, 0, mipWidth, mipHeight);
+		PBRViewerStateCache::SetViewport(0, 0, mipWidth, mipHeight);
 
 		const GLfloat roughness = static_cast<GLfloat>(mip) / static_cast<GLfloat>(maxMipLevels - 1);
 		prefilterShader.setFloat("roughness", roughness);
@@ -313,13 +314,13 @@ GLboolean PBRViewerSkybox::CreatePreFilteredEnvironmentMap()
 	}
 
 	// Reset variables
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	PBRViewerStateCache::BindFramebuffer(0);
 	glDeleteRenderbuffers(1, &captureRBO);
 	glDeleteFramebuffers(1, &captureFBO);
 	glDisable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	myPreFilteredEnvironmentMap.ID = prefilterMap;
-	myPreFilteredEnvironmentMap.Type = "texturePreFilterEnvironment";
+	myPreFilteredEnvironmentMap.Slot = PBRViewerEnumerations::TexturePreFilterEnvironment;
 
 	return GL_TRUE;
 }
@@ -336,7 +337,7 @@ GLvoid PBRViewerSkybox::ConvertEquirectangularTextureToCubemap( PBRViewerTexture
 	glGenFramebuffers(1, &captureFBO);
 	glGenRenderbuffers(1, &captureRBO);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	PBRViewerStateCache::BindFramebuffer(captureFBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 2048, 2048);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
@@ -346,7 +347,7 @@ GLvoid PBRViewerSkybox::ConvertEquirectangularTextureToCubemap( PBRViewerTexture
 	glGenVertexArrays(1, &myVAO);
 	glGenBuffers(1, &skyboxVBO);
 
-	glBindVertexArray(myVAO);
+	PBRViewerStateCache::BindVertexArray(myVAO);
 	glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof vertices[0] * vertices.size(), vertices.data(), GL_STATIC_DRAW);
 
@@ -379,8 +380,8 @@ GLvoid PBRViewerSkybox::ConvertEquirectangularTextureToCubemap( PBRViewerTexture
 	myEquirectangularToCubemapShader->setInt("textureEquirectangular", 0);
 	myEquirectangularToCubemapShader->setMat4("projection", captureProjection);
 
-	glViewport(0, 0, 2048, 2048);
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	PBRViewerStateCache::SetViewport(0, 0, 2048, 2048);
+	PBRViewerStateCache::BindFramebuffer(captureFBO);
 	for (GLuint i = 0; i < 6; ++i)
 	{
 		myEquirectangularToCubemapShader->setMat4("view", captureViews[i]);
@@ -388,16 +389,16 @@ GLvoid PBRViewerSkybox::ConvertEquirectangularTextureToCubemap( PBRViewerTexture
 		                       cubemapTexture.ID, 0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glBindVertexArray(myVAO);
+		PBRViewerStateCache::BindVertexArray(myVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 36);
-		glBindVertexArray(0);
+		PBRViewerStateCache::BindVertexArray(0);
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	PBRViewerStateCache::BindFramebuffer(0);
 
 	// Reset states
 	GLint currentWindowWidth, currentWindowHeight;
 	glfwGetWindowSize(glfwGetCurrentContext(), &currentWindowWidth, &currentWindowHeight);
-	glViewport(0, 0, currentWindowWidth, currentWindowHeight);
+	PBRViewerStateCache::SetViewport(0, 0, currentWindowWidth, currentWindowHeight);
 
 	glDeleteRenderbuffers(1, &captureRBO);
 	glDeleteFramebuffers(1, &captureFBO);
@@ -410,10 +411,9 @@ GLvoid PBRViewerSkybox::ConvertEquirectangularTextureToCubemap( PBRViewerTexture
 GLvoid PBRViewerSkybox::Draw( std::shared_ptr<PBRViewerShader> const& shader ) const
 {
 	// change depth function so depth test passes when values are equal to depth buffer's content	
-	glDepthFunc(GL_LEQUAL);	
+	PBRViewerStateCache::SetDepthFunction(GL_LEQUAL);	
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, myTextureToDisplay);
+	PBRViewerStateCache::BindTexture(0u, GL_TEXTURE_CUBE_MAP, myTextureToDisplay);
 	shader->setInt("textureEnvironment", 0);
 
 	// Currently, only the prefilted environment texture has mip map levels.
@@ -429,14 +429,13 @@ GLvoid PBRViewerSkybox::Draw( std::shared_ptr<PBRViewerShader> const& shader ) c
 
 	RenderCube();
 
-	glDepthFunc(GL_LESS); // set depth function back to default	
+	PBRViewerStateCache::SetDepthFunction(GL_LESS); // set depth function back to default	
 }
 
 GLvoid PBRViewerSkybox::RenderCube() const
 {
-	glBindVertexArray(myVAO);
+	PBRViewerStateCache::BindVertexArray(myVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
-	glBindVertexArray(0);
 }
 
 glm::mat4 PBRViewerSkybox::GetCaptureProjection() const
@@ -0,0 +1,265 @@
+#include "PBRViewerStateCache.h"
+
+// Marks a tracked value as unknown, no valid name or enumeration has this value.
+static const GLuint UnknownState = 0xFFFFFFFFu;
+
+// OpenGL 3.3 guarantees 16 texture units for the fragment shader, which covers all texture slots.
+static const GLuint NumberOfTrackedUnits = 16u;
+
+// The state is part of the single OpenGL context, so it is shared by all callers.
+static GLuint myProgram = UnknownState;
+static GLuint myVertexArray = UnknownState;
+static GLuint myActiveUnit = UnknownState;
+static GLuint myTextures2D[NumberOfTrackedUnits];
+static GLuint myTexturesCubeMap[NumberOfTrackedUnits];
+static GLuint myFramebuffer = UnknownState;
+static GLint myViewport[4];
+static GLboolean myIsViewportKnown = GL_FALSE;
+static GLuint myDepthTest = UnknownState;
+static GLuint myCullFaceEnabled = UnknownState;
+static GLuint myBlend = UnknownState;
+static GLuint myDepthFunction = UnknownState;
+static GLuint myCullFace = UnknownState;
+
+static GLuint myNumberOfRequestedCalls = 0u;
+static GLuint myNumberOfFilteredCalls = 0u;
+
+// Starts with all states unknown. The bindings of the texture units have no constant initializer like the other states.
+static const GLboolean IsInvalidated = (PBRViewerStateCache::Invalidate(), GL_TRUE);
+
+/// <summary>
+/// Installs a program as part of the current rendering state.
+/// </summary>
+/// <param name="program">The program to use.</param>
+GLvoid PBRViewerStateCache::UseProgram( const GLuint program )
+{
+	if (GL_FALSE == IsRedundant(myProgram, program))
+	{
+		glUseProgram(program);
+	}
+}
+
+/// <summary>
+/// Binds a vertex array. The vertex array stays bound until another one is bound, so users do not need to unbind it after drawing.
+/// </summary>
+/// <param name="vertexArray">The vertex array to bind.</param>
+GLvoid PBRViewerStateCache::BindVertexArray( const GLuint vertexArray )
+{
+	if (GL_FALSE == IsRedundant(myVertexArray, vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+	}
+}
+
+/// <summary>
+/// Binds a texture to a texture unit. The active texture unit is only changed if the binding of the unit changes.
+/// </summary>
+/// <param name="unit">The number of the texture unit, starting at 0.</param>
+/// <param name="target">The target of the texture, i. e. GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.</param>
+/// <param name="texture">The texture to bind.</param>
+GLvoid PBRViewerStateCache::BindTexture( const GLuint unit, const GLenum target, const GLuint texture )
+{
+	GLuint* trackedTexture = nullptr;
+	if (unit < NumberOfTrackedUnits)
+	{
+		if (GL_TEXTURE_2D == target)
+		{
+			trackedTexture = &myTextures2D[unit];
+		}
+		else if (GL_TEXTURE_CUBE_MAP == target)
+		{
+			trackedTexture = &myTexturesCubeMap[unit];
+		}
+	}
+
+	// Without the cache, each binding needs to select the unit first.
+	myNumberOfRequestedCalls++;
+	if (nullptr != trackedTexture && *trackedTexture == texture)
+	{
+		myNumberOfRequestedCalls++;
+		myNumberOfFilteredCalls += 2u;
+		return;
+	}
+
+	if (GL_FALSE == IsRedundant(myActiveUnit, unit))
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+
+	glBindTexture(target, texture);
+
+	if (nullptr != trackedTexture)
+	{
+		*trackedTexture = texture;
+	}
+}
+
+/// <summary>
+/// Binds a framebuffer for reading and drawing.
+/// </summary>
+/// <param name="framebuffer">The framebuffer to bind, 0 for the default framebuffer.</param>
+GLvoid PBRViewerStateCache::BindFramebuffer( const GLuint framebuffer )
+{
+	if (GL_FALSE == IsRedundant(myFramebuffer, framebuffer))
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	}
+}
+
+/// <summary>
+/// Sets the viewport.
+/// </summary>
+/// <param name="x">The left corner of the viewport.</param>
+/// <param name="y">The lower corner of the viewport.</param>
+/// <param name="width">The width of the viewport.</param>
+/// <param name="height">The height of the viewport.</param>
+GLvoid PBRViewerStateCache::SetViewport( const GLint x, const GLint y, const GLsizei width, const GLsizei height )
+{
+	myNumberOfRequestedCalls++;
+	if (myIsViewportKnown && x == myViewport[0] && y == myViewport[1] && width == myViewport[2] && height == myViewport[3])
+	{
+		myNumberOfFilteredCalls++;
+		return;
+	}
+
+	glViewport(x, y, width, height);
+
+	myViewport[0] = x;
+	myViewport[1] = y;
+	myViewport[2] = width;
+	myViewport[3] = height;
+	myIsViewportKnown = GL_TRUE;
+}
+
+/// <summary>
+/// Enables or disables a capability. GL_DEPTH_TEST, GL_CULL_FACE and GL_BLEND are tracked, other capabilities are always passed to OpenGL.
+/// </summary>
+/// <param name="capability">The capability to change.</param>
+/// <param name="enabled">True to enable the capability, false to disable it.</param>
+GLvoid PBRViewerStateCache::SetCapability( const GLenum capability, const GLboolean enabled )
+{
+	GLuint untrackedCapability = UnknownState;
+	GLuint* trackedCapability = &untrackedCapability;
+	switch (capability)
+	{
+		case GL_DEPTH_TEST:
+			trackedCapability = &myDepthTest;
+			break;
+		case GL_CULL_FACE:
+			trackedCapability = &myCullFaceEnabled;
+			break;
+		case GL_BLEND:
+			trackedCapability = &myBlend;
+			break;
+		default:
+			break;
+	}
+
+	if (GL_TRUE == IsRedundant(*trackedCapability, enabled))
+	{
+		return;
+	}
+
+	if (GL_FALSE == enabled)
+	{
+		glDisable(capability);
+	}
+	else
+	{
+		glEnable(capability);
+	}
+}
+
+/// <summary>
+/// Sets the function comparing the depth of a fragment with the depth buffer.
+/// </summary>
+/// <param name="function">The depth function, e. g. GL_LESS.</param>
+GLvoid PBRViewerStateCache::SetDepthFunction( const GLenum function )
+{
+	if (GL_FALSE == IsRedundant(myDepthFunction, function))
+	{
+		glDepthFunc(function);
+	}
+}
+
+/// <summary>
+/// Sets the faces which are culled.
+/// </summary>
+/// <param name="mode">The culled faces, e. g. GL_BACK.</param>
+GLvoid PBRViewerStateCache::SetCullFace( const GLenum mode )
+{
+	if (GL_FALSE == IsRedundant(myCullFace, mode))
+	{
+		glCullFace(mode);
+	}
+}
+
+/// <summary>
+/// Forgets the tracked state, so the next call of each kind is passed to OpenGL.
+/// Call this method after the state has been changed without this class, e. g. by NanoVG or while creating resources.
+/// </summary>
+GLvoid PBRViewerStateCache::Invalidate()
+{
+	myProgram = UnknownState;
+	myVertexArray = UnknownState;
+	myActiveUnit = UnknownState;
+	for (GLuint unit = 0u; unit < NumberOfTrackedUnits; unit++)
+	{
+		myTextures2D[unit] = UnknownState;
+		myTexturesCubeMap[unit] = UnknownState;
+	}
+
+	myFramebuffer = UnknownState;
+	myIsViewportKnown = GL_FALSE;
+	myDepthTest = UnknownState;
+	myCullFaceEnabled = UnknownState;
+	myBlend = UnknownState;
+	myDepthFunction = UnknownState;
+	myCullFace = UnknownState;
+}
+
+/// <summary>
+/// Resets the numbers of the requested and the filtered calls. Call this method at the beginning of each frame.
+/// </summary>
+GLvoid PBRViewerStateCache::ResetStatistics()
+{
+	myNumberOfRequestedCalls = 0u;
+	myNumberOfFilteredCalls = 0u;
+}
+
+/// <summary>
+/// Gets the number of calls made to this class since the statistics have been reset.
+/// </summary>
+/// <returns>The number of requested calls.</returns>
+GLuint PBRViewerStateCache::GetNumberOfRequestedCalls()
+{
+	return myNumberOfRequestedCalls;
+}
+
+/// <summary>
+/// Gets the number of OpenGL calls which have not been made since the statistics have been reset, since they would not have changed the state.
+/// </summary>
+/// <returns>The number of filtered calls.</returns>
+GLuint PBRViewerStateCache::GetNumberOfFilteredCalls()
+{
+	return myNumberOfFilteredCalls;
+}
+
+/// <summary>
+/// Compares a tracked value with the requested one and tracks the requested value.
+/// </summary>
+/// <param name="trackedValue">The tracked value, which is set to the requested value.</param>
+/// <param name="value">The requested value.</param>
+/// <returns>True if the call is redundant and has been counted as filtered, false if it has to be passed to OpenGL.</returns>
+GLboolean PBRViewerStateCache::IsRedundant( GLuint& trackedValue, const GLuint value )
+{
+	myNumberOfRequestedCalls++;
+	if (trackedValue == value)
+	{
+		myNumberOfFilteredCalls++;
+		return GL_TRUE;
+	}
+
+	trackedValue = value;
+	return GL_FALSE;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/// <summary>
+/// This class mirrors the parts of the OpenGL state which are changed while drawing a frame, i. e. the program, the vertex array,
+/// the textures bound to the units, the framebuffer, the viewport and the depth and cull state.
+/// A call which would set the state to its current value is not passed to OpenGL. The filtered calls are counted to show the saved driver overhead.
+/// Code changing the tracked state without this class, like NanoVG, has to call <see cref="Invalidate"/> afterwards.
+/// </summary>
+class PBRViewerStateCache
+{
+public:
+	/// <summary>
+	/// Installs a program as part of the current rendering state.
+	/// </summary>
+	/// <param name="program">The program to use.</param>
+	static GLvoid UseProgram( GLuint program );
+
+	/// <summary>
+	/// Binds a vertex array. The vertex array stays bound until another one is bound, so users do not need to unbind it after drawing.
+	/// </summary>
+	/// <param name="vertexArray">The vertex array to bind.</param>
+	static GLvoid BindVertexArray( GLuint vertexArray );
+
+	/// <summary>
+	/// Binds a texture to a texture unit. The active texture unit is only changed if the binding of the unit changes.
+	/// </summary>
+	/// <param name="unit">The number of the texture unit, starting at 0.</param>
+	/// <param name="target">The target of the texture, i. e. GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.</param>
+	/// <param name="texture">The texture to bind.</param>
+	static GLvoid BindTexture( GLuint unit, GLenum target, GLuint texture );
+
+	/// <summary>
+	/// Binds a framebuffer for reading and drawing.
+	/// </summary>
+	/// <param name="framebuffer">The framebuffer to bind, 0 for the default framebuffer.</param>
+	static GLvoid BindFramebuffer( GLuint framebuffer );
+
+	/// <summary>
+	/// Sets the viewport.
+	/// </summary>
+	/// <param name="x">The left corner of the viewport.</param>
+	/// <param name="y">The lower corner of the viewport.</param>
+	/// <param name="width">The width of the viewport.</param>
+	/// <param name="height">The height of the viewport.</param>
+	static GLvoid SetViewport( GLint x, GLint y, GLsizei width, GLsizei height );
+
+	/// <summary>
+	/// Enables or disables a capability. GL_DEPTH_TEST, GL_CULL_FACE and GL_BLEND are tracked, other capabilities are always passed to OpenGL.
+	/// </summary>
+	/// <param name="capability">The capability to change.</param>
+	/// <param name="enabled">True to enable the capability, false to disable it.</param>
+	static GLvoid SetCapability( GLenum capability, GLboolean enabled );
+
+	/// <summary>
+	/// Sets the function comparing the depth of a fragment with the depth buffer.
+	/// </summary>
+	/// <param name="function">The depth function, e. g. GL_LESS.</param>
+	static GLvoid SetDepthFunction( GLenum function );
+
+	/// <summary>
+	/// Sets the faces which are culled.
+	/// </summary>
+	/// <param name="mode">The culled faces, e. g. GL_BACK.</param>
+	static GLvoid SetCullFace( GLenum mode );
+
+	/// <summary>
+	/// Forgets the tracked state, so the next call of each kind is passed to OpenGL.
+	/// Call this method after the state has been changed without this class, e. g. by NanoVG or while creating resources.
+	/// </summary>
+	static GLvoid Invalidate();
+
+	/// <summary>
+	/// Resets the numbers of the requested and the filtered calls. Call this method at the beginning of each frame.
+	/// </summary>
+	static GLvoid ResetStatistics();
+
+	/// <summary>
+	/// Gets the number of calls made to this class since the statistics have been reset.
+	/// </summary>
+	/// <returns>The number of requested calls.</returns>
+	static GLuint GetNumberOfRequestedCalls();
+
+	/// <summary>
+	/// Gets the number of OpenGL calls which have not been made since the statistics have been reset, since they would not have changed the state.
+	/// </summary>
+	/// <returns>The number of filtered calls.</returns>
+	static GLuint GetNumberOfFilteredCalls();
+
+private:
+	static GLboolean IsRedundant( GLuint& trackedValue, GLuint value );
+};
@@ -0,0 +1,100 @@
+#include "PBRViewerTangentSpace.h"
+
+#include <glm/geometric.hpp>
+
+#include <cmath>
+#include <limits>
+
+/// <summary>
+/// Calculates smooth vertex normals by accumulating the area-weighted normals of the adjacent triangles.
+/// </summary>
+/// <param name="positions">The positions of the vertices.</param>
+/// <param name="indices">The triangle list.</param>
+/// <returns>The normal of each vertex.</returns>
+std::vector<glm::vec3> PBRViewerTangentSpace::GenerateNormals( std::vector<glm::vec3> const& positions, std::vector<GLuint> const& indices )
+{
+	std::vector<glm::vec3> normals(positions.size(), glm::vec3(0.0f));
+
+	// The length of the cross product is twice the area of the triangle, so larger triangles weigh more.
+	for (size_t i = 0; i + 2u < indices.size(); i += 3u)
+	{
+		const glm::vec3& p0 = positions[indices[i]];
+		const glm::vec3 faceNormal = glm::cross(positions[indices[i + 1u]] - p0, positions[indices[i + 2u]] - p0);
+
+		normals[indices[i]] += faceNormal;
+		normals[indices[i + 1u]] += faceNormal;
+		normals[indices[i + 2u]] += faceNormal;
+	}
+
+	for (glm::vec3& normal : normals)
+	{
+		const GLfloat length = glm::length(normal);
+		normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+
+	return normals;
+}
+
+/// <summary>
+/// Calculates the tangents from the texture coordinates of the adjacent triangles. The w component holds the handedness,
+/// so the bitangent is the cross product of the normal and the tangent multiplied by w, as defined by glTF.
+/// </summary>
+/// <param name="positions">The positions of the vertices.</param>
+/// <param name="normals">The normals of the vertices.</param>
+/// <param name="textureCoordinates">The texture coordinates of the vertices.</param>
+/// <param name="indices">The triangle list.</param>
+/// <returns>The tangent of each vertex.</returns>
+std::vector<glm::vec4> PBRViewerTangentSpace::GenerateTangents( std::vector<glm::vec3> const& positions, std::vector<glm::vec3> const& normals,
+                                                                std::vector<glm::vec2> const& textureCoordinates, std::vector<GLuint> const& indices )
+{
+	std::vector<glm::vec3> tangents(positions.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> bitangents(positions.size(), glm::vec3(0.0f));
+
+	for (size_t i = 0; i + 2u < indices.size(); i += 3u)
+	{
+		const GLuint i0 = indices[i];
+		const GLuint i1 = indices[i + 1u];
+		const GLuint i2 = indices[i + 2u];
+
+		const glm::vec3 edge1 = positions[i1] - positions[i0];
+		const glm::vec3 edge2 = positions[i2] - positions[i0];
+		const glm::vec2 deltaUV1 = textureCoordinates[i1] - textureCoordinates[i0];
+		const glm::vec2 deltaUV2 = textureCoordinates[i2] - textureCoordinates[i0];
+
+		// Triangles without an extent in texture space do not define a direction.
+		const GLfloat determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+		if (std::abs(determinant) < std::numeric_limits<GLfloat>::epsilon())
+		{
+			continue;
+		}
+
+		const glm::vec3 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) / determinant;
+		const glm::vec3 bitangent = (edge2 * deltaUV1.x - edge1 * deltaUV2.x) / determinant;
+
+		tangents[i0] += tangent;
+		tangents[i1] += tangent;
+		tangents[i2] += tangent;
+		bitangents[i0] += bitangent;
+		bitangents[i1] += bitangent;
+		bitangents[i2] += bitangent;
+	}
+
+	// Orthogonalize each tangent against the normal (Gram-Schmidt). Vertices without a direction get any perpendicular one.
+	std::vector<glm::vec4> result(positions.size());
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		const glm::vec3& normal = normals[i];
+		glm::vec3 tangent = tangents[i] - normal * glm::dot(normal, tangents[i]);
+
+		if (glm::length(tangent) <= 0.0f)
+		{
+			tangent = std::abs(normal.x) < 0.9f ? glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+
+		tangent = glm::normalize(tangent);
+		const GLfloat handedness = glm::dot(glm::cross(normal, tangent), bitangents[i]) < 0.0f ? -1.0f : 1.0f;
+		result[i] = glm::vec4(tangent, handedness);
+	}
+
+	return result;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <vector>
+
+/// <summary>
+/// This class generates the vertex normals and tangents of meshes whose files do not provide them, e. g. for the native loaders.
+/// The methods do not need an OpenGL context, so they run on the import workers.
+/// </summary>
+class PBRViewerTangentSpace
+{
+public:
+	/// <summary>
+	/// Calculates smooth vertex normals by accumulating the area-weighted normals of the adjacent triangles.
+	/// </summary>
+	/// <param name="positions">The positions of the vertices.</param>
+	/// <param name="indices">The triangle list.</param>
+	/// <returns>The normal of each vertex.</returns>
+	static std::vector<glm::vec3> GenerateNormals( std::vector<glm::vec3> const& positions, std::vector<GLuint> const& indices );
+
+	/// <summary>
+	/// Calculates the tangents from the texture coordinates of the adjacent triangles. The w component holds the handedness,
+	/// so the bitangent is the cross product of the normal and the tangent multiplied by w, as defined by glTF.
+	/// </summary>
+	/// <param name="positions">The positions of the vertices.</param>
+	/// <param name="normals">The normals of the vertices.</param>
+	/// <param name="textureCoordinates">The texture coordinates of the vertices.</param>
+	/// <param name="indices">The triangle list.</param>
+	/// <returns>The tangent of each vertex.</returns>
+	static std::vector<glm::vec4> GenerateTangents( std::vector<glm::vec3> const& positions, std::vector<glm::vec3> const& normals,
+	                                                std::vector<glm::vec2> const& textureCoordinates, std::vector<GLuint> const& indices );
+};
@@ -2,6 +2,8 @@
 
 #include <glad/glad.h>
 
+#include "PBRViewerEnumerations.h"
+
 #include <string>
 
 /// <summary>
@@ -15,9 +17,9 @@ struct PBRViewerTexture
 	GLuint ID;
 	
 	/// <summary>
-	/// The type of the texture. E. g. 'textureDiffuse', 'textureEmissive', ...
+	/// The slot the texture is bound to, e. g. the diffuse or the emissive map.
 	/// </summary>
-	std::string Type;
+	PBRViewerEnumerations::TextureSlot Slot;
 	
 	/// <summary>
 	/// The filepath of the texture.
@@ -30,10 +32,44 @@ struct PBRViewerTexture
 	PBRViewerTexture()
 	{
 		ID = 0u;
-		Type = "";
+		Slot = PBRViewerEnumerations::TextureDiffuse;
 		Filepath = "";
 	}	
 	
+	/// <summary>
+	/// Gets the name of a texture slot, which is the name of its sampler within the lighting shaders.
+	/// </summary>
+	/// <param name="slot">The texture slot.</param>
+	/// <returns>The name of the slot, e. g. 'textureDiffuse'.</returns>
+	static const GLchar* GetSlotName( const PBRViewerEnumerations::TextureSlot slot )
+	{
+		switch (slot)
+		{
+			case PBRViewerEnumerations::TextureDiffuse:
+				return "textureDiffuse";
+			case PBRViewerEnumerations::TextureNormal:
+				return "textureNormal";
+			case PBRViewerEnumerations::TextureRoughness:
+				return "textureRoughness";
+			case PBRViewerEnumerations::TextureEmissive:
+				return "textureEmissive";
+			case PBRViewerEnumerations::TextureIrradiance:
+				return "textureIrradiance";
+			case PBRViewerEnumerations::TexturePreFilterEnvironment:
+				return "texturePreFilterEnvironment";
+			case PBRViewerEnumerations::TextureBRDFLookup:
+				return "textureBRDFLookup";
+			case PBRViewerEnumerations::TextureEnvironment:
+				return "textureEnvironment";
+			case PBRViewerEnumerations::TextureEquirectangular:
+				return "textureEquirectangular";
+			case PBRViewerEnumerations::TextureShadows:
+				return "textureShadows";
+			default:
+				return "";
+		}
+	}
+
 	GLboolean operator==(const PBRViewerTexture& other) const
 	{
 		return ID == other.ID;
@@ -0,0 +1,181 @@
+#include "PBRViewerTextureCache.h"
+
+#include <experimental/filesystem>
+#include <sstream>
+
+/// <summary>
+/// Gets the texture cache shared by the whole application.
+/// </summary>
+/// <returns>The shared texture cache.</returns>
+PBRViewerTextureCache& PBRViewerTextureCache::GetInstance()
+{
+	static PBRViewerTextureCache instance;
+	return instance;
+}
+
+/// <summary>
+/// Gets the cache key of a texture file. This method does not need an OpenGL context.
+/// </summary>
+/// <param name="filepath">The filepath of the texture.</param>
+/// <returns>The cache key or an empty string if the file does not exist.</returns>
+std::string PBRViewerTextureCache::GetKey( std::string const& filepath )
+{
+	std::error_code errorCode;
+
+	const auto absolutePath = std::experimental::filesystem::canonical(filepath, errorCode);
+	if (errorCode)
+	{
+		return "";
+	}
+
+	const auto lastWriteTime = std::experimental::filesystem::last_write_time(absolutePath, errorCode);
+	if (errorCode)
+	{
+		return "";
+	}
+
+	const auto fileSize = std::experimental::filesystem::file_size(absolutePath, errorCode);
+	if (errorCode)
+	{
+		return "";
+	}
+
+	std::stringstream key;
+	key << absolutePath.string() << '|' << lastWriteTime.time_since_epoch().count() << '|' << fileSize;
+	return key.str();
+}
+
+/// <summary>
+/// Checks if a texture is resident. This method can be called from any thread.
+/// </summary>
+/// <param name="key">The cache key of the texture.</param>
+/// <returns>True if the texture is resident, false if not.</returns>
+GLboolean PBRViewerTextureCache::Contains( std::string const& key )
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+	return myEntries.find(key) != myEntries.end();
+}
+
+/// <summary>
+/// Acquires a reference to a resident texture.
+/// </summary>
+/// <param name="key">The cache key of the texture.</param>
+/// <param name="textureId">The identifier of the texture if it is resident.</param>
+/// <returns>True if the texture is resident, false if it has to be uploaded.</returns>
+GLboolean PBRViewerTextureCache::Acquire( std::string const& key, GLuint& textureId )
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+
+	const auto entry = myEntries.find(key);
+	if (entry == myEntries.end())
+	{
+		return GL_FALSE;
+	}
+
+	if (0u == entry->second.ReferenceCount)
+	{
+		myUnusedKeys.erase(entry->second.UnusedPosition);
+	}
+
+	entry->second.ReferenceCount++;
+	textureId = entry->second.ID;
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Adds an uploaded texture to the cache. The caller holds the first reference.
+/// </summary>
+/// <param name="key">The cache key of the texture.</param>
+/// <param name="textureId">The identifier of the texture.</param>
+/// <param name="size">The size of the texture in bytes.</param>
+GLvoid PBRViewerTextureCache::Add( std::string const& key, const GLuint textureId, const size_t size )
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+
+	Entry entry;
+	entry.ID = textureId;
+	entry.Size = size;
+	entry.ReferenceCount = 1u;
+
+	if (myEntries.emplace(key, entry).second)
+	{
+		myKeys[textureId] = key;
+		mySize += size;
+		Evict();
+	}
+}
+
+/// <summary>
+/// Releases a reference to a texture. Unreferenced textures are deleted as soon as the byte budget is exceeded.
+/// </summary>
+/// <param name="textureId">The identifier of the texture.</param>
+/// <returns>True if the texture is managed by the cache, false if the caller has to delete it.</returns>
+GLboolean PBRViewerTextureCache::Release( const GLuint textureId )
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+
+	const auto key = myKeys.find(textureId);
+	if (key == myKeys.end())
+	{
+		return GL_FALSE;
+	}
+
+	Entry& entry = myEntries[key->second];
+	if (entry.ReferenceCount > 0u && 0u == --entry.ReferenceCount)
+	{
+		myUnusedKeys.push_front(key->second);
+		entry.UnusedPosition = myUnusedKeys.begin();
+		Evict();
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Sets the maximum number of bytes used by all resident textures.
+/// Referenced textures are never deleted, so only unreferenced textures are evicted to meet the budget.
+/// </summary>
+/// <param name="budget">The budget in bytes.</param>
+GLvoid PBRViewerTextureCache::SetBudget( const size_t budget )
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+
+	myBudget = budget;
+	Evict();
+}
+
+/// <summary>
+/// Deletes all textures. Call this method before the OpenGL context is destroyed.
+/// </summary>
+GLvoid PBRViewerTextureCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(myMutex);
+
+	for (auto& entry : myEntries)
+	{
+		glDeleteTextures(1, &entry.second.ID);
+	}
+
+	myEntries.clear();
+	myKeys.clear();
+	myUnusedKeys.clear();
+	mySize = 0u;
+}
+
+/// <summary>
+/// Deletes the least recently used unreferenced textures until the budget is met.
+/// </summary>
+GLvoid PBRViewerTextureCache::Evict()
+{
+	while (mySize > myBudget && !myUnusedKeys.empty())
+	{
+		const auto entry = myEntries.find(myUnusedKeys.back());
+
+		glDeleteTextures(1, &entry->second.ID);
+		mySize -= entry->second.Size;
+
+		myKeys.erase(entry->second.ID);
+		myEntries.erase(entry);
+		myUnusedKeys.pop_back();
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// <summary>
+/// This class represents the process-wide cache of uploaded material textures.
+/// Textures are keyed by their filepath, modification time and size and are shared by all scenes.
+/// Each scene holds a reference to the textures it uses. Textures which are no longer referenced stay resident
+/// until the least recently used ones exceed the byte budget, so switching back to a recently viewed model is cheap.
+/// </summary>
+class PBRViewerTextureCache
+{
+public:
+	/// <summary>
+	/// Gets the texture cache shared by the whole application.
+	/// </summary>
+	/// <returns>The shared texture cache.</returns>
+	static PBRViewerTextureCache& GetInstance();
+
+	/// <summary>
+	/// Gets the cache key of a texture file. This method does not need an OpenGL context.
+	/// </summary>
+	/// <param name="filepath">The filepath of the texture.</param>
+	/// <returns>The cache key or an empty string if the file does not exist.</returns>
+	static std::string GetKey( std::string const& filepath );
+
+	/// <summary>
+	/// Checks if a texture is resident. This method can be called from any thread.
+	/// </summary>
+	/// <param name="key">The cache key of the texture.</param>
+	/// <returns>True if the texture is resident, false if not.</returns>
+	GLboolean Contains( std::string const& key );
+
+	/// <summary>
+	/// Acquires a reference to a resident texture.
+	/// </summary>
+	/// <param name="key">The cache key of the texture.</param>
+	/// <param name="textureId">The identifier of the texture if it is resident.</param>
+	/// <returns>True if the texture is resident, false if it has to be uploaded.</returns>
+	GLboolean Acquire( std::string const& key, GLuint& textureId );
+
+	/// <summary>
+	/// Adds an uploaded texture to the cache. The caller holds the first reference.
+	/// </summary>
+	/// <param name="key">The cache key of the texture.</param>
+	/// <param name="textureId">The identifier of the texture.</param>
+	/// <param name="size">The size of the texture in bytes.</param>
+	GLvoid Add( std::string const& key, GLuint textureId, size_t size );
+
+	/// <summary>
+	/// Releases a reference to a texture. Unreferenced textures are deleted as soon as the byte budget is exceeded.
+	/// </summary>
+	/// <param name="textureId">The identifier of the texture.</param>
+	/// <returns>True if the texture is managed by the cache, false if the caller has to delete it.</returns>
+	GLboolean Release( GLuint textureId );
+
+	/// <summary>
+	/// Sets the maximum number of bytes used by all resident textures.
+	/// Referenced textures are never deleted, so only unreferenced textures are evicted to meet the budget.
+	/// </summary>
+	/// <param name="budget">The budget in bytes.</param>
+	GLvoid SetBudget( size_t budget );
+
+	/// <summary>
+	/// Deletes all textures. Call this method before the OpenGL context is destroyed.
+	/// </summary>
+	GLvoid Clear();
+
+private:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerTextureCache"/> class.
+	/// </summary>
+	PBRViewerTextureCache() = default;
+
+	struct Entry
+	{
+		GLuint ID = 0u;
+		size_t Size = 0u;
+		GLuint ReferenceCount = 0u;
+		std::list<std::string>::iterator UnusedPosition;
+	};
+
+	std::mutex myMutex;
+	std::unordered_map<std::string, Entry> myEntries;
+	std::unordered_map<GLuint, std::string> myKeys;
+
+	// Keys of unreferenced textures, the least recently used one at the end.
+	std::list<std::string> myUnusedKeys;
+
+	size_t myBudget = 512u * 1024u * 1024u;
+	size_t mySize = 0u;
+
+	/// <summary>
+	/// Deletes the least recently used unreferenced textures until the budget is met.
+	/// </summary>
+	GLvoid Evict();
+};
@@ -0,0 +1,456 @@
+#include "PBRViewerTextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// The interpolation weights of 4-bit BC7 indices (in 64ths).
+static const GLint BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/// <summary>
+/// Writes the lowest bits of a value into a little-endian bit stream.
+/// </summary>
+/// <param name="output">The bit stream. It has to be zero-initialized.</param>
+/// <param name="position">The position of the next bit, advanced by the number of written bits.</param>
+/// <param name="value">The value to write.</param>
+/// <param name="count">The number of bits to write.</param>
+static GLvoid WriteBits( GLubyte* output, GLuint& position, const GLuint value, const GLuint count )
+{
+	for (GLuint i = 0; i < count; i++, position++)
+	{
+		if ((value >> i) & 1u)
+		{
+			output[position / 8u] |= static_cast<GLubyte>(1u << (position % 8u));
+		}
+	}
+}
+
+/// <summary>
+/// Quantizes a BC7 mode 6 endpoint to 7 bits per channel plus a shared p-bit.
+/// </summary>
+/// <param name="endpoint">The unquantized endpoint.</param>
+/// <param name="quantized">The quantized 7-bit channels.</param>
+/// <param name="pBit">The p-bit giving the lowest error.</param>
+static GLvoid QuantizeBC7Endpoint( const GLfloat endpoint[4], GLint quantized[4], GLint& pBit )
+{
+	GLfloat bestError = -1.0f;
+	for (GLint p = 0; p < 2; p++)
+	{
+		// Opaque alpha can only be represented with the p-bit set.
+		if (endpoint[3] >= 255.0f && 0 == p)
+		{
+			continue;
+		}
+
+		GLint candidate[4];
+		GLfloat error = 0.0f;
+		for (GLint c = 0; c < 4; c++)
+		{
+			candidate[c] = std::min(std::max(static_cast<GLint>(std::lround((endpoint[c] - static_cast<GLfloat>(p)) * 0.5f)), 0), 127);
+
+			const GLfloat difference = static_cast<GLfloat>((candidate[c] << 1) | p) - endpoint[c];
+			error += difference * difference;
+		}
+
+		if (bestError < 0.0f || error < bestError)
+		{
+			bestError = error;
+			pBit = p;
+			std::memcpy(quantized, candidate, sizeof candidate);
+		}
+	}
+}
+
+/// <summary>
+/// Encodes an image into BC7 (mode 6: one subset with 4-bit indices and RGBA endpoints).
+/// </summary>
+/// <param name="pixels">The pixels of the image, row by row.</param>
+/// <param name="width">The width of the image.</param>
+/// <param name="height">The height of the image.</param>
+/// <param name="components">The number of 8-bit components per pixel (1 to 4).</param>
+/// <returns>The encoded blocks, row by row.</returns>
+std::vector<GLubyte> PBRViewerTextureCompressor::CompressBC7( const GLubyte* pixels, const GLint width, const GLint height, const GLint components )
+{
+	std::vector<GLubyte> blocks(GetCompressedSize(GL_COMPRESSED_RGBA_BPTC_UNORM, width, height));
+
+	GLubyte* output = blocks.data();
+	for (GLint blockY = 0; blockY < height; blockY += BlockDimension)
+	{
+		for (GLint blockX = 0; blockX < width; blockX += BlockDimension, output += 16)
+		{
+			GLubyte block[16][4];
+			FetchBlock(pixels, width, height, components, blockX, blockY, block);
+			EncodeBC7Block(block, output);
+		}
+	}
+
+	return blocks;
+}
+
+/// <summary>
+/// Encodes the first two components of an image into BC5.
+/// </summary>
+/// <param name="pixels">The pixels of the image, row by row.</param>
+/// <param name="width">The width of the image.</param>
+/// <param name="height">The height of the image.</param>
+/// <param name="components">The number of 8-bit components per pixel (1 to 4).</param>
+/// <returns>The encoded blocks, row by row.</returns>
+std::vector<GLubyte> PBRViewerTextureCompressor::CompressBC5( const GLubyte* pixels, const GLint width, const GLint height, const GLint components )
+{
+	std::vector<GLubyte> blocks(GetCompressedSize(GL_COMPRESSED_RG_RGTC2, width, height));
+
+	GLubyte* output = blocks.data();
+	for (GLint blockY = 0; blockY < height; blockY += BlockDimension)
+	{
+		for (GLint blockX = 0; blockX < width; blockX += BlockDimension, output += 16)
+		{
+			GLubyte block[16][4];
+			FetchBlock(pixels, width, height, components, blockX, blockY, block);
+			EncodeBC4Block(block, 0, output);
+			EncodeBC4Block(block, 1, output + 8);
+		}
+	}
+
+	return blocks;
+}
+
+/// <summary>
+/// Encodes the first component of an image into BC4.
+/// </summary>
+/// <param name="pixels">The pixels of the image, row by row.</param>
+/// <param name="width">The width of the image.</param>
+/// <param name="height">The height of the image.</param>
+/// <param name="components">The number of 8-bit components per pixel (1 to 4).</param>
+/// <returns>The encoded blocks, row by row.</returns>
+std::vector<GLubyte> PBRViewerTextureCompressor::CompressBC4( const GLubyte* pixels, const GLint width, const GLint height, const GLint components )
+{
+	std::vector<GLubyte> blocks(GetCompressedSize(GL_COMPRESSED_RED_RGTC1, width, height));
+
+	GLubyte* output = blocks.data();
+	for (GLint blockY = 0; blockY < height; blockY += BlockDimension)
+	{
+		for (GLint blockX = 0; blockX < width; blockX += BlockDimension, output += 8)
+		{
+			GLubyte block[16][4];
+			FetchBlock(pixels, width, height, components, blockX, blockY, block);
+			EncodeBC4Block(block, 0, output);
+		}
+	}
+
+	return blocks;
+}
+
+/// <summary>
+/// Gets the size of an image in a block-compressed format.
+/// </summary>
+/// <param name="format">The compressed OpenGL format.</param>
+/// <param name="width">The width of the image.</param>
+/// <param name="height">The height of the image.</param>
+/// <returns>The size in bytes or zero if the format is not supported.</returns>
+size_t PBRViewerTextureCompressor::GetCompressedSize( const GLenum format, const GLint width, const GLint height )
+{
+	const size_t numberOfBlocks = static_cast<size_t>((width + BlockDimension - 1) / BlockDimension) *
+	                              static_cast<size_t>((height + BlockDimension - 1) / BlockDimension);
+
+	switch (format)
+	{
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_RG_RGTC2:
+		return numberOfBlocks * 16u;
+	case GL_COMPRESSED_RED_RGTC1:
+		return numberOfBlocks * 8u;
+	default:
+		return 0u;
+	}
+}
+
+/// <summary>
+/// Copies a 4x4 block of an image into RGBA pixels. Pixels outside the image repeat the last row and column.
+/// Missing components are filled like OpenGL does when sampling the image (zero for green and blue, opaque alpha).
+/// </summary>
+GLvoid PBRViewerTextureCompressor::FetchBlock( const GLubyte* pixels, const GLint width, const GLint height, const GLint components,
+                                               const GLint blockX, const GLint blockY, GLubyte block[16][4] )
+{
+	for (GLint y = 0; y < BlockDimension; y++)
+	{
+		const GLint sourceY = std::min(blockY + y, height - 1);
+		for (GLint x = 0; x < BlockDimension; x++)
+		{
+			const GLint sourceX = std::min(blockX + x, width - 1);
+			const GLubyte* source = pixels + (static_cast<size_t>(sourceY) * static_cast<size_t>(width) + static_cast<size_t>(sourceX)) * static_cast<size_t>(components);
+
+			GLubyte* target = block[y * BlockDimension + x];
+			target[0] = source[0];
+			target[1] = components > 1 ? source[1] : 0u;
+			target[2] = components > 2 ? source[2] : 0u;
+			target[3] = components > 3 ? source[3] : 255u;
+		}
+	}
+}
+
+/// <summary>
+/// Encodes a single block in BC7 mode 6.
+/// The endpoints are placed along the principal axis of the block and refined once by a least squares fit to the chosen indices.
+/// </summary>
+GLvoid PBRViewerTextureCompressor::EncodeBC7Block( const GLubyte block[16][4], GLubyte* output )
+{
+	GLfloat mean[4] = {};
+	GLfloat minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+	GLfloat maximum[4] = {};
+	for (GLint i = 0; i < 16; i++)
+	{
+		for (GLint c = 0; c < 4; c++)
+		{
+			const GLfloat value = static_cast<GLfloat>(block[i][c]);
+			mean[c] += value / 16.0f;
+			minimum[c] = std::min(minimum[c], value);
+			maximum[c] = std::max(maximum[c], value);
+		}
+	}
+
+	GLfloat covariance[4][4] = {};
+	for (GLint i = 0; i < 16; i++)
+	{
+		for (GLint r = 0; r < 4; r++)
+		{
+			for (GLint c = 0; c < 4; c++)
+			{
+				covariance[r][c] += (static_cast<GLfloat>(block[i][r]) - mean[r]) * (static_cast<GLfloat>(block[i][c]) - mean[c]);
+			}
+		}
+	}
+
+	// Power iteration starting with the diagonal of the bounding box.
+	GLfloat axis[4];
+	for (GLint c = 0; c < 4; c++)
+	{
+		axis[c] = maximum[c] - minimum[c];
+	}
+
+	for (GLint iteration = 0; iteration < 8; iteration++)
+	{
+		GLfloat product[4] = {};
+		GLfloat length = 0.0f;
+		for (GLint r = 0; r < 4; r++)
+		{
+			for (GLint c = 0; c < 4; c++)
+			{
+				product[r] += covariance[r][c] * axis[c];
+			}
+			length = std::max(length, std::abs(product[r]));
+		}
+
+		if (length <= 0.0f)
+		{
+			break;
+		}
+
+		for (GLint c = 0; c < 4; c++)
+		{
+			axis[c] = product[c] / length;
+		}
+	}
+
+	GLfloat axisLength = 0.0f;
+	for (GLint c = 0; c < 4; c++)
+	{
+		axisLength += axis[c] * axis[c];
+	}
+
+	GLfloat endpoints[2][4];
+	std::memcpy(endpoints[0], mean, sizeof mean);
+	std::memcpy(endpoints[1], mean, sizeof mean);
+
+	if (axisLength > 0.0f)
+	{
+		GLfloat minimumProjection = 0.0f;
+		GLfloat maximumProjection = 0.0f;
+		for (GLint i = 0; i < 16; i++)
+		{
+			GLfloat projection = 0.0f;
+			for (GLint c = 0; c < 4; c++)
+			{
+				projection += (static_cast<GLfloat>(block[i][c]) - mean[c]) * axis[c];
+			}
+
+			minimumProjection = std::min(minimumProjection, projection / axisLength);
+			maximumProjection = std::max(maximumProjection, projection / axisLength);
+		}
+
+		for (GLint c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = std::min(std::max(mean[c] + minimumProjection * axis[c], 0.0f), 255.0f);
+			endpoints[1][c] = std::min(std::max(mean[c] + maximumProjection * axis[c], 0.0f), 255.0f);
+		}
+	}
+
+	GLint bestQuantized[2][4] = {};
+	GLint bestPBits[2] = {};
+	GLint bestIndices[16] = {};
+	GLint bestError = -1;
+
+	for (GLint pass = 0; pass < 2; pass++)
+	{
+		GLint quantized[2][4];
+		GLint pBits[2];
+		QuantizeBC7Endpoint(endpoints[0], quantized[0], pBits[0]);
+		QuantizeBC7Endpoint(endpoints[1], quantized[1], pBits[1]);
+
+		GLint palette[16][4];
+		for (GLint c = 0; c < 4; c++)
+		{
+			const GLint first = (quantized[0][c] << 1) | pBits[0];
+			const GLint second = (quantized[1][c] << 1) | pBits[1];
+			for (GLint w = 0; w < 16; w++)
+			{
+				palette[w][c] = ((64 - BC7Weights[w]) * first + BC7Weights[w] * second + 32) >> 6;
+			}
+		}
+
+		GLint indices[16];
+		GLint error = 0;
+		for (GLint i = 0; i < 16; i++)
+		{
+			GLint bestPixelError = -1;
+			for (GLint w = 0; w < 16; w++)
+			{
+				GLint pixelError = 0;
+				for (GLint c = 0; c < 4; c++)
+				{
+					const GLint difference = palette[w][c] - static_cast<GLint>(block[i][c]);
+					pixelError += difference * difference;
+				}
+
+				if (bestPixelError < 0 || pixelError < bestPixelError)
+				{
+					bestPixelError = pixelError;
+					indices[i] = w;
+				}
+			}
+			error += bestPixelError;
+		}
+
+		if (bestError < 0 || error < bestError)
+		{
+			bestError = error;
+			std::memcpy(bestQuantized, quantized, sizeof quantized);
+			std::memcpy(bestPBits, pBits, sizeof pBits);
+			std::memcpy(bestIndices, indices, sizeof indices);
+		}
+
+		// Least squares fit of the endpoints to the chosen indices for the next pass.
+		GLfloat a = 0.0f, b = 0.0f, d = 0.0f;
+		GLfloat firstSum[4] = {};
+		GLfloat secondSum[4] = {};
+		for (GLint i = 0; i < 16; i++)
+		{
+			const GLfloat weight = static_cast<GLfloat>(BC7Weights[indices[i]]) / 64.0f;
+			a += (1.0f - weight) * (1.0f - weight);
+			b += (1.0f - weight) * weight;
+			d += weight * weight;
+
+			for (GLint c = 0; c < 4; c++)
+			{
+				firstSum[c] += (1.0f - weight) * static_cast<GLfloat>(block[i][c]);
+				secondSum[c] += weight * static_cast<GLfloat>(block[i][c]);
+			}
+		}
+
+		const GLfloat determinant = a * d - b * b;
+		if (std::abs(determinant) < 1e-6f)
+		{
+			break;
+		}
+
+		for (GLint c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = std::min(std::max((d * firstSum[c] - b * secondSum[c]) / determinant, 0.0f), 255.0f);
+			endpoints[1][c] = std::min(std::max((a * secondSum[c] - b * firstSum[c]) / determinant, 0.0f), 255.0f);
+		}
+	}
+
+	// The most significant bit of the first index is implicit zero, so the endpoints are swapped if necessary.
+	if (bestIndices[0] >= 8)
+	{
+		for (GLint c = 0; c < 4; c++)
+		{
+			std::swap(bestQuantized[0][c], bestQuantized[1][c]);
+		}
+		std::swap(bestPBits[0], bestPBits[1]);
+
+		for (GLint i = 0; i < 16; i++)
+		{
+			bestIndices[i] = 15 - bestIndices[i];
+		}
+	}
+
+	std::memset(output, 0, 16);
+
+	GLuint position = 0u;
+	WriteBits(output, position, 1u << 6, 7u);
+	for (GLint c = 0; c < 4; c++)
+	{
+		WriteBits(output, position, static_cast<GLuint>(bestQuantized[0][c]), 7u);
+		WriteBits(output, position, static_cast<GLuint>(bestQuantized[1][c]), 7u);
+	}
+
+	WriteBits(output, position, static_cast<GLuint>(bestPBits[0]), 1u);
+	WriteBits(output, position, static_cast<GLuint>(bestPBits[1]), 1u);
+
+	WriteBits(output, position, static_cast<GLuint>(bestIndices[0]), 3u);
+	for (GLint i = 1; i < 16; i++)
+	{
+		WriteBits(output, position, static_cast<GLuint>(bestIndices[i]), 4u);
+	}
+}
+
+/// <summary>
+/// Encodes a single channel of a block in BC4.
+/// The minimum and the maximum of the block are used as endpoints with six interpolated values in between.
+/// </summary>
+GLvoid PBRViewerTextureCompressor::EncodeBC4Block( const GLubyte block[16][4], const GLint channel, GLubyte* output )
+{
+	GLint minimum = 255;
+	GLint maximum = 0;
+	for (GLint i = 0; i < 16; i++)
+	{
+		minimum = std::min(minimum, static_cast<GLint>(block[i][channel]));
+		maximum = std::max(maximum, static_cast<GLint>(block[i][channel]));
+	}
+
+	std::memset(output, 0, 8);
+	output[0] = static_cast<GLubyte>(maximum);
+	output[1] = static_cast<GLubyte>(minimum);
+
+	if (maximum == minimum)
+	{
+		// All indices zero select the first endpoint.
+		return;
+	}
+
+	// With the first endpoint greater than the second one, index 0 and 1 are the endpoints and 2 to 7 interpolate between them.
+	GLint palette[8];
+	palette[0] = 7 * maximum;
+	palette[1] = 7 * minimum;
+	for (GLint i = 2; i < 8; i++)
+	{
+		palette[i] = (8 - i) * maximum + (i - 1) * minimum;
+	}
+
+	GLuint position = 16u;
+	for (GLint i = 0; i < 16; i++)
+	{
+		const GLint value = 7 * static_cast<GLint>(block[i][channel]);
+
+		GLuint bestIndex = 0u;
+		for (GLuint p = 1u; p < 8u; p++)
+		{
+			if (std::abs(palette[p] - value) < std::abs(palette[bestIndex] - value))
+			{
+				bestIndex = p;
+			}
+		}
+
+		WriteBits(output, position, bestIndex, 3u);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+/// <summary>
+/// This class encodes 8-bit images into the block-compressed formats supported by OpenGL 4.3.
+/// BC7 is used for color images, BC5 for two-channel normal maps and BC4 for single-channel images.
+/// The methods do not need an OpenGL context and can be called from any thread.
+/// </summary>
+class PBRViewerTextureCompressor
+{
+public:
+	/// <summary>
+	/// Encodes an image into BC7 (mode 6: one subset with 4-bit indices and RGBA endpoints).
+	/// </summary>
+	/// <param name="pixels">The pixels of the image, row by row.</param>
+	/// <param name="width">The width of the image.</param>
+	/// <param name="height">The height of the image.</param>
+	/// <param name="components">The number of 8-bit components per pixel (1 to 4).</param>
+	/// <returns>The encoded blocks, row by row.</returns>
+	static std::vector<GLubyte> CompressBC7( const GLubyte* pixels, GLint width, GLint height, GLint components );
+
+	/// <summary>
+	/// Encodes the first two components of an image into BC5.
+	/// </summary>
+	/// <param name="pixels">The pixels of the image, row by row.</param>
+	/// <param name="width">The width of the image.</param>
+	/// <param name="height">The height of the image.</param>
+	/// <param name="components">The number of 8-bit components per pixel (1 to 4).</param>
+	/// <returns>The encoded blocks, row by row.</returns>
+	static std::vector<GLubyte> CompressBC5( const GLubyte* pixels, GLint width, GLint height, GLint components );
+
+	/// <summary>
+	/// Encodes the first component of an image into BC4.
+	/// </summary>
+	/// <param name="pixels">The pixels of the image, row by row.</param>
+	/// <param name="width">The width of the image.</param>
+	/// <param name="height">The height of the image.</param>
+	/// <param name="components">The number of 8-bit components per pixel (1 to 4).</param>
+	/// <returns>The encoded blocks, row by row.</returns>
+	static std::vector<GLubyte> CompressBC4( const GLubyte* pixels, GLint width, GLint height, GLint components );
+
+	/// <summary>
+	/// Gets the size of an image in a block-compressed format.
+	/// </summary>
+	/// <param name="format">The compressed OpenGL format.</param>
+	/// <param name="width">The width of the image.</param>
+	/// <param name="height">The height of the image.</param>
+	/// <returns>The size in bytes or zero if the format is not supported.</returns>
+	static size_t GetCompressedSize( GLenum format, GLint width, GLint height );
+
+private:
+	static const GLint BlockDimension = 4;
+
+	/// <summary>
+	/// Copies a 4x4 block of an image into RGBA pixels. Pixels outside the image repeat the last row and column.
+	/// Missing components are filled like OpenGL does when sampling the image (zero for green and blue, opaque alpha).
+	/// </summary>
+	static GLvoid FetchBlock( const GLubyte* pixels, GLint width, GLint height, GLint components, GLint blockX, GLint blockY, GLubyte block[16][4] );
+
+	/// <summary>
+	/// Encodes a single block in BC7 mode 6.
+	/// The endpoints are placed along the principal axis of the block and refined once by a least squares fit to the chosen indices.
+	/// </summary>
+	static GLvoid EncodeBC7Block( const GLubyte block[16][4], GLubyte* output );
+
+	/// <summary>
+	/// Encodes a single channel of a block in BC4.
+	/// The minimum and the maximum of the block are used as endpoints with six interpolated values in between.
+	/// </summary>
+	static GLvoid EncodeBC4Block( const GLubyte block[16][4], GLint channel, GLubyte* output );
+};
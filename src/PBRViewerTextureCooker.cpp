@@ -0,0 +1,403 @@
+#include "PBRViewerTextureCooker.h"
+
+#include "PBRViewerLogger.h"
+#include "PBRViewerMipGenerator.h"
+#include "PBRViewerTexture.h"
+#include "PBRViewerTextureCompressor.h"
+
+#include <algorithm>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+/// <summary>
+/// The pixel format of a DDS file. Cooked files always use the 'DX10' extension header.
+/// </summary>
+struct PBRViewerDDSPixelFormat
+{
+	std::uint32_t Size;
+	std::uint32_t Flags;
+	std::uint32_t FourCC;
+	std::uint32_t RGBBitCount;
+	std::uint32_t RedMask;
+	std::uint32_t GreenMask;
+	std::uint32_t BlueMask;
+	std::uint32_t AlphaMask;
+};
+
+/// <summary>
+/// The header of a DDS file following the magic number.
+/// The reserved words hold the tag and the version of the cooker as well as the key of the source image.
+/// The filepath of the source image follows the mip levels, since the name of the cooked file is only a hash of it.
+/// </summary>
+struct PBRViewerDDSHeader
+{
+	std::uint32_t Size;
+	std::uint32_t Flags;
+	std::uint32_t Height;
+	std::uint32_t Width;
+	std::uint32_t PitchOrLinearSize;
+	std::uint32_t Depth;
+	std::uint32_t MipMapCount;
+	std::uint32_t Reserved1[11];
+	PBRViewerDDSPixelFormat PixelFormat;
+	std::uint32_t Caps;
+	std::uint32_t Caps2;
+	std::uint32_t Caps3;
+	std::uint32_t Caps4;
+	std::uint32_t Reserved2;
+};
+
+/// <summary>
+/// The DX10 extension header of a DDS file.
+/// </summary>
+struct PBRViewerDDSHeaderDX10
+{
+	std::uint32_t DXGIFormat;
+	std::uint32_t ResourceDimension;
+	std::uint32_t MiscFlag;
+	std::uint32_t ArraySize;
+	std::uint32_t MiscFlags2;
+};
+
+static_assert(sizeof(PBRViewerDDSHeader) == 124, "The DDS header has to match the file format.");
+static_assert(sizeof(PBRViewerDDSHeaderDX10) == 20, "The DDS DX10 header has to match the file format.");
+
+static const std::uint32_t DDSMagic = 0x20534444u; // "DDS "
+static const std::uint32_t DDSFourCCDX10 = 0x30315844u; // "DX10"
+static const std::uint32_t DDSCookerTag = 0x56524250u; // "PBRV"
+
+static const std::uint32_t DXGIFormatBC4 = 80u;
+static const std::uint32_t DXGIFormatBC5 = 83u;
+static const std::uint32_t DXGIFormatBC7 = 98u;
+
+static const std::string TextureCacheDirectory = "TextureCache";
+
+/// <summary>
+/// Reads the cooked mip chain of a texture (if a valid cooked file exists).
+/// </summary>
+/// <param name="texturePath">The filepath of the source image.</param>
+/// <param name="texture">The texture to fill with the compressed mip levels. The slot has to be set.</param>
+/// <returns>True if a cooked file was found, false if the image has to be decoded and cooked.</returns>
+GLboolean PBRViewerTextureCooker::Read( std::string const& texturePath, PBRViewerTextureData& texture )
+{
+	std::int64_t modificationTime;
+	std::uint64_t fileSize;
+	if (GL_FALSE == GetSourceKey(texturePath, modificationTime, fileSize))
+	{
+		return GL_FALSE;
+	}
+
+	std::ifstream file(GetCookedFilepath(texturePath, texture.Slot), std::ios::binary);
+	if (!file)
+	{
+		return GL_FALSE;
+	}
+
+	std::uint32_t magic = 0u;
+	PBRViewerDDSHeader header;
+	PBRViewerDDSHeaderDX10 headerDX10;
+	file.read(reinterpret_cast<char*>(&magic), sizeof magic);
+	file.read(reinterpret_cast<char*>(&header), sizeof header);
+	file.read(reinterpret_cast<char*>(&headerDX10), sizeof headerDX10);
+
+	if (!file || DDSMagic != magic || DDSFourCCDX10 != header.PixelFormat.FourCC
+		|| DDSCookerTag != header.Reserved1[0] || Version != header.Reserved1[1]
+		|| static_cast<std::uint32_t>(modificationTime) != header.Reserved1[2] || static_cast<std::uint32_t>(modificationTime >> 32) != header.Reserved1[3]
+		|| static_cast<std::uint32_t>(fileSize) != header.Reserved1[4] || static_cast<std::uint32_t>(fileSize >> 32) != header.Reserved1[5])
+	{
+		return GL_FALSE;
+	}
+
+	GLenum format;
+	switch (headerDX10.DXGIFormat)
+	{
+	case DXGIFormatBC4:
+		format = GL_COMPRESSED_RED_RGTC1;
+		break;
+	case DXGIFormatBC5:
+		format = GL_COMPRESSED_RG_RGTC2;
+		break;
+	case DXGIFormatBC7:
+		format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+		break;
+	default:
+		return GL_FALSE;
+	}
+
+	const GLint width = static_cast<GLint>(header.Width);
+	const GLint height = static_cast<GLint>(header.Height);
+	if (width <= 0 || height <= 0 || header.MipMapCount != PBRViewerMipGenerator::GetNumberOfLevels(width, height))
+	{
+		return GL_FALSE;
+	}
+
+	std::vector<std::vector<GLubyte>> levels(header.MipMapCount);
+	GLint levelWidth = width;
+	GLint levelHeight = height;
+	for (std::vector<GLubyte>& level : levels)
+	{
+		level.resize(PBRViewerTextureCompressor::GetCompressedSize(format, levelWidth, levelHeight));
+		file.read(reinterpret_cast<char*>(level.data()), static_cast<std::streamsize>(level.size()));
+
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+
+	// Another image whose filepath and slot share the hash must not be loaded instead.
+	std::uint32_t sourcePathLength = 0u;
+	file.read(reinterpret_cast<char*>(&sourcePathLength), sizeof sourcePathLength);
+	if (!file || sourcePathLength != texturePath.size())
+	{
+		return GL_FALSE;
+	}
+
+	std::string sourcePath(sourcePathLength, '\0');
+	file.read(&sourcePath[0], static_cast<std::streamsize>(sourcePathLength));
+	if (!file || sourcePath != texturePath)
+	{
+		return GL_FALSE;
+	}
+
+	texture.Width = width;
+	texture.Height = height;
+	texture.Components = GL_COMPRESSED_RED_RGTC1 == format ? 1 : GL_COMPRESSED_RG_RGTC2 == format ? 2 : 4;
+	texture.CompressedFormat = format;
+	texture.MipLevels = std::move(levels);
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Generates the mip chain of a decoded texture, compresses all levels and writes them into the cache.
+/// The decoded pixels are released afterwards.
+/// </summary>
+/// <param name="texturePath">The filepath of the source image.</param>
+/// <param name="compress">False to keep the mip levels uncompressed. Uncompressed textures are not written into the cache.</param>
+/// <param name="texture">The decoded texture.</param>
+GLvoid PBRViewerTextureCooker::Cook( std::string const& texturePath, const GLboolean compress, PBRViewerTextureData& texture )
+{
+	if (nullptr == texture.Pixels)
+	{
+		return;
+	}
+
+	texture.MipLevels = PBRViewerMipGenerator::Generate(texture.Pixels.get(), texture.Width, texture.Height, texture.Components, GetContent(texture), MipFilter);
+	texture.Pixels.reset();
+
+	if (GL_FALSE == compress)
+	{
+		return;
+	}
+
+	const GLenum format = ChooseFormat(texture);
+
+	GLint width = texture.Width;
+	GLint height = texture.Height;
+	for (std::vector<GLubyte>& level : texture.MipLevels)
+	{
+		level = Compress(format, level.data(), width, height, texture.Components);
+
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+
+	texture.CompressedFormat = format;
+
+	Write(texturePath, texture);
+}
+
+/// <summary>
+/// Gets the content of a texture depending on its type, which decides how its mip levels are filtered.
+/// Only albedo maps are sRGB encoded; the shaders read all other maps as linear values.
+/// </summary>
+/// <param name="texture">The decoded texture.</param>
+/// <returns>The content of the texture.</returns>
+PBRViewerEnumerations::TextureContent PBRViewerTextureCooker::GetContent( PBRViewerTextureData const& texture )
+{
+	if (PBRViewerEnumerations::TextureDiffuse == texture.Slot)
+	{
+		return PBRViewerEnumerations::SRGBColor;
+	}
+
+	if (PBRViewerEnumerations::TextureNormal == texture.Slot)
+	{
+		return PBRViewerEnumerations::TangentSpaceNormals;
+	}
+
+	return PBRViewerEnumerations::LinearData;
+}
+
+/// <summary>
+/// Chooses the compressed format of a texture depending on its type and number of components.
+/// </summary>
+/// <param name="texture">The decoded texture.</param>
+/// <returns>The compressed OpenGL format.</returns>
+GLenum PBRViewerTextureCooker::ChooseFormat( PBRViewerTextureData const& texture )
+{
+	if (1 == texture.Components)
+	{
+		return GL_COMPRESSED_RED_RGTC1;
+	}
+
+	if (2 == texture.Components || PBRViewerEnumerations::TextureNormal == texture.Slot)
+	{
+		return GL_COMPRESSED_RG_RGTC2;
+	}
+
+	return GL_COMPRESSED_RGBA_BPTC_UNORM;
+}
+
+/// <summary>
+/// Compresses a single mip level.
+/// </summary>
+/// <param name="format">The compressed OpenGL format.</param>
+/// <param name="pixels">The pixels of the mip level.</param>
+/// <param name="width">The width of the mip level.</param>
+/// <param name="height">The height of the mip level.</param>
+/// <param name="components">The number of 8-bit components per pixel.</param>
+/// <returns>The compressed mip level.</returns>
+std::vector<GLubyte> PBRViewerTextureCooker::Compress( const GLenum format, const GLubyte* pixels, const GLint width, const GLint height, const GLint components )
+{
+	switch (format)
+	{
+	case GL_COMPRESSED_RED_RGTC1:
+		return PBRViewerTextureCompressor::CompressBC4(pixels, width, height, components);
+	case GL_COMPRESSED_RG_RGTC2:
+		return PBRViewerTextureCompressor::CompressBC5(pixels, width, height, components);
+	default:
+		return PBRViewerTextureCompressor::CompressBC7(pixels, width, height, components);
+	}
+}
+
+/// <summary>
+/// Writes the compressed mip chain of a texture into a DDS file.
+/// </summary>
+/// <param name="texturePath">The filepath of the source image.</param>
+/// <param name="texture">The compressed texture.</param>
+/// <returns>True if the cooked file could be written, false if not.</returns>
+GLboolean PBRViewerTextureCooker::Write( std::string const& texturePath, PBRViewerTextureData const& texture )
+{
+	std::int64_t modificationTime;
+	std::uint64_t fileSize;
+	if (GL_FALSE == GetSourceKey(texturePath, modificationTime, fileSize))
+	{
+		return GL_FALSE;
+	}
+
+	PBRViewerDDSHeader header = {};
+	header.Size = sizeof header;
+	header.Flags = 0x1u | 0x2u | 0x4u | 0x1000u | 0x20000u | 0x80000u; // Caps, height, width, pixel format, mip map count, linear size
+	header.Height = static_cast<std::uint32_t>(texture.Height);
+	header.Width = static_cast<std::uint32_t>(texture.Width);
+	header.PitchOrLinearSize = static_cast<std::uint32_t>(texture.MipLevels.front().size());
+	header.MipMapCount = static_cast<std::uint32_t>(texture.MipLevels.size());
+	header.Reserved1[0] = DDSCookerTag;
+	header.Reserved1[1] = Version;
+	header.Reserved1[2] = static_cast<std::uint32_t>(modificationTime);
+	header.Reserved1[3] = static_cast<std::uint32_t>(modificationTime >> 32);
+	header.Reserved1[4] = static_cast<std::uint32_t>(fileSize);
+	header.Reserved1[5] = static_cast<std::uint32_t>(fileSize >> 32);
+	header.PixelFormat.Size = sizeof header.PixelFormat;
+	header.PixelFormat.Flags = 0x4u; // FourCC
+	header.PixelFormat.FourCC = DDSFourCCDX10;
+	header.Caps = 0x8u | 0x1000u | 0x400000u; // Complex, texture, mip map
+
+	PBRViewerDDSHeaderDX10 headerDX10 = {};
+	headerDX10.DXGIFormat = GL_COMPRESSED_RED_RGTC1 == texture.CompressedFormat ? DXGIFormatBC4
+	                      : GL_COMPRESSED_RG_RGTC2 == texture.CompressedFormat ? DXGIFormatBC5 : DXGIFormatBC7;
+	headerDX10.ResourceDimension = 3u; // Texture 2D
+	headerDX10.ArraySize = 1u;
+
+	std::error_code errorCode;
+	std::experimental::filesystem::create_directories(TextureCacheDirectory, errorCode);
+
+	const std::string cookedFilepath = GetCookedFilepath(texturePath, texture.Slot);
+
+	// Several imports may cook the same image at the same time, so each thread writes its own temporary file.
+	std::stringstream temporaryFilepath;
+	temporaryFilepath << cookedFilepath << '.' << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+	{
+		std::ofstream file(temporaryFilepath.str(), std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not create the cooked texture file:", temporaryFilepath.str());
+			return GL_FALSE;
+		}
+
+		file.write(reinterpret_cast<const char*>(&DDSMagic), sizeof DDSMagic);
+		file.write(reinterpret_cast<const char*>(&header), sizeof header);
+		file.write(reinterpret_cast<const char*>(&headerDX10), sizeof headerDX10);
+
+		for (const std::vector<GLubyte>& level : texture.MipLevels)
+		{
+			file.write(reinterpret_cast<const char*>(level.data()), static_cast<std::streamsize>(level.size()));
+		}
+
+		const std::uint32_t sourcePathLength = static_cast<std::uint32_t>(texturePath.size());
+		file.write(reinterpret_cast<const char*>(&sourcePathLength), sizeof sourcePathLength);
+		file.write(texturePath.data(), static_cast<std::streamsize>(sourcePathLength));
+
+		if (!file)
+		{
+			PBRViewerLogger::PrintErrorMessage(__FILE__, __LINE__, "Could not write the cooked texture file:", temporaryFilepath.str());
+			file.close();
+			std::experimental::filesystem::remove(temporaryFilepath.str(), errorCode);
+			return GL_FALSE;
+		}
+	}
+
+	std::experimental::filesystem::remove(cookedFilepath, errorCode);
+	std::experimental::filesystem::rename(temporaryFilepath.str(), cookedFilepath, errorCode);
+	if (errorCode)
+	{
+		// Another thread may have stored the same texture in the meantime.
+		std::experimental::filesystem::remove(temporaryFilepath.str(), errorCode);
+		return GL_FALSE;
+	}
+
+	return GL_TRUE;
+}
+
+/// <summary>
+/// Gets the filepath of the cooked file belonging to a texture.
+/// </summary>
+/// <param name="texturePath">The filepath of the source image.</param>
+/// <param name="slot">The slot of the texture, since it decides the compressed format.</param>
+/// <returns>The filepath of the cooked file.</returns>
+std::string PBRViewerTextureCooker::GetCookedFilepath( std::string const& texturePath, const PBRViewerEnumerations::TextureSlot slot )
+{
+	// The name of the slot is hashed instead of its number, so files cooked before the slots were numbered stay valid.
+	std::stringstream filename;
+	filename << std::hex << std::setw(16) << std::setfill('0')
+		<< static_cast<std::uint64_t>(std::hash<std::string>()(texturePath + '|' + PBRViewerTexture::GetSlotName(slot))) << ".dds";
+	return (std::experimental::filesystem::path(TextureCacheDirectory) / filename.str()).string();
+}
+
+/// <summary>
+/// Gets the modification time and the size of the source image.
+/// </summary>
+/// <param name="texturePath">The filepath of the source image.</param>
+/// <param name="modificationTime">The modification time of the image.</param>
+/// <param name="fileSize">The size of the image in bytes.</param>
+/// <returns>True if the image exists, false if not.</returns>
+GLboolean PBRViewerTextureCooker::GetSourceKey( std::string const& texturePath, std::int64_t& modificationTime, std::uint64_t& fileSize )
+{
+	std::error_code errorCode;
+
+	const auto lastWriteTime = std::experimental::filesystem::last_write_time(texturePath, errorCode);
+	if (errorCode)
+	{
+		return GL_FALSE;
+	}
+
+	fileSize = static_cast<std::uint64_t>(std::experimental::filesystem::file_size(texturePath, errorCode));
+	if (errorCode)
+	{
+		return GL_FALSE;
+	}
+
+	modificationTime = static_cast<std::int64_t>(lastWriteTime.time_since_epoch().count());
+	return GL_TRUE;
+}
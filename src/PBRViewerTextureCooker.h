@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerEnumerations.h"
+#include "PBRViewerSceneData.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// This class converts decoded material textures into block-compressed mip chains and caches them as DDS files on disk.
+/// Albedo and emissive maps are stored as BC7, normal maps as BC5 (the shader rebuilds the Z component) and single-channel maps as BC4.
+/// The cooked files are keyed by the filepath, the modification time and the size of the source image, so a changed image is cooked again.
+/// </summary>
+class PBRViewerTextureCooker
+{
+public:
+	/// <summary>
+	/// Reads the cooked mip chain of a texture (if a valid cooked file exists).
+	/// </summary>
+	/// <param name="texturePath">The filepath of the source image.</param>
+	/// <param name="texture">The texture to fill with the compressed mip levels. The slot has to be set.</param>
+	/// <returns>True if a cooked file was found, false if the image has to be decoded and cooked.</returns>
+	static GLboolean Read( std::string const& texturePath, PBRViewerTextureData& texture );
+
+	/// <summary>
+	/// Generates the mip chain of a decoded texture, compresses all levels and writes them into the cache.
+	/// The decoded pixels are released afterwards.
+	/// </summary>
+	/// <param name="texturePath">The filepath of the source image.</param>
+	/// <param name="compress">False to keep the mip levels uncompressed. Uncompressed textures are not written into the cache.</param>
+	/// <param name="texture">The decoded texture.</param>
+	static GLvoid Cook( std::string const& texturePath, GLboolean compress, PBRViewerTextureData& texture );
+
+private:
+	// Increase the version whenever the encoders, the mip generation or the file layout change.
+	static const std::uint32_t Version = 2u;
+
+	// The Kaiser filter keeps smaller mip levels sharper than a box filter.
+	static const PBRViewerEnumerations::MipFilter MipFilter = PBRViewerEnumerations::KaiserFilter;
+
+	/// <summary>
+	/// Gets the content of a texture depending on its type, which decides how its mip levels are filtered.
+	/// Only albedo maps are sRGB encoded; the shaders read all other maps as linear values.
+	/// </summary>
+	/// <param name="texture">The decoded texture.</param>
+	/// <returns>The content of the texture.</returns>
+	static PBRViewerEnumerations::TextureContent GetContent( PBRViewerTextureData const& texture );
+
+	/// <summary>
+	/// Chooses the compressed format of a texture depending on its type and number of components.
+	/// </summary>
+	/// <param name="texture">The decoded texture.</param>
+	/// <returns>The compressed OpenGL format.</returns>
+	static GLenum ChooseFormat( PBRViewerTextureData const& texture );
+
+	/// <summary>
+	/// Compresses a single mip level.
+	/// </summary>
+	/// <param name="format">The compressed OpenGL format.</param>
+	/// <param name="pixels">The pixels of the mip level.</param>
+	/// <param name="width">The width of the mip level.</param>
+	/// <param name="height">The height of the mip level.</param>
+	/// <param name="components">The number of 8-bit components per pixel.</param>
+	/// <returns>The compressed mip level.</returns>
+	static std::vector<GLubyte> Compress( GLenum format, const GLubyte* pixels, GLint width, GLint height, GLint components );
+
+	/// <summary>
+	/// Writes the compressed mip chain of a texture into a DDS file.
+	/// </summary>
+	/// <param name="texturePath">The filepath of the source image.</param>
+	/// <param name="texture">The compressed texture.</param>
+	/// <returns>True if the cooked file could be written, false if not.</returns>
+	static GLboolean Write( std::string const& texturePath, PBRViewerTextureData const& texture );
+
+	/// <summary>
+	/// Gets the filepath of the cooked file belonging to a texture.
+	/// </summary>
+	/// <param name="texturePath">The filepath of the source image.</param>
+	/// <param name="slot">The slot of the texture, since it decides the compressed format.</param>
+	/// <returns>The filepath of the cooked file.</returns>
+	static std::string GetCookedFilepath( std::string const& texturePath, PBRViewerEnumerations::TextureSlot slot );
+
+	/// <summary>
+	/// Gets the modification time and the size of the source image.
+	/// </summary>
+	/// <param name="texturePath">The filepath of the source image.</param>
+	/// <param name="modificationTime">The modification time of the image.</param>
+	/// <param name="fileSize">The size of the image in bytes.</param>
+	/// <returns>True if the image exists, false if not.</returns>
+	static GLboolean GetSourceKey( std::string const& texturePath, std::int64_t& modificationTime, std::uint64_t& fileSize );
+};
@@ -0,0 +1,90 @@
+#include "PBRViewerThreadPool.h"
+
+#include <algorithm>
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerThreadPool"/> class.
+/// </summary>
+/// <param name="numberOfThreads">The number of worker threads.</param>
+PBRViewerThreadPool::PBRViewerThreadPool( const GLuint numberOfThreads )
+{
+	const GLuint threadCount = std::max(1u, numberOfThreads);
+	myWorkers.reserve(threadCount);
+
+	for (GLuint i = 0; i < threadCount; i++)
+	{
+		myWorkers.emplace_back([this]()
+		{
+			WorkerLoop();
+		});
+	}
+}
+
+/// <summary>
+/// Finalizes an instance of the <see cref="PBRViewerThreadPool"/> class.
+/// Waits until all queued tasks have been executed.
+/// </summary>
+PBRViewerThreadPool::~PBRViewerThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(myMutex);
+		myIsStopping = GL_TRUE;
+	}
+
+	myCondition.notify_all();
+
+	for (std::thread& worker : myWorkers)
+	{
+		worker.join();
+	}
+}
+
+/// <summary>
+/// Gets the thread pool shared by the whole application.
+/// It uses one thread less than the hardware supports to leave room for the render thread.
+/// </summary>
+/// <returns>The shared thread pool.</returns>
+PBRViewerThreadPool& PBRViewerThreadPool::GetInstance()
+{
+	static PBRViewerThreadPool instance(std::thread::hardware_concurrency() > 1u ? std::thread::hardware_concurrency() - 1u : 1u);
+	return instance;
+}
+
+/// <summary>
+/// Gets the number of worker threads.
+/// </summary>
+/// <returns>The number of worker threads.</returns>
+GLuint PBRViewerThreadPool::GetNumberOfThreads() const
+{
+	return static_cast<GLuint>(myWorkers.size());
+}
+
+/// <summary>
+/// Executes queued tasks until the pool is stopped.
+/// </summary>
+GLvoid PBRViewerThreadPool::WorkerLoop()
+{
+	for (;;)
+	{
+		std::function<GLvoid()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(myMutex);
+			myCondition.wait(lock, [this]()
+			{
+				return myIsStopping || !myTasks.empty();
+			});
+
+			if (myTasks.empty())
+			{
+				// Only reached if the pool is stopping.
+				return;
+			}
+
+			task = std::move(myTasks.front());
+			myTasks.pop();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// This class represents a fixed-size pool of worker threads executing CPU-only tasks like image decoding.
+/// Tasks must not issue OpenGL calls since the worker threads do not own an OpenGL context.
+/// </summary>
+class PBRViewerThreadPool
+{
+public:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerThreadPool"/> class.
+	/// </summary>
+	/// <param name="numberOfThreads">The number of worker threads.</param>
+	explicit PBRViewerThreadPool( GLuint numberOfThreads );
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="PBRViewerThreadPool"/> class.
+	/// Waits until all queued tasks have been executed.
+	/// </summary>
+	~PBRViewerThreadPool();
+
+	PBRViewerThreadPool( PBRViewerThreadPool const& ) = delete;
+	PBRViewerThreadPool& operator=( PBRViewerThreadPool const& ) = delete;
+
+	/// <summary>
+	/// Gets the thread pool shared by the whole application.
+	/// It uses one thread less than the hardware supports to leave room for the render thread.
+	/// </summary>
+	/// <returns>The shared thread pool.</returns>
+	static PBRViewerThreadPool& GetInstance();
+
+	/// <summary>
+	/// Gets the number of worker threads.
+	/// </summary>
+	/// <returns>The number of worker threads.</returns>
+	GLuint GetNumberOfThreads() const;
+
+	/// <summary>
+	/// Queues a task for execution on one of the worker threads.
+	/// </summary>
+	/// <param name="task">The task to execute.</param>
+	/// <returns>A future holding the result of the task.</returns>
+	template <typename Task>
+	std::future<typename std::result_of<Task()>::type> Enqueue( Task task )
+	{
+		using ResultType = typename std::result_of<Task()>::type;
+
+		auto packagedTask = std::make_shared<std::packaged_task<ResultType()>>(std::move(task));
+		std::future<ResultType> result = packagedTask->get_future();
+
+		{
+			std::lock_guard<std::mutex> lock(myMutex);
+			myTasks.push([packagedTask]()
+			{
+				(*packagedTask)();
+			});
+		}
+
+		myCondition.notify_one();
+		return result;
+	}
+
+private:
+	std::vector<std::thread> myWorkers;
+	std::queue<std::function<GLvoid()>> myTasks;
+	std::mutex myMutex;
+	std::condition_variable myCondition;
+	GLboolean myIsStopping = GL_FALSE;
+
+	/// <summary>
+	/// Executes queued tasks until the pool is stopped.
+	/// </summary>
+	GLvoid WorkerLoop();
+};
@@ -0,0 +1,53 @@
+#include "PBRViewerUniformBuffer.h"
+
+/// <summary>
+/// Initializes a new instance of the <see cref="PBRViewerUniformBuffer"/> class and binds the buffer to the binding point of its block.
+/// The content is undefined until the first update.
+/// </summary>
+/// <param name="block">The uniform block held by the buffer.</param>
+/// <param name="size">The size of the block in bytes.</param>
+PBRViewerUniformBuffer::PBRViewerUniformBuffer( const PBRViewerEnumerations::UniformBlock block, const size_t size )
+	: myBlock(block),
+	  mySize(size)
+{
+	glGenBuffers(1, &myUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, myUBO);
+	glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(mySize), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// The binding point belongs to the context, so it lasts for all programs and frames.
+	glBindBufferBase(GL_UNIFORM_BUFFER, myBlock, myUBO);
+}
+
+/// <summary>
+/// Writes the content of the block to the buffer with a single call.
+/// </summary>
+/// <param name="data">The content in the std140 layout with the size of the block.</param>
+/// <param name="version">The version of the parameter store the content has been read from.</param>
+GLvoid PBRViewerUniformBuffer::Update( const GLvoid* data, const GLuint version )
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, myUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(mySize), data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	myUploadedVersion = version;
+}
+
+/// <summary>
+/// Gets the version of the parameter store the content of the buffer has been read from.
+/// </summary>
+/// <returns>The version of the last update or 0 if the buffer has not been written yet.</returns>
+GLuint PBRViewerUniformBuffer::GetUploadedVersion() const
+{
+	return myUploadedVersion;
+}
+
+/// <summary>
+/// Deletes the buffer. Call this method before the OpenGL context is destroyed.
+/// </summary>
+GLvoid PBRViewerUniformBuffer::Cleanup()
+{
+	glDeleteBuffers(1, &myUBO);
+	myUBO = 0u;
+	myUploadedVersion = 0u;
+}
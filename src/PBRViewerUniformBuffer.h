@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+#include "PBRViewerEnumerations.h"
+
+/// <summary>
+/// This class represents the buffer of a std140 uniform block, which all shaders declaring the block read through its binding point.
+/// The buffer remembers the version of the <see cref="PBRViewerParameterStore"/> it holds, so its owner only writes it if one of its fields is dirty.
+/// </summary>
+class PBRViewerUniformBuffer
+{
+public:
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PBRViewerUniformBuffer"/> class and binds the buffer to the binding point of its block.
+	/// The content is undefined until the first update.
+	/// </summary>
+	/// <param name="block">The uniform block held by the buffer.</param>
+	/// <param name="size">The size of the block in bytes.</param>
+	PBRViewerUniformBuffer( PBRViewerEnumerations::UniformBlock block, size_t size );
+
+	PBRViewerUniformBuffer( PBRViewerUniformBuffer const& ) = delete;
+	PBRViewerUniformBuffer& operator=( PBRViewerUniformBuffer const& ) = delete;
+
+	/// <summary>
+	/// Writes the content of the block to the buffer with a single call.
+	/// </summary>
+	/// <param name="data">The content in the std140 layout with the size of the block.</param>
+	/// <param name="version">The version of the parameter store the content has been read from.</param>
+	GLvoid Update( const GLvoid* data, GLuint version );
+
+	/// <summary>
+	/// Gets the version of the parameter store the content of the buffer has been read from.
+	/// </summary>
+	/// <returns>The version of the last update or 0 if the buffer has not been written yet.</returns>
+	GLuint GetUploadedVersion() const;
+
+	/// <summary>
+	/// Deletes the buffer. Call this method before the OpenGL context is destroyed.
+	/// </summary>
+	GLvoid Cleanup();
+
+private:
+	PBRViewerEnumerations::UniformBlock myBlock;
+	size_t mySize;
+	GLuint myUBO = 0u;
+	GLuint myUploadedVersion = 0u;
+};
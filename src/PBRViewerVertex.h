@@ -1,5 +1,7 @@
 #pragma once
 
+#include <glad/glad.h>
+
 #include <glm/vec3.hpp>
 #include <glm/vec2.hpp>
 
@@ -32,4 +34,70 @@ struct Vertex
 	/// The three dimensional bitangent vector of the vertex.
 	/// </summary>
 	glm::vec3 Bitangent;
-};
\ No newline at end of file
+};
+
+/// <summary>
+/// This struct represents a vertex in the compact 20 byte format created by the <see cref="PBRViewerVertexQuantizer"/>.
+/// The vertex shaders decode it with the position offset and scale of the mesh.
+/// </summary>
+struct CompactVertex
+{
+	/// <summary>
+	/// The position quantized to 16 bit against the axis-aligned bounding box of the mesh.
+	/// </summary>
+	GLushort Position[3];
+
+	/// <summary>
+	/// The sign of the bitangent (+-32767). The bitangent is rebuilt as cross product of the normal and the tangent.
+	/// </summary>
+	GLshort Handedness;
+
+	/// <summary>
+	/// The octahedral-encoded normal vector as 16 bit signed normalized values.
+	/// </summary>
+	GLshort Normal[2];
+
+	/// <summary>
+	/// The octahedral-encoded tangent vector as 16 bit signed normalized values.
+	/// </summary>
+	GLshort Tangent[2];
+
+	/// <summary>
+	/// The texture coordinate as half floats.
+	/// </summary>
+	GLhalf TexCoords[2];
+};
+
+static_assert(sizeof(CompactVertex) == 20, "The compact vertex must not contain any padding.");
+
+/// <summary>
+/// This struct represents a single vertex attribute read in place from a glTF buffer by the <see cref="PBRViewerGltfLoader"/>.
+/// The attributes of a mesh in this format are uploaded as they are, one after another, and each keeps its own component type and stride.
+/// </summary>
+struct VertexStream
+{
+	/// <summary>
+	/// The first element of the attribute. Null if the mesh does not have the attribute.
+	/// </summary>
+	const GLubyte* Data = nullptr;
+
+	/// <summary>
+	/// The distance between two elements in bytes.
+	/// </summary>
+	GLsizei Stride = 0;
+
+	/// <summary>
+	/// The number of components of an element.
+	/// </summary>
+	GLint Size = 0;
+
+	/// <summary>
+	/// The OpenGL type of the components, e. g. GL_FLOAT.
+	/// </summary>
+	GLenum Type = GL_FLOAT;
+
+	/// <summary>
+	/// True if integer components are normalized to [0, 1] or [-1, 1].
+	/// </summary>
+	GLboolean IsNormalized = GL_FALSE;
+};
@@ -0,0 +1,191 @@
+#include "PBRViewerVertexQuantizer.h"
+
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// Half floats keep texture coordinates in [-1, 1] within a quarter texel of a 1024x1024 texture.
+// Meshes with larger (tiled) coordinates lose more precision and keep the full precision vertices.
+static const GLfloat MaxTexCoordError = 1.0f / 4096.0f;
+
+static const GLfloat MaxUnsignedShort = 65535.0f;
+static const GLfloat MaxSignedShort = 32767.0f;
+
+/// <summary>
+/// Converts the vertices of a mesh into the compact format.
+/// </summary>
+/// <param name="vertices">The vertices of the mesh.</param>
+/// <param name="numberOfVertices">The number of vertices.</param>
+/// <param name="compactVertices">The converted vertices.</param>
+/// <param name="positionOffset">The minimum corner of the bounding box, which is added to the dequantized positions.</param>
+/// <param name="positionScale">The extent of the bounding box, which scales the dequantized positions.</param>
+/// <param name="error">The largest errors introduced by the conversion.</param>
+/// <returns>True if the errors are small enough to render the mesh with the compact vertices, false if not.</returns>
+GLboolean PBRViewerVertexQuantizer::Quantize( const Vertex* vertices, const GLuint numberOfVertices, std::vector<CompactVertex>& compactVertices,
+                                              glm::vec3& positionOffset, glm::vec3& positionScale, QuantizationError& error )
+{
+	error = QuantizationError();
+	compactVertices.resize(numberOfVertices);
+
+	glm::vec3 minimum(0.0f);
+	glm::vec3 maximum(0.0f);
+	if (numberOfVertices > 0u)
+	{
+		minimum = vertices[0].Position;
+		maximum = vertices[0].Position;
+	}
+
+	for (GLuint i = 1; i < numberOfVertices; i++)
+	{
+		minimum = glm::min(minimum, vertices[i].Position);
+		maximum = glm::max(maximum, vertices[i].Position);
+	}
+
+	positionOffset = minimum;
+	positionScale = maximum - minimum;
+
+	// A flat axis is stored as zero and dequantized to the offset.
+	glm::vec3 inverseScale(0.0f);
+	for (GLint axis = 0; axis < 3; axis++)
+	{
+		if (positionScale[axis] > 0.0f)
+		{
+			inverseScale[axis] = MaxUnsignedShort / positionScale[axis];
+		}
+	}
+
+	for (GLuint i = 0; i < numberOfVertices; i++)
+	{
+		const Vertex& vertex = vertices[i];
+		CompactVertex& compactVertex = compactVertices[i];
+
+		// Position
+		const glm::vec3 quantizedPosition = glm::clamp(glm::round((vertex.Position - minimum) * inverseScale), 0.0f, MaxUnsignedShort);
+		for (GLint axis = 0; axis < 3; axis++)
+		{
+			compactVertex.Position[axis] = static_cast<GLushort>(quantizedPosition[axis]);
+		}
+
+		const glm::vec3 position = positionOffset + positionScale * (quantizedPosition / MaxUnsignedShort);
+		error.Position = std::max(error.Position, glm::length(position - vertex.Position));
+
+		// Tangent frame
+		EncodeOctahedral(vertex.Normal, compactVertex.Normal);
+		EncodeOctahedral(vertex.Tangent, compactVertex.Tangent);
+
+		const glm::vec3 normal = DecodeOctahedral(compactVertex.Normal);
+		const glm::vec3 tangent = DecodeOctahedral(compactVertex.Tangent);
+		const GLfloat handedness = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f ? -1.0f : 1.0f;
+		compactVertex.Handedness = static_cast<GLshort>(handedness * MaxSignedShort);
+
+		error.Normal = std::max(error.Normal, GetAngle(vertex.Normal, normal));
+		error.Tangent = std::max(error.Tangent, GetAngle(vertex.Tangent, tangent));
+
+		// Zero vectors are decoded as +Z, so the rebuilt bitangent is only meaningful for a complete tangent frame.
+		if (glm::dot(vertex.Normal, vertex.Normal) > 0.0f && glm::dot(vertex.Tangent, vertex.Tangent) > 0.0f)
+		{
+			error.Bitangent = std::max(error.Bitangent, GetAngle(vertex.Bitangent, glm::cross(normal, tangent) * handedness));
+		}
+
+		// Texture coordinates
+		for (GLint component = 0; component < 2; component++)
+		{
+			compactVertex.TexCoords[component] = glm::packHalf1x16(vertex.TexCoords[component]);
+			const GLfloat texCoordError = std::abs(glm::unpackHalf1x16(compactVertex.TexCoords[component]) - vertex.TexCoords[component]);
+
+			// Non-finite coordinates have to keep the full precision vertices as well.
+			error.TexCoords = std::isfinite(texCoordError) ? std::max(error.TexCoords, texCoordError) : INFINITY;
+		}
+	}
+
+	const GLfloat diagonal = glm::length(positionScale);
+	error.RelativePosition = diagonal > 0.0f ? error.Position / diagonal : 0.0f;
+
+	return error.TexCoords <= MaxTexCoordError;
+}
+
+/// <summary>
+/// Encodes a unit vector with the octahedral mapping into two 16 bit signed normalized values.
+/// The four nearest quantized values are tested and the one decoding closest to the vector is chosen.
+/// </summary>
+/// <param name="vector">The vector to encode. A zero vector is encoded as +Z.</param>
+/// <param name="encoded">The encoded vector.</param>
+GLvoid PBRViewerVertexQuantizer::EncodeOctahedral( const glm::vec3 vector, GLshort encoded[2] )
+{
+	encoded[0] = 0;
+	encoded[1] = 0;
+
+	const GLfloat manhattanLength = std::abs(vector.x) + std::abs(vector.y) + std::abs(vector.z);
+	if (false == (manhattanLength > 0.0f))
+	{
+		return;
+	}
+
+	// Project onto the octahedron and fold the lower hemisphere over the diagonals.
+	glm::vec2 projected = glm::vec2(vector.x, vector.y) / manhattanLength;
+	if (vector.z < 0.0f)
+	{
+		projected = glm::vec2((1.0f - std::abs(projected.y)) * (projected.x >= 0.0f ? 1.0f : -1.0f),
+		                      (1.0f - std::abs(projected.x)) * (projected.y >= 0.0f ? 1.0f : -1.0f));
+	}
+
+	const glm::vec3 direction = glm::normalize(vector);
+	const glm::vec2 base = glm::floor(glm::clamp(projected, -1.0f, 1.0f) * MaxSignedShort);
+
+	GLfloat bestDeviation = INFINITY;
+	for (GLint x = 0; x < 2; x++)
+	{
+		for (GLint y = 0; y < 2; y++)
+		{
+			const GLshort candidate[2] =
+			{
+				static_cast<GLshort>(glm::clamp(base.x + static_cast<GLfloat>(x), -MaxSignedShort, MaxSignedShort)),
+				static_cast<GLshort>(glm::clamp(base.y + static_cast<GLfloat>(y), -MaxSignedShort, MaxSignedShort))
+			};
+
+			const GLfloat deviation = glm::length(DecodeOctahedral(candidate) - direction);
+			if (deviation < bestDeviation)
+			{
+				bestDeviation = deviation;
+				encoded[0] = candidate[0];
+				encoded[1] = candidate[1];
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Decodes a vector encoded by <see cref="EncodeOctahedral"/> the same way as the vertex shader.
+/// </summary>
+/// <param name="encoded">The encoded vector.</param>
+/// <returns>The decoded unit vector.</returns>
+glm::vec3 PBRViewerVertexQuantizer::DecodeOctahedral( const GLshort encoded[2] )
+{
+	// OpenGL converts signed normalized values with max(c / 32767, -1).
+	const glm::vec2 projected(std::max(static_cast<GLfloat>(encoded[0]) / MaxSignedShort, -1.0f),
+	                          std::max(static_cast<GLfloat>(encoded[1]) / MaxSignedShort, -1.0f));
+
+	glm::vec3 vector(projected.x, projected.y, 1.0f - std::abs(projected.x) - std::abs(projected.y));
+	const GLfloat fold = std::max(-vector.z, 0.0f);
+	vector.x += vector.x >= 0.0f ? -fold : fold;
+	vector.y += vector.y >= 0.0f ? -fold : fold;
+
+	return glm::normalize(vector);
+}
+
+/// <summary>
+/// Gets the angle between two vectors in degrees. Zero vectors are treated as equal.
+/// </summary>
+GLfloat PBRViewerVertexQuantizer::GetAngle( glm::vec3 const& first, glm::vec3 const& second )
+{
+	if (false == (glm::dot(first, first) > 0.0f) || false == (glm::dot(second, second) > 0.0f))
+	{
+		return 0.0f;
+	}
+
+	// The arc tangent stays precise for the tiny angles of the octahedral encoding, unlike the arc cosine.
+	return glm::degrees(std::atan2(glm::length(glm::cross(first, second)), glm::dot(first, second)));
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "PBRViewerVertex.h"
+
+#include <glm/vec3.hpp>
+
+#include <vector>
+
+/// <summary>
+/// This class converts vertices into the compact 20 byte format and measures the precision lost by the conversion.
+/// Positions are quantized against the bounding box of the mesh, normals and tangents are octahedral-encoded and the bitangent is
+/// replaced by its sign. The methods do not need an OpenGL context, so the conversion runs on the import workers.
+/// </summary>
+class PBRViewerVertexQuantizer
+{
+public:
+	/// <summary>
+	/// The largest errors introduced by the quantization of a mesh.
+	/// </summary>
+	struct QuantizationError
+	{
+		/// <summary>
+		/// The largest position error in model units.
+		/// </summary>
+		GLfloat Position = 0.0f;
+
+		/// <summary>
+		/// The largest position error relative to the diagonal of the bounding box.
+		/// </summary>
+		GLfloat RelativePosition = 0.0f;
+
+		/// <summary>
+		/// The largest angle between an original and a decoded normal in degrees.
+		/// </summary>
+		GLfloat Normal = 0.0f;
+
+		/// <summary>
+		/// The largest angle between an original and a decoded tangent in degrees.
+		/// </summary>
+		GLfloat Tangent = 0.0f;
+
+		/// <summary>
+		/// The largest angle between an original and a rebuilt bitangent in degrees.
+		/// Large values indicate a tangent frame which is not orthogonal.
+		/// </summary>
+		GLfloat Bitangent = 0.0f;
+
+		/// <summary>
+		/// The largest texture coordinate error.
+		/// </summary>
+		GLfloat TexCoords = 0.0f;
+	};
+
+	/// <summary>
+	/// Converts the vertices of a mesh into the compact format.
+	/// </summary>
+	/// <param name="vertices">The vertices of the mesh.</param>
+	/// <param name="numberOfVertices">The number of vertices.</param>
+	/// <param name="compactVertices">The converted vertices.</param>
+	/// <param name="positionOffset">The minimum corner of the bounding box, which is added to the dequantized positions.</param>
+	/// <param name="positionScale">The extent of the bounding box, which scales the dequantized positions.</param>
+	/// <param name="error">The largest errors introduced by the conversion.</param>
+	/// <returns>True if the errors are small enough to render the mesh with the compact vertices, false if not.</returns>
+	static GLboolean Quantize( const Vertex* vertices, GLuint numberOfVertices, std::vector<CompactVertex>& compactVertices,
+	                           glm::vec3& positionOffset, glm::vec3& positionScale, QuantizationError& error );
+
+private:
+	/// <summary>
+	/// Encodes a unit vector with the octahedral mapping into two 16 bit signed normalized values.
+	/// The four nearest quantized values are tested and the one decoding closest to the vector is chosen.
+	/// </summary>
+	/// <param name="vector">The vector to encode. A zero vector is encoded as +Z.</param>
+	/// <param name="encoded">The encoded vector.</param>
+	static GLvoid EncodeOctahedral( glm::vec3 vector, GLshort encoded[2] );
+
+	/// <summary>
+	/// Decodes a vector encoded by <see cref="EncodeOctahedral"/> the same way as the vertex shader.
+	/// </summary>
+	/// <param name="encoded">The encoded vector.</param>
+	/// <returns>The decoded unit vector.</returns>
+	static glm::vec3 DecodeOctahedral( const GLshort encoded[2] );
+
+	/// <summary>
+	/// Gets the angle between two vectors in degrees. Zero vectors are treated as equal.
+	/// </summary>
+	static GLfloat GetAngle( glm::vec3 const& first, glm::vec3 const& second );
+};
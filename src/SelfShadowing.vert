@@ -1,10 +1,12 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 5) in vec3 aPositionOffset;
+layout (location = 6) in vec3 aPositionScale;
 
 uniform mat4 model;
 uniform mat4 lightSpaceMatrix;
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    gl_Position = lightSpaceMatrix * model * vec4(aPositionOffset + aPositionScale * aPos, 1.0);
 }
\ No newline at end of file
@@ -10,8 +10,17 @@ uniform samplerCube textureEnvironment;
 //             --- User settings ---
 // ---------------------------------------------
 uniform int mipMapLevel;
-uniform float gamma;
-uniform float exposure;
+
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 camPos;
+	float gamma;
+	float exposure;
+	int renderOutput;
+	int debugOutput;
+};
 
 void main()
 {		
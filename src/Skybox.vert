@@ -4,13 +4,22 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec3 camPos;
+	float gamma;
+	float exposure;
+	int renderOutput;
+	int debugOutput;
+};
 
 void main()
 {
     TexCoords = aPos;
     
-	vec4 pos = projection * view * vec4(aPos, 1.0f);
+	// Remove the translation from the view matrix, so the skybox stays centered around the camera.
+	vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0f);
     gl_Position = pos.xyww;
 }  
\ No newline at end of file